@@ -275,6 +275,52 @@ FUNCTION(LL_ADD_INTEGRATION_TEST
 
 ENDFUNCTION(LL_ADD_INTEGRATION_TEST)
 
+#*****************************************************************************
+#   LL_ADD_BENCHMARK
+#*****************************************************************************
+# Builds tests/${benchmarkname}_benchmark.cpp, a standalone program with its
+# own main() that prints timings, into BENCHMARK_${benchmarkname}. Benchmarks
+# are only built when LL_BENCHMARKS is set and are never run by the build:
+# run them by hand from the staging directory.
+FUNCTION(LL_ADD_BENCHMARK
+        benchmarkname
+        additional_source_files
+        library_dependencies
+        )
+  if(NOT LL_BENCHMARKS)
+    return()
+  endif()
+
+  if(TEST_DEBUG)
+    message(STATUS "Adding BENCHMARK_${benchmarkname}")
+  endif()
+
+  add_executable(BENCHMARK_${benchmarkname}
+          tests/${benchmarkname}_benchmark.cpp
+          ${additional_source_files}
+          )
+  set_target_properties(BENCHMARK_${benchmarkname}
+          PROPERTIES
+          RUNTIME_OUTPUT_DIRECTORY "${EXE_STAGING_DIR}"
+          COMPILE_DEFINITIONS "LL_BENCHMARK=${benchmarkname}"
+          )
+
+  if (WINDOWS)
+    set_target_properties(BENCHMARK_${benchmarkname}
+            PROPERTIES
+            LINK_FLAGS "/debug /NODEFAULTLIB:LIBCMT /SUBSYSTEM:CONSOLE"
+            )
+  endif ()
+
+  if (DARWIN)
+    set_target_properties(BENCHMARK_${benchmarkname}
+            PROPERTIES
+            XCODE_ATTRIBUTE_CODE_SIGN_IDENTITY "-")
+  endif ()
+
+  target_link_libraries(BENCHMARK_${benchmarkname} ${library_dependencies})
+ENDFUNCTION(LL_ADD_BENCHMARK)
+
 #*****************************************************************************
 #   SET_TEST_PATH
 #*****************************************************************************
@@ -1325,6 +1325,28 @@ S32 LLAvatarAppearance::getCollisionVolumeID(std::string &name)
     return -1;
 }
 
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::beginVisualParamUpdate()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::beginVisualParamUpdate()
+{
+    for (polymesh_map_t::value_type& mesh_pair : mPolyMeshes)
+    {
+        mesh_pair.second->beginMorphBatch();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// LLAvatarAppearance::endVisualParamUpdate()
+//-----------------------------------------------------------------------------
+void LLAvatarAppearance::endVisualParamUpdate()
+{
+    for (polymesh_map_t::value_type& mesh_pair : mPolyMeshes)
+    {
+        mesh_pair.second->endMorphBatch();
+    }
+}
+
 //-----------------------------------------------------------------------------
 // LLAvatarAppearance::getHeadMesh()
 //-----------------------------------------------------------------------------
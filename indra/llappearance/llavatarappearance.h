@@ -36,6 +36,8 @@
 #include "llxmltree.h"
 
 class LLTexLayerSet;
+class LLLocalTextureObject;
+class LLImageRaw;
 class LLTexGlobalColor;
 class LLTexGlobalColorInfo;
 class LLWearableData;
@@ -260,6 +262,8 @@ public:
     // <FS:Ansariel> [Legacy Bake]
     //virtual void  invalidateComposite(LLTexLayerSet* layerset) = 0;
     virtual void    invalidateComposite(LLTexLayerSet* layerset, bool upload_result) = 0;
+    // Decoded pixels of a local texture for CPU compositing (LLTexLayerSet::renderToImage), if still available.
+    virtual LLImageRaw* getLocalTextureRaw(const LLLocalTextureObject* lto) const { return NULL; }
 
 /********************************************************************************
  **                                                                            **
@@ -269,6 +273,8 @@ public:
 public:
     virtual void    updateMeshTextures() = 0;
     virtual void    dirtyMesh() = 0; // Dirty the avatar mesh
+    /*virtual*/ void beginVisualParamUpdate(); // Batch morph target application
+    /*virtual*/ void endVisualParamUpdate();
     static const LLAvatarAppearanceDefines::LLAvatarAppearanceDictionary *getDictionary() { return sAvatarDictionary; }
 protected:
     virtual void    dirtyMesh(S32 priority) = 0; // Dirty the avatar mesh, with priority
@@ -39,6 +39,8 @@
 #include "lldir.h"
 #include "llvolume.h"
 #include "llendianswizzle.h"
+#include "llpolymeshcache.h"
+#include "hbxxh.h"
 
 
 #define HEADER_ASCII "Linden Mesh 1.0"
@@ -124,7 +126,20 @@ void LLPolyMeshSharedData::setupLOD(LLPolyMeshSharedData* reference_data)
 //-----------------------------------------------------------------------------
 void LLPolyMeshSharedData::freeMeshData()
 {
-        if (!mReferenceData)
+        if (mMappedFile.notNull())
+        {
+                // arrays point into the cache file mapping
+                mNumVertices = 0;
+                mBaseCoords = NULL;
+                mBaseNormals = NULL;
+                mBaseBinormals = NULL;
+                mTexCoords = NULL;
+                mDetailTexCoords = NULL;
+                mWeights = NULL;
+                mFaces = NULL;
+                mMappedFile = NULL;
+        }
+        else if (!mReferenceData)
         {
                 mNumVertices = 0;
 
@@ -267,6 +282,69 @@ bool LLPolyMeshSharedData::allocateJointNames( U32 numJointNames )
         return true;
 }
 
+//-----------------------------------------------------------------------------
+// LLPolyMeshSharedData::addMorphData()
+// Adds a loaded morph target along with the physics morphs derived from it.
+//-----------------------------------------------------------------------------
+void LLPolyMeshSharedData::addMorphData(LLPolyMorphData* morph_data)
+{
+        mMorphData.insert(morph_data);
+
+        const char* morph_name = morph_data->mName.c_str();
+
+        if (!strcmp(morph_name, "Breast_Female_Cleavage"))
+        {
+                mMorphData.insert(clone_morph_param_cleavage(morph_data,
+                                                             .75f,
+                                                             "Breast_Physics_LeftRight_Driven"));
+        }
+
+        if (!strcmp(morph_name, "Breast_Female_Cleavage"))
+        {
+                mMorphData.insert(clone_morph_param_duplicate(morph_data,
+                      "Breast_Physics_InOut_Driven"));
+        }
+        if (!strcmp(morph_name, "Breast_Gravity"))
+        {
+                mMorphData.insert(clone_morph_param_duplicate(morph_data,
+                      "Breast_Physics_UpDown_Driven"));
+        }
+
+        if (!strcmp(morph_name, "Big_Belly_Torso"))
+        {
+                mMorphData.insert(clone_morph_param_direction(morph_data,
+                      LLVector3(0,0,0.05f),
+                      "Belly_Physics_Torso_UpDown_Driven"));
+        }
+
+        if (!strcmp(morph_name, "Big_Belly_Legs"))
+        {
+                mMorphData.insert(clone_morph_param_direction(morph_data,
+                      LLVector3(0,0,0.05f),
+                      "Belly_Physics_Legs_UpDown_Driven"));
+        }
+
+        if (!strcmp(morph_name, "skirt_belly"))
+        {
+                mMorphData.insert(clone_morph_param_direction(morph_data,
+                      LLVector3(0,0,0.05f),
+                      "Belly_Physics_Skirt_UpDown_Driven"));
+        }
+
+        if (!strcmp(morph_name, "Small_Butt"))
+        {
+                mMorphData.insert(clone_morph_param_direction(morph_data,
+                      LLVector3(0,0,0.05f),
+                      "Butt_Physics_UpDown_Driven"));
+        }
+        if (!strcmp(morph_name, "Small_Butt"))
+        {
+                mMorphData.insert(clone_morph_param_direction(morph_data,
+                      LLVector3(0,0.03f,0),
+                      "Butt_Physics_LeftRight_Driven"));
+        }
+}
+
 //--------------------------------------------------------------------
 // LLPolyMeshSharedData::loadMesh()
 //--------------------------------------------------------------------
@@ -287,6 +365,32 @@ bool LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                 return false;
         }
 
+        //-------------------------------------------------------------------------
+        // Base meshes may come from the preprocessed cache instead
+        //-------------------------------------------------------------------------
+        U64 source_hash = 0;
+        if (!isLOD() && LLPolyMeshCache::sEnabled)
+        {
+                source_hash = HBXXH64(fp).digest();
+                fseek(fp, 0, SEEK_SET);
+
+                std::vector<LLPolyMorphData*> cached_morphs;
+                if (LLPolyMeshCache::load(this, fileName, source_hash, cached_morphs))
+                {
+                        for (LLPolyMorphData* morph_data : cached_morphs)
+                        {
+                                addMorphData(morph_data);
+                        }
+                        if (0 == mNumJointNames)
+                        {
+                                allocateJointNames(1);
+                        }
+                        fclose(fp);
+                        return true;
+                }
+        }
+        std::vector<LLPolyMorphData*> loaded_morphs;
+
         //-------------------------------------------------------------------------
         // Read a chunk
         //-------------------------------------------------------------------------
@@ -624,59 +728,8 @@ bool LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                                     continue;
                                 }
 
-                                mMorphData.insert(morph_data);
-
-                                if (!strcmp(morphName, "Breast_Female_Cleavage"))
-                                {
-                                        mMorphData.insert(clone_morph_param_cleavage(morph_data,
-                                                                                     .75f,
-                                                                                     "Breast_Physics_LeftRight_Driven"));
-                                }
-
-                                if (!strcmp(morphName, "Breast_Female_Cleavage"))
-                                {
-                                        mMorphData.insert(clone_morph_param_duplicate(morph_data,
-                                              "Breast_Physics_InOut_Driven"));
-                                }
-                                if (!strcmp(morphName, "Breast_Gravity"))
-                                {
-                                        mMorphData.insert(clone_morph_param_duplicate(morph_data,
-                                              "Breast_Physics_UpDown_Driven"));
-                                }
-
-                                if (!strcmp(morphName, "Big_Belly_Torso"))
-                                {
-                                        mMorphData.insert(clone_morph_param_direction(morph_data,
-                                              LLVector3(0,0,0.05f),
-                                              "Belly_Physics_Torso_UpDown_Driven"));
-                                }
-
-                                if (!strcmp(morphName, "Big_Belly_Legs"))
-                                {
-                                        mMorphData.insert(clone_morph_param_direction(morph_data,
-                                              LLVector3(0,0,0.05f),
-                                              "Belly_Physics_Legs_UpDown_Driven"));
-                                }
-
-                                if (!strcmp(morphName, "skirt_belly"))
-                                {
-                                        mMorphData.insert(clone_morph_param_direction(morph_data,
-                                              LLVector3(0,0,0.05f),
-                                              "Belly_Physics_Skirt_UpDown_Driven"));
-                                }
-
-                                if (!strcmp(morphName, "Small_Butt"))
-                                {
-                                        mMorphData.insert(clone_morph_param_direction(morph_data,
-                                              LLVector3(0,0,0.05f),
-                                              "Butt_Physics_UpDown_Driven"));
-                                }
-                                if (!strcmp(morphName, "Small_Butt"))
-                                {
-                                        mMorphData.insert(clone_morph_param_direction(morph_data,
-                                              LLVector3(0,0.03f,0),
-                                              "Butt_Physics_LeftRight_Driven"));
-                                }
+                                addMorphData(morph_data);
+                                loaded_morphs.push_back(morph_data);
                         }
 
                         S32 numRemaps;
@@ -703,6 +756,11 @@ bool LLPolyMeshSharedData::loadMesh( const std::string& fileName )
                                         mSharedVerts[remapSrc] = remapDst;
                                 }
                         }
+
+                        if (source_hash)
+                        {
+                                LLPolyMeshCache::save(this, fileName, source_hash, loaded_morphs);
+                        }
                 }
 
                 status = true;
@@ -757,6 +815,7 @@ LLPolyMesh::LLPolyMesh(LLPolyMeshSharedData *shared_data, LLPolyMesh *reference_
     mReferenceMesh = reference_mesh;
     mAvatarp = NULL;
     mVertexData = NULL;
+    mMorphBatchDepth = 0;
 
     mCurVertexCount = 0;
     mFaceIndexCount = 0;
@@ -970,6 +1029,123 @@ LLVector4a *LLPolyMesh::getScaledBinormals()
         return mScaledBinormals;
 }
 
+//-----------------------------------------------------------------------------
+// beginMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::beginMorphBatch()
+{
+    if (mMorphBatchDepth++ == 0 && !isLOD())
+    {
+        mMorphDirty.resize(mSharedData->mNumVertices, 0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// endMorphBatch()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::endMorphBatch()
+{
+    llassert(mMorphBatchDepth > 0);
+    if (mMorphBatchDepth <= 0 || --mMorphBatchDepth > 0)
+    {
+        return;
+    }
+
+    if (!mMorphDirtyList.empty())
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        updateMorphedNormals(mMorphDirtyList.data(), (U32)mMorphDirtyList.size());
+        for (U32 vert : mMorphDirtyList)
+        {
+            mMorphDirty[vert] = 0;
+        }
+        mMorphDirtyList.clear();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// markMorphedVertices()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::markMorphedVertices(const U32* indices, U32 count)
+{
+    llassert(isMorphBatchOpen());
+    for (U32 i = 0; i < count; ++i)
+    {
+        U32 vert = indices[i];
+        if (!mMorphDirty[vert])
+        {
+            mMorphDirty[vert] = 1;
+            mMorphDirtyList.push_back(vert);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+// updateMorphedNormals()
+//-----------------------------------------------------------------------------
+void LLPolyMesh::updateMorphedNormals(const U32* indices, U32 count)
+{
+    // Same math as the per vertex path:
+    //   normal   = normalize(scaled_normal)
+    //   binormal = normalize(normal x (scaled_binormal x normal))
+    // but done on four vertices at once with the components transposed
+    // into x, y, z and w registers.
+    U32 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const U32 v0 = indices[i], v1 = indices[i + 1], v2 = indices[i + 2], v3 = indices[i + 3];
+
+        LLQuad nx = mScaledNormals[v0], ny = mScaledNormals[v1], nz = mScaledNormals[v2], nw = mScaledNormals[v3];
+        _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+
+        LLQuad rsqrt = _mm_rsqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz)));
+        nx = _mm_mul_ps(nx, rsqrt);
+        ny = _mm_mul_ps(ny, rsqrt);
+        nz = _mm_mul_ps(nz, rsqrt);
+        nw = _mm_mul_ps(nw, rsqrt);
+
+        LLQuad bx = mScaledBinormals[v0], by = mScaledBinormals[v1], bz = mScaledBinormals[v2], bw = mScaledBinormals[v3];
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        // tangent = scaled_binormal x normal
+        const LLQuad tx = _mm_sub_ps(_mm_mul_ps(by, nz), _mm_mul_ps(bz, ny));
+        const LLQuad ty = _mm_sub_ps(_mm_mul_ps(bz, nx), _mm_mul_ps(bx, nz));
+        const LLQuad tz = _mm_sub_ps(_mm_mul_ps(bx, ny), _mm_mul_ps(by, nx));
+
+        // binormal = normal x tangent
+        bx = _mm_sub_ps(_mm_mul_ps(ny, tz), _mm_mul_ps(nz, ty));
+        by = _mm_sub_ps(_mm_mul_ps(nz, tx), _mm_mul_ps(nx, tz));
+        bz = _mm_sub_ps(_mm_mul_ps(nx, ty), _mm_mul_ps(ny, tx));
+        bw = _mm_setzero_ps();
+
+        rsqrt = _mm_rsqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(bx, bx), _mm_mul_ps(by, by)), _mm_mul_ps(bz, bz)));
+        bx = _mm_mul_ps(bx, rsqrt);
+        by = _mm_mul_ps(by, rsqrt);
+        bz = _mm_mul_ps(bz, rsqrt);
+
+        _MM_TRANSPOSE4_PS(nx, ny, nz, nw);
+        mNormals[v0] = nx; mNormals[v1] = ny; mNormals[v2] = nz; mNormals[v3] = nw;
+
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+        mBinormals[v0] = bx; mBinormals[v1] = by; mBinormals[v2] = bz; mBinormals[v3] = bw;
+    }
+
+    for (; i < count; ++i)
+    {
+        const U32 vert = indices[i];
+
+        LLVector4a norm = mScaledNormals[vert];
+        norm.normalize3fast();
+        mNormals[vert] = norm;
+
+        LLVector4a tangent;
+        tangent.setCross3(mScaledBinormals[vert], norm);
+        LLVector4a& normalized_binormal = mBinormals[vert];
+        normalized_binormal.setCross3(norm, tangent);
+        normalized_binormal.normalize3fast();
+    }
+}
+
 
 //-----------------------------------------------------------------------------
 // initializeForMorph()
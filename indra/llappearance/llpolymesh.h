@@ -30,6 +30,8 @@
 #include <string>
 #include <map>
 #include "llstl.h"
+#include "llmappedfile.h"
+#include "llpointer.h"
 
 #include "v3math.h"
 #include "v2math.h"
@@ -64,6 +66,7 @@ class LLPolyMorphTarget;
 class LLPolyMeshSharedData
 {
     friend class LLPolyMesh;
+    friend class LLPolyMeshCache;
 private:
     // transform data
     LLVector3               mPosition;
@@ -99,6 +102,9 @@ private:
     LLPolyMeshSharedData*       mReferenceData;
     S32                         mLastIndexOffset;
 
+    // set when the vertex and face arrays live in a mapped cache file
+    LLPointer<LLMappedFile>     mMappedFile;
+
 public:
     // Temporarily...
     // Triangle indices
@@ -131,6 +137,9 @@ private:
     // Load mesh data from file
     bool loadMesh( const std::string& fileName );
 
+    // Adds a morph target and the physics morphs derived from it
+    void addMorphData( LLPolyMorphData* morph_data );
+
 public:
     void genIndices(S32 offset);
 
@@ -318,6 +327,22 @@ public:
 
     bool    isLOD() { return mSharedData && mSharedData->isLOD(); }
 
+    //--------------------------------------------------------------------
+    // Morph batching
+    //--------------------------------------------------------------------
+    // While a batch is open, morph targets only accumulate their deltas
+    // into the coords and scaled normals/binormals and flag the vertices
+    // they touched. The output normals and binormals of all flagged
+    // vertices are then rebuilt in one pass by endMorphBatch().
+    void    beginMorphBatch();
+    void    endMorphBatch();
+    bool    isMorphBatchOpen() const { return mMorphBatchDepth > 0; }
+    void    markMorphedVertices(const U32* indices, U32 count);
+
+    // Rebuilds output normals and binormals from the scaled ones for the
+    // given vertices, four vertices at a time.
+    void    updateMorphedNormals(const U32* indices, U32 count);
+
     void setAvatar(LLAvatarAppearance* avatarp) { mAvatarp = avatarp; }
     LLAvatarAppearance* getAvatar() { return mAvatarp; }
 
@@ -356,6 +381,11 @@ protected:
 
     LLPolyMesh              *mReferenceMesh;
 
+    // open morph batch nesting count and vertices touched within the batch
+    S32                     mMorphBatchDepth;
+    std::vector<U8>         mMorphDirty;
+    std::vector<U32>        mMorphDirtyList;
+
     // global mesh list
     typedef std::map<std::string, LLPolyMeshSharedData*> LLPolyMeshSharedDataTable;
     static LLPolyMeshSharedDataTable sGlobalSharedMeshList;
@@ -0,0 +1,402 @@
+/**
+ * @file llpolymeshcache.cpp
+ * @brief Preprocessed, memory mappable cache of avatar base meshes and morphs.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpolymeshcache.h"
+
+#include "llapp.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llpolymesh.h"
+#include "llpolymorph.h"
+
+bool LLPolyMeshCache::sEnabled = true;
+
+static const char CACHE_MAGIC[8] = { 'L', 'L', 'M', 'C', 'A', 'C', 'H', 'E' };
+// Bump whenever the layout below or the parsing in loadMesh() changes.
+static const U32 CACHE_VERSION = 1;
+static const U32 CACHE_NAME_LENGTH = 64;
+static const U32 CACHE_FLAG_WEIGHTS = 0x1;
+static const U32 CACHE_FLAG_DETAIL_TEXCOORDS = 0x2;
+
+// All offsets are in bytes from the start of the file and 16 byte aligned.
+struct LLPolyMeshCacheHeader
+{
+    char    mMagic[8];
+    U32     mVersion;
+    U32     mFlags;
+    U64     mSourceHash;
+
+    U32     mNumVertices;
+    U32     mNumFaces;
+    U32     mNumJointNames;
+    U32     mNumMorphs;
+    U32     mNumRemaps;
+    U32     mPad;
+
+    F32     mPosition[3];
+    F32     mRotation[4];
+    F32     mScale[3];
+
+    U64     mCoordsOffset;          // LLVector4a[mNumVertices]
+    U64     mNormalsOffset;         // LLVector4a[mNumVertices]
+    U64     mBinormalsOffset;       // LLVector4a[mNumVertices]
+    U64     mTexCoordsOffset;       // LLVector2[mNumVertices]
+    U64     mDetailTexCoordsOffset; // LLVector2[mNumVertices]
+    U64     mWeightsOffset;         // F32[mNumVertices]
+    U64     mFacesOffset;           // LLPolyFace[mNumFaces]
+    U64     mJointNamesOffset;      // char[mNumJointNames][CACHE_NAME_LENGTH]
+    U64     mMorphsOffset;          // LLPolyMeshCacheMorph[mNumMorphs]
+    U64     mRemapsOffset;          // S32[mNumRemaps][2]
+};
+
+struct LLPolyMeshCacheMorph
+{
+    char    mName[CACHE_NAME_LENGTH];
+    U32     mNumIndices;
+    F32     mTotalDistortion;
+    F32     mMaxDistortion;
+    U32     mPad;
+    F32     mAvgDistortion[4];
+
+    U64     mIndicesOffset;         // U32[mNumIndices]
+    U64     mCoordsOffset;          // LLVector4a[mNumIndices]
+    U64     mNormalsOffset;         // LLVector4a[mNumIndices]
+    U64     mBinormalsOffset;       // LLVector4a[mNumIndices]
+    U64     mTexCoordsOffset;       // LLVector2[mNumIndices]
+};
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Appends data to the output buffer at the next 16 byte boundary and
+    // returns its offset.
+    U64 append_block(std::vector<U8>& buffer, const void* data, size_t size)
+    {
+        size_t offset = (buffer.size() + 15) & ~(size_t)15;
+        buffer.resize(offset + size, 0);
+        if (size)
+        {
+            memcpy(&buffer[offset], data, size);
+        }
+        return offset;
+    }
+
+    void copy_name(char* dst, const std::string& name)
+    {
+        memset(dst, 0, CACHE_NAME_LENGTH);
+        strncpy(dst, name.c_str(), CACHE_NAME_LENGTH - 1);
+    }
+
+    // Returns a pointer into the mapping if [offset, offset + count * size)
+    // lies within it and offset is suitably aligned, NULL otherwise.
+    template<typename T>
+    T* map_block(const LLMappedFile* file, U64 offset, U64 count)
+    {
+        const U64 file_size = file->getSize();
+        if ((offset & 15) || offset > file_size || count > (file_size - offset) / sizeof(T))
+        {
+            return NULL;
+        }
+        return reinterpret_cast<T*>(file->getData() + offset);
+    }
+
+    bool name_is_valid(const char* name)
+    {
+        return memchr(name, '\0', CACHE_NAME_LENGTH) != NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// getCacheFilename()
+//-----------------------------------------------------------------------------
+// static
+std::string LLPolyMeshCache::getCacheFilename(const std::string& mesh_filename)
+{
+    std::string basename = gDirUtilp->getBaseFileName(mesh_filename, true);
+    return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, basename + ".llmc");
+}
+
+//-----------------------------------------------------------------------------
+// load()
+//-----------------------------------------------------------------------------
+// static
+bool LLPolyMeshCache::load(LLPolyMeshSharedData* mesh, const std::string& mesh_filename, U64 source_hash,
+                           std::vector<LLPolyMorphData*>& morphs)
+{
+    const std::string filename = getCacheFilename(mesh_filename);
+    if (!LLFile::isfile(filename))
+    {
+        return false;
+    }
+
+    LLPointer<LLMappedFile> file = new LLMappedFile();
+    if (!file->map(filename))
+    {
+        return false;
+    }
+
+    const LLPolyMeshCacheHeader* header = map_block<LLPolyMeshCacheHeader>(file, 0, 1);
+    if (!header
+        || memcmp(header->mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC))
+        || header->mVersion != CACHE_VERSION
+        || header->mSourceHash != source_hash)
+    {
+        LL_INFOS("Avatar") << "Mesh cache " << filename << " is stale, rebuilding" << LL_ENDL;
+        return false;
+    }
+
+    const U32 num_vertices = header->mNumVertices;
+    LLVector4a* coords = map_block<LLVector4a>(file, header->mCoordsOffset, num_vertices);
+    LLVector4a* normals = map_block<LLVector4a>(file, header->mNormalsOffset, num_vertices);
+    LLVector4a* binormals = map_block<LLVector4a>(file, header->mBinormalsOffset, num_vertices);
+    LLVector2* tex_coords = map_block<LLVector2>(file, header->mTexCoordsOffset, num_vertices);
+    LLVector2* detail_tex_coords = map_block<LLVector2>(file, header->mDetailTexCoordsOffset, num_vertices);
+    F32* weights = map_block<F32>(file, header->mWeightsOffset, num_vertices);
+    LLPolyFace* faces = map_block<LLPolyFace>(file, header->mFacesOffset, header->mNumFaces);
+    const char* joint_names = map_block<const char>(file, header->mJointNamesOffset,
+                                                    (U64)header->mNumJointNames * CACHE_NAME_LENGTH);
+    const LLPolyMeshCacheMorph* morph_table = map_block<const LLPolyMeshCacheMorph>(file, header->mMorphsOffset,
+                                                                                   header->mNumMorphs);
+    const S32* remaps = map_block<const S32>(file, header->mRemapsOffset, (U64)header->mNumRemaps * 2);
+    if (!coords || !normals || !binormals || !tex_coords || !detail_tex_coords || !weights
+        || !faces || !joint_names || !morph_table || !remaps)
+    {
+        LL_WARNS("Avatar") << "Mesh cache " << filename << " is truncated or corrupt" << LL_ENDL;
+        return false;
+    }
+
+    for (U32 i = 0; i < header->mNumJointNames; ++i)
+    {
+        if (!name_is_valid(joint_names + i * CACHE_NAME_LENGTH))
+        {
+            LL_WARNS("Avatar") << "Mesh cache " << filename << " has an invalid joint name" << LL_ENDL;
+            return false;
+        }
+    }
+
+    // Validate every morph before creating any, so failure leaves nothing behind
+    for (U32 i = 0; i < header->mNumMorphs; ++i)
+    {
+        const LLPolyMeshCacheMorph& entry = morph_table[i];
+        const U32 count = entry.mNumIndices;
+        const U32* indices = map_block<const U32>(file, entry.mIndicesOffset, count);
+        bool valid = name_is_valid(entry.mName)
+            && indices
+            && map_block<LLVector4a>(file, entry.mCoordsOffset, count)
+            && map_block<LLVector4a>(file, entry.mNormalsOffset, count)
+            && map_block<LLVector4a>(file, entry.mBinormalsOffset, count)
+            && map_block<LLVector2>(file, entry.mTexCoordsOffset, count);
+        for (U32 v = 0; valid && v < count; ++v)
+        {
+            valid = indices[v] < num_vertices;
+        }
+        if (!valid)
+        {
+            LL_WARNS("Avatar") << "Mesh cache " << filename << " has an invalid morph target" << LL_ENDL;
+            return false;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Mesh data
+    //-------------------------------------------------------------------------
+    mesh->mMappedFile = file;
+    mesh->mNumVertices = num_vertices;
+    mesh->mBaseCoords = coords;
+    mesh->mBaseNormals = normals;
+    mesh->mBaseBinormals = binormals;
+    mesh->mTexCoords = tex_coords;
+    mesh->mDetailTexCoords = detail_tex_coords;
+    mesh->mWeights = weights;
+    mesh->mHasWeights = (header->mFlags & CACHE_FLAG_WEIGHTS) != 0;
+    mesh->mHasDetailTexCoords = (header->mFlags & CACHE_FLAG_DETAIL_TEXCOORDS) != 0;
+    mesh->mNumFaces = header->mNumFaces;
+    mesh->mNumTriangleIndices = header->mNumFaces * 3;
+    mesh->mFaces = faces;
+
+    mesh->setPosition(LLVector3(header->mPosition));
+    mesh->setRotation(LLQuaternion(header->mRotation[VX], header->mRotation[VY],
+                                   header->mRotation[VZ], header->mRotation[VW]));
+    mesh->setScale(LLVector3(header->mScale));
+
+    if (header->mNumJointNames)
+    {
+        mesh->allocateJointNames(header->mNumJointNames);
+        for (U32 i = 0; i < header->mNumJointNames; ++i)
+        {
+            mesh->mJointNames[i] = joint_names + i * CACHE_NAME_LENGTH;
+        }
+    }
+
+    for (U32 i = 0; i < header->mNumRemaps; ++i)
+    {
+        mesh->mSharedVerts[remaps[i * 2]] = remaps[i * 2 + 1];
+    }
+
+    //-------------------------------------------------------------------------
+    // Morph targets
+    //-------------------------------------------------------------------------
+    morphs.reserve(header->mNumMorphs);
+    for (U32 i = 0; i < header->mNumMorphs; ++i)
+    {
+        const LLPolyMeshCacheMorph& entry = morph_table[i];
+        LLPolyMorphData* morph_data = new LLPolyMorphData(std::string(entry.mName));
+        morph_data->mMappedFile = file;
+        morph_data->mMesh = mesh;
+        morph_data->mNumIndices = entry.mNumIndices;
+        morph_data->mVertexIndices = map_block<U32>(file, entry.mIndicesOffset, entry.mNumIndices);
+        morph_data->mCoords = map_block<LLVector4a>(file, entry.mCoordsOffset, entry.mNumIndices);
+        morph_data->mNormals = map_block<LLVector4a>(file, entry.mNormalsOffset, entry.mNumIndices);
+        morph_data->mBinormals = map_block<LLVector4a>(file, entry.mBinormalsOffset, entry.mNumIndices);
+        morph_data->mTexCoords = map_block<LLVector2>(file, entry.mTexCoordsOffset, entry.mNumIndices);
+        morph_data->mTotalDistortion = entry.mTotalDistortion;
+        morph_data->mMaxDistortion = entry.mMaxDistortion;
+        morph_data->mAvgDistortion.loadua(entry.mAvgDistortion);
+        morphs.push_back(morph_data);
+    }
+
+    LL_DEBUGS("Avatar") << "Mapped " << mesh_filename << " from cache: " << num_vertices << " vertices, "
+                        << header->mNumMorphs << " morphs" << LL_ENDL;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// save()
+//-----------------------------------------------------------------------------
+// static
+bool LLPolyMeshCache::save(const LLPolyMeshSharedData* mesh, const std::string& mesh_filename, U64 source_hash,
+                           const std::vector<LLPolyMorphData*>& morphs)
+{
+    if (!mesh || !mesh->mNumVertices || !mesh->mBaseCoords)
+    {
+        return false;
+    }
+
+    const U32 num_vertices = mesh->mNumVertices;
+    const U32 num_faces = mesh->mFaces ? mesh->mNumFaces : 0;
+
+    std::vector<U8> buffer;
+    buffer.reserve(num_vertices * (sizeof(LLVector4a) * 3 + sizeof(LLVector2) * 2 + sizeof(F32)) * 2);
+    buffer.resize(sizeof(LLPolyMeshCacheHeader), 0);
+
+    LLPolyMeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.mVersion = CACHE_VERSION;
+    header.mFlags = (mesh->mHasWeights ? CACHE_FLAG_WEIGHTS : 0)
+                  | (mesh->mHasDetailTexCoords ? CACHE_FLAG_DETAIL_TEXCOORDS : 0);
+    header.mSourceHash = source_hash;
+    header.mNumVertices = num_vertices;
+    header.mNumFaces = num_faces;
+    header.mNumJointNames = mesh->mNumJointNames;
+    header.mNumMorphs = (U32)morphs.size();
+    header.mNumRemaps = (U32)mesh->mSharedVerts.size();
+    memcpy(header.mPosition, mesh->mPosition.mV, sizeof(header.mPosition));
+    memcpy(header.mRotation, mesh->mRotation.mQ, sizeof(header.mRotation));
+    memcpy(header.mScale, mesh->mScale.mV, sizeof(header.mScale));
+
+    header.mCoordsOffset = append_block(buffer, mesh->mBaseCoords, num_vertices * sizeof(LLVector4a));
+    header.mNormalsOffset = append_block(buffer, mesh->mBaseNormals, num_vertices * sizeof(LLVector4a));
+    header.mBinormalsOffset = append_block(buffer, mesh->mBaseBinormals, num_vertices * sizeof(LLVector4a));
+    header.mTexCoordsOffset = append_block(buffer, mesh->mTexCoords, num_vertices * sizeof(LLVector2));
+    header.mDetailTexCoordsOffset = append_block(buffer, mesh->mDetailTexCoords, num_vertices * sizeof(LLVector2));
+    header.mWeightsOffset = append_block(buffer, mesh->mWeights, num_vertices * sizeof(F32));
+    header.mFacesOffset = append_block(buffer, mesh->mFaces, num_faces * sizeof(LLPolyFace));
+
+    std::vector<char> joint_names(mesh->mNumJointNames * CACHE_NAME_LENGTH);
+    for (U32 i = 0; i < mesh->mNumJointNames; ++i)
+    {
+        copy_name(&joint_names[i * CACHE_NAME_LENGTH], mesh->mJointNames[i]);
+    }
+    header.mJointNamesOffset = append_block(buffer, joint_names.data(), joint_names.size());
+
+    std::vector<S32> remaps;
+    remaps.reserve(mesh->mSharedVerts.size() * 2);
+    for (const auto& remap : mesh->mSharedVerts)
+    {
+        remaps.push_back(remap.first);
+        remaps.push_back(remap.second);
+    }
+    header.mRemapsOffset = append_block(buffer, remaps.data(), remaps.size() * sizeof(S32));
+
+    std::vector<LLPolyMeshCacheMorph> morph_table(morphs.size());
+    for (size_t i = 0; i < morphs.size(); ++i)
+    {
+        const LLPolyMorphData* morph_data = morphs[i];
+        LLPolyMeshCacheMorph& entry = morph_table[i];
+        memset(&entry, 0, sizeof(entry));
+        copy_name(entry.mName, morph_data->mName);
+        entry.mNumIndices = morph_data->mNumIndices;
+        entry.mTotalDistortion = morph_data->mTotalDistortion;
+        entry.mMaxDistortion = morph_data->mMaxDistortion;
+        memcpy(entry.mAvgDistortion, morph_data->mAvgDistortion.getF32ptr(), sizeof(entry.mAvgDistortion));
+
+        const U32 count = morph_data->mNumIndices;
+        entry.mIndicesOffset = append_block(buffer, morph_data->mVertexIndices, count * sizeof(U32));
+        entry.mCoordsOffset = append_block(buffer, morph_data->mCoords, count * sizeof(LLVector4a));
+        entry.mNormalsOffset = append_block(buffer, morph_data->mNormals, count * sizeof(LLVector4a));
+        entry.mBinormalsOffset = append_block(buffer, morph_data->mBinormals, count * sizeof(LLVector4a));
+        entry.mTexCoordsOffset = append_block(buffer, morph_data->mTexCoords, count * sizeof(LLVector2));
+    }
+    header.mMorphsOffset = append_block(buffer, morph_table.data(), morph_table.size() * sizeof(LLPolyMeshCacheMorph));
+
+    memcpy(&buffer[0], &header, sizeof(header));
+
+    // Write to a temporary file and move it in place, so that a concurrent
+    // viewer never maps a partially written cache.
+    const std::string filename = getCacheFilename(mesh_filename);
+    const std::string temp_filename = llformat("%s.%d.tmp", filename.c_str(), LLApp::getPid());
+    LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+    if (!fp)
+    {
+        LL_WARNS("Avatar") << "Can't create mesh cache " << temp_filename << LL_ENDL;
+        return false;
+    }
+    const bool written = fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+    fclose(fp);
+
+    if (!written)
+    {
+        LL_WARNS("Avatar") << "Failed writing mesh cache " << temp_filename << LL_ENDL;
+        LLFile::remove(temp_filename);
+        return false;
+    }
+
+    LLFile::remove(filename, ENOENT);
+    if (LLFile::rename(temp_filename, filename) != 0)
+    {
+        // most likely another viewer instance has the old cache mapped
+        LLFile::remove(temp_filename);
+        return false;
+    }
+
+    LL_DEBUGS("Avatar") << "Wrote mesh cache " << filename << " (" << buffer.size() << " bytes)" << LL_ENDL;
+    return true;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file llpolymeshcache.h
+ * @brief Preprocessed, memory mappable cache of avatar base meshes and morphs.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPOLYMESHCACHE_H
+#define LL_LLPOLYMESHCACHE_H
+
+#include <string>
+#include <vector>
+
+class LLPolyMeshSharedData;
+class LLPolyMorphData;
+
+//-----------------------------------------------------------------------------
+// LLPolyMeshCache
+// Stores the parsed contents of an avatar_*.llm base mesh (vertex arrays,
+// faces, joint names, vertex remaps and morph targets) in a native, 16 byte
+// aligned file under the cache directory. Loading maps that file and points
+// LLPolyMeshSharedData and LLPolyMorphData straight into it, so nothing is
+// parsed or copied and the pages are shared between viewer instances.
+// A cache file is only used when its format version and the hash of the
+// source .llm file both match; otherwise the mesh is parsed and the cache
+// rewritten.
+//-----------------------------------------------------------------------------
+class LLPolyMeshCache
+{
+public:
+    static bool sEnabled;
+
+    static std::string getCacheFilename(const std::string& mesh_filename);
+
+    // On success, mesh is filled in and morphs receives the morph targets
+    // stored in the cache (the caller takes ownership).
+    static bool load(LLPolyMeshSharedData* mesh, const std::string& mesh_filename, U64 source_hash,
+                     std::vector<LLPolyMorphData*>& morphs);
+
+    // Writes the cache for a freshly parsed base mesh. morphs are the morph
+    // targets read from the file, without the derived physics morphs.
+    static bool save(const LLPolyMeshSharedData* mesh, const std::string& mesh_filename, U64 source_hash,
+                     const std::vector<LLPolyMorphData*>& morphs);
+};
+
+#endif // LL_LLPOLYMESHCACHE_H
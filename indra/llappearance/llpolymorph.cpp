@@ -28,6 +28,8 @@
 // Header Files
 //-----------------------------------------------------------------------------
 
+#include "linden_common.h"
+
 #include "llpolymorph.h"
 #include "llavatarappearance.h"
 #include "llavatarjoint.h"
@@ -221,6 +223,18 @@ bool LLPolyMorphData::loadBinary(LLFILE *fp, LLPolyMeshSharedData *mesh)
 //-----------------------------------------------------------------------------
 void LLPolyMorphData::freeData()
 {
+    if (mMappedFile.notNull())
+    {
+        // arrays point into the cache file mapping
+        mCoords = NULL;
+        mNormals = NULL;
+        mBinormals = NULL;
+        mTexCoords = NULL;
+        mVertexIndices = NULL;
+        mMappedFile = NULL;
+        return;
+    }
+
     if (mCoords != NULL)
     {
         ll_aligned_free_16(mCoords);
@@ -573,15 +587,22 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
         LLVector4a *coords = mMesh->getWritableCoords();
 
         LLVector4a *scaled_normals = mMesh->getScaledNormals();
-        LLVector4a *normals = mMesh->getWritableNormals();
-
         LLVector4a *scaled_binormals = mMesh->getScaledBinormals();
-        LLVector4a *binormals = mMesh->getWritableBinormals();
 
         LLVector4a *clothing_weights = mMesh->getWritableClothingWeights();
         LLVector2 *tex_coords = mMesh->getWritableTexCoords();
 
         F32 *maskWeightArray = (mVertMask) ? mVertMask->getMorphMaskWeights() : NULL;
+        const bool clothing_morph = getInfo()->mIsClothingMorph && clothing_weights;
+
+        // Accumulate the weighted deltas only. Output normals and binormals
+        // depend solely on the accumulated scaled vectors, so they are
+        // rebuilt afterwards in a separate pass (once per batch of morphs
+        // when the mesh has a morph batch open).
+        LLVector4a weight;
+        weight.splat(delta_weight);
+        LLVector4a soft_weight;
+        soft_weight.splat(delta_weight * NORMAL_SOFTEN_FACTOR);
 
         for(U32 vert_index_morph = 0; vert_index_morph < mMorphData->mNumIndices; vert_index_morph++)
         {
@@ -591,34 +612,25 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
             if (maskWeightArray)
             {
                 maskWeight = maskWeightArray[vert_index_morph];
+                weight.splat(delta_weight * maskWeight);
+                soft_weight.splat(delta_weight * maskWeight * NORMAL_SOFTEN_FACTOR);
             }
 
-
-            LLVector4a pos = mMorphData->mCoords[vert_index_morph];
-            pos.mul(delta_weight*maskWeight);
+            LLVector4a pos;
+            pos.setMul(mMorphData->mCoords[vert_index_morph], weight);
             coords[vert_index_mesh].add(pos);
 
-            if (getInfo()->mIsClothingMorph && clothing_weights)
+            if (clothing_morph)
             {
-                LLVector4a clothing_offset = mMorphData->mCoords[vert_index_morph];
-                clothing_offset.mul(delta_weight * maskWeight);
                 LLVector4a* clothing_weight = &clothing_weights[vert_index_mesh];
-                clothing_weight->add(clothing_offset);
+                clothing_weight->add(pos);
                 clothing_weight->getF32ptr()[VW] = maskWeight;
             }
 
-            // calculate new normals based on half angles
-            LLVector4a norm = mMorphData->mNormals[vert_index_morph];
-            norm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+            LLVector4a norm;
+            norm.setMul(mMorphData->mNormals[vert_index_morph], soft_weight);
             scaled_normals[vert_index_mesh].add(norm);
-            norm = scaled_normals[vert_index_mesh];
-
-            // guard against degenerate input data before we create NaNs below!
-            //
-            norm.normalize3fast();
-            normals[vert_index_mesh] = norm;
 
-            // calculate new binormals
             LLVector4a binorm = mMorphData->mBinormals[vert_index_morph];
 
             // guard against degenerate input data before we create NaNs below!
@@ -628,18 +640,21 @@ void LLPolyMorphTarget::apply( ESex avatar_sex )
                 binorm.set(1,0,0,1);
             }
 
-            binorm.mul(delta_weight*maskWeight*NORMAL_SOFTEN_FACTOR);
+            binorm.mul(soft_weight);
             scaled_binormals[vert_index_mesh].add(binorm);
-            LLVector4a tangent;
-            tangent.setCross3(scaled_binormals[vert_index_mesh], norm);
-            LLVector4a& normalized_binormal = binormals[vert_index_mesh];
-
-            normalized_binormal.setCross3(norm, tangent);
-            normalized_binormal.normalize3fast();
 
             tex_coords[vert_index_mesh] += mMorphData->mTexCoords[vert_index_morph] * delta_weight * maskWeight;
         }
 
+        if (mMesh->isMorphBatchOpen())
+        {
+            mMesh->markMorphedVertices(mMorphData->mVertexIndices, mMorphData->mNumIndices);
+        }
+        else
+        {
+            mMesh->updateMorphedNormals(mMorphData->mVertexIndices, mMorphData->mNumIndices);
+        }
+
         // now apply volume changes
         for(LLPolyVolumeMorph& volume_morph : mVolumeMorphs)
         {
@@ -30,6 +30,8 @@
 #include <string>
 #include <vector>
 
+#include "llmappedfile.h"
+#include "llpointer.h"
 #include "llviewervisualparam.h"
 
 class LLAvatarJointCollisionVolume;
@@ -69,6 +71,9 @@ public:
     LLVector4a          mAvgDistortion;     // average vertex distortion, to infer directionality of the morph
     LLPolyMeshSharedData*   mMesh;
 
+    // set when the arrays above live in a mapped cache file
+    LLPointer<LLMappedFile> mMappedFile;
+
 private:
     void freeData();
 } LL_ALIGN_POSTFIX(16);
@@ -32,6 +32,7 @@
 #include "llcrc.h"
 #include "llimagej2c.h"
 #include "llimagetga.h"
+#include "lltexlayerimage.h"
 #include "lldir.h"
 #include "lltexlayerparams.h"
 #include "lltexturemanagerbridge.h"
@@ -535,6 +536,94 @@ void LLTexLayerSet::renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height,
     gGL.setSceneBlendType(LLRender::BT_ALPHA);
 }
 
+bool LLTexLayerSet::renderToImage(LLImageRaw* image)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    if (!image || image->getComponents() != 4)
+    {
+        return false;
+    }
+
+    bool success = true;
+    mIsVisible = true;
+
+    for (LLTexLayerInterface* layer : mMaskLayerList)
+    {
+        if (layer->isInvisibleAlphaMask())
+        {
+            mIsVisible = false;
+        }
+    }
+
+    LLTexLayerImageTarget target(image);
+
+    // clear to opaque black, as render() does
+    target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+    target.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+    target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+
+    if (mIsVisible)
+    {
+        // composite color layers
+        for (LLTexLayerInterface* layer : mLayerList)
+        {
+            if (layer->getRenderPass() == LLTexLayer::RP_COLOR)
+            {
+                success &= layer->renderToImage(target);
+            }
+        }
+
+        renderAlphaMaskTexturesToImage(target, false);
+    }
+    else
+    {
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.setMinimumAlpha(0.f);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 0.f));
+    }
+
+    return success;
+}
+
+void LLTexLayerSet::renderAlphaMaskTexturesToImage(LLTexLayerImageTarget& target, bool forceClear)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const LLTexLayerSetInfo *info = getInfo();
+
+    target.setColorMask(false, true);
+    target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+
+    // (Optionally) replace alpha with a single component image from a tga file.
+    if (!info->mStaticAlphaFileName.empty())
+    {
+        LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(info->mStaticAlphaFileName, true);
+        if (image)
+        {
+            target.drawImage(image, LLColor4::white);
+        }
+    }
+    else if (forceClear || info->mClearAlpha || (mMaskLayerList.size() > 0))
+    {
+        // Set the alpha channel to one (clean up after previous blending)
+        target.setMinimumAlpha(0.f);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+        target.setMinimumAlpha(0.004f);
+    }
+
+    // (Optional) Mask out part of the baked texture with alpha masks
+    if (mMaskLayerList.size() > 0)
+    {
+        target.setBlendType(LLTexLayerImageTarget::BT_MULT_ALPHA);
+        for (LLTexLayerInterface* layer : mMaskLayerList)
+        {
+            layer->blendAlphaTextureToImage(target);
+        }
+    }
+
+    target.setColorMask(true, true);
+    target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+}
+
 void LLTexLayerSet::applyMorphMask(const U8* tex_data, S32 width, S32 height, S32 num_components)
 {
     mAvatarAppearance->applyMorphMask(tex_data, width, height, num_components, mBakedTexIndex);
@@ -1187,6 +1276,194 @@ bool LLTexLayer::render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bou
     return success;
 }
 
+/*virtual*/ bool LLTexLayer::renderToImage(LLTexLayerImageTarget& target)
+{
+    LLColor4 net_color;
+    bool color_specified = findNetColor(&net_color);
+
+    if (mTexLayerSet->getAvatarAppearance()->mIsDummy)
+    {
+        color_specified = true;
+        net_color = LLAvatarAppearance::getDummyColor();
+    }
+
+    bool success = true;
+
+    // If you can't see the layer, don't render it.
+    if( is_approx_zero( net_color.mV[VALPHA] ) )
+    {
+        return success;
+    }
+
+    bool alpha_mask_specified = false;
+    if (!mParamAlphaList.empty())
+    {
+        renderMorphMasksToImage(target, net_color);
+        alpha_mask_specified = true;
+        target.setBlendType(LLTexLayerImageTarget::BT_DEST_ALPHA);
+    }
+
+    if( getInfo()->mWriteAllChannels )
+    {
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+    }
+
+    if( (getInfo()->mLocalTexture != -1) && !getInfo()->mUseLocalTextureAlphaOnly )
+    {
+        LLImageRaw* image = NULL;
+        if (mLocalTextureObject && mLocalTextureObject->getID() != IMG_DEFAULT_AVATAR)
+        {
+            image = mTexLayerSet->getAvatarAppearance()->getLocalTextureRaw(mLocalTextureObject);
+        }
+        if (image)
+        {
+            bool no_alpha_test = getInfo()->mWriteAllChannels;
+            if (no_alpha_test)
+            {
+                target.setMinimumAlpha(0.f);
+            }
+            target.drawImage(image, net_color);
+            if (no_alpha_test)
+            {
+                target.setMinimumAlpha(0.004f);
+            }
+        }
+    }
+
+    if( !getInfo()->mStaticImageFileName.empty() )
+    {
+        LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+        if( image )
+        {
+            target.drawImage(image, net_color);
+        }
+        else
+        {
+            success = false;
+        }
+    }
+
+    if(((-1 == getInfo()->mLocalTexture) ||
+         getInfo()->mUseLocalTextureAlphaOnly) &&
+        getInfo()->mStaticImageFileName.empty() &&
+        color_specified )
+    {
+        target.setMinimumAlpha(0.f);
+        target.drawRect(net_color);
+        target.setMinimumAlpha(0.004f);
+    }
+
+    if( alpha_mask_specified || getInfo()->mWriteAllChannels )
+    {
+        // Restore standard blend func value
+        target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+    }
+
+    if( !success )
+    {
+        LL_INFOS() << "LLTexLayer::renderToImage() partial: " << getInfo()->mName << LL_ENDL;
+    }
+    return success;
+}
+
+void LLTexLayer::renderMorphMasksToImage(LLTexLayerImageTarget& target, const LLColor4 &layer_color)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    llassert( !mParamAlphaList.empty() );
+
+    target.setMinimumAlpha(0.f);
+    target.setColorMask(false, true);
+
+    LLTexLayerParamAlpha* first_param = *mParamAlphaList.begin();
+    // Note: if the first param is a mulitply, multiply against the current buffer's alpha
+    if( !first_param || !first_param->getMultiplyBlend() )
+    {
+        // Clear the alpha
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 0.f));
+    }
+
+    // Accumulate alphas
+    for (LLTexLayerParamAlpha* param : mParamAlphaList)
+    {
+        param->renderToImage(target);
+    }
+
+    // Approximates a min() function
+    target.setBlendType(LLTexLayerImageTarget::BT_MULT_ALPHA);
+
+    // Accumulate the alpha component of the texture
+    if( getInfo()->mLocalTexture != -1 && mLocalTextureObject )
+    {
+        LLImageRaw* image = mTexLayerSet->getAvatarAppearance()->getLocalTextureRaw(mLocalTextureObject);
+        if( image && (image->getComponents() == 4) )
+        {
+            target.drawImage(image, LLColor4::white);
+        }
+    }
+
+    if( !getInfo()->mStaticImageFileName.empty() && getInfo()->mStaticImageIsMask )
+    {
+        LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+        if( image )
+        {
+            if( (image->getComponents() == 4) || (image->getComponents() == 1) )
+            {
+                target.drawImage(image, LLColor4::white);
+            }
+            else
+            {
+                LL_WARNS() << "Skipping rendering of " << getInfo()->mStaticImageFileName
+                        << "; expected 1 or 4 components." << LL_ENDL;
+            }
+        }
+    }
+
+    // Draw a rectangle with the layer color to multiply the alpha by that color's alpha.
+    if ( !is_approx_equal(layer_color.mV[VALPHA], 1.f) )
+    {
+        target.drawRect(layer_color);
+    }
+
+    target.setMinimumAlpha(0.004f);
+    target.setColorMask(true, true);
+}
+
+/*virtual*/ bool LLTexLayer::blendAlphaTextureToImage(LLTexLayerImageTarget& target)
+{
+    bool success = true;
+
+    if( !getInfo()->mStaticImageFileName.empty() )
+    {
+        LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw( getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask );
+        if( image )
+        {
+            target.setMinimumAlpha(0.f);
+            target.drawImage(image, LLColor4::white);
+            target.setMinimumAlpha(0.004f);
+        }
+        else
+        {
+            success = false;
+        }
+    }
+    else
+    {
+        if (getInfo()->mLocalTexture >=0 && getInfo()->mLocalTexture < TEX_NUM_INDICES && mLocalTextureObject)
+        {
+            LLImageRaw* image = mTexLayerSet->getAvatarAppearance()->getLocalTextureRaw(mLocalTextureObject);
+            if (image)
+            {
+                target.setMinimumAlpha(0.f);
+                target.drawImage(image, LLColor4::white);
+                target.setMinimumAlpha(0.004f);
+            }
+        }
+    }
+
+    return success;
+}
+
 const U8*   LLTexLayer::getAlphaData() const
 {
     LLCRC alpha_mask_crc;
@@ -1745,6 +2022,53 @@ LLTexLayer* LLTexLayerTemplate::getLayer(U32 i) const
     return success;
 }
 
+/*virtual*/ bool LLTexLayerTemplate::renderToImage(LLTexLayerImageTarget& target)
+{
+    if(!mInfo)
+    {
+        return false ;
+    }
+
+    bool success = true;
+    updateWearableCache();
+    for (LLWearable* wearable : mWearableCache)
+    {
+        LLLocalTextureObject *lto = NULL;
+        LLTexLayer *layer = NULL;
+        if (wearable)
+        {
+            lto = wearable->getLocalTextureObject(mInfo->mLocalTexture);
+        }
+        if (lto)
+        {
+            layer = lto->getTexLayer(getName());
+        }
+        if (layer)
+        {
+            wearable->writeToAvatar(mAvatarAppearance);
+            layer->setLTO(lto);
+            success &= layer->renderToImage(target);
+        }
+    }
+
+    return success;
+}
+
+/*virtual*/ bool LLTexLayerTemplate::blendAlphaTextureToImage(LLTexLayerImageTarget& target)
+{
+    bool success = true;
+    U32 num_wearables = updateWearableCache();
+    for (U32 i = 0; i < num_wearables; i++)
+    {
+        LLTexLayer *layer = getLayer(i);
+        if (layer)
+        {
+            success &= layer->blendAlphaTextureToImage(target);
+        }
+    }
+    return success;
+}
+
 /*virtual*/ void LLTexLayerTemplate::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target)
 {
     U32 num_wearables = updateWearableCache();
@@ -1851,6 +2175,7 @@ void LLTexLayerSet::cloneTemplates(LLLocalTextureObject *lto, LLAvatarAppearance
 LLTexLayerStaticImageList::LLTexLayerStaticImageList() :
     mGLBytes(0),
     mTGABytes(0),
+    mRawBytes(0),
     mImageNames(16384)
 {
 }
@@ -1864,12 +2189,13 @@ void LLTexLayerStaticImageList::dumpByteCount() const
 {
     LL_INFOS() << "Avatar Static Textures " <<
         "KB GL:" << (mGLBytes / 1024) <<
-        "KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+        "KB TGA:" << (mTGABytes / 1024) <<
+        "KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
 }
 
 void LLTexLayerStaticImageList::deleteCachedImages()
 {
-    if( mGLBytes || mTGABytes )
+    if( mGLBytes || mTGABytes || mRawBytes )
     {
         //LL_INFOS() << "Clearing Static Textures " <<
         //  "KB GL:" << (mGLBytes / 1024) <<
@@ -1879,9 +2205,11 @@ void LLTexLayerStaticImageList::deleteCachedImages()
 
         mStaticImageListTGA.clear();
         mStaticImageList.clear();
+        mStaticImageListRaw.clear();
 
         mGLBytes = 0;
         mTGABytes = 0;
+        mRawBytes = 0;
     }
 }
 
@@ -1967,6 +2295,40 @@ LLGLTexture* LLTexLayerStaticImageList::getTexture(const std::string& file_name,
     return tex;
 }
 
+// Returns the decoded data from a tga file named file_name, without creating a GL texture.
+// Grayscale masks are expanded to RGBA like getTexture() does.
+// Caches the result to speed identical subsequent requests.
+LLImageRaw* LLTexLayerStaticImageList::getImageRaw(const std::string& file_name, bool is_mask)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const char *namekey = mImageNames.addString(file_name);
+    image_raw_map_t::const_iterator iter = mStaticImageListRaw.find(namekey);
+    if( iter != mStaticImageListRaw.end() )
+    {
+        return iter->second;
+    }
+
+    LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+    if( !loadImageRaw( file_name, image_raw ) )
+    {
+        return NULL;
+    }
+
+    if( (image_raw->getComponents() == 1) && is_mask )
+    {
+        LLPointer<LLImageRaw> alpha_image_raw = image_raw;
+        image_raw = new LLImageRaw(image_raw->getWidth(),
+                                   image_raw->getHeight(),
+                                   4);
+
+        image_raw->copyUnscaledAlphaMask(alpha_image_raw, LLColor4U::black);
+    }
+
+    mStaticImageListRaw[ namekey ] = image_raw;
+    mRawBytes += image_raw->getDataSize();
+    return image_raw;
+}
+
 // Reads a .tga file, decodes it, and puts the decoded data in image_raw.
 // Returns true if successful.
 bool LLTexLayerStaticImageList::loadImageRaw(const std::string& file_name, LLImageRaw* image_raw)
@@ -42,6 +42,7 @@ class LLTexLayerSet;
 class LLTexLayerSetInfo;
 class LLTexLayerInfo;
 class LLTexLayerSetBuffer;
+class LLTexLayerImageTarget;
 class LLWearable;
 class LLViewerVisualParam;
 
@@ -70,6 +71,10 @@ public:
     virtual bool            blendAlphaTexture(S32 x, S32 y, S32 width, S32 height) = 0;
     virtual bool            isInvisibleAlphaMask() const = 0;
 
+    // CPU equivalents of render() and blendAlphaTexture(), see LLTexLayerSet::renderToImage()
+    virtual bool            renderToImage(LLTexLayerImageTarget& target) = 0;
+    virtual bool            blendAlphaTextureToImage(LLTexLayerImageTarget& target) = 0;
+
     const LLTexLayerInfo*   getInfo() const             { return mInfo; }
     virtual bool            setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // sets mInfo, calls initialization functions
     LLWearableType::EType   getWearableType() const;
@@ -128,6 +133,8 @@ public:
     /*virtual*/ void        setHasMorph(bool newval);
     /*virtual*/ void        deleteCaches();
     /*virtual*/ bool        isInvisibleAlphaMask() const;
+    /*virtual*/ bool        renderToImage(LLTexLayerImageTarget& target);
+    /*virtual*/ bool        blendAlphaTextureToImage(LLTexLayerImageTarget& target);
 protected:
     U32                     updateWearableCache() const;
     LLTexLayer*             getLayer(U32 i) const;
@@ -163,6 +170,9 @@ public:
     void                    renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, LLRenderTarget* bound_target, bool force_render);
     void                    addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height, LLRenderTarget* bound_target);
     /*virtual*/ bool        isInvisibleAlphaMask() const;
+    /*virtual*/ bool        renderToImage(LLTexLayerImageTarget& target);
+    /*virtual*/ bool        blendAlphaTextureToImage(LLTexLayerImageTarget& target);
+    void                    renderMorphMasksToImage(LLTexLayerImageTarget& target, const LLColor4 &layer_color);
 
     void                    setLTO(LLLocalTextureObject *lto)   { mLocalTextureObject = lto; }
     LLLocalTextureObject*   getLTO()                            { return mLocalTextureObject; }
@@ -202,6 +212,13 @@ public:
     bool                        render(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target = nullptr);
     void                        renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height, LLRenderTarget* bound_target = nullptr, bool forceClear = false);
 
+    // Composites the layer set into image (RGBA, sized by the caller) on the
+    // CPU, reproducing what render() draws into the bake render target.
+    // Does not need a GL context; local textures are taken from
+    // LLAvatarAppearance::getLocalTextureRaw().
+    bool                        renderToImage(LLImageRaw* image);
+    void                        renderAlphaMaskTexturesToImage(LLTexLayerImageTarget& target, bool forceClear = false);
+
     bool                        isBodyRegion(const std::string& region) const;
     void                        applyMorphMask(const U8* tex_data, S32 width, S32 height, S32 num_components);
     bool                        isMorphValid() const;
@@ -299,6 +316,8 @@ class LLTexLayerStaticImageList : public LLSingleton<LLTexLayerStaticImageList>
 public:
     LLGLTexture*        getTexture(const std::string& file_name, bool is_mask);
     LLImageTGA*         getImageTGA(const std::string& file_name);
+    // Decoded image for CPU compositing, converted the same way as for getTexture().
+    LLImageRaw*         getImageRaw(const std::string& file_name, bool is_mask);
     void                deleteCachedImages();
     void                dumpByteCount() const;
 protected:
@@ -309,8 +328,11 @@ private:
     texture_map_t       mStaticImageList;
     typedef std::map<const char*, LLPointer<LLImageTGA> > image_tga_map_t;
     image_tga_map_t     mStaticImageListTGA;
+    typedef std::map<const char*, LLPointer<LLImageRaw> > image_raw_map_t;
+    image_raw_map_t     mStaticImageListRaw;
     S32                 mGLBytes;
     S32                 mTGABytes;
+    S32                 mRawBytes;
 };
 
 #endif  // LL_LLTEXLAYER_H
@@ -0,0 +1,211 @@
+/**
+ * @file lltexlayerimage.cpp
+ * @brief Software render target used to composite texture layers on the CPU.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltexlayerimage.h"
+
+#include "llimage.h"
+
+static const F32 INV_255 = 1.f / 255.f;
+
+static inline U8 quantize_channel(F32 value)
+{
+    return (U8)llclamp(ll_round(value * 255.f), 0, 255);
+}
+
+// Fetches texel (x, y) of image as normalized RGBA, expanding the
+// formats static and local textures are uploaded with.
+static inline void fetch_texel(const U8* data, S32 components, S32 width, S32 x, S32 y, F32* out)
+{
+    const U8* texel = data + (y * width + x) * components;
+    switch (components)
+    {
+        case 1:
+            out[VRED] = out[VGREEN] = out[VBLUE] = 0.f;
+            out[VALPHA] = texel[0] * INV_255;
+            break;
+        case 2:
+            out[VRED] = out[VGREEN] = out[VBLUE] = texel[0] * INV_255;
+            out[VALPHA] = texel[1] * INV_255;
+            break;
+        case 3:
+            out[VRED] = texel[0] * INV_255;
+            out[VGREEN] = texel[1] * INV_255;
+            out[VBLUE] = texel[2] * INV_255;
+            out[VALPHA] = 1.f;
+            break;
+        default:
+            out[VRED] = texel[0] * INV_255;
+            out[VGREEN] = texel[1] * INV_255;
+            out[VBLUE] = texel[2] * INV_255;
+            out[VALPHA] = texel[3] * INV_255;
+            break;
+    }
+}
+
+LLTexLayerImageTarget::LLTexLayerImageTarget(LLImageRaw* image) :
+    mImage(image),
+    mWidth(image ? image->getWidth() : 0),
+    mHeight(image ? image->getHeight() : 0),
+    mBlendType(BT_ALPHA),
+    mWriteColor(true),
+    mWriteAlpha(true),
+    mMinimumAlpha(0.004f)
+{
+    llassert(image && image->getComponents() == 4);
+}
+
+void LLTexLayerImageTarget::blendPixel(U8* dst, const F32* src) const
+{
+    if (src[VALPHA] < mMinimumAlpha)
+    {
+        return; // discarded by the alpha mask shader
+    }
+
+    F32 d[4] = { dst[VRED] * INV_255, dst[VGREEN] * INV_255, dst[VBLUE] * INV_255, dst[VALPHA] * INV_255 };
+    F32 result[4];
+    switch (mBlendType)
+    {
+        case BT_ALPHA:
+            for (S32 i = 0; i < 4; ++i)
+            {
+                result[i] = src[i] * src[VALPHA] + d[i] * (1.f - src[VALPHA]);
+            }
+            break;
+        case BT_REPLACE:
+            for (S32 i = 0; i < 4; ++i)
+            {
+                result[i] = src[i];
+            }
+            break;
+        case BT_ADD:
+            for (S32 i = 0; i < 4; ++i)
+            {
+                result[i] = src[i] + d[i];
+            }
+            break;
+        case BT_MULT_ALPHA:
+            for (S32 i = 0; i < 4; ++i)
+            {
+                result[i] = src[i] * d[VALPHA];
+            }
+            break;
+        case BT_DEST_ALPHA:
+        default:
+            for (S32 i = 0; i < 4; ++i)
+            {
+                result[i] = src[i] * d[VALPHA] + d[i] * (1.f - d[VALPHA]);
+            }
+            break;
+    }
+
+    if (mWriteColor)
+    {
+        dst[VRED] = quantize_channel(result[VRED]);
+        dst[VGREEN] = quantize_channel(result[VGREEN]);
+        dst[VBLUE] = quantize_channel(result[VBLUE]);
+    }
+    if (mWriteAlpha)
+    {
+        dst[VALPHA] = quantize_channel(result[VALPHA]);
+    }
+}
+
+void LLTexLayerImageTarget::drawRect(const LLColor4& color)
+{
+    if (!mImage || (!mWriteColor && !mWriteAlpha))
+    {
+        return;
+    }
+
+    U8* dst = mImage->getData();
+    const S32 pixels = mWidth * mHeight;
+    for (S32 i = 0; i < pixels; ++i, dst += 4)
+    {
+        blendPixel(dst, color.mV);
+    }
+}
+
+void LLTexLayerImageTarget::drawImage(const LLImageRaw* image, const LLColor4& color)
+{
+    if (!mImage || !image || !image->getData() || (!mWriteColor && !mWriteAlpha))
+    {
+        return;
+    }
+
+    const U8* src_data = image->getData();
+    const S32 src_width = image->getWidth();
+    const S32 src_height = image->getHeight();
+    const S32 components = image->getComponents();
+    const bool same_size = (src_width == mWidth) && (src_height == mHeight);
+
+    // Texel center mapping and clamped bilinear filtering, matching a
+    // TAM_CLAMP texture stretched over the target quad.
+    const F32 scale_x = (F32)src_width / (F32)mWidth;
+    const F32 scale_y = (F32)src_height / (F32)mHeight;
+
+    U8* dst = mImage->getData();
+    F32 texel[4];
+    F32 src[4];
+    for (S32 y = 0; y < mHeight; ++y)
+    {
+        for (S32 x = 0; x < mWidth; ++x, dst += 4)
+        {
+            if (same_size)
+            {
+                fetch_texel(src_data, components, src_width, x, y, texel);
+            }
+            else
+            {
+                const F32 u = llclamp((x + 0.5f) * scale_x - 0.5f, 0.f, (F32)(src_width - 1));
+                const F32 v = llclamp((y + 0.5f) * scale_y - 0.5f, 0.f, (F32)(src_height - 1));
+                const S32 x0 = (S32)u;
+                const S32 y0 = (S32)v;
+                const S32 x1 = llmin(x0 + 1, src_width - 1);
+                const S32 y1 = llmin(y0 + 1, src_height - 1);
+                const F32 fx = u - x0;
+                const F32 fy = v - y0;
+
+                F32 t00[4], t10[4], t01[4], t11[4];
+                fetch_texel(src_data, components, src_width, x0, y0, t00);
+                fetch_texel(src_data, components, src_width, x1, y0, t10);
+                fetch_texel(src_data, components, src_width, x0, y1, t01);
+                fetch_texel(src_data, components, src_width, x1, y1, t11);
+                for (S32 i = 0; i < 4; ++i)
+                {
+                    texel[i] = lerp(lerp(t00[i], t10[i], fx), lerp(t01[i], t11[i], fx), fy);
+                }
+            }
+
+            for (S32 i = 0; i < 4; ++i)
+            {
+                src[i] = texel[i] * color.mV[i];
+            }
+            blendPixel(dst, src);
+        }
+    }
+}
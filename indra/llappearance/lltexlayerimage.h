@@ -0,0 +1,88 @@
+/**
+ * @file lltexlayerimage.h
+ * @brief Software render target used to composite texture layers on the CPU.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXLAYERIMAGE_H
+#define LL_LLTEXLAYERIMAGE_H
+
+#include "llpointer.h"
+#include "v4color.h"
+
+class LLImageRaw;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerImageTarget
+//
+// CPU stand-in for the render target, blend state and alpha mask shader
+// that LLTexLayerSet::render() drives through gGL. It wraps an RGBA
+// LLImageRaw and reproduces the fixed set of blend modes used while
+// baking, quantizing to 8 bits per channel after every draw exactly like
+// an RGBA8 framebuffer would. Used by the LLTexLayerSet::renderToImage()
+// family to bake without a GL context.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerImageTarget
+{
+public:
+    enum EBlendType
+    {
+        BT_ALPHA,           // src * src_alpha + dst * (1 - src_alpha)
+        BT_REPLACE,         // src
+        BT_ADD,             // src + dst
+        BT_MULT_ALPHA,      // src * dst_alpha
+        BT_DEST_ALPHA       // src * dst_alpha + dst * (1 - dst_alpha)
+    };
+
+    LLTexLayerImageTarget(LLImageRaw* image);
+
+    LLImageRaw*     getImage() const                { return mImage; }
+    S32             getWidth() const                { return mWidth; }
+    S32             getHeight() const               { return mHeight; }
+
+    void            setBlendType(EBlendType type)   { mBlendType = type; }
+    EBlendType      getBlendType() const            { return mBlendType; }
+    void            setColorMask(bool color, bool alpha) { mWriteColor = color; mWriteAlpha = alpha; }
+    // Fragments whose alpha is below this value are discarded, as in gAlphaMaskProgram.
+    void            setMinimumAlpha(F32 min_alpha)  { mMinimumAlpha = min_alpha; }
+
+    // Equivalent of gl_rect_2d_simple() with an untextured color.
+    void            drawRect(const LLColor4& color);
+    // Equivalent of gl_rect_2d_simple_tex() with the image stretched over the
+    // whole target and modulated by color. Single component images are
+    // treated as alpha only textures (black, alpha = value).
+    void            drawImage(const LLImageRaw* image, const LLColor4& color);
+
+private:
+    void            blendPixel(U8* dst, const F32* src) const;
+
+    LLPointer<LLImageRaw> mImage;
+    S32             mWidth;
+    S32             mHeight;
+    EBlendType      mBlendType;
+    bool            mWriteColor;
+    bool            mWriteAlpha;
+    F32             mMinimumAlpha;
+};
+
+#endif // LL_LLTEXLAYERIMAGE_H
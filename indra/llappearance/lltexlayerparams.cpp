@@ -32,6 +32,7 @@
 #include "llimagetga.h"
 #include "llquantize.h"
 #include "lltexlayer.h"
+#include "lltexlayerimage.h"
 #include "lltexturemanagerbridge.h"
 #include "../llui/llui.h"
 #include "llwearable.h"
@@ -126,7 +127,9 @@ LLTexLayerParamAlpha::LLTexLayerParamAlpha(LLTexLayerInterface* layer)
     mNeedsCreateTexture(false),
     mStaticImageInvalid(false),
     mAvgDistortionVec(1.f, 1.f, 1.f),
-    mCachedEffectiveWeight(0.f)
+    mCachedEffectiveWeight(0.f),
+    mBakeImageRaw(),
+    mBakeImageWeight(0.f)
 {
     sInstances.push_front(this);
 }
@@ -139,7 +142,9 @@ LLTexLayerParamAlpha::LLTexLayerParamAlpha(LLAvatarAppearance* appearance)
     mNeedsCreateTexture(false),
     mStaticImageInvalid(false),
     mAvgDistortionVec(1.f, 1.f, 1.f),
-    mCachedEffectiveWeight(0.f)
+    mCachedEffectiveWeight(0.f),
+    mBakeImageRaw(),
+    mBakeImageWeight(0.f)
 {
     sInstances.push_front(this);
 }
@@ -152,7 +157,9 @@ LLTexLayerParamAlpha::LLTexLayerParamAlpha(const LLTexLayerParamAlpha& pOther)
     mNeedsCreateTexture(pOther.mNeedsCreateTexture.load()),
     mStaticImageInvalid(pOther.mStaticImageInvalid),
     mAvgDistortionVec(pOther.mAvgDistortionVec),
-    mCachedEffectiveWeight(pOther.mCachedEffectiveWeight)
+    mCachedEffectiveWeight(pOther.mCachedEffectiveWeight),
+    mBakeImageRaw(pOther.mBakeImageRaw),
+    mBakeImageWeight(pOther.mBakeImageWeight)
 {
     sInstances.push_front(this);
 }
@@ -174,6 +181,7 @@ void LLTexLayerParamAlpha::deleteCaches()
     mCachedProcessedTexture = NULL;
     mStaticImageRaw = NULL;
     mNeedsCreateTexture = false;
+    mBakeImageRaw = NULL;
 }
 
 bool LLTexLayerParamAlpha::getMultiplyBlend() const
@@ -386,6 +394,66 @@ bool LLTexLayerParamAlpha::render(S32 x, S32 y, S32 width, S32 height)
     return success;
 }
 
+bool LLTexLayerParamAlpha::renderToImage(LLTexLayerImageTarget& target)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    bool success = true;
+
+    if (!mTexLayer)
+    {
+        return success;
+    }
+
+    F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+    if (getSkip())
+    {
+        return success;
+    }
+
+    LLTexLayerParamAlphaInfo *info = (LLTexLayerParamAlphaInfo *)getInfo();
+    if (info->mMultiplyBlend)
+    {
+        target.setBlendType(LLTexLayerImageTarget::BT_MULT_ALPHA); // Multiplication: approximates a min() function
+    }
+    else
+    {
+        target.setBlendType(LLTexLayerImageTarget::BT_ADD);  // Addition: approximates a max() function
+    }
+
+    if (!info->mStaticImageFileName.empty() && !mStaticImageInvalid)
+    {
+        if (mStaticImageTGA.isNull())
+        {
+            mStaticImageTGA = LLTexLayerStaticImageList::getInstance()->getImageTGA(info->mStaticImageFileName);
+            LLTexLayerSet::sHasCaches |= mStaticImageTGA.notNull();
+
+            if (mStaticImageTGA.isNull())
+            {
+                LL_WARNS() << "Unable to load static file: " << info->mStaticImageFileName << LL_ENDL;
+                mStaticImageInvalid = true; // don't try again.
+                return false;
+            }
+        }
+
+        // Processed into a copy of our own, mStaticImageRaw and
+        // mCachedEffectiveWeight belong to render() and its GL texture
+        if (mBakeImageRaw.isNull() || effective_weight != mBakeImageWeight)
+        {
+            mBakeImageWeight = effective_weight;
+            mBakeImageRaw = new LLImageRaw;
+            mStaticImageTGA->decodeAndProcess(mBakeImageRaw, info->mDomain, effective_weight);
+        }
+
+        target.drawImage(mBakeImageRaw, LLColor4::white);
+    }
+    else
+    {
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, effective_weight));
+    }
+
+    return success;
+}
+
 //-----------------------------------------------------------------------------
 // LLTexLayerParamAlphaInfo
 //-----------------------------------------------------------------------------
@@ -36,6 +36,7 @@ class LLImageRaw;
 class LLImageTGA;
 class LLTexLayer;
 class LLTexLayerInterface;
+class LLTexLayerImageTarget;
 class LLGLTexture;
 class LLWearable;
 
@@ -101,6 +102,7 @@ public:
 
     // New functions
     bool                    render( S32 x, S32 y, S32 width, S32 height );
+    bool                    renderToImage( LLTexLayerImageTarget& target );
     bool                    getSkip() const;
     void                    deleteCaches();
     bool                    getMultiplyBlend() const;
@@ -115,6 +117,9 @@ private:
     bool                    mStaticImageInvalid;
     LL_ALIGN_16(LLVector4a              mAvgDistortionVec);
     F32                     mCachedEffectiveWeight;
+    // renderToImage()'s own processed mask, so it leaves the GL bake's cache alone
+    LLPointer<LLImageRaw>   mBakeImageRaw;
+    F32                     mBakeImageWeight;
 
 public:
     // Global list of instances for gathering statistics
@@ -0,0 +1,156 @@
+/**
+ * @file lltexlayerimage_test.cpp
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "llimage.h"
+#include "../lltexlayerimage.h"
+
+namespace tut
+{
+    struct texlayerimage
+    {
+        LLPointer<LLImageRaw> makeImage(S32 width, S32 height, S32 components, const U8* data)
+        {
+            return new LLImageRaw(data, width, height, components);
+        }
+
+        void ensure_pixel(const std::string& msg, const LLImageRaw* image, S32 x, S32 y,
+                          U8 red, U8 green, U8 blue, U8 alpha)
+        {
+            const U8* pixel = image->getData() + (y * image->getWidth() + x) * 4;
+            ensure_equals(msg + " red", (S32)pixel[VRED], (S32)red);
+            ensure_equals(msg + " green", (S32)pixel[VGREEN], (S32)green);
+            ensure_equals(msg + " blue", (S32)pixel[VBLUE], (S32)blue);
+            ensure_equals(msg + " alpha", (S32)pixel[VALPHA], (S32)alpha);
+        }
+    };
+
+    typedef test_group<texlayerimage> texlayerimage_t;
+    typedef texlayerimage_t::object texlayerimage_object_t;
+    tut::texlayerimage_t tut_texlayerimage("LLTexLayerImageTarget");
+
+    // A layer set of a tinted color layer, a layer drawn through its morph
+    // mask and a visibility mask, in the order LLTexLayerSet::renderToImage()
+    // composites them
+    template<> template<>
+    void texlayerimage_object_t::test<1>()
+    {
+        LLPointer<LLImageRaw> bake = new LLImageRaw(2, 2, 4);
+        LLTexLayerImageTarget target(bake);
+
+        // left column of the morph mask, top row of the visibility mask
+        const U8 morph_mask[] = { 255, 0, 255, 0 };
+        const U8 visibility_mask[] = { 255, 255, 0, 0 };
+        const U8 blue[] = { 0, 0, 255 };
+        LLPointer<LLImageRaw> morph_image = makeImage(2, 2, 1, morph_mask);
+        LLPointer<LLImageRaw> visibility_image = makeImage(2, 2, 1, visibility_mask);
+        LLPointer<LLImageRaw> blue_image = makeImage(1, 1, 3, blue);
+
+        // clear to opaque black
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+        target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+
+        // half transparent red layer
+        target.drawRect(LLColor4(1.f, 0.f, 0.f, 0.5f));
+        ensure_pixel("red layer", bake, 1, 1, 128, 0, 0, 191);
+
+        // blue layer through its morph mask, as LLTexLayer::renderToImage()
+        target.setMinimumAlpha(0.f);
+        target.setColorMask(false, true);
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 0.f));
+        target.setBlendType(LLTexLayerImageTarget::BT_ADD);
+        target.drawImage(morph_image, LLColor4::white);
+        target.setMinimumAlpha(0.004f);
+        target.setColorMask(true, true);
+        target.setBlendType(LLTexLayerImageTarget::BT_DEST_ALPHA);
+        target.drawImage(blue_image, LLColor4::white);
+        target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+        ensure_pixel("inside the morph mask", bake, 0, 1, 0, 0, 255, 255);
+        ensure_pixel("outside the morph mask", bake, 1, 1, 128, 0, 0, 0);
+
+        // alpha mask pass, as renderAlphaMaskTexturesToImage()
+        target.setColorMask(false, true);
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.setMinimumAlpha(0.f);
+        target.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+        target.setBlendType(LLTexLayerImageTarget::BT_MULT_ALPHA);
+        target.drawImage(visibility_image, LLColor4::white);
+        target.setMinimumAlpha(0.004f);
+        target.setColorMask(true, true);
+        target.setBlendType(LLTexLayerImageTarget::BT_ALPHA);
+
+        ensure_pixel("top left", bake, 0, 0, 0, 0, 255, 255);
+        ensure_pixel("top right", bake, 1, 0, 128, 0, 0, 255);
+        ensure_pixel("bottom left", bake, 0, 1, 0, 0, 255, 0);
+        ensure_pixel("bottom right", bake, 1, 1, 128, 0, 0, 0);
+    }
+
+    // Smaller images are stretched over the target with clamped bilinear
+    // filtering
+    template<> template<>
+    void texlayerimage_object_t::test<2>()
+    {
+        LLPointer<LLImageRaw> bake = new LLImageRaw(4, 1, 4);
+        LLTexLayerImageTarget target(bake);
+
+        const U8 ramp[] = { 0, 255 };
+        LLPointer<LLImageRaw> ramp_image = makeImage(2, 1, 1, ramp);
+
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.setMinimumAlpha(0.f);
+        target.drawImage(ramp_image, LLColor4::white);
+
+        ensure_pixel("clamped low", bake, 0, 0, 0, 0, 0, 0);
+        ensure_pixel("quarter", bake, 1, 0, 0, 0, 0, 64);
+        ensure_pixel("three quarters", bake, 2, 0, 0, 0, 0, 191);
+        ensure_pixel("clamped high", bake, 3, 0, 0, 0, 0, 255);
+    }
+
+    // Fragments below the minimum alpha are discarded, as by the alpha mask
+    // shader
+    template<> template<>
+    void texlayerimage_object_t::test<3>()
+    {
+        LLPointer<LLImageRaw> bake = new LLImageRaw(1, 1, 4);
+        LLTexLayerImageTarget target(bake);
+
+        target.setBlendType(LLTexLayerImageTarget::BT_REPLACE);
+        target.drawRect(LLColor4(0.2f, 0.4f, 0.6f, 1.f));
+        ensure_pixel("replaced", bake, 0, 0, 51, 102, 153, 255);
+
+        target.drawRect(LLColor4(1.f, 1.f, 1.f, 0.002f));
+        ensure_pixel("discarded", bake, 0, 0, 51, 102, 153, 255);
+
+        target.setMinimumAlpha(0.f);
+        target.drawRect(LLColor4(1.f, 1.f, 1.f, 0.002f));
+        ensure_pixel("kept with no minimum", bake, 0, 0, 255, 255, 255, 1);
+    }
+}
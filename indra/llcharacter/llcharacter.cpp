@@ -486,6 +486,7 @@ void LLCharacter::addVisualParam(LLVisualParam *param)
 //-----------------------------------------------------------------------------
 void LLCharacter::updateVisualParams()
 {
+    beginVisualParamUpdate();
     for (LLVisualParam *param = getFirstVisualParam();
         param;
         param = getNextVisualParam())
@@ -501,6 +502,7 @@ void LLCharacter::updateVisualParams()
             param->apply( mSex );
         }
     }
+    endVisualParamUpdate();
 }
 
 LLAnimPauseRequest LLCharacter::requestPause()
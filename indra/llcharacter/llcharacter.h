@@ -123,6 +123,11 @@ public:
     // updates all visual parameters for this character
     virtual void updateVisualParams();
 
+    // bracket a pass of updateVisualParams() so that derived classes can
+    // batch the work done by the individual params
+    virtual void beginVisualParamUpdate() {}
+    virtual void endVisualParamUpdate() {}
+
     virtual void addDebugText( const std::string& text ) = 0;
 
     virtual const LLUUID&   getID() const = 0;
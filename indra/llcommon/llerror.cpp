@@ -36,6 +36,10 @@
 # include <cxxabi.h>
 #endif // __GNUC__
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
 #if !LL_WINDOWS
 # include <syslog.h>
 # include <unistd.h>
@@ -784,6 +788,12 @@ namespace
     }
 }
 
+namespace
+{
+    // defined with the asynchronous logger below
+    void setAsyncTimeFunction(LLError::TimeFunction f);
+}
+
 namespace LLError
 {
     void initForApplication(const std::string& user_dir, const std::string& app_dir, bool log_to_stderr)
@@ -812,6 +822,7 @@ namespace LLError
     {
         SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
         s->mTimeFunction = f;
+        setAsyncTimeFunction(f);
     }
 
     void setDefaultLevel(ELevel level)
@@ -940,6 +951,10 @@ namespace LLError
         {
             setAlwaysFlush(config["log-always-flush"]);
         }
+        if (config.has("log-async"))
+        {
+            setAsyncLogging(config["log-async"]);
+        }
         if (config.has("enabled-log-types-mask"))
         {
             setEnabledLogTypesMask(config["enabled-log-types-mask"].asInteger());
@@ -1224,16 +1239,17 @@ namespace
         return out.str();
     }
 
-    void writeToRecorders(const LLError::CallSite& site, const std::string& message)
+    // time is what the time function returned when the message was queued
+    // for the writer thread, or NULL to ask time_function now
+    void writeToRecorders(const Recorders& recorders, LLError::TimeFunction time_function,
+                          const LLError::CallSite& site, const std::string& message,
+                          const std::string* time)
     {
-        LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
         LLError::ELevel level = site.mLevel;
-        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
 
         std::string escaped_message;
 
-        std::unique_lock lock(s->mRecorderMutex); LL_PROFILE_MUTEX_LOCK(s->mRecorderMutex);
-        for (LLError::RecorderPtr& r : s->mRecorders)
+        for (const LLError::RecorderPtr& r : recorders)
         {
             // <FS:Ansariel> Crash fix
             //if (!r->enabled())
@@ -1244,9 +1260,13 @@ namespace
 
             std::ostringstream message_stream;
 
-            if (r->wantsTime() && s->mTimeFunction != NULL)
+            if (r->wantsTime() && time)
             {
-                message_stream << s->mTimeFunction();
+                message_stream << *time;
+            }
+            else if (r->wantsTime() && time_function != NULL)
+            {
+                message_stream << time_function();
             }
             message_stream << " ";
 
@@ -1290,6 +1310,15 @@ namespace
             r->recordMessage(level, message_stream.str());
         }
     }
+
+    void writeToRecorders(const LLError::CallSite& site, const std::string& message)
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
+        SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+
+        std::unique_lock lock(s->mRecorderMutex); LL_PROFILE_MUTEX_LOCK(s->mRecorderMutex);
+        writeToRecorders(s->mRecorders, s->mTimeFunction, site, message, NULL);
+    }
 }
 
 namespace {
@@ -1356,6 +1385,383 @@ namespace {
     }
 }
 
+namespace
+{
+    //-------------------------------------------------------------------------
+    // Asynchronous logging. Each thread queues its formatted messages in a
+    // ring of its own, with a single producer and a single consumer, so
+    // logging never waits on a lock. A writer thread drains all rings in
+    // sequence order into the recorders. A full ring drops the message and
+    // counts it.
+    //-------------------------------------------------------------------------
+
+    struct AsyncLogRecord
+    {
+        const LLError::CallSite*    mSite = NULL;
+        U64                         mSequence = 0;
+        std::string                 mTime;
+        std::string                 mMessage;
+    };
+
+    class AsyncLogRing
+    {
+    public:
+        static const U32 CAPACITY = 1024; // power of two
+
+        AsyncLogRing()
+            : mHead(0), mTail(0), mDropped(0), mClosed(false)
+        {
+        }
+
+        // Producer side; the slot from beginPush() is published by endPush().
+        AsyncLogRecord* beginPush()
+        {
+            U32 tail = mTail.load(std::memory_order_relaxed);
+            if (tail - mHead.load(std::memory_order_acquire) >= CAPACITY)
+            {
+                return NULL;
+            }
+            return &mSlots[tail & (CAPACITY - 1)];
+        }
+
+        // Returns the number of records now waiting.
+        U32 endPush()
+        {
+            U32 tail = mTail.load(std::memory_order_relaxed) + 1;
+            mTail.store(tail, std::memory_order_release);
+            return tail - mHead.load(std::memory_order_relaxed);
+        }
+
+        // Consumer side
+        bool pop(AsyncLogRecord& record)
+        {
+            U32 head = mHead.load(std::memory_order_relaxed);
+            if (head == mTail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            AsyncLogRecord& slot = mSlots[head & (CAPACITY - 1)];
+            record.mSite = slot.mSite;
+            record.mSequence = slot.mSequence;
+            record.mTime.swap(slot.mTime);
+            record.mMessage.swap(slot.mMessage);
+            mHead.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const
+        {
+            return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+        }
+
+        std::atomic<U32>    mHead;      // next record to read, moved by the writer
+        std::atomic<U32>    mTail;      // next slot to fill, moved by the owning thread
+        std::atomic<U64>    mDropped;   // since the writer last looked
+        std::atomic<bool>   mClosed;    // the owning thread has exited
+
+    private:
+        AsyncLogRecord      mSlots[CAPACITY];
+    };
+
+    typedef std::shared_ptr<AsyncLogRing> AsyncLogRingPtr;
+
+    // Marks the ring of a thread closed when the thread exits, the writer
+    // frees it once drained.
+    struct AsyncLogRingHolder
+    {
+        ~AsyncLogRingHolder()
+        {
+            if (mRing)
+            {
+                mRing->mClosed = true;
+            }
+        }
+
+        AsyncLogRingPtr mRing;
+    };
+
+    class AsyncLogger
+    {
+    public:
+        // Longer messages are written synchronously, which bounds the memory
+        // a full ring can hold.
+        static const size_t MAX_MESSAGE_LENGTH = 16 * 1024;
+        static const S32 WRITER_INTERVAL_MS = 5;
+
+        static AsyncLogger& instance()
+        {
+            // function-static for the same reason as getLogMutex()
+            static AsyncLogger sInstance;
+            return sInstance;
+        }
+
+        ~AsyncLogger()
+        {
+            // the recorders may be gone by now, whatever is left is lost
+            mEnabled = false;
+            stopWriter();
+        }
+
+        bool enabled() const
+        {
+            return mEnabled.load(std::memory_order_relaxed);
+        }
+
+        void start(LLError::TimeFunction time_function)
+        {
+            std::lock_guard<std::mutex> lock(mControlMutex);
+            mTimeFunction = time_function;
+            if (mThread.joinable())
+            {
+                return;
+            }
+            mStop = false;
+            mThread = std::thread([this]() { run(); });
+            mEnabled = true;
+        }
+
+        void stop()
+        {
+            std::lock_guard<std::mutex> lock(mControlMutex);
+            mEnabled = false;
+            stopWriter();
+            drain();
+        }
+
+        void setTimeFunction(LLError::TimeFunction time_function)
+        {
+            mTimeFunction = time_function;
+        }
+
+        // Returns false if the caller has to write the message itself.
+        bool push(const LLError::CallSite& site, std::string& message)
+        {
+            if (!enabled() || message.length() > MAX_MESSAGE_LENGTH)
+            {
+                return false;
+            }
+
+            AsyncLogRing* ring = getRing();
+            AsyncLogRecord* record = ring->beginPush();
+            if (!record)
+            {
+                ring->mDropped.fetch_add(1, std::memory_order_relaxed);
+                mTotalDropped.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            record->mSite = &site;
+            record->mSequence = mSequence.fetch_add(1, std::memory_order_relaxed);
+            LLError::TimeFunction time_function = mTimeFunction;
+            if (time_function)
+            {
+                record->mTime = time_function();
+            }
+            else
+            {
+                record->mTime.clear();
+            }
+            record->mMessage.swap(message);
+
+            if (ring->endPush() == AsyncLogRing::CAPACITY / 2)
+            {
+                // don't wait for the timer before the ring fills up
+                mWake.notify_one();
+            }
+            return true;
+        }
+
+        // Writes everything queued so far. Any thread may call this.
+        void drain()
+        {
+            // The settings are copied under the log mutex and written without
+            // it, so threads checking uncached call sites never wait on disk.
+            SettingsConfigPtr s;
+            Recorders recorders;
+            LLError::TimeFunction time_function = NULL;
+            {
+                std::unique_lock lock(*getLogMutex()); LL_PROFILE_MUTEX_LOCK(*getLogMutex());
+                s = Globals::getInstance()->getSettingsConfig();
+                std::unique_lock recorder_lock(s->mRecorderMutex);
+                recorders = s->mRecorders;
+                time_function = s->mTimeFunction;
+            }
+
+            U64 dropped = 0;
+            {
+                // the recorder mutex keeps a synchronous write on another
+                // thread from interleaving with the batch
+                std::lock_guard<std::mutex> drain_lock(mDrainMutex);
+                std::unique_lock recorder_lock(s->mRecorderMutex); LL_PROFILE_MUTEX_LOCK(s->mRecorderMutex);
+                dropped = writeQueued(recorders, time_function);
+            }
+
+            if (dropped)
+            {
+                // queued like any other message, written on the next pass
+                LL_WARNS("Log") << "Dropped " << dropped << " log messages, logging threads outran the writer" << LL_ENDL;
+            }
+        }
+
+        U64 getDropCount() const
+        {
+            return mTotalDropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        AsyncLogger()
+            : mEnabled(false),
+            mStop(false),
+            mTimeFunction(NULL),
+            mSequence(0),
+            mTotalDropped(0)
+        {
+        }
+
+        // Returns the number of messages dropped since the last call.
+        U64 writeQueued(const Recorders& recorders, LLError::TimeFunction time_function)
+        {
+            std::vector<AsyncLogRingPtr> rings;
+            {
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                rings = mRings;
+            }
+
+            U64 dropped = 0;
+            AsyncLogRecord record;
+            for (const AsyncLogRingPtr& ring : rings)
+            {
+                while (ring->pop(record))
+                {
+                    mRecords.emplace_back();
+                    std::swap(mRecords.back(), record);
+                }
+                dropped += ring->mDropped.exchange(0);
+            }
+
+            {
+                // rings of threads that have exited are done with
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                mRings.erase(std::remove_if(mRings.begin(), mRings.end(),
+                                            [](const AsyncLogRingPtr& ring) { return ring->mClosed && ring->empty(); }),
+                             mRings.end());
+            }
+
+            std::sort(mRecords.begin(), mRecords.end(),
+                      [](const AsyncLogRecord& a, const AsyncLogRecord& b) { return a.mSequence < b.mSequence; });
+            for (const AsyncLogRecord& queued : mRecords)
+            {
+                writeToRecorders(recorders, time_function, *queued.mSite, queued.mMessage, &queued.mTime);
+            }
+            mRecords.clear();
+            return dropped;
+        }
+
+        AsyncLogRing* getRing()
+        {
+            static thread_local AsyncLogRingHolder sHolder;
+            if (!sHolder.mRing)
+            {
+                sHolder.mRing = std::make_shared<AsyncLogRing>();
+                std::lock_guard<std::mutex> lock(mRingsMutex);
+                mRings.push_back(sHolder.mRing);
+            }
+            return sHolder.mRing.get();
+        }
+
+        void stopWriter()
+        {
+            if (mThread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> wake_lock(mWakeMutex);
+                    mStop = true;
+                }
+                mWake.notify_one();
+                mThread.join();
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            while (!mStop)
+            {
+                mWake.wait_for(lock, std::chrono::milliseconds(WRITER_INTERVAL_MS));
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        std::atomic<bool>                   mEnabled;
+        bool                                mStop;              // guarded by mWakeMutex
+        std::atomic<LLError::TimeFunction>  mTimeFunction;
+        std::atomic<U64>                    mSequence;
+        std::atomic<U64>                    mTotalDropped;
+
+        std::mutex                          mControlMutex;      // start() and stop()
+        std::mutex                          mRingsMutex;        // taken once per logging thread, and by drain()
+        std::vector<AsyncLogRingPtr>        mRings;
+        std::mutex                          mDrainMutex;
+        std::vector<AsyncLogRecord>         mRecords;           // guarded by mDrainMutex
+        std::thread                         mThread;
+        std::mutex                          mWakeMutex;
+        std::condition_variable             mWake;
+    };
+
+    void setAsyncTimeFunction(LLError::TimeFunction f)
+    {
+        AsyncLogger::instance().setTimeFunction(f);
+    }
+
+    // Locks the log mutex for a message written on the calling thread. Most
+    // messages give up rather than wait on another logging thread, but errors
+    // wait so that the crash is never lost.
+    typedef std::unique_lock<std::remove_pointer_t<decltype(getLogMutex())>> log_lock_t;
+
+    log_lock_t lockLogMutex(const LLError::CallSite& site)
+    {
+        if (site.mLevel == LLError::LEVEL_ERROR)
+        {
+            return log_lock_t(*getLogMutex());
+        }
+        return log_lock_t(*getLogMutex(), std::try_to_lock);
+    }
+}
+
+namespace LLError
+{
+    void setAsyncLogging(bool async)
+    {
+        AsyncLogger& logger = AsyncLogger::instance();
+        if (async)
+        {
+            SettingsConfigPtr s = Globals::getInstance()->getSettingsConfig();
+            logger.start(s->mTimeFunction);
+        }
+        else
+        {
+            logger.stop();
+        }
+    }
+
+    bool getAsyncLogging()
+    {
+        return AsyncLogger::instance().enabled();
+    }
+
+    void flushAsyncLogging()
+    {
+        AsyncLogger::instance().drain();
+    }
+
+    U64 getAsyncLogDropCount()
+    {
+        return AsyncLogger::instance().getDropCount();
+    }
+}
+
 namespace LLError
 {
 
@@ -1407,7 +1813,15 @@ namespace LLError
     void Log::flush(const std::ostringstream& out, const CallSite& site)
     {
         LL_PROFILE_ZONE_SCOPED_CATEGORY_LOGGING;
-        std::unique_lock lock(*getLogMutex(), std::try_to_lock); LL_PROFILE_MUTEX_LOCK(*getLogMutex());
+        AsyncLogger& async_logger = AsyncLogger::instance();
+        std::string message = out.str();
+        if (!site.mPrintOnce && site.mLevel != LEVEL_ERROR && async_logger.push(site, message))
+        {
+            // the writer thread takes it from here
+            return;
+        }
+
+        log_lock_t lock(lockLogMutex(site)); LL_PROFILE_MUTEX_LOCK(*getLogMutex());
         if (!lock)
         {
             return;
@@ -1416,8 +1830,6 @@ namespace LLError
         Globals* g = Globals::getInstance();
         SettingsConfigPtr s = g->getSettingsConfig();
 
-        std::string message = out.str();
-
         if (site.mPrintOnce)
         {
             std::ostringstream message_stream;
@@ -1445,6 +1857,16 @@ namespace LLError
             message = message_stream.str();
         }
 
+        if (site.mLevel == LEVEL_ERROR && async_logger.enabled())
+        {
+            // what led up to the crash goes first
+            async_logger.drain();
+        }
+        else if (site.mPrintOnce && async_logger.push(site, message))
+        {
+            return;
+        }
+
         writeToRecorders(site, message);
 
         if (site.mLevel == LEVEL_ERROR)
@@ -75,6 +75,15 @@ namespace LLError
     LL_COMMON_API ELevel getDefaultLevel();
     LL_COMMON_API void setAlwaysFlush(bool flush);
     LL_COMMON_API bool getAlwaysFlush();
+    LL_COMMON_API void setAsyncLogging(bool async);
+        // when on, messages are queued per thread and written by a writer
+        // thread, so logging threads don't wait on each other or on the
+        // recorders; errors are still written at once. A thread queueing
+        // faster than the writer keeps up loses messages, which are counted.
+    LL_COMMON_API bool getAsyncLogging();
+    LL_COMMON_API void flushAsyncLogging();
+        // writes out everything queued so far
+    LL_COMMON_API U64 getAsyncLogDropCount();
     LL_COMMON_API void setEnabledLogTypesMask(U32 mask);
     LL_COMMON_API U32 getEnabledLogTypesMask();
     LL_COMMON_API void setFunctionLevel(const std::string& function_name, LLError::ELevel);
@@ -38,6 +38,8 @@
 #include "lltracethreadrecorder.h"
 
 #include <boost/bind.hpp>
+#include <memory>
+#include <mutex>
 #include <queue>
 
 
@@ -78,6 +80,212 @@ U64         BlockTimer::sClockResolution = 1000000; // Microsecond resolution
 static LLMutex*         sLogLock = NULL;
 static std::queue<LLSD> sLogQueue;
 
+std::atomic<bool> BlockTimer::sTraceEvents(false);
+
+namespace
+{
+    // Timer events of one thread. The thread writes without locking, an
+    // exporter reading at the same time skips slots caught mid-write by
+    // checking their sequence numbers on both sides of the read.
+    class TraceEventRing
+    {
+    public:
+        static const U32 CAPACITY = 16384; // power of two
+
+        TraceEventRing(const std::string& thread_name, U32 thread_id)
+        :   mThreadName(thread_name),
+            mThreadId(thread_id),
+            mCount(0),
+            mSlots(new Slot[CAPACITY])
+        {
+        }
+
+        void push(const BlockTimerStatHandle* timer, U64 start, U64 duration)
+        {
+            U32 count = mCount.load(std::memory_order_relaxed);
+            Slot& slot = mSlots[count & (CAPACITY - 1)];
+            // odd while being written
+            slot.mSequence.store(count * 2 + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.mTimer.store(timer, std::memory_order_relaxed);
+            slot.mStart.store(start, std::memory_order_relaxed);
+            slot.mDuration.store(duration, std::memory_order_relaxed);
+            slot.mSequence.store(count * 2 + 2, std::memory_order_release);
+            mCount.store(count + 1, std::memory_order_relaxed);
+        }
+
+        struct Event
+        {
+            const BlockTimerStatHandle* mTimer;
+            U64                         mStart;
+            U64                         mDuration;
+        };
+
+        void read(std::vector<Event>& events) const
+        {
+            for (U32 i = 0; i < CAPACITY; ++i)
+            {
+                const Slot& slot = mSlots[i];
+                U32 before = slot.mSequence.load(std::memory_order_acquire);
+                Event event;
+                event.mTimer = slot.mTimer.load(std::memory_order_relaxed);
+                event.mStart = slot.mStart.load(std::memory_order_relaxed);
+                event.mDuration = slot.mDuration.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                U32 after = slot.mSequence.load(std::memory_order_relaxed);
+                if (before && before == after && !(before & 1) && event.mTimer)
+                {
+                    events.push_back(event);
+                }
+            }
+        }
+
+        const std::string   mThreadName;
+        const U32           mThreadId;
+
+    private:
+        struct Slot
+        {
+            std::atomic<U32>                            mSequence{ 0 };
+            std::atomic<const BlockTimerStatHandle*>    mTimer{ nullptr };
+            std::atomic<U64>                            mStart{ 0 };
+            std::atomic<U64>                            mDuration{ 0 };
+        };
+
+        std::atomic<U32>            mCount;
+        std::unique_ptr<Slot[]>     mSlots;
+    };
+
+    // Rings outlive their threads so the last events of a finished worker
+    // still show up in an export.
+    std::mutex& trace_rings_mutex()
+    {
+        static std::mutex sMutex;
+        return sMutex;
+    }
+
+    std::vector<std::shared_ptr<TraceEventRing> >& trace_rings()
+    {
+        static std::vector<std::shared_ptr<TraceEventRing> > sRings;
+        return sRings;
+    }
+
+    thread_local std::string sTraceThreadName;
+    thread_local TraceEventRing* sTraceRing = NULL;
+
+    void write_json_string(std::ostream& os, const std::string& str)
+    {
+        os << '"';
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+            {
+                os << '\\' << c;
+            }
+            else if ((U8)c < 0x20)
+            {
+                os << ' ';
+            }
+            else
+            {
+                os << c;
+            }
+        }
+        os << '"';
+    }
+}
+
+//static
+void BlockTimer::setTraceEvents(bool enable)
+{
+    sTraceEvents = enable;
+}
+
+//static
+void BlockTimer::setTraceThreadName(const std::string& name)
+{
+    sTraceThreadName = name;
+}
+
+//static
+void BlockTimer::recordTraceEvent(const BlockTimerStatHandle* timer, U64 start, U64 duration)
+{
+    if (!sTraceRing)
+    {
+        std::lock_guard<std::mutex> lock(trace_rings_mutex());
+        std::vector<std::shared_ptr<TraceEventRing> >& rings = trace_rings();
+        std::string name = sTraceThreadName;
+        if (name.empty())
+        {
+            name = on_main_thread() ? "main" : llformat("thread %d", (S32)rings.size());
+        }
+        rings.push_back(std::make_shared<TraceEventRing>(name, (U32)rings.size() + 1));
+        sTraceRing = rings.back().get();
+    }
+    sTraceRing->push(timer, start, duration);
+}
+
+//static
+bool BlockTimer::exportTraceEvents(std::ostream& os)
+{
+    std::vector<std::shared_ptr<TraceEventRing> > rings;
+    {
+        std::lock_guard<std::mutex> lock(trace_rings_mutex());
+        rings = trace_rings();
+    }
+
+    std::vector<std::vector<TraceEventRing::Event> > events(rings.size());
+    U64 first_start = std::numeric_limits<U64>::max();
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        rings[i]->read(events[i]);
+        for (const TraceEventRing::Event& event : events[i])
+        {
+            first_start = llmin(first_start, event.mStart);
+        }
+    }
+
+    // trace timestamps are in microseconds
+    const F64 usec_per_count = 1000000.0 / (F64)countsPerSecond();
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        const TraceEventRing& ring = *rings[i];
+        os << (first ? "\n" : ",\n");
+        first = false;
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.mThreadId << ",\"args\":{\"name\":";
+        write_json_string(os, ring.mThreadName);
+        os << "}}";
+
+        for (const TraceEventRing::Event& event : events[i])
+        {
+            os << ",\n{\"name\":";
+            write_json_string(os, event.mTimer->getName());
+            os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.mThreadId
+               << ",\"ts\":" << llformat("%.3f", (F64)(event.mStart - first_start) * usec_per_count)
+               << ",\"dur\":" << llformat("%.3f", (F64)event.mDuration * usec_per_count) << "}";
+        }
+    }
+    os << "\n]}\n";
+    return os.good();
+}
+
+//static
+bool BlockTimer::exportTraceEvents(const std::string& filename)
+{
+    llofstream os(filename.c_str());
+    if (!os.is_open())
+    {
+        LL_WARNS("FastTimers") << "Couldn't open " << filename << " for timer events" << LL_ENDL;
+        return false;
+    }
+    bool success = exportTraceEvents(os);
+    LL_INFOS("FastTimers") << "Wrote timer events to " << filename << LL_ENDL;
+    return success;
+}
+
 block_timer_tree_df_iterator_t begin_block_timer_tree_df(BlockTimerStatHandle& id)
 {
     return block_timer_tree_df_iterator_t(&id,
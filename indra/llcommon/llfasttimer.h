@@ -31,6 +31,8 @@
 #include "lltrace.h"
 #include "lltreeiterators.h"
 
+#include <atomic>
+
 #if LL_WINDOWS
 #include <intrin.h>
 #endif
@@ -206,6 +208,19 @@ public:
     // call nextFrame() to reset timers
     static void dumpCurTimes();
 
+    // Timer events: while on, every timer also records its start and
+    // duration in a fixed size ring of its thread, overwriting the oldest
+    // events. Unlike the accumulators this needs no merging or
+    // processTimes(), so it can stay on in a live session.
+    static void setTraceEvents(bool enable);
+    static bool getTraceEvents() { return sTraceEvents.load(std::memory_order_relaxed); }
+    // names the calling thread in exported traces
+    static void setTraceThreadName(const std::string& name);
+    // writes the events held by all threads as Chrome trace JSON, for
+    // chrome://tracing or Perfetto
+    static bool exportTraceEvents(std::ostream& os);
+    static bool exportTraceEvents(const std::string& filename);
+
 private:
     friend class BlockTimerStatHandle;
     // FIXME: this friendship exists so that each thread can instantiate a root timer,
@@ -219,10 +234,14 @@ private:
     BlockTimer(const BlockTimer& other);
     BlockTimer& operator=(const BlockTimer& other);
 
+    static void recordTraceEvent(const BlockTimerStatHandle* timer, U64 start, U64 duration);
+
 private:
     U64                     mStartTime;
     BlockTimerStackRecord   mParentTimerData{};
 
+    static std::atomic<bool> sTraceEvents;
+
 public:
     // statics
     static std::string      sLogName;
@@ -337,6 +356,11 @@ LL_FORCE_INLINE BlockTimer::~BlockTimer()
     // we are only tracking self time, so subtract our total time delta from parents
     mParentTimerData.mChildTime += total_time;
 
+    if (sTraceEvents.load(std::memory_order_relaxed))
+    {
+        recordTraceEvent(cur_timer_data->mTimeBlock, mStartTime, total_time);
+    }
+
     //pop stack
     *cur_timer_data = mParentTimerData;
 #endif
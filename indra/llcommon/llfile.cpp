@@ -32,6 +32,7 @@
 #include "llstring.h"
 #include "llerror.h"
 #include "stringize.h"
+#include "llapp.h"
 
 #if LL_WINDOWS
 #include "llwin32headers.h"
@@ -357,6 +358,34 @@ bool LLFile::copy(const std::string& from, const std::string& to)
     return copied;
 }
 
+bool LLFile::replaceContents(const std::string& filename, const void* data, size_t size)
+{
+    const std::string temp_filename = stringize(filename, '.', LLApp::getPid(), ".tmp");
+    LLFILE* out = LLFile::fopen(temp_filename, "wb");     /* Flawfinder: ignore */
+    if (!out)
+    {
+        LL_WARNS("LLFile") << "Unable to write " << temp_filename << LL_ENDL;
+        return false;
+    }
+    const bool written = fwrite(data, 1, size, out) == size;
+    fclose(out);
+    if (!written)
+    {
+        LL_WARNS("LLFile") << "Short write to " << temp_filename << LL_ENDL;
+        LLFile::remove(temp_filename);
+        return false;
+    }
+
+    // rename() doesn't replace an existing file on Windows
+    LLFile::remove(filename, ENOENT);
+    if (LLFile::rename(temp_filename, filename) != 0)
+    {
+        LLFile::remove(temp_filename);
+        return false;
+    }
+    return true;
+}
+
 int LLFile::stat(const std::string& filename, llstat* filestatus)
 {
 #if LL_WINDOWS
@@ -78,6 +78,10 @@ public:
     static  int     remove(const std::string& filename, int supress_error = 0);
     static  int     rename(const std::string& filename,const std::string& newname, int supress_error = 0);
     static  bool    copy(const std::string& from, const std::string& to);
+    // Writes to a temporary file next to filename and renames it over
+    // filename, so that another process opening filename meanwhile never
+    // reads a partial file.
+    static  bool    replaceContents(const std::string& filename, const void* data, size_t size);
 
     static  int     stat(const std::string& filename,llstat*    file_status);
     static  bool    isdir(const std::string&    filename);
@@ -0,0 +1,139 @@
+/**
+ * @file llmappedfile.cpp
+ * @brief Private, copy on write memory mapping of a whole file.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmappedfile.h"
+
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+LLMappedFile::LLMappedFile()
+:   mData(NULL),
+    mSize(0)
+#if LL_WINDOWS
+    , mMapping(NULL)
+#endif
+{
+}
+
+LLMappedFile::~LLMappedFile()
+{
+    unmap();
+}
+
+bool LLMappedFile::map(const std::string& filename)
+{
+    unmap();
+
+#if LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    CloseHandle(file); // the mapping keeps its own reference to the file
+    if (!mapping)
+    {
+        LL_WARNS() << "Cannot create file mapping for " << filename << ": " << GetLastError() << LL_ENDL;
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (!data)
+    {
+        LL_WARNS() << "Cannot map " << filename << ": " << GetLastError() << LL_ENDL;
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mMapping = mapping;
+    mData = (U8*)data;
+    mSize = (size_t)size.QuadPart;
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (data == MAP_FAILED)
+    {
+        LL_WARNS() << "Cannot map " << filename << ": " << errno << LL_ENDL;
+        return false;
+    }
+
+    mData = (U8*)data;
+    mSize = (size_t)st.st_size;
+#endif
+
+    return true;
+}
+
+void LLMappedFile::unmap()
+{
+    if (!mData)
+    {
+        return;
+    }
+
+#if LL_WINDOWS
+    UnmapViewOfFile(mData);
+    CloseHandle((HANDLE)mMapping);
+    mMapping = NULL;
+#else
+    munmap(mData, mSize);
+#endif
+
+    mData = NULL;
+    mSize = 0;
+}
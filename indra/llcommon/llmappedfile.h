@@ -0,0 +1,64 @@
+/**
+ * @file llmappedfile.h
+ * @brief Private, copy on write memory mapping of a whole file.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMAPPEDFILE_H
+#define LL_LLMAPPEDFILE_H
+
+#include "llrefcount.h"
+
+/**
+ * Maps a whole file into memory. The mapping is private and copy on
+ * write: pages stay shared with the page cache (and so with any other
+ * process mapping the same file) until they are written to, and writes
+ * never reach the file. Reference counted so that objects pointing into
+ * the mapping can keep it alive.
+ */
+class LL_COMMON_API LLMappedFile : public LLThreadSafeRefCount
+{
+public:
+    LLMappedFile();
+
+    // Maps filename, replacing any previous mapping. Returns false if the
+    // file cannot be opened or is empty.
+    bool map(const std::string& filename);
+    void unmap();
+
+    bool        isMapped() const    { return mData != NULL; }
+    U8*         getData() const     { return mData; }
+    size_t      getSize() const     { return mSize; }
+
+protected:
+    ~LLMappedFile();
+
+private:
+    U8*     mData;
+    size_t  mSize;
+#if LL_WINDOWS
+    void*   mMapping; // HANDLE
+#endif
+};
+
+#endif // LL_LLMAPPEDFILE_H
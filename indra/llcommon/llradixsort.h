@@ -0,0 +1,86 @@
+/**
+ * @file   llradixsort.h
+ * @date   2026-10-16
+ * @brief  radix_sort() orders elements by a precomputed 64 bit key without
+ *         comparisons.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_LLRADIXSORT_H)
+#define LL_LLRADIXSORT_H
+
+#include "stdtypes.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+namespace LL
+{
+    /**
+     * radix_sort() stably orders [begin, end) by ascending key(element), a
+     * U64, one byte of the key per pass. The histograms of all eight bytes
+     * are counted in a single pass first, so bytes that every key shares,
+     * typically the high ones, cost nothing more.
+     *
+     * scratch must hold end - begin elements. Elements are moved back and
+     * forth between the two ranges and always end up in [begin, end). key is
+     * called several times per element and should be cheap: sort (key,
+     * value) pairs rather than pointers to objects holding the key.
+     */
+    template <typename T, typename KEY>
+    void radix_sort(T* begin, T* end, T* scratch, KEY key)
+    {
+        const size_t count = end - begin;
+        if (count < 2)
+        {
+            return;
+        }
+
+        size_t histogram[8][256] = {};
+        for (T* i = begin; i != end; ++i)
+        {
+            U64 k = key(*i);
+            for (U32 b = 0; b < 8; ++b)
+            {
+                histogram[b][(k >> (b * 8)) & 0xff]++;
+            }
+        }
+
+        T* src = begin;
+        T* dst = scratch;
+        for (U32 b = 0; b < 8; ++b)
+        {
+            const U32 shift = b * 8;
+            size_t* offsets = histogram[b];
+            if (offsets[(key(*src) >> shift) & 0xff] == count)
+            { // all keys share this byte
+                continue;
+            }
+
+            size_t offset = 0;
+            for (U32 d = 0; d < 256; ++d)
+            {
+                size_t digits = offsets[d];
+                offsets[d] = offset;
+                offset += digits;
+            }
+
+            for (T* i = src; i != src + count; ++i)
+            {
+                dst[offsets[(key(*i) >> shift) & 0xff]++] = std::move(*i);
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != begin)
+        {
+            std::move(src, src + count, begin);
+        }
+    }
+} // namespace LL
+
+#endif /* ! defined(LL_LLRADIXSORT_H) */
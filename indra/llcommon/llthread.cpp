@@ -34,6 +34,7 @@
 #include "lltimer.h"
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
+#include "llfasttimer.h"
 #include "llexception.h"
 
 #if LL_LINUX
@@ -157,6 +158,7 @@ void LLThread::threadRun()
     LL_INFOS("THREAD") << "Started thread " << mName << LL_ENDL;
     LL_PROFILER_SET_THREAD_NAME( mName.c_str() );
     // </FS:Beq>
+    LLTrace::BlockTimer::setTraceThreadName(mName);
     // Run the user supplied function
     do
     {
@@ -0,0 +1,123 @@
+/**
+ * @file   parallelfor.cpp
+ * @date   2026-10-16
+ * @brief  Implementation for parallel_for().
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "parallelfor.h"
+// STL headers
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+// std headers
+// external library headers
+// other Linden headers
+#include "llprofiler.h"
+#include "threadpool.h"
+#include "workqueue.h"
+
+namespace
+{
+    // Shared by the caller and the workers helping it. A worker that starts
+    // after the last range was claimed finds nothing left and never touches
+    // mFunc, which belongs to the caller.
+    class ParallelForState
+    {
+    public:
+        ParallelForState(size_t count, size_t grain, const LL::parallel_for_func_t& func):
+            mCount(count),
+            mGrain(grain),
+            mFunc(func),
+            mNext(0),
+            mDone(0)
+        {}
+
+        // Runs ranges until none are left to claim
+        void run()
+        {
+            size_t ran = 0;
+            for (size_t begin = mNext.fetch_add(mGrain); begin < mCount; begin = mNext.fetch_add(mGrain))
+            {
+                const size_t end = std::min(begin + mGrain, mCount);
+                mFunc(begin, end);
+                ran += end - begin;
+            }
+
+            if (ran && mDone.fetch_add(ran) + ran == mCount)
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mCondition.notify_all();
+            }
+        }
+
+        // Waits for ranges claimed by workers that are still running
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mDone.load() == mCount; });
+        }
+
+    private:
+        const size_t mCount;
+        const size_t mGrain;
+        const LL::parallel_for_func_t& mFunc;
+        std::atomic<size_t> mNext;
+        std::atomic<size_t> mDone;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+    };
+} // anonymous namespace
+
+void LL::parallel_for(const std::string& pool, size_t count, size_t grain,
+                      const parallel_for_func_t& func)
+{
+    if (!count)
+    {
+        return;
+    }
+    grain = std::max(grain, size_t(1));
+    const size_t ranges = (count + grain - 1) / grain;
+
+    LL::WorkQueue::ptr_t queue;
+    size_t helpers = 0;
+    if (ranges > 1)
+    {
+        auto threads = LL::ThreadPoolBase::getInstance(pool);
+        queue = LL::WorkQueue::getInstance(pool);
+        if (threads && queue && !queue->isClosed())
+        {
+            helpers = std::min(threads->getWidth(), ranges - 1);
+        }
+    }
+    if (!helpers)
+    {
+        func(0, count);
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    auto state = std::make_shared<ParallelForState>(count, grain, func);
+    for (size_t i = 0; i < helpers; ++i)
+    {
+        // Never block on a full queue, the caller can do the work itself
+        if (!queue->tryPost([state]()
+                            {
+                                LL_PROFILE_ZONE_NAMED("parallel_for worker");
+                                state->run();
+                            }))
+        {
+            break;
+        }
+    }
+    state->run();
+    state->wait();
+}
@@ -0,0 +1,36 @@
+/**
+ * @file   parallelfor.h
+ * @date   2026-10-16
+ * @brief  parallel_for() shares a loop between the calling thread and the
+ *         threads of a ThreadPool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_PARALLELFOR_H)
+#define LL_PARALLELFOR_H
+
+#include <functional>
+#include <string>
+
+namespace LL
+{
+    using parallel_for_func_t = std::function<void(size_t begin, size_t end)>;
+
+    /**
+     * parallel_for() calls func(begin, end) over consecutive ranges of at
+     * most grain indices covering [0, count), and returns once all of them
+     * are done. Ranges are claimed by the calling thread and by the threads
+     * of the ThreadPool named pool as they come free, so a busy or missing
+     * pool costs parallelism but never stalls the caller: whatever no worker
+     * picked up is run by the caller itself.
+     *
+     * func is called concurrently for different ranges and must not throw.
+     */
+    void parallel_for(const std::string& pool, size_t count, size_t grain,
+                      const parallel_for_func_t& func);
+} // namespace LL
+
+#endif /* ! defined(LL_PARALLELFOR_H) */
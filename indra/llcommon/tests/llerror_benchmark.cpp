@@ -0,0 +1,99 @@
+/**
+ * @file   llerror_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times synchronous against asynchronous logging from several
+ *         threads. Built when LL_BENCHMARKS is set, run by hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "../llerror.h"
+#include "../llerrorcontrol.h"
+
+namespace
+{
+    class CountingRecorder : public LLError::Recorder
+    {
+    public:
+        CountingRecorder()
+        {
+            showTime(false);
+        }
+
+        void recordMessage(LLError::ELevel level, const std::string& message) override
+        {
+            ++mCount;
+        }
+
+        std::atomic<U64> mCount{ 0 };
+    };
+
+    // Returns the seconds taken by thread_count threads logging count
+    // messages each.
+    F64 logFromThreads(int thread_count, int count)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([t, count]()
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    LL_INFOS("Benchmark") << "worker " << t << " message " << i << LL_ENDL;
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        return std::chrono::duration<F64>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int THREADS = 4;
+    const int COUNT = 20000;
+
+    LLError::setDefaultLevel(LLError::LEVEL_DEBUG);
+    std::shared_ptr<CountingRecorder> recorder(new CountingRecorder());
+    LLError::addRecorder(recorder);
+
+    // settle whether the call site logs while nothing else holds the log
+    // mutex, a contended first call would skip its message
+    logFromThreads(1, 1);
+    recorder->mCount = 0;
+
+    // the synchronous path gives up on messages while another thread holds
+    // the log mutex
+    F64 sync_seconds = logFromThreads(THREADS, COUNT);
+    U64 sync_written = recorder->mCount;
+    recorder->mCount = 0;
+
+    U64 dropped_before = LLError::getAsyncLogDropCount();
+    LLError::setAsyncLogging(true);
+    F64 async_seconds = logFromThreads(THREADS, COUNT);
+    LLError::setAsyncLogging(false);
+    U64 async_written = recorder->mCount;
+    U64 dropped = LLError::getAsyncLogDropCount() - dropped_before;
+
+    LLError::removeRecorder(recorder);
+
+    std::cout << THREADS << " threads x " << COUNT << " messages:\n"
+              << "  synchronous  " << sync_seconds << "s, " << sync_written << " written\n"
+              << "  asynchronous " << async_seconds << "s, " << async_written << " written, "
+              << dropped << " dropped" << std::endl;
+    return 0;
+}
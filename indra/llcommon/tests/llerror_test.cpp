@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <stdexcept>
+#include <thread>
 
 #include "linden_common.h"
 
@@ -921,6 +922,108 @@ namespace tut
     }
 }
 
+namespace
+{
+    void writeOrderedMessages(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            LL_INFOS("Async") << "message " << i << LL_ENDL;
+        }
+    }
+
+    void logFromThreads(int thread_count, int count)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            threads.emplace_back([t, count]()
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    LL_INFOS("Async") << "worker " << t << " message " << i << LL_ENDL;
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+namespace tut
+{
+    template<> template<>
+    void ErrorTestObject::test<19>()
+        // asynchronous messages arrive in order once flushed, errors at once
+    {
+        LLError::setAsyncLogging(true);
+        ensure("async logging on", LLError::getAsyncLogging());
+
+        writeOrderedMessages(100);
+        CATCH(LL_ERRS("Async"), "fatal");
+        ensure("fatal callback called", fatalWasCalled);
+        ensure_message_count(101);
+        for (int i = 0; i < 100; ++i)
+        {
+            ensure_message_field_equals(i, MSG_FIELD, "message " + std::to_string(i));
+        }
+        ensure_message_field_equals(100, MSG_FIELD, "fatal");
+
+        writeOrderedMessages(10);
+        LLError::flushAsyncLogging();
+        ensure_message_count(111);
+        ensure_message_field_equals(110, MSG_FIELD, "message 9");
+
+        LLError::setAsyncLogging(false);
+        ensure("async logging off", !LLError::getAsyncLogging());
+    }
+
+    template<> template<>
+    void ErrorTestObject::test<20>()
+        // several threads logging at once; every message is either written
+        // or counted as dropped
+    {
+        const int THREADS = 4;
+        const int COUNT = 1000;
+
+        U64 dropped_before = LLError::getAsyncLogDropCount();
+        LLError::setAsyncLogging(true);
+        logFromThreads(THREADS, COUNT);
+        LLError::setAsyncLogging(false);
+        U64 dropped = LLError::getAsyncLogDropCount() - dropped_before;
+
+        int written = 0;
+        for (int i = 0; i < countMessages(); ++i)
+        {
+            if (message_field(i, MSG_FIELD).find("worker ") == 0)
+            {
+                ++written;
+            }
+        }
+        ensure_equals("written and dropped messages", written + dropped, (U64)(THREADS * COUNT));
+    }
+
+    template<> template<>
+    void ErrorTestObject::test<21>()
+        // an error from another thread isn't lost while the writer is busy
+    {
+        LLError::setAsyncLogging(true);
+        std::thread logger([]() { logFromThreads(1, 1000); });
+        std::thread fatal([]()
+        {
+            CATCH(LL_ERRS("Async"), "fatal from another thread");
+        });
+        fatal.join();
+        logger.join();
+        LLError::setAsyncLogging(false);
+
+        ensure("fatal callback called", fatalWasCalled);
+        ensure_equals("fatal message", LLError::getFatalMessage(), std::string("fatal from another thread"));
+    }
+}
+
 /* Tests left:
     handling of classes without LOG_CLASS
 
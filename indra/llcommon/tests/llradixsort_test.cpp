@@ -0,0 +1,91 @@
+/**
+ * @file   llradixsort_test.cpp
+ * @date   2026-10-16
+ * @brief  Test for llradixsort.h.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llradixsort.h"
+// STL headers
+// std headers
+#include <algorithm>
+#include <vector>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llradixsort_data
+    {
+        typedef std::pair<U64, U32> entry_t;
+
+        U32 mSeed = 1;
+
+        // deterministic so failures reproduce
+        U32 random()
+        {
+            mSeed = mSeed * 1664525 + 1013904223;
+            return mSeed >> 8;
+        }
+
+        // radix sorts entries and checks them against std::stable_sort
+        void check(const std::string& desc, std::vector<entry_t> entries)
+        {
+            std::vector<entry_t> expected(entries);
+            std::stable_sort(expected.begin(), expected.end(),
+                             [](const entry_t& a, const entry_t& b) { return a.first < b.first; });
+
+            std::vector<entry_t> scratch(entries.size());
+            LL::radix_sort(entries.data(), entries.data() + entries.size(), scratch.data(),
+                           [](const entry_t& e) { return e.first; });
+            ensure(desc, entries == expected);
+        }
+    };
+    typedef test_group<llradixsort_data> llradixsort_group;
+    typedef llradixsort_group::object object;
+    llradixsort_group llradixsortgrp("llradixsort");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("same order as a stable comparison sort");
+
+        check("empty", {});
+        check("one", { { 42, 0 } });
+
+        std::vector<entry_t> entries;
+        for (U32 i = 0; i < 10000; ++i)
+        {
+            entries.emplace_back(((U64) random() << 40) ^ ((U64) random() << 16) ^ random(), i);
+        }
+        check("full width keys", entries);
+
+        for (entry_t& e : entries)
+        {
+            e.first &= 0xff00000000ff00ffULL;
+        }
+        check("keys sharing middle bytes", entries);
+
+        for (entry_t& e : entries)
+        {
+            e.first = random() % 7;
+        }
+        check("many equal keys", entries);
+
+        for (entry_t& e : entries)
+        {
+            e.first = 0x0123456789abcdefULL;
+        }
+        check("identical keys", entries);
+    }
+} // namespace tut
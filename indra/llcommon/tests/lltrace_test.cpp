@@ -30,6 +30,7 @@
 #include "lltrace.h"
 #include "lltracethreadrecorder.h"
 #include "lltracerecording.h"
+#include "llfasttimer.h"
 #include "../test/lltut.h"
 
 #ifdef LL_WINDOWS
@@ -72,6 +73,8 @@ namespace tut
     static SampleStatHandle<F32Milligrams> sCaffeineLevelStat("caffeinelevel", "Coffee buzz quotient");
     static EventStatHandle<S32Ounces> sOuncesPerCup("cupsize", "Large, huge, or ginormous");
 
+    static BlockTimerStatHandle sBrewTimer("brew_coffee");
+
     static F32 sCaffeineLevel(0.f);
     const F32Milligrams sCaffeinePerOz(18.f);
 
@@ -143,4 +146,35 @@ namespace tut
                 && after_3pm.getMax(sCaffeineLevelStat) == sCaffeinePerOz * ((S32Ounces)S32TallCup(1) + (S32Ounces)S32GrandeCup(3) + (S32Ounces)S32VentiCup(1)).value());
     }
 
+
+    // timer events export as Chrome trace JSON
+    template<> template<>
+    void trace_object_t::test<2>()
+    {
+        BlockTimer::setTraceEvents(true);
+        for (S32 i = 0; i < 3; ++i)
+        {
+            LL_RECORD_BLOCK_TIME(sBrewTimer);
+            drink_coffee(1, S32TallCup(1));
+        }
+        BlockTimer::setTraceEvents(false);
+        {
+            // not recorded
+            LL_RECORD_BLOCK_TIME(sBrewTimer);
+        }
+
+        std::ostringstream trace;
+        ensure("export succeeds", BlockTimer::exportTraceEvents(trace));
+        std::string json = trace.str();
+        ensure_starts_with("trace header", json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        ensure_contains("thread named", json, "\"ph\":\"M\"");
+
+        S32 events = 0;
+        for (size_t pos = json.find("{\"name\":\"brew_coffee\",\"ph\":\"X\""); pos != std::string::npos;
+             pos = json.find("{\"name\":\"brew_coffee\",\"ph\":\"X\"", pos + 1))
+        {
+            ++events;
+        }
+        ensure_equals("timer events while on", events, 3);
+    }
 }
@@ -0,0 +1,107 @@
+/**
+ * @file   parallelfor_test.cpp
+ * @date   2026-10-16
+ * @brief  Test for parallelfor.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "parallelfor.h"
+// STL headers
+// std headers
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "threadpool.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct parallelfor_data
+    {
+        // Counts the calls for each index, and checks they all came once
+        void check(const std::string& desc, const std::string& pool, size_t count, size_t grain)
+        {
+            std::vector<std::atomic<U32> > calls(count);
+            for (std::atomic<U32>& c : calls)
+            {
+                c = 0;
+            }
+            LL::parallel_for(pool, count, grain,
+                             [&calls](size_t begin, size_t end)
+                             {
+                                 for (size_t i = begin; i < end; ++i)
+                                 {
+                                     ++calls[i];
+                                 }
+                             });
+            for (size_t i = 0; i < count; ++i)
+            {
+                ensure_equals(desc + " index " + std::to_string(i), calls[i].load(), 1U);
+            }
+        }
+    };
+    typedef test_group<parallelfor_data> parallelfor_group;
+    typedef parallelfor_group::object object;
+    parallelfor_group parallelforgrp("parallelfor");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("no pool");
+        std::thread::id caller = std::this_thread::get_id();
+        bool other_thread = false;
+        LL::parallel_for("NoSuchPool", 100, 10,
+                         [caller, &other_thread](size_t, size_t)
+                         {
+                             other_thread |= std::this_thread::get_id() != caller;
+                         });
+        ensure("ran off the calling thread", !other_thread);
+        check("no pool", "NoSuchPool", 100, 10);
+        check("empty", "NoSuchPool", 0, 10);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("pool");
+        LL::ThreadPool pool("ParallelForTest", 3);
+        pool.start();
+        check("grain 1", "ParallelForTest", 1000, 1);
+        check("uneven grain", "ParallelForTest", 1000, 7);
+        check("one range", "ParallelForTest", 5, 64);
+        check("zero grain", "ParallelForTest", 50, 0);
+
+        // the workers really do take a share
+        std::atomic<U32> off_caller{ 0 };
+        std::thread::id caller = std::this_thread::get_id();
+        for (U32 i = 0; i < 20 && !off_caller; ++i)
+        {
+            LL::parallel_for("ParallelForTest", 64, 1,
+                             [caller, &off_caller](size_t, size_t)
+                             {
+                                 if (std::this_thread::get_id() != caller)
+                                 {
+                                     ++off_caller;
+                                 }
+                                 std::this_thread::sleep_for(std::chrono::microseconds(200));
+                             });
+        }
+        ensure("no range ran on the pool", off_caller > 0);
+        pool.close();
+
+        // a closed pool leaves it all to the caller
+        check("closed pool", "ParallelForTest", 100, 1);
+    }
+} // namespace tut
@@ -20,7 +20,9 @@
 #include "commoncontrol.h"
 #include "llerror.h"
 #include "llevents.h"
+#include "llfasttimer.h"
 #include "llsd.h"
+#include "lltracethreadrecorder.h"
 #include "stringize.h"
 
 #include <boost/fiber/algo/round_robin.hpp>
@@ -80,6 +82,13 @@ void LL::ThreadPoolBase::start()
             {
                 LL_PROFILER_SET_THREAD_NAME(tname.c_str());
                 LL_INFOS("THREAD") << "Started thread " << tname << LL_ENDL;
+                // as in LLThread, so block timers work on pool threads too
+                std::unique_ptr<LLTrace::ThreadRecorder> recorder;
+                if (LLTrace::get_master_thread_recorder())
+                {
+                    recorder.reset(new LLTrace::ThreadRecorder(*LLTrace::get_master_thread_recorder()));
+                }
+                LLTrace::BlockTimer::setTraceThreadName(tname);
                 run(tname);
             });
     }
@@ -0,0 +1,412 @@
+/**
+ * @file llsoftwaredepthbuffer.cpp
+ * @brief Low resolution CPU rasterized depth buffer with a hierarchical Z
+ * test for occlusion culling.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsoftwaredepthbuffer.h"
+
+#include "llcamera.h"
+
+#include <algorithm>
+
+// Triangles of a box with corners indexed as in rasterizeBox(), counter
+// clockwise seen from outside
+static const U16 BOX_INDICES[] =
+{
+    0, 4, 6,  0, 6, 2,  // -x
+    1, 3, 7,  1, 7, 5,  // +x
+    0, 1, 5,  0, 5, 4,  // -y
+    2, 6, 7,  2, 7, 3,  // +y
+    0, 2, 3,  0, 3, 1,  // -z
+    4, 5, 7,  4, 7, 6,  // +z
+};
+
+// Distance in pixels outside an edge a pixel center still counts as inside
+static const F32 EDGE_TOLERANCE = 1.f / 256.f;
+
+// Most texels a side of a box covers in the level isOccluded() tests
+static const S32 MAX_TEST_TEXELS = 4;
+
+LLSoftwareDepthBuffer::LLSoftwareDepthBuffer()
+:   mWidth(0),
+    mHeight(0),
+    mNumTriangles(0),
+    mNear(DEFAULT_NEAR_PLANE)
+{
+    mOrigin.clear();
+    mRowX.clear();
+    mRowY.clear();
+    mRowW.clear();
+}
+
+void LLSoftwareDepthBuffer::resize(U32 width, U32 height)
+{
+    mWidth = (width + 3) & ~3;
+    mHeight = height;
+
+    LLVector4a zero;
+    zero.clear();
+    mDepth.assign(mWidth / 4 * mHeight, zero);
+
+    mLevels.clear();
+    U32 level_width = mWidth;
+    U32 level_height = mHeight;
+    while (level_width > 1 || level_height > 1)
+    {
+        level_width = (level_width + 1) / 2;
+        level_height = (level_height + 1) / 2;
+        mLevels.emplace_back();
+        Level& level = mLevels.back();
+        level.mWidth = level_width;
+        level.mHeight = level_height;
+        level.mTexels.assign(level_width * level_height, 0.f);
+    }
+}
+
+void LLSoftwareDepthBuffer::clear(const LLCamera& camera)
+{
+    LLVector4a zero;
+    zero.clear();
+    std::fill(mDepth.begin(), mDepth.end(), zero);
+    mNumTriangles = 0;
+
+    // Same projection as LLViewerCamera, without the depth range
+    F32 tan_half_height = tanf(camera.getView() * 0.5f);
+    F32 tan_half_width = tan_half_height * camera.getAspect();
+
+    mOrigin.load3(camera.getOrigin().mV);
+    mRowX.load3(camera.getLeftAxis().mV);
+    mRowX.mul(-1.f / tan_half_width);
+    mRowY.load3(camera.getUpAxis().mV);
+    mRowY.mul(1.f / tan_half_height);
+    mRowW.load3(camera.getAtAxis().mV);
+    mNear = camera.getNear();
+}
+
+void LLSoftwareDepthBuffer::project(const LLVector4a& v, LLVector4a& clip) const
+{
+    LLVector4a delta;
+    delta.setSub(v, mOrigin);
+    clip.set(delta.dot3(mRowX).getF32(), delta.dot3(mRowY).getF32(), 0.f, delta.dot3(mRowW).getF32());
+}
+
+void LLSoftwareDepthBuffer::toScreen(const LLVector4a& clip, LLVector4a& screen) const
+{
+    F32 inv_w = 1.f / clip[3];
+    screen.set((clip[0] * inv_w * 0.5f + 0.5f) * mWidth,
+               (clip[1] * inv_w * 0.5f + 0.5f) * mHeight,
+               inv_w);
+}
+
+void LLSoftwareDepthBuffer::rasterizeTriangles(const LLVector4a* vertices, const U16* indices, U32 index_count, bool cull_back_faces)
+{
+    if (mDepth.empty())
+    {
+        return;
+    }
+
+    LLVector4a clip[3];
+    for (U32 i = 0; i + 2 < index_count; i += 3)
+    {
+        U32 behind = 0;
+        for (U32 j = 0; j < 3; ++j)
+        {
+            project(vertices[indices[i + j]], clip[j]);
+            if (clip[j][3] < mNear)
+            {
+                behind++;
+            }
+        }
+
+        if (behind == 3)
+        {
+            continue;
+        }
+        else if (behind)
+        {
+            rasterizeClipped(clip, cull_back_faces);
+        }
+        else
+        {
+            LLVector4a screen[3];
+            for (U32 j = 0; j < 3; ++j)
+            {
+                toScreen(clip[j], screen[j]);
+            }
+            rasterizeTriangle(screen[0], screen[1], screen[2], cull_back_faces);
+        }
+    }
+}
+
+void LLSoftwareDepthBuffer::rasterizeBox(const LLVector4a* corners)
+{
+    rasterizeTriangles(corners, BOX_INDICES, LL_ARRAY_SIZE(BOX_INDICES), true);
+}
+
+void LLSoftwareDepthBuffer::rasterizeClipped(const LLVector4a* clip, bool cull_back_face)
+{
+    // Clip against the near plane, a triangle becomes at most a quad
+    LLVector4a polygon[4];
+    U32 count = 0;
+    for (U32 i = 0; i < 3; ++i)
+    {
+        const LLVector4a& a = clip[i];
+        const LLVector4a& b = clip[(i + 1) % 3];
+        bool a_in = a[3] >= mNear;
+        bool b_in = b[3] >= mNear;
+        if (a_in)
+        {
+            polygon[count++] = a;
+        }
+        if (a_in != b_in)
+        {
+            polygon[count++].setLerp(a, b, (mNear - a[3]) / (b[3] - a[3]));
+        }
+    }
+
+    LLVector4a screen[4];
+    for (U32 i = 0; i < count; ++i)
+    {
+        toScreen(polygon[i], screen[i]);
+    }
+    for (U32 i = 1; i + 1 < count; ++i)
+    {
+        rasterizeTriangle(screen[0], screen[i], screen[i + 1], cull_back_face);
+    }
+}
+
+void LLSoftwareDepthBuffer::rasterizeTriangle(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2, bool cull_back_face)
+{
+    F32 area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v1[1] - v0[1]) * (v2[0] - v0[0]);
+    if (area < 0.f && !cull_back_face)
+    { //draw the back face as if it was wound the other way
+        rasterizeTriangle(v0, v2, v1, true);
+        return;
+    }
+    if (area <= F_APPROXIMATELY_ZERO)
+    {
+        return;
+    }
+
+    // Pixels whose centers are in the bounding box, in groups of four
+    F32 min_x = llmin(v0[0], v1[0], v2[0]);
+    F32 max_x = llmax(v0[0], v1[0], v2[0]);
+    F32 min_y = llmin(v0[1], v1[1], v2[1]);
+    F32 max_y = llmax(v0[1], v1[1], v2[1]);
+    S32 x_begin = llmax((S32)ceilf(min_x - 0.5f), 0) & ~3;
+    S32 x_end = llmin((S32)floorf(max_x - 0.5f) + 1, (S32)mWidth);
+    S32 y_begin = llmax((S32)ceilf(min_y - 0.5f), 0);
+    S32 y_end = llmin((S32)floorf(max_y - 0.5f) + 1, (S32)mHeight);
+    if (x_begin >= x_end || y_begin >= y_end)
+    {
+        return;
+    }
+
+    mNumTriangles++;
+
+    // Edge functions, positive inside, each the weight of the vertex facing it
+    const LLVector4a* verts[3] = { &v0, &v1, &v2 };
+    F32 a[3], b[3], c[3];
+    for (U32 i = 0; i < 3; ++i)
+    {
+        const LLVector4a& p = *verts[(i + 1) % 3];
+        const LLVector4a& q = *verts[(i + 2) % 3];
+        a[i] = p[1] - q[1];
+        b[i] = q[0] - p[0];
+        c[i] = -(a[i] * p[0] + b[i] * p[1]);
+    }
+
+    // Inverse depth is linear in screen space
+    F32 inv_area = 1.f / area;
+    F32 z_a = (a[0] * v0[2] + a[1] * v1[2] + a[2] * v2[2]) * inv_area;
+    F32 z_b = (b[0] * v0[2] + b[1] * v1[2] + b[2] * v2[2]) * inv_area;
+    F32 z_c = (c[0] * v0[2] + c[1] * v1[2] + c[2] * v2[2]) * inv_area;
+
+    // Scale the edge functions to distances in pixels, so that pixel centers
+    // on an edge shared by two triangles land in one of them despite rounding
+    for (U32 i = 0; i < 3; ++i)
+    {
+        F32 inv_length = 1.f / sqrtf(a[i] * a[i] + b[i] * b[i]);
+        a[i] *= inv_length;
+        b[i] *= inv_length;
+        c[i] *= inv_length;
+    }
+
+    LLVector4a zero;
+    zero.clear();
+    LLVector4a edge_tolerance(-EDGE_TOLERANCE);
+    LLVector4a pixel_x_begin(x_begin + 0.5f, x_begin + 1.5f, x_begin + 2.5f, x_begin + 3.5f);
+    LLVector4a edge_step[3];
+    LLVector4a edge_a[3];
+    for (U32 i = 0; i < 3; ++i)
+    {
+        edge_a[i].splat(a[i]);
+        edge_step[i].splat(a[i] * 4.f);
+    }
+    LLVector4a depth_a(z_a);
+    LLVector4a depth_step(z_a * 4.f);
+
+    const U32 row_stride = mWidth / 4;
+    for (S32 y = y_begin; y < y_end; ++y)
+    {
+        F32 pixel_y = y + 0.5f;
+        LLVector4a edge[3];
+        for (U32 i = 0; i < 3; ++i)
+        {
+            edge[i].setMul(edge_a[i], pixel_x_begin);
+            edge[i].add(LLVector4a(b[i] * pixel_y + c[i]));
+        }
+        LLVector4a depth;
+        depth.setMul(depth_a, pixel_x_begin);
+        depth.add(LLVector4a(z_b * pixel_y + z_c));
+
+        LLVector4a* dst = &mDepth[y * row_stride + x_begin / 4];
+        for (S32 x = x_begin; x < x_end; x += 4, ++dst)
+        {
+            LLVector4a inside;
+            inside.setMin(edge[0], edge[1]);
+            inside.setMin(inside, edge[2]);
+            LLVector4Logical mask = inside.greaterEqual(edge_tolerance);
+            if (mask.getGatheredBits())
+            {
+                LLVector4a covered;
+                covered.setSelectWithMask(mask, depth, zero);
+                dst->setMax(*dst, covered);
+            }
+
+            for (U32 i = 0; i < 3; ++i)
+            {
+                edge[i].add(edge_step[i]);
+            }
+            depth.add(depth_step);
+        }
+    }
+}
+
+F32 LLSoftwareDepthBuffer::getDepth(U32 x, U32 y) const
+{
+    llassert(x < mWidth && y < mHeight);
+    return mDepth[y * (mWidth / 4) + x / 4][x & 3];
+}
+
+void LLSoftwareDepthBuffer::buildHierarchy()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_OCTREE;
+    U32 src_width = mWidth;
+    U32 src_height = mHeight;
+    const F32* src = mDepth.empty() ? NULL : mDepth[0].getF32ptr();
+
+    for (Level& level : mLevels)
+    {
+        for (U32 y = 0; y < level.mHeight; ++y)
+        {
+            U32 y0 = y * 2;
+            U32 y1 = llmin(y0 + 1, src_height - 1);
+            for (U32 x = 0; x < level.mWidth; ++x)
+            {
+                U32 x0 = x * 2;
+                U32 x1 = llmin(x0 + 1, src_width - 1);
+                level.mTexels[y * level.mWidth + x] = llmin(src[y0 * src_width + x0], src[y0 * src_width + x1],
+                                                            src[y1 * src_width + x0], src[y1 * src_width + x1]);
+            }
+        }
+
+        src_width = level.mWidth;
+        src_height = level.mHeight;
+        src = level.mTexels.data();
+    }
+}
+
+bool LLSoftwareDepthBuffer::isOccluded(const LLVector4a* bounds) const
+{
+    if (mDepth.empty() || !mNumTriangles)
+    {
+        return false;
+    }
+
+    // Screen rectangle and nearest inverse depth of the box
+    F32 min_x = F32_MAX;
+    F32 max_x = -F32_MAX;
+    F32 min_y = F32_MAX;
+    F32 max_y = -F32_MAX;
+    F32 nearest = 0.f;
+    for (U32 i = 0; i < 8; ++i)
+    {
+        LLVector4a corner(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f);
+        corner.mul(bounds[1]);
+        corner.add(bounds[0]);
+
+        LLVector4a clip;
+        project(corner, clip);
+        if (clip[3] < mNear)
+        { //crosses the near plane
+            return false;
+        }
+
+        LLVector4a screen;
+        toScreen(clip, screen);
+        min_x = llmin(min_x, screen[0]);
+        max_x = llmax(max_x, screen[0]);
+        min_y = llmin(min_y, screen[1]);
+        max_y = llmax(max_y, screen[1]);
+        nearest = llmax(nearest, screen[2]);
+    }
+
+    if (max_x < 0.f || max_y < 0.f || min_x >= mWidth || min_y >= mHeight)
+    {
+        return false;
+    }
+
+    S32 x_begin = llmax((S32)floorf(min_x), 0);
+    S32 x_end = llmin((S32)floorf(max_x), (S32)mWidth - 1);
+    S32 y_begin = llmax((S32)floorf(min_y), 0);
+    S32 y_end = llmin((S32)floorf(max_y), (S32)mHeight - 1);
+
+    // Finest level where the box spans few enough texels, coarser levels
+    // hold the farthest depth of larger areas so are more conservative
+    U32 level = 0;
+    while (level < mLevels.size() &&
+           ((x_end >> level) - (x_begin >> level) >= MAX_TEST_TEXELS ||
+            (y_end >> level) - (y_begin >> level) >= MAX_TEST_TEXELS))
+    {
+        level++;
+    }
+
+    for (S32 y = y_begin >> level; y <= y_end >> level; ++y)
+    {
+        for (S32 x = x_begin >> level; x <= x_end >> level; ++x)
+        {
+            F32 farthest = level ? mLevels[level - 1].mTexels[y * mLevels[level - 1].mWidth + x] : getDepth(x, y);
+            if (farthest <= nearest)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file llsoftwaredepthbuffer.h
+ * @brief Low resolution CPU rasterized depth buffer with a hierarchical Z
+ * test for occlusion culling.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSOFTWAREDEPTHBUFFER_H
+#define LL_LLSOFTWAREDEPTHBUFFER_H
+
+#include "llmath.h"
+#include "llvector4a.h"
+
+#include <vector>
+
+class LLCamera;
+
+// Occluders are rasterized from the point of view of an LLCamera into a small
+// depth buffer, four pixels at a time, then a hierarchy of farthest depths is
+// built over it so that a bounding box can be tested against a few texels
+// whatever its size on screen. Depth is stored as the inverse of the distance
+// along the view axis, zero where nothing was drawn.
+//
+// Depth is sampled at pixel centers, so occluders should lie inside the
+// geometry they stand for (the ground under a terrain patch, the volume of a
+// solid box) for a box to never be reported occluded while visible.
+class LLSoftwareDepthBuffer
+{
+public:
+    LLSoftwareDepthBuffer();
+
+    // width is rounded up to a multiple of 4
+    void resize(U32 width, U32 height);
+    U32 getWidth() const        { return mWidth; }
+    U32 getHeight() const       { return mHeight; }
+
+    // Empties the buffer and projects the next occluders as seen from camera
+    void clear(const LLCamera& camera);
+
+    // Indexed triangles in agent space, counter clockwise when front facing
+    void rasterizeTriangles(const LLVector4a* vertices, const U16* indices, U32 index_count, bool cull_back_faces);
+    // Corners of a box in agent space, bit 0 of the index selecting +x, bit 1
+    // +y and bit 2 +z in the box's own frame
+    void rasterizeBox(const LLVector4a* corners);
+
+    // Must be called after the last occluder and before isOccluded()
+    void buildHierarchy();
+
+    // True if the axis aligned box (center, half size) is entirely hidden
+    // behind the occluders rasterized since clear()
+    bool isOccluded(const LLVector4a* bounds) const;
+
+    U32 getNumTriangles() const { return mNumTriangles; }
+    // Inverse depth of pixel x, y, for debugging and tests
+    F32 getDepth(U32 x, U32 y) const;
+
+private:
+    // x and y in pixels, z inverse depth
+    void rasterizeTriangle(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2, bool cull_back_face);
+    void rasterizeClipped(const LLVector4a* clip, bool cull_back_face);
+    void project(const LLVector4a& v, LLVector4a& clip) const;
+    void toScreen(const LLVector4a& clip, LLVector4a& screen) const;
+
+    U32 mWidth;
+    U32 mHeight;
+    U32 mNumTriangles;
+
+    // Agent to clip space as three rows: x, y and w
+    LL_ALIGN_16(LLVector4a mOrigin);
+    LL_ALIGN_16(LLVector4a mRowX);
+    LL_ALIGN_16(LLVector4a mRowY);
+    LL_ALIGN_16(LLVector4a mRowW);
+    F32 mNear;
+
+    // Four pixels per entry, rows of mWidth / 4
+    std::vector<LLVector4a> mDepth;
+
+    // Farthest depth of 2x2 texels of the level below, level 0 being mDepth
+    struct Level
+    {
+        U32 mWidth;
+        U32 mHeight;
+        std::vector<F32> mTexels;
+    };
+    std::vector<Level> mLevels;
+};
+
+#endif // LL_LLSOFTWAREDEPTHBUFFER_H
@@ -0,0 +1,145 @@
+/**
+ * @file llsoftwaredepthbuffer_test.cpp
+ * @brief Test for llsoftwaredepthbuffer.cpp.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llcamera.h"
+#include "../llsoftwaredepthbuffer.h"
+
+namespace tut
+{
+    struct LLSoftwareDepthBufferData
+    {
+        LLCamera mCamera;
+        LLSoftwareDepthBuffer mBuffer;
+
+        LLSoftwareDepthBufferData()
+        :   mCamera(60.f * DEG_TO_RAD, 1.5f, 384, 0.5f, 256.f)
+        {
+            // at the origin looking down +x with +z up
+            mCamera.setOrigin(LLVector3::zero);
+            mCamera.setAxes(LLVector3::x_axis, LLVector3::y_axis, LLVector3::z_axis);
+            mBuffer.resize(96, 64);
+            mBuffer.clear(mCamera);
+        }
+
+        // A square facing the camera at distance x, counter clockwise as seen
+        // from the origin unless flipped
+        void drawWall(F32 x, F32 half_size, bool flipped, bool cull_back_faces)
+        {
+            LLVector4a vertices[4] =
+            {
+                LLVector4a(x, half_size, -half_size),
+                LLVector4a(x, -half_size, -half_size),
+                LLVector4a(x, -half_size, half_size),
+                LLVector4a(x, half_size, half_size),
+            };
+            const U16 front[] = { 0, 1, 2, 0, 2, 3 };
+            const U16 back[] = { 0, 2, 1, 0, 3, 2 };
+            mBuffer.rasterizeTriangles(vertices, flipped ? back : front, 6, cull_back_faces);
+            mBuffer.buildHierarchy();
+        }
+
+        bool isOccluded(const LLVector3& center, F32 half_size)
+        {
+            LLVector4a bounds[2];
+            bounds[0].load3(center.mV);
+            bounds[1].splat(half_size);
+            return mBuffer.isOccluded(bounds);
+        }
+    };
+
+    typedef test_group<LLSoftwareDepthBufferData> factory;
+    typedef factory::object object;
+}
+
+namespace
+{
+    tut::factory llsoftwaredepthbuffer_test_factory("LLSoftwareDepthBuffer");
+}
+
+namespace tut
+{
+    // boxes behind a wall are hidden, beside or in front of it they are not
+    template<> template<>
+    void object::test<1>()
+    {
+        ensure("empty buffer hides nothing", !isOccluded(LLVector3(30.f, 0.f, 0.f), 1.f));
+
+        drawWall(10.f, 3.f, false, true);
+        ensure("wall drawn", mBuffer.getNumTriangles() == 2);
+        ensure("wall depth", fabsf(mBuffer.getDepth(48, 32) - 0.1f) < 0.001f);
+
+        ensure("behind the wall", isOccluded(LLVector3(30.f, 0.f, 0.f), 1.f));
+        ensure("far behind the wall", isOccluded(LLVector3(200.f, 5.f, -5.f), 10.f));
+        ensure("in front of the wall", !isOccluded(LLVector3(5.f, 0.f, 0.f), 0.5f));
+        ensure("through the wall", !isOccluded(LLVector3(10.f, 0.f, 0.f), 1.f));
+        ensure("beside the wall", !isOccluded(LLVector3(30.f, 12.f, 0.f), 1.f));
+        ensure("larger than the wall", !isOccluded(LLVector3(30.f, 0.f, 0.f), 12.f));
+        ensure("across the near plane", !isOccluded(LLVector3(0.f, 0.f, 0.f), 1.f));
+    }
+
+    // back faces only occlude when asked to
+    template<> template<>
+    void object::test<2>()
+    {
+        drawWall(10.f, 3.f, true, true);
+        ensure("back face culled", !isOccluded(LLVector3(30.f, 0.f, 0.f), 1.f));
+
+        drawWall(10.f, 3.f, true, false);
+        ensure("two sided", isOccluded(LLVector3(30.f, 0.f, 0.f), 1.f));
+    }
+
+    // occluders crossing the near plane are clipped, solid boxes occlude
+    template<> template<>
+    void object::test<3>()
+    {
+        LLVector4a floor[4] =
+        {
+            LLVector4a(-50.f, -50.f, -2.f),
+            LLVector4a(100.f, -50.f, -2.f),
+            LLVector4a(100.f, 50.f, -2.f),
+            LLVector4a(-50.f, 50.f, -2.f),
+        };
+        const U16 indices[] = { 0, 1, 2, 0, 2, 3 };
+        mBuffer.rasterizeTriangles(floor, indices, 6, true);
+
+        LLVector4a corners[8];
+        for (U32 i = 0; i < 8; ++i)
+        {
+            corners[i].set(i & 1 ? 22.f : 20.f, i & 2 ? 8.f : -8.f, i & 4 ? 8.f : -8.f);
+        }
+        mBuffer.rasterizeBox(corners);
+        mBuffer.buildHierarchy();
+
+        ensure("under the floor", isOccluded(LLVector3(20.f, 0.f, -6.f), 1.f));
+        ensure("above the floor", !isOccluded(LLVector3(60.f, 40.f, 5.f), 1.f));
+        ensure("behind the box", isOccluded(LLVector3(40.f, 0.f, 0.f), 2.f));
+        ensure("in front of the box", !isOccluded(LLVector3(15.f, 0.f, 0.f), 2.f));
+    }
+}
@@ -90,5 +90,8 @@ void set_group_of_patch_header(LLGroupHeader *gopp);
 void init_patch_decompressor(S32 size);
 void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph);
 void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph);
+// Vectorized separable transform by default, the scalar line and column
+// transforms otherwise
+void set_patch_idct_simd(bool enable);
 
 #endif
@@ -29,6 +29,7 @@
 #include "llmath.h"
 //#include "vmath.h"
 #include "v3math.h"
+#include "llvector4a.h"
 #include "patch_dct.h"
 
 LLGroupHeader   *gGOPP;
@@ -69,6 +70,30 @@ void setup_patch_icosines(S32 size)
     }
 }
 
+// Basis of the inverse transform as a matrix, gPatchICosines with the first
+// row scaled by 1/sqrt(2), so that a patch is C^T * X * C * 2/size.
+LL_ALIGN_16(F32 gPatchIDCTMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+
+void setup_patch_idct_matrix(S32 size)
+{
+    S32 n, u;
+    for (u = 0; u < size; u++)
+    {
+        F32 scale = u ? 1.f : OO_SQRT2;
+        for (n = 0; n < size; n++)
+        {
+            gPatchIDCTMatrix[u*size+n] = gPatchICosines[u*size+n]*scale;
+        }
+    }
+}
+
+bool gPatchIDCTSIMD = true;
+
+void set_patch_idct_simd(bool enable)
+{
+    gPatchIDCTSIMD = enable;
+}
+
 S32 gDeCopyMatrix[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
 
 void build_decopy_matrix(S32 size)
@@ -142,6 +167,7 @@ void init_patch_decompressor(S32 size)
         gCurrentDeSize = size;
         build_patch_dequantize_table(size);
         setup_patch_icosines(size);
+        setup_patch_idct_matrix(size);
         build_decopy_matrix(size);
     }
 }
@@ -586,13 +612,68 @@ inline void idct_patch_large(F32 *block)
     idct_line_large_slow(temp, block, 31);
 }
 
+// Both passes of the separable transform, four outputs at a time. Only the
+// first rows of the coefficients can be non-zero, the column pass skips the
+// rest.
+void idct_patch_simd(F32 *block, S32 size, S32 rows)
+{
+    LL_ALIGN_16(F32 temp[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    const F32 *cosines = gPatchIDCTMatrix;
+    S32 n, c, u, line;
+
+    // columns: temp[n][c] = sum over u of C[u][n]*block[u][c]
+    for (n = 0; n < size; n++)
+    {
+        for (c = 0; c < size; c += 4)
+        {
+            LLVector4a total;
+            total.clear();
+            for (u = 0; u < rows; u++)
+            {
+                LLVector4a coef;
+                coef.splat(cosines[u*size + n]);
+                LLVector4a in;
+                in.load4a(block + u*size + c);
+                in.mul(coef);
+                total.add(in);
+            }
+            total.store4a(temp + n*size + c);
+        }
+    }
+
+    // lines: block[line][n] = 2/size * sum over u of temp[line][u]*C[u][n]
+    LLVector4a scale;
+    scale.splat(2.f/size);
+    for (line = 0; line < size; line++)
+    {
+        const F32 *linein = temp + line*size;
+        for (n = 0; n < size; n += 4)
+        {
+            LLVector4a total;
+            total.clear();
+            for (u = 0; u < size; u++)
+            {
+                LLVector4a coef;
+                coef.splat(linein[u]);
+                LLVector4a basis;
+                basis.load4a(cosines + u*size + n);
+                basis.mul(coef);
+                total.add(basis);
+            }
+            total.mul(scale);
+            total.store4a(block + line*size + n);
+        }
+    }
+}
+
 S32 gDitherNoise = 128;
 
 void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
 {
     S32     i, j;
 
-    F32     block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
+    LL_ALIGN_16(F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    F32     *tblock = block;
     F32     *tpatch;
 
     LLGroupHeader   *gopp = gGOPP;
@@ -610,12 +691,22 @@ void decompress_patch(F32 *patch, S32 *cpatch, LLPatchHeader *ph)
     F32     mult = ooq*range;
     F32     addval = mult*(F32)(1<<(prequant - 1))+hmin;
 
+    S32     rows = 0;
     for (i = 0; i < size*size; i++)
     {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
+        S32 coef = *(cpatch + *(decopy_matrix++));
+        *(tblock++) = coef*(*dq++);
+        if (coef)
+        {
+            rows = i/size + 1;
+        }
     }
 
-    if (size == 16)
+    if (gPatchIDCTSIMD)
+    {
+        idct_patch_simd(block, size, rows);
+    }
+    else if (size == 16)
     {
         idct_patch(block);
     }
@@ -640,7 +731,8 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
 {
     S32     i, j;
 
-    F32         block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE], *tblock = block;
+    LL_ALIGN_16(F32 block[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE]);
+    F32         *tblock = block;
     LLVector3   *tvec;
 
     LLGroupHeader   *gopp = gGOPP;
@@ -661,12 +753,20 @@ void decompress_patchv(LLVector3 *v, S32 *cpatch, LLPatchHeader *ph)
 //  bool    b_diag = false;
 //  bool    b_right = true;
 
+    S32     rows = 0;
     for (i = 0; i < size*size; i++)
     {
-        *(tblock++) = *(cpatch + *(decopy_matrix++))*(*dq++);
+        S32 coef = *(cpatch + *(decopy_matrix++));
+        *(tblock++) = coef*(*dq++);
+        if (coef)
+        {
+            rows = i/size + 1;
+        }
     }
 
-    if (size == 16)
+    if (gPatchIDCTSIMD)
+        idct_patch_simd(block, size, rows);
+    else if (size == 16)
         idct_patch(block);
     else
         idct_patch_large(block);
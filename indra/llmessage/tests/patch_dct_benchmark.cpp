@@ -0,0 +1,78 @@
+/**
+ * @file   patch_dct_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times terrain patch decompression with the scalar and the
+ *         vectorized inverse DCT. Built when LL_BENCHMARKS is set, run by
+ *         hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+#include "lltimer.h"
+#include "v3math.h"
+
+#include "../patch_dct.h"
+
+#include <iostream>
+
+namespace
+{
+    F32             sPatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+    S32             sCompressed[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+    LLPatchHeader   sHeader;
+    LLGroupHeader   sGroupHeader;
+
+    // Rolling terrain compressed with the given patch size, ready to
+    // decompress.
+    void compress(S32 size)
+    {
+        for (S32 j = 0; j < size; j++)
+        {
+            for (S32 i = 0; i < size; i++)
+            {
+                sPatch[j*size + i] = 20.f + 5.f*sinf(i*0.3f) + 3.f*cosf(j*0.45f + i*0.1f);
+            }
+        }
+
+        init_patch_compressor(size, size, 0);
+        F32 zmax, zmin;
+        prescan_patch(sPatch, &sHeader, zmax, zmin);
+        compress_patch(sPatch, sCompressed, &sHeader, 10);
+
+        get_patch_group_header(&sGroupHeader);
+        set_group_of_patch_header(&sGroupHeader);
+        init_patch_decompressor(size);
+    }
+
+    F64 time_decompress(S32 count)
+    {
+        F32 out[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        LLTimer timer;
+        for (S32 i = 0; i < count; i++)
+        {
+            decompress_patch(out, sCompressed, &sHeader);
+        }
+        return timer.getElapsedTimeF64();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const S32 COUNT = 10000;
+    for (S32 size : { (S32)NORMAL_PATCH_SIZE, (S32)LARGE_PATCH_SIZE })
+    {
+        compress(size);
+        set_patch_idct_simd(false);
+        F64 scalar_seconds = time_decompress(COUNT);
+        set_patch_idct_simd(true);
+        F64 simd_seconds = time_decompress(COUNT);
+
+        std::cout << COUNT << " patches of " << size << "x" << size << ": scalar "
+                  << scalar_seconds << "s, vectorized " << simd_seconds << "s" << std::endl;
+    }
+    return 0;
+}
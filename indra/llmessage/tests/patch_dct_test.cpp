@@ -0,0 +1,104 @@
+/**
+ * @file patch_dct_test.cpp
+ * @brief Terrain patch compression round trip and IDCT throughput.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmath.h"
+#include "v3math.h"
+
+#include "../patch_dct.h"
+
+#include "../test/lltut.h"
+
+namespace tut
+{
+    struct patch_dct
+    {
+        F32             mPatch[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        S32             mCompressed[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+        LLPatchHeader   mHeader;
+        LLGroupHeader   mGroupHeader;
+
+        // Rolling terrain compressed with the given patch size, ready to
+        // decompress.
+        void compress(S32 size)
+        {
+            for (S32 j = 0; j < size; j++)
+            {
+                for (S32 i = 0; i < size; i++)
+                {
+                    mPatch[j*size + i] = 20.f + 5.f*sinf(i*0.3f) + 3.f*cosf(j*0.45f + i*0.1f);
+                }
+            }
+
+            init_patch_compressor(size, size, 0);
+            F32 zmax, zmin;
+            prescan_patch(mPatch, &mHeader, zmax, zmin);
+            compress_patch(mPatch, mCompressed, &mHeader, 10);
+
+            get_patch_group_header(&mGroupHeader);
+            set_group_of_patch_header(&mGroupHeader);
+            init_patch_decompressor(size);
+        }
+
+        void ensure_round_trip(S32 size)
+        {
+            compress(size);
+
+            F32 scalar[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+            F32 simd[LARGE_PATCH_SIZE*LARGE_PATCH_SIZE];
+            set_patch_idct_simd(false);
+            decompress_patch(scalar, mCompressed, &mHeader);
+            set_patch_idct_simd(true);
+            decompress_patch(simd, mCompressed, &mHeader);
+
+            for (S32 i = 0; i < size*size; i++)
+            {
+                // quantization error stays well below a tenth of a meter per meter of range
+                ensure_approximately_equals_range("decompressed height", simd[i], mPatch[i], mHeader.range*0.05f);
+                // the SIMD transform does the same float operations in the same order
+                ensure_equals("same as scalar transform", simd[i], scalar[i]);
+            }
+        }
+    };
+
+    typedef test_group<patch_dct> patch_dct_t;
+    typedef patch_dct_t::object patch_dct_object_t;
+    tut::patch_dct_t tut_patch_dct("patch_dct");
+
+    // round trip of a normal patch
+    template<> template<>
+    void patch_dct_object_t::test<1>()
+    {
+        ensure_round_trip(NORMAL_PATCH_SIZE);
+    }
+
+    // round trip of a large patch
+    template<> template<>
+    void patch_dct_object_t::test<2>()
+    {
+        ensure_round_trip(LARGE_PATCH_SIZE);
+    }
+}
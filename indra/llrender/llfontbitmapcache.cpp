@@ -46,6 +46,12 @@ void LLFontBitmapCache::init(S32 max_char_width,
     mMaxCharWidth = max_char_width;
     mMaxCharHeight = max_char_height;
 
+    mBitmapWidth = getImageSize();
+    mBitmapHeight = mBitmapWidth;
+}
+
+S32 LLFontBitmapCache::getImageSize() const
+{
     S32 image_width = mMaxCharWidth * 20;
     S32 pow_iw = 2;
     while (pow_iw < image_width)
@@ -53,10 +59,7 @@ void LLFontBitmapCache::init(S32 max_char_width,
         pow_iw <<= 1;
     }
     image_width = pow_iw;
-    image_width = llmin(512, image_width); // Don't make bigger than 512x512, ever.
-
-    mBitmapWidth = image_width;
-    mBitmapHeight = image_width;
+    return llmin(512, image_width); // Don't make bigger than 512x512, ever.
 }
 
 LLImageRaw *LLFontBitmapCache::getImageRaw(EFontGlyphType bitmap_type, U32 bitmap_num) const
@@ -93,40 +96,14 @@ bool LLFontBitmapCache::nextOpenPos(S32 width, S32& pos_x, S32& pos_y, EFontGlyp
             // We're out of space in the current image, or no image
             // has been allocated yet.  Make a new one.
 
-            S32 image_width = mMaxCharWidth * 20;
-            S32 pow_iw = 2;
-            while (pow_iw < image_width)
-            {
-                pow_iw *= 2;
-            }
-            image_width = pow_iw;
-            image_width = llmin(512, image_width); // Don't make bigger than 512x512, ever.
-            S32 image_height = image_width;
-
-            mBitmapWidth = image_width;
-            mBitmapHeight = image_height;
-
+            S32 image_size = getImageSize();
             S32 num_components = getNumComponents(bitmap_type);
-            mImageRawVec[bitmap_idx].push_back(new LLImageRaw(mBitmapWidth, mBitmapHeight, num_components));
-            bitmap_num = static_cast<U32>(mImageRawVec[bitmap_idx].size()) - 1;
-
-            LLImageRaw* image_raw = getImageRaw(bitmap_type, bitmap_num);
+            LLPointer<LLImageRaw> image_raw = new LLImageRaw(image_size, image_size, num_components);
             if (EFontGlyphType::Grayscale == bitmap_type)
             {
                 image_raw->clear(255, 0);
             }
-
-            // Make corresponding GL image.
-            mImageGLVec[bitmap_idx].push_back(new LLImageGL(image_raw, false, false));
-            LLImageGL* image_gl = getImageGL(bitmap_type, bitmap_num);
-
-            // Start at beginning of the new image.
-            mCurrentOffsetX[bitmap_idx] = 1;
-            mCurrentOffsetY[bitmap_idx] = 1;
-
-            // Attach corresponding GL texture. (*TODO: is this needed?)
-            gGL.getTexUnit(0)->bind(image_gl);
-            image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(true, true);
+            addBitmap(bitmap_type, image_raw);
         }
         else
         {
@@ -145,6 +122,56 @@ bool LLFontBitmapCache::nextOpenPos(S32 width, S32& pos_x, S32& pos_y, EFontGlyp
     return true;
 }
 
+bool LLFontBitmapCache::addBitmap(EFontGlyphType bitmap_type, LLImageRaw* image_raw)
+{
+    if (bitmap_type >= EFontGlyphType::Count)
+    {
+        return false;
+    }
+
+    S32 image_size = getImageSize();
+    if (image_raw->getWidth() != image_size || image_raw->getHeight() != image_size
+        || image_raw->getComponents() != getNumComponents(bitmap_type))
+    {
+        return false;
+    }
+
+    mBitmapWidth = image_size;
+    mBitmapHeight = image_size;
+
+    const U32 bitmap_idx = static_cast<U32>(bitmap_type);
+    mImageRawVec[bitmap_idx].push_back(image_raw);
+
+    // Make corresponding GL image.
+    LLImageGL* image_gl = new LLImageGL(image_raw, false, false);
+    mImageGLVec[bitmap_idx].push_back(image_gl);
+
+    // Start at beginning of the new image.
+    mCurrentOffsetX[bitmap_idx] = 1;
+    mCurrentOffsetY[bitmap_idx] = 1;
+
+    // Attach corresponding GL texture. (*TODO: is this needed?)
+    gGL.getTexUnit(0)->bind(image_gl);
+    image_gl->setFilteringOption(LLTexUnit::TFO_POINT); // was setMipFilterNearest(true, true);
+    return true;
+}
+
+void LLFontBitmapCache::getOpenPos(EFontGlyphType bitmap_type, S32& pos_x, S32& pos_y) const
+{
+    const U32 bitmap_idx = static_cast<U32>(bitmap_type);
+    llassert(bitmap_type < EFontGlyphType::Count);
+    pos_x = mCurrentOffsetX[bitmap_idx];
+    pos_y = mCurrentOffsetY[bitmap_idx];
+}
+
+void LLFontBitmapCache::setOpenPos(EFontGlyphType bitmap_type, S32 pos_x, S32 pos_y)
+{
+    const U32 bitmap_idx = static_cast<U32>(bitmap_type);
+    llassert(bitmap_type < EFontGlyphType::Count);
+    mCurrentOffsetX[bitmap_idx] = pos_x;
+    mCurrentOffsetY[bitmap_idx] = pos_y;
+}
+
 void LLFontBitmapCache::destroyGL()
 {
     for (U32 idx = 0, cnt = static_cast<U32>(EFontGlyphType::Count); idx < cnt; idx++)
@@ -54,6 +54,12 @@ public:
 
     bool nextOpenPos(S32 width, S32& posX, S32& posY, EFontGlyphType bitmapType, U32& bitmapNum);
 
+    // Restoring a saved atlas: appends an already filled bitmap, then packing
+    // carries on from the saved open position.
+    bool addBitmap(EFontGlyphType bitmapType, LLImageRaw* image_raw);
+    void getOpenPos(EFontGlyphType bitmapType, S32& posX, S32& posY) const;
+    void setOpenPos(EFontGlyphType bitmapType, S32 posX, S32 posY);
+
     void destroyGL();
 
     LLImageRaw* getImageRaw(EFontGlyphType bitmapType, U32 bitmapNum) const;
@@ -64,9 +70,11 @@ public:
     S32 getBitmapWidth() const { return mBitmapWidth; }
     S32 getBitmapHeight() const { return mBitmapHeight; }
 
-protected:
     static U32 getNumComponents(EFontGlyphType bitmap_type);
 
+protected:
+    S32 getImageSize() const;
+
 private:
     S32 mBitmapWidth = 0;
     S32 mBitmapHeight = 0;
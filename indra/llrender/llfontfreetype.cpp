@@ -53,6 +53,9 @@
 #include "llgl.h"
 
 #include "llapr.h"
+#include "hbxxh.h"
+#include "llfile.h"
+#include "workqueue.h"
 
 #define ENABLE_OT_SVG_SUPPORT
 
@@ -62,6 +65,91 @@ LLFontManager *gFontManagerp = NULL;
 
 FT_Library gFTLibrary = NULL;
 
+std::string LLFontFreetype::sGlyphCacheDir;
+std::vector<std::pair<llwchar, llwchar> > LLFontFreetype::sPrefetchRanges;
+
+// What a glyph rendered by FreeType looks like before it goes into the atlas
+struct LLFontGlyphBitmap
+{
+    U32             mGlyphIndex = 0;
+    EFontGlyphType  mType = EFontGlyphType::Grayscale; // one byte per pixel, or BGRA for Color
+    S32             mWidth = 0;
+    S32             mHeight = 0;
+    S32             mPitch = 0;
+    S32             mLeft = 0;
+    S32             mTop = 0;
+    F32             mXAdvance = 0.f;
+    F32             mYAdvance = 0.f;
+    const U8*       mData = nullptr;
+};
+
+// A glyph rendered by a prefetch worker, owning its pixels
+struct LLFontPrefetchedGlyph
+{
+    llwchar             mChar = 0;
+    LLFontGlyphBitmap   mBitmap;
+    std::vector<U8>     mPixels;
+};
+
+namespace
+{
+    // Describes the bitmap FreeType left in slot. 1-bit bitmaps are expanded
+    // into gray_data.
+    void get_slot_bitmap(FT_GlyphSlot slot, U32 glyph_index, LLFontGlyphBitmap& bitmap, std::vector<U8>& gray_data)
+    {
+        bitmap.mGlyphIndex = glyph_index;
+        bitmap.mWidth = slot->bitmap.width;
+        bitmap.mHeight = slot->bitmap.rows;
+        bitmap.mLeft = slot->bitmap_left;
+        bitmap.mTop = slot->bitmap_top;
+        // Convert these from 26.6 units to float pixels.
+        bitmap.mXAdvance = slot->advance.x / 64.f;
+        bitmap.mYAdvance = slot->advance.y / 64.f;
+        bitmap.mData = slot->bitmap.buffer;
+        bitmap.mPitch = slot->bitmap.pitch;
+
+        switch (slot->bitmap.pixel_mode)
+        {
+            case FT_PIXEL_MODE_MONO:
+            {
+                // need to expand 1-bit bitmap to 8-bit graymap.
+                gray_data.resize(bitmap.mWidth * bitmap.mHeight);
+                for (S32 ypos = 0; ypos < bitmap.mHeight; ++ypos)
+                {
+                    S32 bm_row_offset = slot->bitmap.pitch * ypos;
+                    for (S32 xpos = 0; xpos < bitmap.mWidth; ++xpos)
+                    {
+                        U32 bm_col_offsetbyte = xpos / 8;
+                        U32 bm_col_offsetbit = 7 - (xpos % 8);
+                        U32 bit = !!(slot->bitmap.buffer[bm_row_offset + bm_col_offsetbyte] & (1 << bm_col_offsetbit));
+                        gray_data[bitmap.mWidth * ypos + xpos] = 255 * bit;
+                    }
+                }
+                // use newly-built graymap.
+                bitmap.mType = EFontGlyphType::Grayscale;
+                bitmap.mData = gray_data.data();
+                bitmap.mPitch = bitmap.mWidth;
+                break;
+            }
+            case FT_PIXEL_MODE_GRAY:
+                bitmap.mType = EFontGlyphType::Grayscale;
+                break;
+            case FT_PIXEL_MODE_BGRA:
+                bitmap.mType = EFontGlyphType::Color;
+                bitmap.mPitch = llabs(slot->bitmap.pitch);
+                break;
+            default:
+                llassert(false);
+                // keep an empty glyph rather than misread the bitmap
+                bitmap.mType = EFontGlyphType::Grayscale;
+                bitmap.mWidth = 0;
+                bitmap.mHeight = 0;
+                bitmap.mData = nullptr;
+                break;
+        }
+    }
+}
+
 //static
 void LLFontManager::initClass()
 {
@@ -151,8 +239,15 @@ LLFontFreetype::LLFontFreetype()
     mRenderGlyphCount(0),
     mAddGlyphCount(0),
     mStyle(0),
-    mPointSize(0)
+    mPointSize(0),
+    mVertDPI(0.f),
+    mHorzDPI(0.f),
+    mFaceIndex(0),
+    mSavedGlyphCount(0),
+    mGeneration(0)
 {
+    mPrefetchToken = std::make_shared<const LLFontFreetype*>(this);
+
     // <FS:ND> Set up kerning cache, size is 256x256, the initial cache lines are all null
     mKerningCache = new F32*[ 256 ];
 
@@ -302,6 +397,9 @@ bool LLFontFreetype::loadFace(const std::string& filename, F32 point_size, F32 v
 
     mName = filename;
     mPointSize = point_size;
+    mVertDPI = vert_dpi;
+    mHorzDPI = horz_dpi;
+    mFaceIndex = face_n;
 
     mStyle = LLFontGL::NORMAL;
     if(mFTFace->style_flags & FT_STYLE_FLAG_BOLD)
@@ -544,19 +642,10 @@ bool LLFontFreetype::hasGlyph(llwchar wch) const
     return(mCharGlyphInfoMap.find(wch) != mCharGlyphInfoMap.end());
 }
 
-LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type) const
+const LLFontFreetype* LLFontFreetype::findGlyphFont(llwchar wch, U32& glyph_index) const
 {
-    if (!mFTFace)
-    {
-        return NULL;
-    }
-
-    llassert(!mIsFallback);
-    llassert(glyph_type < EFontGlyphType::Count);
-    //LL_DEBUGS() << "Adding new glyph for " << wch << " to font" << LL_ENDL;
-
     // Initialize char to glyph map
-    FT_UInt glyph_index = FT_Get_Char_Index(mFTFace, wch);
+    glyph_index = FT_Get_Char_Index(mFTFace, wch);
     if (glyph_index == 0)
     {
         // No corresponding glyph in this font: look for a glyph in fallback
@@ -582,8 +671,7 @@ LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type
                 glyph_index = FT_Get_Char_Index(pair.first->mFTFace, wch);
                 if (glyph_index)
                 {
-                    return addGlyphFromFont(pair.first, wch, glyph_index,
-                                            glyph_type);
+                    return pair.first;
                 }
             }
         }
@@ -607,8 +695,7 @@ LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type
             glyph_index = FT_Get_Char_Index(pair.first->mFTFace, wch);
             if (glyph_index)
             {
-                return addGlyphFromFont(pair.first, wch, glyph_index,
-                                        glyph_type);
+                return pair.first;
             }
         }
         // Everything failed so far: this character is not a genuine emoji,
@@ -622,12 +709,33 @@ LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type
             glyph_index = FT_Get_Char_Index(pair.first->mFTFace, wch);
             if (glyph_index)
             {
-                return addGlyphFromFont(pair.first, wch, glyph_index,
-                                        glyph_type);
+                return pair.first;
             }
         }
     }
 
+    // Not found anywhere: this font renders its default glyph
+    return this;
+}
+
+LLFontGlyphInfo* LLFontFreetype::addGlyph(llwchar wch, EFontGlyphType glyph_type) const
+{
+    if (!mFTFace)
+    {
+        return NULL;
+    }
+
+    llassert(!mIsFallback);
+    llassert(glyph_type < EFontGlyphType::Count);
+    //LL_DEBUGS() << "Adding new glyph for " << wch << " to font" << LL_ENDL;
+
+    U32 glyph_index = 0;
+    const LLFontFreetype* fontp = findGlyphFont(wch, glyph_index);
+    if (fontp != this)
+    {
+        return addGlyphFromFont(fontp, wch, glyph_index, glyph_type);
+    }
+
     auto range_it = mCharGlyphInfoMap.equal_range(wch);
     char_glyph_info_map_t::iterator iter =
         std::find_if(range_it.first, range_it.second,
@@ -651,113 +759,77 @@ LLFontGlyphInfo* LLFontFreetype::addGlyphFromFont(const LLFontFreetype *fontp, l
     llassert(!mIsFallback);
     fontp->renderGlyph(requested_glyph_type, glyph_index);
 
-    EFontGlyphType bitmap_glyph_type = EFontGlyphType::Unspecified;
-    switch (fontp->mFTFace->glyph->bitmap.pixel_mode)
-    {
-        case FT_PIXEL_MODE_MONO:
-        case FT_PIXEL_MODE_GRAY:
-            bitmap_glyph_type = EFontGlyphType::Grayscale;
-            break;
-        case FT_PIXEL_MODE_BGRA:
-            bitmap_glyph_type = EFontGlyphType::Color;
-            break;
-        default:
-            llassert_always(true);
-            break;
-    }
-    S32 width = fontp->mFTFace->glyph->bitmap.width;
-    S32 height = fontp->mFTFace->glyph->bitmap.rows;
+    LLFontGlyphBitmap bitmap;
+    std::vector<U8> gray_data;
+    get_slot_bitmap(fontp->mFTFace->glyph, glyph_index, bitmap, gray_data);
+
+    LLFontGlyphInfo* gi = insertGlyphBitmap(wch, requested_glyph_type, bitmap);
+    uploadBitmap(gi->mBitmapEntry.first, gi->mBitmapEntry.second);
 
+    return gi;
+}
+
+LLFontGlyphInfo* LLFontFreetype::insertGlyphBitmap(llwchar wch, EFontGlyphType requested_glyph_type, const LLFontGlyphBitmap& bitmap) const
+{
     S32 pos_x, pos_y;
     U32 bitmap_num;
-    mFontBitmapCachep->nextOpenPos(width, pos_x, pos_y, bitmap_glyph_type, bitmap_num);
+    mFontBitmapCachep->nextOpenPos(bitmap.mWidth, pos_x, pos_y, bitmap.mType, bitmap_num);
     mAddGlyphCount++;
 
-    LLFontGlyphInfo* gi = new LLFontGlyphInfo(glyph_index, requested_glyph_type);
+    LLFontGlyphInfo* gi = new LLFontGlyphInfo(bitmap.mGlyphIndex, requested_glyph_type);
     gi->mXBitmapOffset = pos_x;
     gi->mYBitmapOffset = pos_y;
-    gi->mBitmapEntry = std::make_pair(bitmap_glyph_type, bitmap_num);
-    gi->mWidth = width;
-    gi->mHeight = height;
-    gi->mXBearing = fontp->mFTFace->glyph->bitmap_left;
-    gi->mYBearing = fontp->mFTFace->glyph->bitmap_top;
-    // Convert these from 26.6 units to float pixels.
-    gi->mXAdvance = fontp->mFTFace->glyph->advance.x / 64.f;
-    gi->mYAdvance = fontp->mFTFace->glyph->advance.y / 64.f;
+    gi->mBitmapEntry = std::make_pair(bitmap.mType, bitmap_num);
+    gi->mWidth = bitmap.mWidth;
+    gi->mHeight = bitmap.mHeight;
+    gi->mXBearing = bitmap.mLeft;
+    gi->mYBearing = bitmap.mTop;
+    gi->mXAdvance = bitmap.mXAdvance;
+    gi->mYAdvance = bitmap.mYAdvance;
 
     insertGlyphInfo(wch, gi);
 
-    if (requested_glyph_type != bitmap_glyph_type)
+    if (requested_glyph_type != bitmap.mType)
     {
         LLFontGlyphInfo* gi_temp = new LLFontGlyphInfo(*gi);
-        gi_temp->mGlyphType = bitmap_glyph_type;
+        gi_temp->mGlyphType = bitmap.mType;
         insertGlyphInfo(wch, gi_temp);
     }
 
-    if (fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_MONO
-        || fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY)
+    if (EFontGlyphType::Grayscale == bitmap.mType)
     {
-        U8 *buffer_data = fontp->mFTFace->glyph->bitmap.buffer;
-        S32 buffer_row_stride = fontp->mFTFace->glyph->bitmap.pitch;
-        U8 *tmp_graydata = NULL;
-
-        if (fontp->mFTFace->glyph->bitmap.pixel_mode
-            == FT_PIXEL_MODE_MONO)
-        {
-            // need to expand 1-bit bitmap to 8-bit graymap.
-            tmp_graydata = new U8[width * height];
-            S32 xpos, ypos;
-            for (ypos = 0; ypos < height; ++ypos)
-            {
-                S32 bm_row_offset = buffer_row_stride * ypos;
-                for (xpos = 0; xpos < width; ++xpos)
-                {
-                    U32 bm_col_offsetbyte = xpos / 8;
-                    U32 bm_col_offsetbit = 7 - (xpos % 8);
-                    U32 bit =
-                    !!(buffer_data[bm_row_offset
-                               + bm_col_offsetbyte
-                       ] & (1 << bm_col_offsetbit) );
-                    tmp_graydata[width*ypos + xpos] =
-                        255 * bit;
-                }
-            }
-            // use newly-built graymap.
-            buffer_data = tmp_graydata;
-            buffer_row_stride = width;
-        }
-
         setSubImageLuminanceAlpha(pos_x,
                                     pos_y,
                                     bitmap_num,
-                                    width,
-                                    height,
-                                    buffer_data,
-                                    buffer_row_stride);
-
-        if (tmp_graydata)
-            delete[] tmp_graydata;
+                                    bitmap.mWidth,
+                                    bitmap.mHeight,
+                                    bitmap.mData,
+                                    bitmap.mPitch);
     }
-    else if (fontp->mFTFace->glyph->bitmap.pixel_mode == FT_PIXEL_MODE_BGRA)
+    else
     {
         setSubImageBGRA(pos_x,
                         pos_y,
                         bitmap_num,
-                        fontp->mFTFace->glyph->bitmap.width,
-                        fontp->mFTFace->glyph->bitmap.rows,
-                        fontp->mFTFace->glyph->bitmap.buffer,
-                        llabs(fontp->mFTFace->glyph->bitmap.pitch));
-    } else {
-        llassert(false);
+                        bitmap.mWidth,
+                        bitmap.mHeight,
+                        bitmap.mData,
+                        bitmap.mPitch);
     }
 
-    LLImageGL *image_gl = mFontBitmapCachep->getImageGL(bitmap_glyph_type, bitmap_num);
-    LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(bitmap_glyph_type, bitmap_num);
-    image_gl->setSubImage(image_raw, 0, 0, image_gl->getWidth(), image_gl->getHeight());
-
     return gi;
 }
 
+void LLFontFreetype::uploadBitmap(EFontGlyphType bitmap_type, U32 bitmap_num) const
+{
+    LLImageGL *image_gl = mFontBitmapCachep->getImageGL(bitmap_type, bitmap_num);
+    LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(bitmap_type, bitmap_num);
+    if (image_gl && image_raw)
+    {
+        image_gl->setSubImage(image_raw, 0, 0, image_gl->getWidth(), image_gl->getHeight());
+    }
+}
+
 LLFontGlyphInfo* LLFontFreetype::getGlyphInfo(llwchar wch, EFontGlyphType glyph_type) const
 {
     std::pair<char_glyph_info_map_t::iterator, char_glyph_info_map_t::iterator> range_it = mCharGlyphInfoMap.equal_range(wch);
@@ -833,6 +905,7 @@ void LLFontFreetype::renderGlyph(EFontGlyphType bitmap_type, U32 glyph_index) co
 
 void LLFontFreetype::reset(F32 vert_dpi, F32 horz_dpi)
 {
+    saveGlyphCache();
     resetBitmapCache();
     loadFace(mName, mPointSize, vert_dpi ,horz_dpi, mIsFallback, 0);
     if (!mIsFallback)
@@ -849,6 +922,10 @@ void LLFontFreetype::reset(F32 vert_dpi, F32 horz_dpi)
                 it->first->reset(vert_dpi, horz_dpi);
             }
         }
+
+        // the fallbacks are back in shape, so the key of the atlas is known
+        loadGlyphCache();
+        prefetchGlyphs();
     }
 }
 
@@ -862,6 +939,8 @@ void LLFontFreetype::resetBitmapCache()
     }
     mCharGlyphInfoMap.clear();
     mFontBitmapCachep->reset();
+    mSavedGlyphCount = 0;
+    ++mGeneration;
 
     // Adding default glyph is skipped for fallback fonts here as well as in loadFace().
     // This if was added as fix for EXT-4971.
@@ -954,7 +1033,7 @@ bool LLFontFreetype::setSubImageBGRA(U32 x, U32 y, U32 bitmap_num, U16 width, U1
     return true;
 }
 
-void LLFontFreetype::setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, U8 *data, S32 stride) const
+void LLFontFreetype::setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, const U8 *data, S32 stride) const
 {
     LLImageRaw *image_raw = mFontBitmapCachep->getImageRaw(EFontGlyphType::Grayscale, bitmap_num);
     LLImageDataLock lock(image_raw);
@@ -1005,12 +1084,15 @@ namespace nd
                 mName = aName;
                 mSize = aSize;
                 mRefs = 1;
+                mHash = 0;
             }
 
             std::string mName;
             std::vector<U8> mAddress;
             long mSize;
             U32  mRefs;
+            U64  mHash; // of the file contents, 0 until asked for
+
         };
     }
 }
@@ -1053,3 +1135,547 @@ void LLFontManager::unloadAllFonts()
 }
 // </FS:ND>
 
+
+std::shared_ptr<nd::fonts::LoadedFont> LLFontManager::getLoadedFont(const std::string& filename) const
+{
+    auto itr = m_LoadedFonts.find(filename);
+    return itr != m_LoadedFonts.end() ? itr->second : nullptr;
+}
+
+U64 LLFontManager::getFontHash(const std::string& filename) const
+{
+    auto itr = m_LoadedFonts.find(filename);
+    if (itr == m_LoadedFonts.end())
+    {
+        return 0;
+    }
+    nd::fonts::LoadedFont& font = *itr->second;
+    if (!font.mHash)
+    {
+        font.mHash = HBXXH64::digest(font.mAddress.data(), font.mSize);
+    }
+    return font.mHash;
+}
+
+//-----------------------------------------------------------------------------
+// Glyph atlas cache and prefetching
+//-----------------------------------------------------------------------------
+
+namespace
+{
+    const U32 GLYPH_CACHE_MAGIC = 0x4c4c4743; // "LLGC"
+    const U32 GLYPH_CACHE_VERSION = 1;
+    const U32 NUM_BITMAP_TYPES = static_cast<U32>(EFontGlyphType::Count);
+    // Sanity limit on what a cache file may claim to hold
+    const U32 MAX_CACHED_BITMAPS = 64;
+
+    struct GlyphCacheHeader
+    {
+        U32 mMagic;
+        U32 mVersion;
+        U64 mKey;
+        S32 mBitmapSize;
+        U32 mNumGlyphs;
+        U32 mNumBitmaps[NUM_BITMAP_TYPES];
+        S32 mOpenX[NUM_BITMAP_TYPES];
+        S32 mOpenY[NUM_BITMAP_TYPES];
+    };
+
+    struct GlyphCacheRecord
+    {
+        U32 mChar;
+        U32 mGlyphIndex;
+        U32 mGlyphType;
+        U32 mBitmapType;
+        S32 mBitmapNum;
+        S32 mWidth;
+        S32 mHeight;
+        S32 mXBitmapOffset;
+        S32 mYBitmapOffset;
+        S32 mXBearing;
+        S32 mYBearing;
+        F32 mXAdvance;
+        F32 mYAdvance;
+    };
+
+    template<typename T>
+    void append_value(std::vector<U8>& buffer, const T& value)
+    {
+        const U8* data = reinterpret_cast<const U8*>(&value);
+        buffer.insert(buffer.end(), data, data + sizeof(T));
+    }
+
+    std::string get_glyph_cache_filename(const std::string& dir, U64 key)
+    {
+        return gDirUtilp->add(dir, llformat("%016llx.glyphs", (unsigned long long)key));
+    }
+
+    bool read_file(const std::string& filename, std::vector<U8>& buffer)
+    {
+        LLFILE* fp = LLFile::fopen(filename, "rb");
+        if (!fp)
+        {
+            return false;
+        }
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        bool success = size > 0;
+        if (success)
+        {
+            buffer.resize(size);
+            success = fread(buffer.data(), 1, size, fp) == (size_t)size;
+        }
+        fclose(fp);
+        return success;
+    }
+
+    struct GlyphPrefetchFace
+    {
+        std::shared_ptr<nd::fonts::LoadedFont> mFont;
+        S32 mFaceIndex;
+        F32 mPointSize;
+        F32 mVertDPI;
+        F32 mHorzDPI;
+    };
+
+    struct GlyphPrefetchRequest
+    {
+        llwchar mChar;
+        U32 mFace;          // in the face list sent along
+        U32 mGlyphIndex;
+    };
+
+    // Runs on the "General" thread pool. FreeType objects must stay on one
+    // thread, so this opens a library and faces of its own on the font data
+    // the main thread loaded. Whatever fails here is simply rendered on
+    // demand later.
+    std::vector<LLFontPrefetchedGlyph> render_prefetched_glyphs(const std::vector<GlyphPrefetchFace>& faces,
+                                                                const std::vector<GlyphPrefetchRequest>& requests)
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        std::vector<LLFontPrefetchedGlyph> glyphs;
+
+        FT_Library library = NULL;
+        if (FT_Init_FreeType(&library) != FT_Err_Ok)
+        {
+            return glyphs;
+        }
+
+        std::vector<FT_Face> ft_faces(faces.size(), (FT_Face)NULL);
+        for (size_t i = 0; i < faces.size(); ++i)
+        {
+            const GlyphPrefetchFace& face = faces[i];
+            if (!face.mFont)
+            {
+                continue;
+            }
+
+            FT_Open_Args open_args;
+            memset(&open_args, 0, sizeof(open_args));
+            open_args.flags = FT_OPEN_MEMORY;
+            open_args.memory_base = face.mFont->mAddress.data();
+            open_args.memory_size = face.mFont->mSize;
+            if (FT_Open_Face(library, &open_args, face.mFaceIndex, &ft_faces[i]) != FT_Err_Ok)
+            {
+                ft_faces[i] = NULL;
+                continue;
+            }
+            if (FT_Set_Char_Size(ft_faces[i], 0, (S32)(face.mPointSize * 64), (U32)face.mHorzDPI, (U32)face.mVertDPI) != FT_Err_Ok)
+            {
+                FT_Done_Face(ft_faces[i]);
+                ft_faces[i] = NULL;
+            }
+        }
+
+        glyphs.reserve(requests.size());
+        std::vector<U8> gray_data;
+        for (const GlyphPrefetchRequest& request : requests)
+        {
+            FT_Face ft_face = ft_faces[request.mFace];
+            if (!ft_face
+                || FT_Load_Glyph(ft_face, request.mGlyphIndex, FT_LOAD_FORCE_AUTOHINT) != FT_Err_Ok
+                || FT_Render_Glyph(ft_face->glyph, gFontRenderMode) != FT_Err_Ok)
+            {
+                continue;
+            }
+
+            glyphs.emplace_back();
+            LLFontPrefetchedGlyph& glyph = glyphs.back();
+            glyph.mChar = request.mChar;
+            get_slot_bitmap(ft_face->glyph, request.mGlyphIndex, glyph.mBitmap, gray_data);
+
+            // copy the rows out of FreeType's buffer, tightly packed
+            const S32 row_bytes = glyph.mBitmap.mWidth * (EFontGlyphType::Color == glyph.mBitmap.mType ? 4 : 1);
+            glyph.mPixels.resize(row_bytes * glyph.mBitmap.mHeight);
+            if (glyph.mBitmap.mData)
+            {
+                for (S32 row = 0; row < glyph.mBitmap.mHeight; ++row)
+                {
+                    memcpy(glyph.mPixels.data() + row * row_bytes, glyph.mBitmap.mData + row * glyph.mBitmap.mPitch, row_bytes);
+                }
+            }
+            glyph.mBitmap.mPitch = row_bytes;
+            // pointed at mPixels once the glyph stops moving around
+            glyph.mBitmap.mData = nullptr;
+        }
+
+        for (FT_Face ft_face : ft_faces)
+        {
+            if (ft_face)
+            {
+                FT_Done_Face(ft_face);
+            }
+        }
+        FT_Done_FreeType(library);
+
+        return glyphs;
+    }
+}
+
+//static
+void LLFontFreetype::setGlyphCacheDir(const std::string& dir)
+{
+    sGlyphCacheDir = dir;
+}
+
+//static
+void LLFontFreetype::setPrefetchRanges(const std::string& ranges)
+{
+    sPrefetchRanges.clear();
+
+    std::vector<std::string> tokens;
+    LLStringUtil::getTokens(ranges, tokens, ", ");
+    for (const std::string& token : tokens)
+    {
+        unsigned int first = 0, last = 0;
+        S32 count = sscanf(token.c_str(), "%x-%x", &first, &last);
+        if (count == 1)
+        {
+            last = first;
+        }
+        if (count < 1 || first > last || last > 0x10FFFF)
+        {
+            LL_WARNS("Font") << "Ignoring glyph prefetch range " << token << LL_ENDL;
+            continue;
+        }
+        sPrefetchRanges.emplace_back((llwchar)first, (llwchar)last);
+    }
+}
+
+U64 LLFontFreetype::getGlyphCacheKey() const
+{
+    HBXXH64 hash;
+    auto add_font = [&hash](const LLFontFreetype* fontp)
+    {
+        U64 file_hash = gFontManagerp->getFontHash(fontp->mName);
+        hash.update(&file_hash, sizeof(file_hash));
+        hash.update(&fontp->mFaceIndex, sizeof(fontp->mFaceIndex));
+        hash.update(&fontp->mPointSize, sizeof(fontp->mPointSize));
+        hash.update(&fontp->mVertDPI, sizeof(fontp->mVertDPI));
+        hash.update(&fontp->mHorzDPI, sizeof(fontp->mHorzDPI));
+    };
+
+    add_font(this);
+    for (const fallback_font_t& fallback : mFallbackFonts)
+    {
+        add_font(fallback.first);
+        const U8 has_functor = fallback.second ? 1 : 0;
+        hash.update(&has_functor, sizeof(has_functor));
+    }
+    hash.update(&gFontRenderMode, sizeof(gFontRenderMode));
+    return hash.digest();
+}
+
+bool LLFontFreetype::loadGlyphCache()
+{
+    if (mIsFallback || !mFTFace || sGlyphCacheDir.empty() || !gFontManagerp)
+    {
+        return false;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    const U64 key = getGlyphCacheKey();
+    const std::string filename = get_glyph_cache_filename(sGlyphCacheDir, key);
+    std::vector<U8> buffer;
+    if (!read_file(filename, buffer))
+    {
+        // first time for this font, size and DPI
+        return false;
+    }
+
+    GlyphCacheHeader header;
+    const S32 bitmap_size = mFontBitmapCachep->getBitmapWidth();
+    bool valid = buffer.size() >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, buffer.data(), sizeof(header));
+        valid = header.mMagic == GLYPH_CACHE_MAGIC
+            && header.mVersion == GLYPH_CACHE_VERSION
+            && header.mKey == key
+            && header.mBitmapSize == bitmap_size;
+    }
+    size_t expected_size = sizeof(header);
+    for (U32 type = 0; valid && type < NUM_BITMAP_TYPES; ++type)
+    {
+        valid = header.mNumBitmaps[type] <= MAX_CACHED_BITMAPS;
+        expected_size += (size_t)header.mNumBitmaps[type] * bitmap_size * bitmap_size
+            * LLFontBitmapCache::getNumComponents(static_cast<EFontGlyphType>(type));
+    }
+    if (valid)
+    {
+        expected_size += (size_t)header.mNumGlyphs * sizeof(GlyphCacheRecord);
+        valid = buffer.size() == expected_size;
+    }
+    if (!valid)
+    {
+        LL_WARNS("Font") << "Ignoring invalid glyph cache " << filename << LL_ENDL;
+        LLFile::remove(filename);
+        return false;
+    }
+
+    // Replace the atlas built so far. Prefetched glyphs rendered for it
+    // would be duplicates now.
+    for (char_glyph_info_map_t::iterator it = mCharGlyphInfoMap.begin(), end_it = mCharGlyphInfoMap.end();
+        it != end_it;
+        ++it)
+    {
+        delete it->second;
+    }
+    mCharGlyphInfoMap.clear();
+    mFontBitmapCachep->reset();
+    ++mGeneration;
+
+    const U8* data = buffer.data() + sizeof(header);
+    for (U32 type = 0; type < NUM_BITMAP_TYPES; ++type)
+    {
+        const EFontGlyphType bitmap_type = static_cast<EFontGlyphType>(type);
+        const S32 components = LLFontBitmapCache::getNumComponents(bitmap_type);
+        for (U32 bitmap_num = 0; bitmap_num < header.mNumBitmaps[type]; ++bitmap_num)
+        {
+            LLPointer<LLImageRaw> image_raw = new LLImageRaw(bitmap_size, bitmap_size, components);
+            memcpy(image_raw->getData(), data, image_raw->getDataSize());
+            data += image_raw->getDataSize();
+            mFontBitmapCachep->addBitmap(bitmap_type, image_raw);
+        }
+        if (header.mNumBitmaps[type])
+        {
+            mFontBitmapCachep->setOpenPos(bitmap_type, header.mOpenX[type], header.mOpenY[type]);
+        }
+    }
+
+    for (U32 i = 0; i < header.mNumGlyphs; ++i, data += sizeof(GlyphCacheRecord))
+    {
+        GlyphCacheRecord record;
+        memcpy(&record, data, sizeof(record));
+        if (record.mGlyphType >= NUM_BITMAP_TYPES
+            || record.mBitmapType >= NUM_BITMAP_TYPES
+            || record.mBitmapNum < 0
+            || (U32)record.mBitmapNum >= header.mNumBitmaps[record.mBitmapType])
+        {
+            continue;
+        }
+
+        LLFontGlyphInfo* gi = new LLFontGlyphInfo(record.mGlyphIndex, static_cast<EFontGlyphType>(record.mGlyphType));
+        gi->mXBitmapOffset = record.mXBitmapOffset;
+        gi->mYBitmapOffset = record.mYBitmapOffset;
+        gi->mBitmapEntry = std::make_pair(static_cast<EFontGlyphType>(record.mBitmapType), record.mBitmapNum);
+        gi->mWidth = record.mWidth;
+        gi->mHeight = record.mHeight;
+        gi->mXBearing = record.mXBearing;
+        gi->mYBearing = record.mYBearing;
+        gi->mXAdvance = record.mXAdvance;
+        gi->mYAdvance = record.mYAdvance;
+        insertGlyphInfo(record.mChar, gi);
+    }
+
+    if (mCharGlyphInfoMap.find(0) == mCharGlyphInfoMap.end())
+    {
+        // Add the default glyph
+        addGlyphFromFont(this, 0, 0, EFontGlyphType::Grayscale);
+    }
+
+    mSavedGlyphCount = mCharGlyphInfoMap.size();
+    LL_INFOS("Font") << "Loaded " << mSavedGlyphCount << " cached glyphs for " << mName << " size " << mPointSize << LL_ENDL;
+    return true;
+}
+
+void LLFontFreetype::saveGlyphCache() const
+{
+    if (mIsFallback || !mFTFace || sGlyphCacheDir.empty() || !gFontManagerp
+        || mCharGlyphInfoMap.size() == mSavedGlyphCount)
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    GlyphCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.mMagic = GLYPH_CACHE_MAGIC;
+    header.mVersion = GLYPH_CACHE_VERSION;
+    header.mKey = getGlyphCacheKey();
+    header.mBitmapSize = mFontBitmapCachep->getBitmapWidth();
+    header.mNumGlyphs = (U32)mCharGlyphInfoMap.size();
+    for (U32 type = 0; type < NUM_BITMAP_TYPES; ++type)
+    {
+        const EFontGlyphType bitmap_type = static_cast<EFontGlyphType>(type);
+        header.mNumBitmaps[type] = mFontBitmapCachep->getNumBitmaps(bitmap_type);
+        if (header.mNumBitmaps[type] > MAX_CACHED_BITMAPS)
+        {
+            // the atlas grew too large to be worth keeping
+            return;
+        }
+        mFontBitmapCachep->getOpenPos(bitmap_type, header.mOpenX[type], header.mOpenY[type]);
+    }
+
+    std::vector<U8> buffer;
+    append_value(buffer, header);
+    for (U32 type = 0; type < NUM_BITMAP_TYPES; ++type)
+    {
+        const EFontGlyphType bitmap_type = static_cast<EFontGlyphType>(type);
+        for (U32 bitmap_num = 0; bitmap_num < header.mNumBitmaps[type]; ++bitmap_num)
+        {
+            const LLImageRaw* image_raw = mFontBitmapCachep->getImageRaw(bitmap_type, bitmap_num);
+            if (!image_raw || !image_raw->getData()
+                || image_raw->getWidth() != header.mBitmapSize || image_raw->getHeight() != header.mBitmapSize)
+            {
+                return;
+            }
+            buffer.insert(buffer.end(), image_raw->getData(), image_raw->getData() + image_raw->getDataSize());
+        }
+    }
+    for (const char_glyph_info_map_t::value_type& entry : mCharGlyphInfoMap)
+    {
+        const LLFontGlyphInfo* gi = entry.second;
+        GlyphCacheRecord record;
+        record.mChar = entry.first;
+        record.mGlyphIndex = gi->mGlyphIndex;
+        record.mGlyphType = static_cast<U32>(gi->mGlyphType);
+        record.mBitmapType = static_cast<U32>(gi->mBitmapEntry.first);
+        record.mBitmapNum = gi->mBitmapEntry.second;
+        record.mWidth = gi->mWidth;
+        record.mHeight = gi->mHeight;
+        record.mXBitmapOffset = gi->mXBitmapOffset;
+        record.mYBitmapOffset = gi->mYBitmapOffset;
+        record.mXBearing = gi->mXBearing;
+        record.mYBearing = gi->mYBearing;
+        record.mXAdvance = gi->mXAdvance;
+        record.mYAdvance = gi->mYAdvance;
+        append_value(buffer, record);
+    }
+
+    LLFile::mkdir(sGlyphCacheDir);
+    const std::string filename = get_glyph_cache_filename(sGlyphCacheDir, header.mKey);
+    if (LLFile::replaceContents(filename, buffer.data(), buffer.size()))
+    {
+        mSavedGlyphCount = mCharGlyphInfoMap.size();
+    }
+    else
+    {
+        LL_WARNS("Font") << "Unable to write glyph cache " << filename << LL_ENDL;
+    }
+}
+
+void LLFontFreetype::prefetchGlyphs() const
+{
+    if (mIsFallback || !mFTFace || sPrefetchRanges.empty() || !gFontManagerp)
+    {
+        return;
+    }
+
+    // Tools and tests run without the viewer's thread pools
+    LL::WorkQueue::ptr_t main_queue = LL::WorkQueue::getInstance("mainloop");
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!main_queue || !general_queue)
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    // Picking the font of a character is a cheap charmap lookup, done here
+    // so that the worker only has to render
+    std::vector<GlyphPrefetchFace> faces;
+    std::vector<GlyphPrefetchRequest> requests;
+    std::map<const LLFontFreetype*, U32> face_slots;
+    for (const std::pair<llwchar, llwchar>& range : sPrefetchRanges)
+    {
+        for (llwchar wch = range.first; wch <= range.second; ++wch)
+        {
+            if (mCharGlyphInfoMap.find(wch) != mCharGlyphInfoMap.end())
+            {
+                continue;
+            }
+
+            U32 glyph_index = 0;
+            const LLFontFreetype* fontp = findGlyphFont(wch, glyph_index);
+            if (!glyph_index)
+            {
+                // no font has it, leave it to the default glyph
+                continue;
+            }
+
+            auto slot = face_slots.emplace(fontp, (U32)faces.size());
+            if (slot.second)
+            {
+                faces.push_back({ gFontManagerp->getLoadedFont(fontp->mName), fontp->mFaceIndex,
+                                  fontp->mPointSize, fontp->mVertDPI, fontp->mHorzDPI });
+            }
+            requests.push_back({ wch, slot.first->second, glyph_index });
+        }
+    }
+    if (requests.empty())
+    {
+        return;
+    }
+
+    std::weak_ptr<const LLFontFreetype*> token = mPrefetchToken;
+    const U32 generation = mGeneration;
+    main_queue->postTo(
+        general_queue,
+        [faces, requests]() // Work done on general queue
+        {
+            return render_prefetched_glyphs(faces, requests);
+        },
+        [token, generation](std::vector<LLFontPrefetchedGlyph> glyphs) // Callback to main thread
+        {
+            if (std::shared_ptr<const LLFontFreetype*> fontpp = token.lock())
+            {
+                (*fontpp)->addPrefetchedGlyphs(generation, glyphs);
+            }
+        });
+}
+
+void LLFontFreetype::addPrefetchedGlyphs(U32 generation, std::vector<LLFontPrefetchedGlyph>& glyphs) const
+{
+    if (generation != mGeneration || !mFTFace)
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::set<std::pair<EFontGlyphType, U32> > dirty_bitmaps;
+    for (LLFontPrefetchedGlyph& glyph : glyphs)
+    {
+        auto range_it = mCharGlyphInfoMap.equal_range(glyph.mChar);
+        if (std::any_of(range_it.first, range_it.second,
+                        [](const char_glyph_info_map_t::value_type& entry)
+                        {
+                            return entry.second->mGlyphType == EFontGlyphType::Grayscale;
+                        }))
+        {
+            // drawn meanwhile
+            continue;
+        }
+
+        glyph.mBitmap.mData = glyph.mPixels.empty() ? nullptr : glyph.mPixels.data();
+        LLFontGlyphInfo* gi = insertGlyphBitmap(glyph.mChar, EFontGlyphType::Grayscale, glyph.mBitmap);
+        dirty_bitmaps.emplace(gi->mBitmapEntry.first, (U32)gi->mBitmapEntry.second);
+    }
+
+    // one texture upload per touched bitmap rather than one per glyph
+    for (const std::pair<EFontGlyphType, U32>& bitmap : dirty_bitmaps)
+    {
+        uploadBitmap(bitmap.first, bitmap.second);
+    }
+    LL_DEBUGS("Font") << "Prefetched " << glyphs.size() << " glyphs for " << mName << LL_ENDL;
+}
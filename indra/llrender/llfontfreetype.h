@@ -43,6 +43,9 @@ typedef struct FT_FaceRec_* LLFT_Face;
 struct FT_StreamRec_;
 typedef struct FT_StreamRec_ LLFT_Stream;
 
+struct LLFontGlyphBitmap;
+struct LLFontPrefetchedGlyph;
+
 // <FS:ND> FIRE-7570. Only load/mmap fonts once.
 namespace nd
 {
@@ -59,6 +62,11 @@ public:
     static void initClass();
     static void cleanupClass();
 
+    // Keeps the file data alive for threads rendering from it
+    std::shared_ptr<nd::fonts::LoadedFont> getLoadedFont(const std::string& filename) const;
+    // Content hash of a loaded font file, computed once
+    U64 getFontHash(const std::string& filename) const;
+
 private:
     LLFontManager();
     ~LLFontManager();
@@ -167,13 +175,30 @@ public:
     void setStyle(U8 style);
     U8 getStyle() const;
 
+    // Glyph atlases persist between sessions in this directory, one file per
+    // head font keyed by the contents, size and DPI of its font files. An
+    // empty directory disables the cache.
+    static void setGlyphCacheDir(const std::string& dir);
+    bool loadGlyphCache();
+    void saveGlyphCache() const;
+
+    // Ranges of characters rendered on the "General" thread pool ahead of
+    // their first use, as a list of hexadecimal pairs like "0020-00FF,3000-30FF"
+    static void setPrefetchRanges(const std::string& ranges);
+    void prefetchGlyphs() const;
+
 private:
     void resetBitmapCache();
-    void setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, U8 *data, S32 stride = 0) const;
+    void setSubImageLuminanceAlpha(U32 x, U32 y, U32 bitmap_num, U32 width, U32 height, const U8 *data, S32 stride = 0) const;
     bool setSubImageBGRA(U32 x, U32 y, U32 bitmap_num, U16 width, U16 height, const U8* data, U32 stride) const;
     bool hasGlyph(llwchar wch) const;       // Has a glyph for this character
     LLFontGlyphInfo* addGlyph(llwchar wch, EFontGlyphType glyph_type) const;        // Add a new character to the font if necessary
     LLFontGlyphInfo* addGlyphFromFont(const LLFontFreetype *fontp, llwchar wch, U32 glyph_index, EFontGlyphType bitmap_type) const; // Add a glyph from this font to the other (returns the glyph_index, 0 if not found)
+    const LLFontFreetype* findGlyphFont(llwchar wch, U32& glyph_index) const; // This font or the fallback that renders wch
+    LLFontGlyphInfo* insertGlyphBitmap(llwchar wch, EFontGlyphType requested_glyph_type, const LLFontGlyphBitmap& bitmap) const;
+    void uploadBitmap(EFontGlyphType bitmap_type, U32 bitmap_num) const;
+    void addPrefetchedGlyphs(U32 generation, std::vector<LLFontPrefetchedGlyph>& glyphs) const;
+    U64 getGlyphCacheKey() const;
     void renderGlyph(EFontGlyphType bitmap_type, U32 glyph_index) const;
     void insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const;
 
@@ -182,6 +207,9 @@ private:
     U8 mStyle;
 
     F32 mPointSize;
+    F32 mVertDPI;
+    F32 mHorzDPI;
+    S32 mFaceIndex;
     F32 mAscender;
     F32 mDescender;
     F32 mLineHeight;
@@ -207,6 +235,17 @@ private:
     mutable S32 mRenderGlyphCount;
     mutable S32 mAddGlyphCount;
 
+    // Glyph count when the atlas was last loaded or saved
+    mutable size_t mSavedGlyphCount;
+    // Bumped whenever the atlas is thrown away, prefetched glyphs rendered
+    // for an older one are dropped
+    U32 mGeneration;
+    // Expires with this font, so prefetch replies arriving late are ignored
+    std::shared_ptr<const LLFontFreetype*> mPrefetchToken;
+
+    static std::string sGlyphCacheDir;
+    static std::vector<std::pair<llwchar, llwchar> > sPrefetchRanges;
+
     // <FS:ND> Save X-kerning data, so far only for all glyphs with index small than 256 (to not waste too much memory)
     // right now it is 256 slots with 256 glyphs each, maybe consider splitting it into smaller slices to use less memory if we
     // we want to cache 0xFFFF glyphs
@@ -621,6 +621,11 @@ LLFontGL *LLFontRegistry::createFont(const LLFontDescriptor& desc)
     if (result)
     {
         result->mFontDescriptor = desc;
+
+        // now that the fallbacks are known, pick up the atlas of the last
+        // session and render likely glyphs in the background
+        result->mFontFreetype->loadGlyphCache();
+        result->mFontFreetype->prefetchGlyphs();
     }
     else
     {
@@ -650,6 +655,10 @@ void LLFontRegistry::clear()
          ++it)
     {
         LLFontGL *fontp = it->second;
+        if (fontp && fontp->mFontFreetype.notNull())
+        {
+            fontp->mFontFreetype->saveGlyphCache();
+        }
         delete fontp;
     }
     mFontMap.clear();
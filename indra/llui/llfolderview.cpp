@@ -114,6 +114,11 @@ void LLAllDescendentsPassedFilter::doItem(LLFolderViewItem* item)
     mAllDescendentsPassedFilter &= (item) && (item->passedFilter());
 }
 
+void LLAllDescendentsPassedFilter::doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+{
+    mAllDescendentsPassedFilter &= item->passedFilter();
+}
+
 ///----------------------------------------------------------------------------
 /// Class LLFolderViewScrollContainer
 ///----------------------------------------------------------------------------
@@ -735,7 +740,15 @@ void LLFolderView::draw()
 
     // skip over LLFolderViewFolder::draw since we don't want the folder icon, label,
     // and arrow for the root folder
-    LLView::draw();
+    if (drawVisibleRows((mRenamer ? 1 : 0) + (mStatusTextBox ? 1 : 0)))
+    {
+        drawChild(mRenamer);
+        drawChild(mStatusTextBox);
+    }
+    else
+    {
+        LLView::draw();
+    }
 
     mDragAndDropThisFrame = false;
 }
@@ -1763,6 +1776,18 @@ void LLFolderView::scrollToShowItem(LLFolderViewItem* item, const LLRect& constr
     }
 }
 
+bool LLFolderView::buildsItemsLazily() const
+{
+    static LLCachedControl<bool> virtual_rows(*LLUI::getInstance()->mSettingGroups["config"], "FolderViewVirtualRows", true);
+    // only rows in view of the scroll container get built
+    return virtual_rows && mScrollContainer && !mBuildItemCallback.empty();
+}
+
+LLFolderViewItem* LLFolderView::buildItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+{
+    return mBuildItemCallback.empty() ? NULL : mBuildItemCallback(folder, item);
+}
+
 LLRect LLFolderView::getVisibleRect()
 {
     S32 visible_height = (mScrollContainer ? mScrollContainer->getRect().getHeight() : 0);
@@ -2094,6 +2119,7 @@ bool LLFolderView::isFolderSelected()
 
 bool LLFolderView::selectFirstItem()
 {
+    buildRowsAround(NULL);
     for (folders_t::iterator iter = mFolders.begin();
          iter != mFolders.end();++iter)
     {
@@ -2121,6 +2147,7 @@ bool LLFolderView::selectFirstItem()
 }
 bool LLFolderView::selectLastItem()
 {
+    buildRowsAround(NULL);
     for(items_t::reverse_iterator iit = mItems.rbegin();
         iit != mItems.rend(); ++iit)
     {
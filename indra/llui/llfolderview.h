@@ -228,6 +228,14 @@ public:
     void setScrollContainer( LLScrollContainer* parent ) { mScrollContainer = parent; }
     LLRect getVisibleRect();
 
+    // Lets folders add items by their models alone and build the widgets
+    // once they scroll into view; the callback creates the widget of item
+    // and adds it to folder.
+    typedef boost::function<LLFolderViewItem* (LLFolderViewFolder* folder, LLFolderViewModelItem* item)> build_item_callback_t;
+    void setBuildItemCallback(const build_item_callback_t& cb) { mBuildItemCallback = cb; }
+    bool buildsItemsLazily() const;
+    LLFolderViewItem* buildItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item);
+
     bool search(LLFolderViewItem* first_item, const std::string &search_string, bool backward);
     void setShowSelectionContext(bool show) { mShowSelectionContext = show; }
     bool getShowSelectionContext();
@@ -339,6 +347,7 @@ protected:
 
     LLFolderViewModelInterface*     mViewModel;
     LLFolderViewGroupedItemModel*   mGroupedItemModel;
+    build_item_callback_t           mBuildItemCallback;
 
     /**
      * Is used to determine if we need to cut text In LLFolderViewItem to avoid horizontal scroll.
@@ -379,6 +388,9 @@ public:
     virtual ~LLFolderViewFunctor() {}
     virtual void doFolder(LLFolderViewFolder* folder) = 0;
     virtual void doItem(LLFolderViewItem* item) = 0;
+    // Items of folder whose widgets are not built; an override that needs
+    // the widget gets it from folder->buildUnbuiltItem(item).
+    virtual void doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item) {}
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -399,6 +411,7 @@ public:
     virtual ~LLSelectFirstFilteredItem() {}
     virtual void doFolder(LLFolderViewFolder* folder);
     virtual void doItem(LLFolderViewItem* item);
+    virtual void doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item);
     bool wasItemSelected() { return mItemSelected || mFolderSelected; }
 protected:
     bool mItemSelected;
@@ -412,6 +425,7 @@ public:
     virtual ~LLOpenFilteredFolders() {}
     virtual void doFolder(LLFolderViewFolder* folder);
     virtual void doItem(LLFolderViewItem* item);
+    virtual void doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item);
 };
 
 class LLSaveFolderState : public LLFolderViewFunctor
@@ -444,6 +458,7 @@ public:
     /*virtual*/ ~LLAllDescendentsPassedFilter() {}
     /*virtual*/ void doFolder(LLFolderViewFolder* folder);
     /*virtual*/ void doItem(LLFolderViewItem* item);
+    /*virtual*/ void doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item);
     bool allDescendentsPassedFilter() const { return mAllDescendentsPassedFilter; }
 protected:
     bool mAllDescendentsPassedFilter;
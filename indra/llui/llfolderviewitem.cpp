@@ -39,6 +39,7 @@
 #include "llclipboard.h"
 #include "llfocusmgr.h"     // gFocusMgr
 #include "lltrans.h"
+#include "llui.h"
 #include "llwindow.h"
 
 ///----------------------------------------------------------------------------
@@ -171,6 +172,7 @@ LLFolderViewItem::LLFolderViewItem(const LLFolderViewItem::Params& p)
 :   LLView(p),
     mLabelWidth(0),
     mLabelWidthDirty(false),
+    mArrangeDeferred(false),
     mSuffixNeedsRefresh(false),
     mLabelPaddingRight(DEFAULT_LABEL_PADDING_RIGHT),
     mParentFolder( NULL ),
@@ -433,6 +435,8 @@ void LLFolderViewItem::addToFolder(LLFolderViewFolder* folder)
 // makes sure that this view and its children are the right size.
 S32 LLFolderViewItem::arrange( S32* width, S32* height )
 {
+    mArrangeDeferred = false;
+
     // Only indent deeper items in hierarchy
 
     // <FS:Ansariel> Inventory specials
@@ -480,6 +484,39 @@ S32 LLFolderViewItem::arrange( S32* width, S32* height )
     return *height;
 }
 
+S32 LLFolderViewItem::deferArrange( S32* width, S32* height )
+{
+    // the label width is only known once the item has been arranged
+    if (!mLabelWidthDirty)
+    {
+        *width = llmax(*width, mLabelWidth);
+        if (getRoot()->getUseEllipses())
+        {
+            *width = llmin(*width, getRoot()->getRect().getWidth());
+        }
+    }
+    mArrangeDeferred = true;
+    *height = getItemHeight();
+    return *height;
+}
+
+void LLFolderViewItem::finishDeferredArrange()
+{
+    if (!mArrangeDeferred)
+    {
+        return;
+    }
+
+    S32 width = 0;
+    S32 height = 0;
+    arrange(&width, &height);
+    // the parent folder needs to widen for a long label
+    if (width > getRect().getWidth() && mParentFolder)
+    {
+        mParentFolder->requestArrange();
+    }
+}
+
 S32 LLFolderViewItem::getItemHeight() const
 {
     return mItemHeight;
@@ -1260,6 +1297,8 @@ static LLTrace::BlockTimerStatHandle FTM_ARRANGE("Arrange");
 // * Makes sure that this view and its children are the right size
 S32 LLFolderViewFolder::arrange( S32* width, S32* height )
 {
+    static LLCachedControl<bool> virtual_rows(*LLUI::getInstance()->mSettingGroups["config"], "FolderViewVirtualRows", true);
+
     // Sort before laying out contents
     // Note that we sort from the root (CHUI-849)
     if (mAreChildrenInited)
@@ -1284,6 +1323,17 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
                 break;
         }
         if (!found)
+        {
+            // Then the items whose widgets are not built
+            S32 filter_generation = getFolderViewModel()->getFilter().getFirstSuccessGeneration();
+            for (unbuilt_items_t::iterator uit = mUnbuiltItems.begin(); uit != mUnbuiltItems.end(); ++uit)
+            {
+                found = (*uit)->passedFilter(filter_generation);
+                if (found)
+                    break;
+            }
+        }
+        if (!found)
         {
             // If no item found, try the folders
             for (folders_t::iterator fit = mFolders.begin(); fit != mFolders.end(); ++fit)
@@ -1320,6 +1370,7 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
         // set last arrange generation first, in case children are animating
         // and need to be arranged again
         mLastArrangeGeneration = getRoot()->getArrangeGeneration();
+        mRows.clear();
         if (isOpen())
         {
             // Add sizes of children
@@ -1341,29 +1392,19 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
                     running_height += (F32)child_height;
                     *width = llmax(*width, child_width);
                     folderp->setOrigin( 0, child_top - folderp->getRect().getHeight() );
+                    row_t row = { folderp, mUnbuiltItems.end(), parent_item_height - child_top, child_height };
+                    mRows.push_back(row);
                 }
             }
-            for(items_t::iterator iit = mItems.begin();
-                iit != mItems.end(); ++iit)
-            {
-                LLFolderViewItem* itemp = (*iit);
-                itemp->setVisible(itemp->isPotentiallyVisible());
-
-                if (itemp->getVisible())
-                {
-                    S32 child_width = *width;
-                    S32 child_height = 0;
-                    S32 child_top = parent_item_height - ll_round(running_height);
-
-                    target_height += itemp->arrange( &child_width, &child_height );
-                    // don't change width, as this item is as wide as its parent folder by construction
-                    itemp->reshape( itemp->getRect().getWidth(), child_height);
 
-                    running_height += (F32)child_height;
-                    *width = llmax(*width, child_width);
-                    itemp->setOrigin( 0, child_top - itemp->getRect().getHeight() );
-                }
-            }
+            item_layout_params params;
+            params.mViewModel = getFolderViewModel();
+            params.mFilterGeneration = params.mViewModel->getFilter().getFirstSuccessGeneration();
+            params.mRowHeight = getItemHeight();
+            params.mParentItemHeight = parent_item_height;
+            // rows out of view are never drawn, so they only need a height
+            params.mDeferArrange = virtual_rows;
+            running_height = layoutItemRows(params, mItems, mUnbuiltItems, running_height, target_height, width, mRows);
         }
 
         mTargetHeight = target_height;
@@ -1423,6 +1464,69 @@ S32 LLFolderViewFolder::arrange( S32* width, S32* height )
     return ll_round(mTargetHeight);
 }
 
+// static
+F32 LLFolderViewFolder::layoutItemRows(const item_layout_params& params, items_t& items, unbuilt_items_t& unbuilt,
+                                       F32 running_height, F32& target_height, S32* width, rows_t& rows)
+{
+    items_t::iterator iit = items.begin();
+    unbuilt_items_t::iterator uit = unbuilt.begin();
+    while (iit != items.end() || uit != unbuilt.end())
+    {
+        // built items go first among equals
+        if (uit == unbuilt.end()
+            || (iit != items.end() && !params.mViewModel->sortsBefore(*uit, (*iit)->getViewModelItem())))
+        {
+            LLFolderViewItem* itemp = (*iit++);
+            itemp->setVisible(itemp->isPotentiallyVisible(params.mFilterGeneration));
+
+            if (itemp->getVisible())
+            {
+                S32 child_width = *width;
+                S32 child_height = 0;
+                S32 child_top = params.mParentItemHeight - ll_round(running_height);
+
+                target_height += params.mDeferArrange ? itemp->deferArrange( &child_width, &child_height )
+                                                      : itemp->arrange( &child_width, &child_height );
+                // don't change width, as this item is as wide as its parent folder by construction
+                itemp->reshape( itemp->getRect().getWidth(), child_height);
+
+                row_t row = { itemp, unbuilt.end(), ll_round(running_height), child_height };
+                rows.push_back(row);
+                running_height += (F32)child_height;
+                *width = llmax(*width, child_width);
+                itemp->setOrigin( 0, child_top - itemp->getRect().getHeight() );
+            }
+        }
+        else
+        {
+            // takes a row of the folder's item height and no width until
+            // the widget is built
+            unbuilt_items_t::iterator modelp = uit++;
+            if ((*modelp)->passedFilter(params.mFilterGeneration))
+            {
+                row_t row = { NULL, modelp, ll_round(running_height), params.mRowHeight };
+                rows.push_back(row);
+                running_height += (F32)params.mRowHeight;
+                target_height += (F32)params.mRowHeight;
+            }
+        }
+    }
+    return running_height;
+}
+
+// static
+void LLFolderViewFolder::getRowRange(const rows_t& rows, S32 top, S32 bottom,
+                                     rows_t::size_type& first, rows_t::size_type& last)
+{
+    // rows are contiguous from the top down
+    rows_t::const_iterator begin = std::partition_point(rows.begin(), rows.end(),
+        [top](const row_t& row) { return row.mTop + row.mHeight <= top; });
+    rows_t::const_iterator end = std::partition_point(begin, rows.end(),
+        [bottom](const row_t& row) { return row.mTop < bottom; });
+    first = begin - rows.begin();
+    last = end - rows.begin();
+}
+
 bool LLFolderViewFolder::needsArrange()
 {
     return mLastArrangeGeneration < getRoot()->getArrangeGeneration();
@@ -1620,6 +1724,9 @@ LLFolderViewFolder* LLFolderViewFolder::getCommonAncestor(LLFolderViewItem* item
 
 void LLFolderViewFolder::gatherChildRangeExclusive(LLFolderViewItem* start, LLFolderViewItem* end, bool reverse, std::vector<LLFolderViewItem*>& items)
 {
+    // every visible row might be in the range
+    buildRows(0, mRows.size());
+
     bool selecting = start == NULL;
     if (reverse)
     {
@@ -1793,6 +1900,12 @@ void LLFolderViewFolder::extendSelectionTo(LLFolderViewItem* new_selection)
 
 void LLFolderViewFolder::destroyView()
 {
+    mRows.clear();
+    while (!mUnbuiltItems.empty())
+    {
+        getViewModelItem()->removeChild(mUnbuiltItems.back());
+        mUnbuiltItems.pop_back();
+    }
     while (!mItems.empty())
     {
         LLFolderViewItem *itemp = mItems.back();
@@ -1842,6 +1955,7 @@ void LLFolderViewFolder::extractItem( LLFolderViewItem* item, bool deparent_mode
     }
     //because an item is going away regardless of filter status, force rearrange
     requestArrange();
+    mRows.clear();
     removeChild(item);
 }
 
@@ -1871,6 +1985,14 @@ bool LLFolderViewFolder::isMovable()
                 return false;
             }
         }
+
+        for (unbuilt_items_t::iterator uit = mUnbuiltItems.begin(); uit != mUnbuiltItems.end(); ++uit)
+        {
+            if (!(*uit)->isItemMovable())
+            {
+                return false;
+            }
+        }
     return true;
 }
 
@@ -1901,6 +2023,14 @@ bool LLFolderViewFolder::isRemovable()
                 return false;
             }
         }
+
+        for (unbuilt_items_t::iterator uit = mUnbuiltItems.begin(); uit != mUnbuiltItems.end(); ++uit)
+        {
+            if (!(*uit)->isItemRemovable())
+            {
+                return false;
+            }
+        }
     return true;
 }
 
@@ -1959,6 +2089,58 @@ void LLFolderViewFolder::addFolder(LLFolderViewFolder* folder)
     }
 }
 
+void LLFolderViewFolder::addUnbuiltItem(LLFolderViewModelItem* item)
+{
+    mUnbuiltItems.push_back(item);
+    if (item->hasParent())
+    {
+        getViewModelItem()->requestSort();
+    }
+    else
+    {
+        getViewModelItem()->addChild(item);
+    }
+    mRows.clear();
+    requestArrange();
+}
+
+LLFolderViewItem* LLFolderViewFolder::buildUnbuiltItem(LLFolderViewModelItem* item)
+{
+    unbuilt_items_t::iterator it = std::find(mUnbuiltItems.begin(), mUnbuiltItems.end(), item);
+    if (it == mUnbuiltItems.end())
+    {
+        return NULL;
+    }
+
+    LLPointer<LLFolderViewModelItem> modelp = *it;
+    // the widget dirties the filter of its model, keep what it passed
+    bool visible = isOpen() && modelp->passedFilter();
+    mUnbuiltItems.erase(it);
+    mRows.clear();
+    requestArrange();
+
+    LLFolderViewItem* itemp = getRoot()->buildItem(this, modelp);
+    if (itemp)
+    {
+        itemp->setVisible(visible);
+        // appended, sorted on the next arrange
+        getViewModelItem()->requestSort();
+    }
+    else
+    {
+        getViewModelItem()->removeChild(modelp);
+    }
+    return itemp;
+}
+
+void LLFolderViewFolder::buildUnbuiltItems()
+{
+    while (!mUnbuiltItems.empty())
+    {
+        buildUnbuiltItem(mUnbuiltItems.front());
+    }
+}
+
 void LLFolderViewFolder::requestArrange()
 {
     mLastArrangeGeneration = -1;
@@ -2072,6 +2254,12 @@ void LLFolderViewFolder::applyFunctorToChildren(LLFolderViewFunctor& functor)
         items_t::iterator iit = iter++;
         functor.doItem((*iit));
     }
+    for (unbuilt_items_t::iterator iter = mUnbuiltItems.begin();
+        iter != mUnbuiltItems.end();)
+    {
+        unbuilt_items_t::iterator uit = iter++;
+        functor.doUnbuiltItem(this, (*uit));
+    }
 }
 
 void LLFolderViewFolder::applyFunctorRecursively(LLFolderViewFunctor& functor)
@@ -2090,6 +2278,12 @@ void LLFolderViewFolder::applyFunctorRecursively(LLFolderViewFunctor& functor)
         items_t::iterator iit = iter++;
         functor.doItem((*iit));
     }
+    for (unbuilt_items_t::iterator iter = mUnbuiltItems.begin();
+        iter != mUnbuiltItems.end();)
+    {
+        unbuilt_items_t::iterator uit = iter++;
+        functor.doUnbuiltItem(this, (*uit));
+    }
 }
 
 // LLView functionality
@@ -2275,15 +2469,170 @@ void LLFolderViewFolder::draw()
     // draw children if root folder, or any other folder that is open or animating to closed state
     if( getRoot() == this || (isOpen() || mCurHeight != mTargetHeight ))
     {
-        LLView::draw();
+        if (!drawVisibleRows())
+        {
+            LLView::draw();
+        }
     }
 
     mExpanderHighlighted = false;
 }
 
+bool LLFolderViewFolder::drawVisibleRows(size_t other_children)
+{
+    static LLCachedControl<bool> virtual_rows(*LLUI::getInstance()->mSettingGroups["config"], "FolderViewVirtualRows", true);
+
+    // visible part of the scroll container, in local coordinates
+    LLFolderView* root = getRoot();
+    LLRect visible_rect = root->getVisibleRect();
+    if (!virtual_rows || visible_rect.isEmpty()
+        || (size_t)getChildCount() != mItems.size() + mFolders.size() + other_children)
+    {
+        // LLView::draw() only sees the widgets
+        buildUnbuiltItems();
+        finishDeferredArranges();
+        return false;
+    }
+    if (mRows.empty())
+    {
+        finishDeferredArranges();
+        return false;
+    }
+    for (LLView* viewp = this; viewp && viewp != root; viewp = viewp->getParent())
+    {
+        visible_rect.translate(-viewp->getRect().mLeft, -viewp->getRect().mBottom);
+    }
+    // rows of a folder animating closed fall out of its rect
+    visible_rect.intersectWith(getLocalRect());
+
+    const S32 folder_height = getRect().getHeight();
+    rows_t::size_type first = 0;
+    rows_t::size_type last = 0;
+    getRowRange(mRows, folder_height - visible_rect.mTop, folder_height - visible_rect.mBottom, first, last);
+    buildRows(first, last);
+    for (rows_t::size_type i = first; i < last; ++i)
+    {
+        LLFolderViewItem* itemp = mRows[i].mItem;
+        if (itemp)
+        {
+            itemp->finishDeferredArrange();
+            drawChild(itemp);
+        }
+    }
+    return true;
+}
+
+void LLFolderViewFolder::buildRows(rows_t::size_type first, rows_t::size_type last)
+{
+    last = llmin(last, mRows.size());
+    rows_t::size_type i = first;
+    while (i < last && mRows[i].mUnbuilt == mUnbuiltItems.end())
+    {
+        ++i;
+    }
+    if (i == last)
+    {
+        return;
+    }
+
+    // new widgets go before the first built item below them, keeping
+    // mItems sorted
+    items_t::iterator pos = mItems.end();
+    for (rows_t::size_type next = last; next < mRows.size(); ++next)
+    {
+        if (mRows[next].mItem)
+        {
+            pos = std::find(mItems.begin(), mItems.end(), mRows[next].mItem);
+            break;
+        }
+    }
+
+    LLFolderView* root = getRoot();
+    const S32 folder_height = getRect().getHeight();
+    while (last-- > first)
+    {
+        row_t& row = mRows[last];
+        if (row.mUnbuilt == mUnbuiltItems.end())
+        {
+            if (row.mItem)
+            {
+                // folders are never found, they all come before the items
+                pos = std::find(mItems.begin(), pos, row.mItem);
+            }
+            continue;
+        }
+
+        LLPointer<LLFolderViewModelItem> modelp = *row.mUnbuilt;
+        mUnbuiltItems.erase(row.mUnbuilt);
+        row.mUnbuilt = mUnbuiltItems.end();
+        LLFolderViewItem* itemp = root->buildItem(this, modelp);
+        if (!itemp)
+        {
+            getViewModelItem()->removeChild(modelp);
+            requestArrange();
+            continue;
+        }
+        if (mItems.back() != itemp)
+        {
+            // not placed until the folder is sorted and arranged again
+            getViewModelItem()->requestSort();
+            requestArrange();
+            continue;
+        }
+        // addItem() appended it
+        mItems.splice(pos, mItems, std::prev(mItems.end()));
+        pos = std::prev(pos);
+
+        S32 width = 0;
+        S32 height = 0;
+        itemp->deferArrange(&width, &height);
+        itemp->setVisible(true);
+        itemp->reshape(getRect().getWidth(), height);
+        itemp->setOrigin(0, folder_height - row.mTop - height);
+        row.mItem = itemp;
+        if (height != row.mHeight)
+        {
+            // the rows below move on the next arrange
+            requestArrange();
+        }
+    }
+}
+
+void LLFolderViewFolder::buildRowsAround(LLFolderViewItem* item)
+{
+    if (mUnbuiltItems.empty() || mRows.empty())
+    {
+        return;
+    }
+    if (!item)
+    {
+        buildRows(mRows.size() - 1, mRows.size());
+        buildRows(0, 1);
+        return;
+    }
+    for (rows_t::size_type i = 0; i < mRows.size(); ++i)
+    {
+        if (mRows[i].mItem == item)
+        {
+            buildRows(i > 0 ? i - 1 : 0, i + 2);
+            return;
+        }
+    }
+}
+
+void LLFolderViewFolder::finishDeferredArranges()
+{
+    for (LLFolderViewItem* itemp : mItems)
+    {
+        itemp->finishDeferredArrange();
+    }
+}
+
 // this does prefix traversal, as folders are listed above their contents
 LLFolderViewItem* LLFolderViewFolder::getNextFromChild( LLFolderViewItem* item, bool include_children )
 {
+    buildRowsAround(item);
+
     bool found_item = false;
 
     LLFolderViewItem* result = NULL;
@@ -2389,6 +2738,8 @@ LLFolderViewItem* LLFolderViewFolder::getNextFromChild( LLFolderViewItem* item,
 // this does postfix traversal, as folders are listed above their contents
 LLFolderViewItem* LLFolderViewFolder::getPreviousFromChild( LLFolderViewItem* item, bool include_children )
 {
+    buildRowsAround(item);
+
     bool found_item = false;
 
     LLFolderViewItem* result = NULL;
@@ -97,6 +97,7 @@ protected:
     LLWString                   mLabel;
     S32                         mLabelWidth;
     bool                        mLabelWidthDirty;
+    bool                        mArrangeDeferred;
     S32                         mLabelPaddingRight;
     LLFolderViewFolder*         mParentFolder;
     LLPointer<LLFolderViewModelItem> mViewModelItem;
@@ -189,6 +190,14 @@ public:
     // Finds width and height of this object and it's children.  Also
     // makes sure that this view and it's children are the right size.
     virtual S32 arrange( S32* width, S32* height );
+    // Takes the height of the item only and leaves the rest of arrange()
+    // until the item is next drawn, for rows out of view in large folders.
+    S32 deferArrange( S32* width, S32* height );
+    // Runs the arrange() deferArrange() left for later. The parent folder
+    // calls this before drawing the item rather than the item's draw(),
+    // which subclasses may override without calling it.
+    void finishDeferredArrange();
+    bool isArrangeDeferred() const { return mArrangeDeferred; }
     virtual S32 getItemHeight() const;
     virtual S32 getLabelXPos();
     S32 getIconPad();
@@ -353,10 +362,13 @@ protected:
 public:
     typedef std::list<LLFolderViewItem*> items_t;
     typedef std::list<LLFolderViewFolder*> folders_t;
+    // models of items whose widgets are built once they scroll into view
+    typedef std::list<LLPointer<LLFolderViewModelItem> > unbuilt_items_t;
 
 protected:
     items_t mItems;
     folders_t mFolders;
+    unbuilt_items_t mUnbuiltItems;
 
     bool        mIsOpen;
     bool        mExpanderHighlighted;
@@ -368,6 +380,55 @@ protected:
     bool        mIsFolderComplete; // indicates that some children were not loaded/added yet
     bool        mAreChildrenInited; // indicates that no children were initialized
 
+    // A visible child as of the last arrange, placed by its offset from the
+    // top of the folder. Rows of unbuilt items have no mItem yet.
+    struct row_t
+    {
+        LLFolderViewItem* mItem;
+        unbuilt_items_t::iterator mUnbuilt;
+        S32 mTop;
+        S32 mHeight;
+    };
+    typedef std::vector<row_t> rows_t;
+    // visible children from top to bottom, for drawing only those in view
+    rows_t mRows;
+
+    struct item_layout_params
+    {
+        LLFolderViewModelInterface* mViewModel;
+        S32 mFilterGeneration;
+        S32 mRowHeight;             // of an unbuilt item
+        S32 mParentItemHeight;      // the folder widgets are placed in
+        bool mDeferArrange;
+    };
+
+    // Appends the rows of the items, below running_height. items and
+    // unbuilt are each sorted by the view model and get merged; built
+    // items are arranged and placed, unbuilt ones take a row of their own
+    // height if they pass the filter. Returns the running height below the
+    // last row, target_height and width grow with the rows.
+    static F32 layoutItemRows(const item_layout_params& params, items_t& items, unbuilt_items_t& unbuilt,
+                              F32 running_height, F32& target_height, S32* width, rows_t& rows);
+    // The rows [first, last) that overlap the pixels from top to bottom
+    // below the top of the folder
+    static void getRowRange(const rows_t& rows, S32 top, S32 bottom,
+                            rows_t::size_type& first, rows_t::size_type& last);
+
+    // Draws the rows that overlap the visible part of the folder view,
+    // building the widgets they lack. The caller draws other_children
+    // children of its own that are not rows; returns false if there are
+    // any more, LLView::draw() is needed then. Either way every item about
+    // to be drawn is fully arranged.
+    bool drawVisibleRows(size_t other_children = 0);
+    // Arranges every item left by deferArrange(), for draw() overrides that
+    // draw the items with LLView::draw().
+    void finishDeferredArranges();
+    // Builds the widgets of the rows [first, last) and places them
+    void buildRows(rows_t::size_type first, rows_t::size_type last);
+    // Builds the widgets of the rows next to item, or of the first and last
+    // rows when item is NULL, for keyboard navigation to step onto
+    void buildRowsAround(LLFolderViewItem* item);
+
 public:
     typedef enum e_recurse_type
     {
@@ -506,9 +567,20 @@ public:
     void addItem(LLFolderViewItem* item);
     void addFolder( LLFolderViewFolder* folder);
 
+    // Adds an item by its model alone, LLFolderView::buildItem() makes the
+    // widget once the item is drawn or navigated to
+    void addUnbuiltItem(LLFolderViewModelItem* item);
+    // Builds the widget of an unbuilt item, NULL if it is not one
+    LLFolderViewItem* buildUnbuiltItem(LLFolderViewModelItem* item);
+    void buildUnbuiltItems();
+    unbuilt_items_t::const_iterator getUnbuiltItemsBegin() const { return mUnbuiltItems.begin(); }
+    unbuilt_items_t::const_iterator getUnbuiltItemsEnd() const { return mUnbuiltItems.end(); }
+    unbuilt_items_t::size_type getUnbuiltItemsCount() const { return mUnbuiltItems.size(); }
+
     //WARNING: do not call directly...use the appropriate LLFolderViewModel-derived class instead
     template<typename SORT_FUNC> void sortFolders(const SORT_FUNC& func) { mFolders.sort(func); }
     template<typename SORT_FUNC> void sortItems(const SORT_FUNC& func) { mItems.sort(func); }
+    template<typename SORT_FUNC> void sortUnbuiltItems(const SORT_FUNC& func) { mUnbuiltItems.sort(func); mRows.clear(); }
 };
 
 typedef std::deque<LLFolderViewItem*> folder_view_item_deque;
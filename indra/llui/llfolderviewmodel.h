@@ -128,6 +128,9 @@ public:
     virtual std::string getStatusText(bool is_empty_folder = false) = 0;
 
     virtual bool startDrag(std::vector<LLFolderViewModelItem*>& items) = 0;
+
+    // Whether a is listed before b, for items whose widgets are not built
+    virtual bool sortsBefore(const LLFolderViewModelItem* a, const LLFolderViewModelItem* b) const = 0;
 };
 
 // This is an abstract base class that users of the folderview classes
@@ -466,6 +469,11 @@ public:
             return mSorter(static_cast<const ItemType*>(a->getViewModelItem()), static_cast<const ItemType*>(b->getViewModelItem()));
         }
 
+        bool operator () (const LLPointer<LLFolderViewModelItem>& a, const LLPointer<LLFolderViewModelItem>& b) const
+        {
+            return mSorter(static_cast<const ItemType*>(a.get()), static_cast<const ItemType*>(b.get()));
+        }
+
         const SortType& mSorter;
     };
 
@@ -475,11 +483,17 @@ public:
         {
             folder->sortFolders(ViewModelCompare(getSorter()));
             folder->sortItems(ViewModelCompare(getSorter()));
+            folder->sortUnbuiltItems(ViewModelCompare(getSorter()));
             folder->getViewModelItem()->setSortVersion(mTargetSortVersion);
             folder->requestArrange();
         }
     }
 
+    bool sortsBefore(const LLFolderViewModelItem* a, const LLFolderViewModelItem* b) const
+    {
+        return getSorter()(static_cast<const ItemType*>(a), static_cast<const ItemType*>(b));
+    }
+
 protected:
     std::unique_ptr<SortType>       mSorter;
     std::unique_ptr<FilterType>     mFilter;
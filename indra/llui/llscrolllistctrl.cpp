@@ -45,6 +45,7 @@
 #include "llresmgr.h"
 #include "llscrollbar.h"
 #include "llscrolllistcell.h"
+#include "llscrolllistsortkey.h"
 #include "llstring.h"
 #include "llui.h"
 #include "lluictrlfactory.h"
@@ -201,6 +202,8 @@ LLScrollListCtrl::LLScrollListCtrl(const LLScrollListCtrl::Params& p)
     mHighlightedItem(-1),
     mBorder(NULL),
     mSortCallback(NULL),
+    mDataProvider(NULL),
+    mPendingCellRows(0),
     mNumDynamicWidthColumns(0),
     mTotalStaticColumnWidth(0),
     mTotalColumnPadding(0),
@@ -358,6 +361,7 @@ S32 LLScrollListCtrl::getSearchColumn()
         LLScrollListItem* itemp = getFirstData();
         if (itemp)
         {
+            buildRowCells(itemp);
             for(S32 column = 0; column < getNumColumns(); column++)
             {
                 LLScrollListCell* cell = itemp->getColumn(column);
@@ -445,6 +449,7 @@ S32 LLScrollListCtrl::getItemCount() const
         for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
         {
             LLScrollListItem* item  = *iter;
+            buildRowCells(item);
             std::string filterColumnValue = item->getColumn(mFilterColumn)->getValue().asString();
             std::transform(filterColumnValue.begin(), filterColumnValue.end(), filterColumnValue.begin(), ::tolower);
             if (filterColumnValue.find(mFilterString) == std::string::npos)
@@ -480,6 +485,7 @@ void LLScrollListCtrl::clearRows()
 {
     std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
     mItemList.clear();
+    mPendingCellRows = 0;
     //mItemCount = 0;
 
     // Scroll the bar back up to the top.
@@ -1375,6 +1381,7 @@ LLScrollListItem* LLScrollListCtrl::getItemByLabel(const std::string& label, boo
     {
         return NULL;
     }
+    buildAllRowCells();
 
     std::string target_text = label;
     if (!case_sensitive)
@@ -1424,6 +1431,7 @@ bool LLScrollListCtrl::selectItemByStringMatch(const LLWString& target, bool pre
 // </FS:Ansariel>
 {
     bool found = false;
+    buildAllRowCells();
 
     LLWString target_trimmed( target );
     auto target_len = target_trimmed.size();
@@ -1526,6 +1534,7 @@ U32 LLScrollListCtrl::searchItems(const LLWString& substring, bool case_sensitiv
     else
     {
         deselectAllItems(true);
+        buildAllRowCells();
         if (!case_sensitive)
         {
             // do comparisons in lower case
@@ -1610,6 +1619,7 @@ std::string LLScrollListCtrl::getSelectedItemLabel(S32 column) const
     item = getFirstSelected();
     if (item)
     {
+        buildRowCells(item);
         if (LLScrollListCell* cell = item->getColumn(column))
         {
             return cell->getValue().asString();
@@ -1807,6 +1817,7 @@ void LLScrollListCtrl::drawItems()
                 mLineHeight );
             item->setRect(item_rect);
 
+            buildRowCells(item);
             max_columns = llmax(max_columns, item->getNumColumns());
 
             LLColor4 fg_color;
@@ -2919,6 +2930,7 @@ bool LLScrollListCtrl::handleUnicodeCharHere(llwchar uni_char)
 
     // type ahead search is case insensitive
     uni_char = LLStringOps::toLower((llwchar)uni_char);
+    buildAllRowCells();
 
     if (selectItemByPrefix(wstring_to_utf8str(mSearchString + (llwchar)uni_char), false))
     {
@@ -3022,6 +3034,8 @@ bool LLScrollListCtrl::isRepeatedChars(const LLWString& string) const
 
 void LLScrollListCtrl::selectItem(LLScrollListItem* itemp, S32 cell, bool select_single_item)
 {
+    // selected rows are what callers read cells from
+    buildRowCells(itemp);
     if (itemp && !itemp->getSelected())
     {
         if (mLastSelected)
@@ -3177,11 +3191,20 @@ void LLScrollListCtrl::updateSort() const
     {
         mLastUpdateFrame=0;
     // </FS:Beq>
-        // do stable sort to preserve any previous sorts
-        std::stable_sort(
-            mItemList.begin(),
-            mItemList.end(),
-            SortScrollListItem(mSortColumns,mSortCallback, mAlternateSort));
+        if (mDataProvider && !mSortCallback)
+        {
+            sortOnKeys(mSortColumns);
+        }
+        else
+        {
+            // sort callbacks look at the cells
+            buildAllRowCells();
+            // do stable sort to preserve any previous sorts
+            std::stable_sort(
+                mItemList.begin(),
+                mItemList.end(),
+                SortScrollListItem(mSortColumns,mSortCallback, mAlternateSort));
+        }
 
         mSorted = true;
     }
@@ -3193,6 +3216,13 @@ void LLScrollListCtrl::sortOnce(S32 column, bool ascending)
     std::vector<std::pair<S32, bool> > sort_column;
     sort_column.push_back(std::make_pair(column, ascending));
 
+    if (mDataProvider && !mSortCallback)
+    {
+        sortOnKeys(sort_column);
+        return;
+    }
+
+    buildAllRowCells();
     // do stable sort to preserve any previous sorts
     std::stable_sort(
         mItemList.begin(),
@@ -3200,6 +3230,48 @@ void LLScrollListCtrl::sortOnce(S32 column, bool ascending)
         SortScrollListItem(sort_column,mSortCallback,mAlternateSort));
 }
 
+// Same order as SortScrollListItem, but every row and column is looked up
+// once rather than on every comparison, and without building cells.
+void LLScrollListCtrl::sortOnKeys(const std::vector<std::pair<S32, bool> >& sort_orders) const
+{
+    const size_t num_orders = sort_orders.size();
+    const size_t num_rows = mItemList.size();
+    if (!num_orders || num_rows < 2)
+    {
+        return;
+    }
+
+    std::vector<LLScrollListSortKey> keys;
+    keys.reserve(num_rows * num_orders);
+    for (const LLScrollListItem* item : mItemList)
+    {
+        for (const auto& sort_order : sort_orders)
+        {
+            const S32 column = sort_order.first;
+            LLSD value;
+            if (item->mProviderRow >= 0)
+            {
+                if (column >= 0 && column < (S32)mColumnsIndexed.size() && mColumnsIndexed[column])
+                {
+                    value = mDataProvider->getSortKey(item->mProviderRow, mColumnsIndexed[column]->mName);
+                }
+            }
+            else if (const LLScrollListCell* cell = item->getColumn(column))
+            {
+                value = (mAlternateSort && !cell->getAltValue().asString().empty()) ? cell->getAltValue() : cell->getValue();
+            }
+            keys.emplace_back(value);
+        }
+    }
+
+    item_list sorted;
+    for (U32 row : ll_sort_scroll_list_keys(keys, sort_orders))
+    {
+        sorted.push_back(mItemList[row]);
+    }
+    mItemList.swap(sorted);
+}
+
 void LLScrollListCtrl::dirtyColumns()
 {
     mColumnsDirty = true;
@@ -3287,6 +3359,7 @@ void LLScrollListCtrl::copy()
     std::vector<LLScrollListItem*>::iterator itor;
     for (itor = items.begin(); itor != items.end(); ++itor)
     {
+        buildRowCells(*itor);
         buffer += (*itor)->getContentsCSV() + "\n";
     }
     LLClipboard::instance().copyToClipboard(utf8str_to_wstring(buffer), 0, static_cast<S32>(buffer.length()));
@@ -3619,6 +3692,13 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
     if (!item_p.validateBlock() || !new_item) return NULL;
+    addCells(new_item, item_p);
+    addItem(new_item, pos);
+    return new_item;
+}
+
+void LLScrollListCtrl::addCells(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p)
+{
     new_item->setNumColumns(static_cast<S32>(mColumns.size()));
 
     // Add any columns we don't already have
@@ -3705,6 +3785,11 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
         }
     }
 
+    addSpacerCells(new_item);
+}
+
+void LLScrollListCtrl::addSpacerCells(LLScrollListItem* new_item)
+{
     // add dummy cells for missing columns
     for (column_map_t::iterator column_it = mColumns.begin(); column_it != mColumns.end(); ++column_it)
     {
@@ -3718,9 +3803,94 @@ LLScrollListItem* LLScrollListCtrl::addRow(LLScrollListItem *new_item, const LLS
             new_item->setColumn(column_idx, new LLScrollListSpacer(cell_p));
         }
     }
+}
 
-    addItem(new_item, pos);
-    return new_item;
+void LLScrollListCtrl::setDataProvider(LLScrollListDataProvider* provider)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_UI;
+    clearRows();
+    mDataProvider = provider;
+    if (!provider)
+    {
+        return;
+    }
+
+    // rows start out as their value and empty placeholder cells, so that
+    // callers looking at a row before it is drawn never find a NULL cell;
+    // see buildRowCells()
+    const S32 count = llmin(provider->getRowCount(), mMaxItemCount);
+    for (S32 row = 0; row < count; ++row)
+    {
+        LLScrollListItem::Params item_p;
+        item_p.value = provider->getRowValue(row);
+        LLScrollListItem* item = new LLScrollListItem(item_p);
+        item->mProviderRow = row;
+        item->mCellsPending = true;
+        item->setNumColumns(static_cast<S32>(mColumns.size()));
+        addSpacerCells(item);
+        mItemList.push_back(item);
+    }
+    mPendingCellRows = count;
+
+    if (!mItemList.empty())
+    {
+        // the line height comes from the cells, assume they are all alike
+        buildRowCells(mItemList.front());
+    }
+    setNeedsSort();
+    updateLayout();
+}
+
+void LLScrollListCtrl::buildRowCells(LLScrollListItem* item) const
+{
+    if (!item || !item->mCellsPending)
+    {
+        return;
+    }
+    item->mCellsPending = false;
+    if (!mDataProvider || item->mProviderRow >= mDataProvider->getRowCount())
+    {
+        return;
+    }
+
+    LLScrollListItem::Params item_p;
+    LLParamSDParser parser;
+    parser.readSD(mDataProvider->getRow(item->mProviderRow), item_p);
+    if (!item_p.validateBlock())
+    {
+        return;
+    }
+    item->setEnabled(item_p.enabled);
+    item->mItemAltValue = item_p.alt_value;
+
+    // the cells are a cache of the provider's rows, building them does not
+    // change the list as far as callers can tell
+    LLScrollListCtrl* self = const_cast<LLScrollListCtrl*>(this);
+    self->addCells(item, item_p);
+
+    S32 num_cols = item->getNumColumns();
+    S32 i = 0;
+    for (LLScrollListCell* cell = item->getColumn(i); i < num_cols; cell = item->getColumn(++i))
+    {
+        if (i >= (S32)mColumnsIndexed.size())
+            break;
+
+        cell->setWidth(mColumnsIndexed[i]->getWidth());
+    }
+    self->updateLineHeightInsert(item);
+    mDataProvider->decorateRow(item->mProviderRow, item);
+}
+
+void LLScrollListCtrl::buildAllRowCells() const
+{
+    if (mPendingCellRows > 0)
+    {
+        for (LLScrollListItem* item : mItemList)
+        {
+            buildRowCells(item);
+        }
+        mPendingCellRows = 0;
+    }
 }
 
 LLScrollListItem* LLScrollListCtrl::addSimpleElement(const std::string& value, EAddPosition pos, const LLSD& id)
@@ -3866,6 +4036,7 @@ bool LLScrollListCtrl::highlightMatchingItems(const std::string& filter_str)
     std::string filter_str_lc(filter_str);
     LLStringUtil::toLower(filter_str_lc);
 
+    buildAllRowCells();
     std::vector<LLScrollListItem*> data = getAllData();
     std::vector<LLScrollListItem*>::iterator iter = data.begin();
     while (iter != data.end())
@@ -3915,6 +4086,7 @@ bool LLScrollListCtrl::isFiltered(const LLScrollListItem* item) const
 {
     if (mIsFiltered)
     {
+        buildRowCells(const_cast<LLScrollListItem*>(item));
         std::string filterColumnValue = item->getColumn(mFilterColumn)->getValue().asString();
         std::transform(filterColumnValue.begin(), filterColumnValue.end(), filterColumnValue.begin(), ::tolower);
         if (filterColumnValue.find(mFilterString) == std::string::npos)
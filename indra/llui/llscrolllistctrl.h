@@ -50,6 +50,28 @@ class LLScrollListCell;
 class LLTextBox;
 class LLContextMenu;
 
+//---------------------------------------------------------------------------
+// LLScrollListDataProvider
+// Source of the rows of a list too long to build every row of up front,
+// see LLScrollListCtrl::setDataProvider(). Rows are identified by index.
+//---------------------------------------------------------------------------
+class LLScrollListDataProvider
+{
+public:
+    virtual ~LLScrollListDataProvider() {}
+
+    virtual S32 getRowCount() const = 0;
+    // What LLScrollListItem::getValue() returns for the row
+    virtual LLSD getRowValue(S32 row) const = 0;
+    // The row in the format taken by LLScrollListCtrl::addElement()
+    virtual LLSD getRow(S32 row) const = 0;
+    // What the row sorts by in the named column, a string or a number
+    virtual LLSD getSortKey(S32 row, const std::string& column) const = 0;
+    // Called once the cells of the row are built from getRow(), for what
+    // the addElement() format cannot describe (font styles, colors)
+    virtual void decorateRow(S32 row, LLScrollListItem* item) const {}
+};
+
 class LLScrollListCtrl : public LLUICtrl, public LLEditMenuHandler,
     public LLCtrlListInterface, public LLCtrlScrollInterface
 {
@@ -197,6 +219,13 @@ public:
     virtual void clearRows(); // clears all elements
     virtual void sortByColumn(const std::string& name, bool ascending);
 
+    // Fills the list with the rows of provider, which has to outlive the
+    // list or be replaced. Rows hold empty spacer cells until they are
+    // drawn, selected or searched, and sort on the keys of the provider.
+    // Call again when the rows of the provider change; NULL empties the list.
+    void            setDataProvider(LLScrollListDataProvider* provider);
+    LLScrollListDataProvider* getDataProvider() const { return mDataProvider; }
+
     // These functions take and return an array of arrays of elements, as above
     virtual void    setValue(const LLSD& value );
     virtual LLSD    getValue() const;
@@ -493,6 +522,12 @@ private:
     void            drawItems();
 
     void            updateLineHeightInsert(LLScrollListItem* item);
+    void            addCells(LLScrollListItem* new_item, const LLScrollListItem::Params& item_p);
+    void            addSpacerCells(LLScrollListItem* new_item);
+    // cells of the rows of the data provider are built on demand
+    void            buildRowCells(LLScrollListItem* item) const;
+    void            buildAllRowCells() const;
+    void            sortOnKeys(const std::vector<std::pair<S32, bool> >& sort_orders) const;
     void            reportInvalidInput();
     bool            isRepeatedChars(const LLWString& string) const;
     void            selectItem(LLScrollListItem* itemp, S32 cell, bool single_select = true);
@@ -615,6 +650,9 @@ private:
 
     sort_signal_t*  mSortCallback;
 
+    LLScrollListDataProvider* mDataProvider;
+    mutable S32     mPendingCellRows;   // upper bound of rows without cells
+
     is_friend_signal_t* mIsFriendSignal;
 
     friend class LLComboBox;
@@ -45,7 +45,9 @@ LLScrollListItem::LLScrollListItem( const Params& p )
     mEnabled(p.enabled),
     mUserdata(p.userdata),
     mItemValue(p.value),
-    mItemAltValue(p.alt_value)
+    mItemAltValue(p.alt_value),
+    mProviderRow(-1),
+    mCellsPending(false)
 {
 }
 
@@ -137,6 +137,8 @@ private:
     LLSD    mItemAltValue;
     std::vector<LLScrollListCell *> mColumns;
     LLRect  mRectangle;
+    S32     mProviderRow;   // index in the list's data provider, or -1
+    bool    mCellsPending;  // row of a data provider whose cells are not built yet
 };
 
 #endif
@@ -0,0 +1,104 @@
+/**
+ * @file llscrolllistsortkey.h
+ * @brief Sort keys of the rows of a scroll list data provider, see
+ * LLScrollListCtrl::setDataProvider().
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LLSCROLLLISTSORTKEY_H
+#define LLSCROLLLISTSORTKEY_H
+
+#include "llsd.h"
+#include "llstring.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// What a row sorts by in one column: a number, or a string compared the way
+// SortScrollListItem compares cell values. Numbers sort ahead of strings.
+struct LLScrollListSortKey
+{
+    std::string mString;
+    F64         mNumber = 0.0;
+    bool        mIsNumber = false;
+
+    LLScrollListSortKey() = default;
+    explicit LLScrollListSortKey(const LLSD& value)
+    :   mIsNumber(value.isReal() || value.isInteger())
+    {
+        if (mIsNumber)
+        {
+            mNumber = value.asReal();
+        }
+        else
+        {
+            mString = value.asString();
+        }
+    }
+
+    S32 compare(const LLScrollListSortKey& other) const
+    {
+        if (mIsNumber && other.mIsNumber)
+        {
+            return mNumber < other.mNumber ? -1 : (other.mNumber < mNumber ? 1 : 0);
+        }
+        if (mIsNumber != other.mIsNumber)
+        {
+            return mIsNumber ? -1 : 1;
+        }
+        return LLStringUtil::compareDict(mString, other.mString);
+    }
+};
+
+// Stable sorts row indices on keys, which holds sort_orders.size() keys per
+// row, row by row. As with LLScrollListCtrl::mSortColumns, the last sort
+// order takes precedence and the second of each pair is true for ascending.
+inline std::vector<U32> ll_sort_scroll_list_keys(const std::vector<LLScrollListSortKey>& keys,
+                                                 const std::vector<std::pair<S32, bool> >& sort_orders)
+{
+    const size_t num_orders = sort_orders.size();
+    const size_t num_rows = num_orders ? keys.size() / num_orders : 0;
+
+    std::vector<U32> order(num_rows);
+    for (U32 row = 0; row < (U32)num_rows; ++row)
+    {
+        order[row] = row;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](U32 row1, U32 row2)
+    {
+        for (size_t i = num_orders; i-- > 0; )
+        {
+            S32 result = keys[row1 * num_orders + i].compare(keys[row2 * num_orders + i]);
+            if (result != 0)
+            {
+                return sort_orders[i].second ? result < 0 : result > 0;
+            }
+        }
+        return false;
+    });
+    return order;
+}
+
+#endif // LLSCROLLLISTSORTKEY_H
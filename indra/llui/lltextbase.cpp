@@ -1760,23 +1760,166 @@ void LLTextBase::updateScrollFromCursor()
 
 S32 LLTextBase::getLeftOffset(S32 width)
 {
-    switch (mHAlign)
+    return getLeftOffset(getLineLayoutParams(), width);
+}
+
+// static
+S32 LLTextBase::getLeftOffset(const line_layout_params& params, S32 width)
+{
+    switch (params.mHAlign)
     {
     case LLFontGL::LEFT:
-        return mHPad;
+        return params.mHPad;
     case LLFontGL::HCENTER:
-        return mHPad + llmax(0, (mVisibleTextRect.getWidth() - width - mHPad) / 2);
+        return params.mHPad + llmax(0, (params.mVisibleWidth - width - params.mHPad) / 2);
     case LLFontGL::RIGHT:
         {
             // Font's rendering rounds string size, if value gets rounded
             // down last symbol might not have enough space to render,
             // compensate by adding an extra pixel as padding
             const S32 right_padding = 1;
-            return llmax(mHPad, mVisibleTextRect.getWidth() - width - right_padding);
+            return llmax(params.mHPad, params.mVisibleWidth - width - right_padding);
         }
     default:
-        return mHPad;
+        return params.mHPad;
+    }
+}
+
+LLTextBase::line_layout_params LLTextBase::getLineLayoutParams() const
+{
+    line_layout_params params;
+    params.mVisibleWidth = mVisibleTextRect.getWidth();
+    params.mHPad = mHPad;
+    params.mHAlign = mHAlign;
+    params.mWordWrap = getWordWrap();
+    params.mLineSpacingMult = mLineSpacingMult;
+    params.mLineSpacingPixels = mLineSpacingPixels;
+    return params;
+}
+
+// static
+S32 LLTextBase::reflowLines(const line_layout_params& params, const segment_set_t& segments,
+                            S32 start_index, line_list_t& lines)
+{
+    S32 cur_top = 0;
+
+    segment_set_t::const_iterator seg_iter = segments.begin();
+    S32 seg_offset = 0;
+    S32 line_start_index = 0;
+    const F32 text_available_width = (F32)(params.mVisibleWidth - params.mHPad);  // reserve room for margin
+    F32 remaining_pixels = text_available_width;
+    S32 line_count = 0;
+
+    // find and erase line info structs starting at start_index and going to end of document
+    if (!lines.empty())
+    {
+        // find first element whose end comes after start_index
+        line_list_t::iterator iter = std::upper_bound(lines.begin(), lines.end(), start_index, line_end_compare());
+        if (iter == lines.end())
+        {
+            // text was appended after the last line, so only that line
+            // can change, everything above it keeps its layout
+            --iter;
+        }
+        line_start_index = iter->mDocIndexStart;
+        line_count = iter->mLineNum;
+        cur_top = iter->mRect.mTop;
+        seg_iter = getSegIterContaining(segments, line_start_index);
+        seg_offset = seg_iter != segments.end() ? line_start_index - (*seg_iter)->getStart() : 0;
+        lines.erase(iter, lines.end());
+    }
+    const S32 reflow_start_index = line_start_index;
+
+    S32 line_height = 0;
+    S32 seg_line_offset = line_count + 1;
+
+    while(seg_iter != segments.end())
+    {
+        LLTextSegmentPtr segment = *seg_iter;
+
+        // track maximum height of any segment on this line
+        S32 cur_index = segment->getStart() + seg_offset;
+
+        // ask segment how many character fit in remaining space
+        S32 character_count = segment->getNumChars(params.mWordWrap ? llmax(0, ll_round(remaining_pixels)) : S32_MAX,
+                                                    seg_offset,
+                                                    cur_index - line_start_index,
+                                                    S32_MAX,
+                                                    line_count - seg_line_offset);
+
+        F32 segment_width;
+        S32 segment_height;
+        bool force_newline = segment->getDimensionsF32(seg_offset, character_count, segment_width, segment_height);
+        // grow line height as necessary based on reported height of this segment
+        line_height = llmax(line_height, segment_height);
+        remaining_pixels -= segment_width;
+
+        seg_offset += character_count;
+
+        S32 last_segment_char_on_line = segment->getStart() + seg_offset;
+
+        // Note: make sure text will fit in width - use ceil, but also make sure
+        // ceil is used only once per line
+        S32 text_actual_width = llceil(text_available_width - remaining_pixels);
+        S32 text_left = getLeftOffset(params, text_actual_width);
+        LLRect line_rect(text_left,
+                        cur_top,
+                        text_left + text_actual_width,
+                        cur_top - line_height);
+
+        // if we didn't finish the current segment...
+        if (last_segment_char_on_line < segment->getEnd())
+        {
+            // add line info and keep going
+            lines.push_back(line_info(
+                                        line_start_index,
+                                        last_segment_char_on_line,
+                                        line_rect,
+                                        line_count));
+
+            line_start_index = segment->getStart() + seg_offset;
+            cur_top -= ll_round((F32)line_height * params.mLineSpacingMult) + params.mLineSpacingPixels;
+            remaining_pixels = text_available_width;
+            line_height = 0;
+        }
+        // ...just consumed last segment..
+        else if (++segment_set_t::const_iterator(seg_iter) == segments.end())
+        {
+            lines.push_back(line_info(
+                                        line_start_index,
+                                        last_segment_char_on_line,
+                                        line_rect,
+                                        line_count));
+            cur_top -= ll_round((F32)line_height * params.mLineSpacingMult) + params.mLineSpacingPixels;
+            break;
+        }
+        // ...or finished a segment and there are segments remaining on this line
+        else
+        {
+            // subtract pixels used and increment segment
+            if (force_newline)
+            {
+                lines.push_back(line_info(
+                                            line_start_index,
+                                            last_segment_char_on_line,
+                                            line_rect,
+                                            line_count));
+                line_start_index = segment->getStart() + seg_offset;
+                cur_top -= ll_round((F32)line_height * params.mLineSpacingMult) + params.mLineSpacingPixels;
+                line_height = 0;
+                remaining_pixels = text_available_width;
+            }
+            ++seg_iter;
+            seg_offset = 0;
+            seg_line_offset = force_newline ? line_count + 1 : line_count;
+        }
+        if (force_newline)
+        {
+            line_count++;
+        }
     }
+
+    return reflow_start_index;
 }
 
 void LLTextBase::reflow()
@@ -1837,118 +1980,8 @@ void LLTextBase::reflow()
             mDocumentView->reshape(mVisibleTextRect.getWidth(), mDocumentView->getRect().getHeight());
         }
 
-        S32 cur_top = 0;
-
-        segment_set_t::iterator seg_iter = mSegments.begin();
-        S32 seg_offset = 0;
-        S32 line_start_index = 0;
-        const F32 text_available_width = (F32)(mVisibleTextRect.getWidth() - mHPad);  // reserve room for margin
-        F32 remaining_pixels = text_available_width;
-        S32 line_count = 0;
-
-        // find and erase line info structs starting at start_index and going to end of document
-        if (!mLineInfoList.empty())
-        {
-            // find first element whose end comes after start_index
-            line_list_t::iterator iter = std::upper_bound(mLineInfoList.begin(), mLineInfoList.end(), start_index, line_end_compare());
-            if (iter != mLineInfoList.end())
-            {
-                line_start_index = iter->mDocIndexStart;
-                line_count = iter->mLineNum;
-                cur_top = iter->mRect.mTop;
-                getSegmentAndOffset(iter->mDocIndexStart, &seg_iter, &seg_offset);
-                mLineInfoList.erase(iter, mLineInfoList.end());
-            }
-        }
-
-        S32 line_height = 0;
-        S32 seg_line_offset = line_count + 1;
-
-        while(seg_iter != mSegments.end())
-        {
-            LLTextSegmentPtr segment = *seg_iter;
-
-            // track maximum height of any segment on this line
-            S32 cur_index = segment->getStart() + seg_offset;
-
-            // ask segment how many character fit in remaining space
-            S32 character_count = segment->getNumChars(getWordWrap() ? llmax(0, ll_round(remaining_pixels)) : S32_MAX,
-                                                        seg_offset,
-                                                        cur_index - line_start_index,
-                                                        S32_MAX,
-                                                        line_count - seg_line_offset);
-
-            F32 segment_width;
-            S32 segment_height;
-            bool force_newline = segment->getDimensionsF32(seg_offset, character_count, segment_width, segment_height);
-            // grow line height as necessary based on reported height of this segment
-            line_height = llmax(line_height, segment_height);
-            remaining_pixels -= segment_width;
-
-            seg_offset += character_count;
-
-            S32 last_segment_char_on_line = segment->getStart() + seg_offset;
-
-            // Note: make sure text will fit in width - use ceil, but also make sure
-            // ceil is used only once per line
-            S32 text_actual_width = llceil(text_available_width - remaining_pixels);
-            S32 text_left = getLeftOffset(text_actual_width);
-            LLRect line_rect(text_left,
-                            cur_top,
-                            text_left + text_actual_width,
-                            cur_top - line_height);
-
-            // if we didn't finish the current segment...
-            if (last_segment_char_on_line < segment->getEnd())
-            {
-                // add line info and keep going
-                mLineInfoList.push_back(line_info(
-                                            line_start_index,
-                                            last_segment_char_on_line,
-                                            line_rect,
-                                            line_count));
-
-                line_start_index = segment->getStart() + seg_offset;
-                cur_top -= ll_round((F32)line_height * mLineSpacingMult) + mLineSpacingPixels;
-                remaining_pixels = text_available_width;
-                line_height = 0;
-            }
-            // ...just consumed last segment..
-            else if (++segment_set_t::iterator(seg_iter) == mSegments.end())
-            {
-                mLineInfoList.push_back(line_info(
-                                            line_start_index,
-                                            last_segment_char_on_line,
-                                            line_rect,
-                                            line_count));
-                cur_top -= ll_round((F32)line_height * mLineSpacingMult) + mLineSpacingPixels;
-                break;
-            }
-            // ...or finished a segment and there are segments remaining on this line
-            else
-            {
-                // subtract pixels used and increment segment
-                if (force_newline)
-                {
-                    mLineInfoList.push_back(line_info(
-                                                line_start_index,
-                                                last_segment_char_on_line,
-                                                line_rect,
-                                                line_count));
-                    line_start_index = segment->getStart() + seg_offset;
-                    cur_top -= ll_round((F32)line_height * mLineSpacingMult) + mLineSpacingPixels;
-                    line_height = 0;
-                    remaining_pixels = text_available_width;
-                }
-                ++seg_iter;
-                seg_offset = 0;
-                seg_line_offset = force_newline ? line_count + 1 : line_count;
-            }
-            if (force_newline)
-            {
-                line_count++;
-            }
-        }
+        // segments ending before this point kept their layout
+        const S32 reflow_start_index = reflowLines(getLineLayoutParams(), mSegments, start_index, mLineInfoList);
 
         // calculate visible region for diplaying text
         updateRects();
@@ -1958,8 +1991,12 @@ void LLTextBase::reflow()
             ++segment_it)
         {
             LLTextSegmentPtr segmentp = *segment_it;
-            segmentp->updateLayout(*this);
-
+            // text before the reflowed lines is unchanged and stays where
+            // it was, so those segments keep their font buffers
+            if (segmentp->getEnd() >= reflow_start_index || segmentp->followsLineLayout())
+            {
+                segmentp->updateLayout(*this);
+            }
         }
     }
 
@@ -2214,15 +2251,21 @@ LLTextBase::segment_set_t::iterator LLTextBase::getSegIterContaining(S32 index)
 }
 
 LLTextBase::segment_set_t::const_iterator LLTextBase::getSegIterContaining(S32 index) const
+{
+    return getSegIterContaining(mSegments, index);
+}
+
+// static
+LLTextBase::segment_set_t::const_iterator LLTextBase::getSegIterContaining(const segment_set_t& segments, S32 index)
 {
     static LLPointer<LLIndexSegment> index_segment = new LLIndexSegment();
 
     // when there are no segments, we return the end iterator, which must be checked by caller
-    if (mSegments.size() <= 1) { return mSegments.begin(); }
+    if (segments.size() <= 1) { return segments.begin(); }
 
     index_segment->setStart(index);
     index_segment->setEnd(index);
-    LLTextBase::segment_set_t::const_iterator it =  mSegments.upper_bound(index_segment);
+    LLTextBase::segment_set_t::const_iterator it =  segments.upper_bound(index_segment);
 
     return it;
 }
@@ -2648,8 +2691,37 @@ S32 LLTextBase::removeFirstLine()
     if (!mLineInfoList.empty())
     {
         S32 length = getLineEnd(0);
+        // with an up to date layout the remaining lines only move up, so
+        // shift them instead of reflowing the whole document. This is still
+        // linear in lines and segments, it only saves re-measuring the text.
+        // All segments moved, so their font buffers regenerate on next draw
+        bool shift_lines = mReflowIndex == S32_MAX && mLineInfoList.size() > 1;
         deselect();
         removeStringNoUndo(0, length);
+        if (shift_lines)
+        {
+            S32 delta_y = mLineInfoList[0].mRect.mTop - mLineInfoList[1].mRect.mTop;
+            S32 delta_line_num = mLineInfoList[1].mLineNum;
+            mLineInfoList.erase(mLineInfoList.begin());
+            for (line_info& line : mLineInfoList)
+            {
+                line.mDocIndexStart -= length;
+                line.mDocIndexEnd -= length;
+                line.mRect.translate(0, delta_y);
+                line.mLineNum -= delta_line_num;
+            }
+
+            // a segment that started in the removed line now starts at 0
+            segment_set_t::iterator seg_iter = getSegIterContaining(0);
+            if (seg_iter != mSegments.end())
+            {
+                LLTextSegmentPtr segmentp = *seg_iter;
+                segmentp->updateLayout(*this);
+            }
+
+            // relaying out the last line brings the document rect up to date
+            mReflowIndex = mLineInfoList.back().mDocIndexStart;
+        }
         return length;
     }
     return 0;
@@ -3684,8 +3756,7 @@ LLNormalTextSegment::LLNormalTextSegment( LLStyleConstSP style, S32 start, S32 e
 :   LLTextSegment(start, end),
     mStyle( style ),
     mToken(NULL),
-    mEditor(editor),
-    mLastGeneration(-1)
+    mEditor(editor)
 {
     mFontHeight = mStyle->getFont()->getLineHeight();
 
@@ -3699,8 +3770,7 @@ LLNormalTextSegment::LLNormalTextSegment( LLStyleConstSP style, S32 start, S32 e
 LLNormalTextSegment::LLNormalTextSegment( const LLUIColor& color, S32 start, S32 end, LLTextBase& editor, bool is_visible)
 :   LLTextSegment(start, end),
     mToken(NULL),
-    mEditor(editor),
-    mLastGeneration(-1)
+    mEditor(editor)
 {
     mStyle = new LLStyle(LLStyle::Params().visible(is_visible).color(color));
 
@@ -3739,17 +3809,10 @@ F32 LLNormalTextSegment::drawClippedSegment(S32 seg_start, S32 seg_end, S32 sele
 
     F32 alpha = LLViewDrawContext::getCurrentContext().mAlpha;
 
+    // The font buffers regenerate themselves when where and how much of
+    // the text is drawn changes, and reflow() drops them through
+    // updateLayout() when the text itself changes
     const LLWString& text = getWText();
-    S32 text_gen = mEditor.getTextGeneration();
-
-    if (text_gen != mLastGeneration)
-    {
-        mLastGeneration = text_gen;
-
-        mFontBufferPreSelection.reset();
-        mFontBufferSelection.reset();
-        mFontBufferPostSelection.reset();
-    }
 
     const LLFontGL* font = mStyle->getFont();
     LLColor4 color = (mEditor.getReadOnly() ? mStyle->getReadOnlyColor() : mStyle->getColor())  % (alpha * mStyle->getAlpha());
@@ -3781,8 +3844,6 @@ F32 LLNormalTextSegment::drawClippedSegment(S32 seg_start, S32 seg_end, S32 sele
             // Font buffer doesn't do well with changes and huge notecard with a bunch
             // of segments will see a lot of buffer updates, so instead use derect
             // rendering to cache.
-            // Todo: instead of mLastGeneration make buffer invalidation more fine grained
-            // like string hash of a given segment.
             font->render(
                 text, start,
                 rect,
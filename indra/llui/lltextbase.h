@@ -84,6 +84,8 @@ public:
     */
     virtual S32                 getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     virtual void                updateLayout(const class LLTextBase& editor);
+    // true if updateLayout() has to run whenever lines move, not only when the segment itself was reflowed
+    virtual bool                followsLineLayout() const { return false; }
     virtual F32                 draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     virtual bool                canEdit() const;
     virtual void                unlinkFromDocument(class LLTextBase* editor);
@@ -174,7 +176,6 @@ protected:
     LLFontVertexBuffer  mFontBufferPreSelection;
     LLFontVertexBuffer  mFontBufferSelection;
     LLFontVertexBuffer  mFontBufferPostSelection;
-    S32                 mLastGeneration = -1;
 };
 
 // This text segment is the same as LLNormalTextSegment, the only difference
@@ -249,6 +250,7 @@ public:
     /*virtual*/ bool        getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const;
     /*virtual*/ S32         getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const;
     /*virtual*/ void        updateLayout(const class LLTextBase& editor);
+    /*virtual*/ bool        followsLineLayout() const { return true; }
     /*virtual*/ F32         draw(S32 start, S32 end, S32 selection_start, S32 selection_end, const LLRectf& draw_rect);
     /*virtual*/ bool        canEdit() const { return false; }
     /*virtual*/ void        unlinkFromDocument(class LLTextBase* editor);
@@ -588,6 +590,17 @@ protected:
     };
     typedef std::vector<line_info> line_list_t;
 
+    // Widget state reflowLines() needs besides the segments
+    struct line_layout_params
+    {
+        S32                 mVisibleWidth;
+        S32                 mHPad;
+        LLFontGL::HAlign    mHAlign;
+        bool                mWordWrap;
+        F32                 mLineSpacingMult;
+        S32                 mLineSpacingPixels;
+    };
+
     // helper structs
     struct compare_bottom
     {
@@ -698,6 +711,14 @@ protected:
     std::pair<S32, S32>             getVisibleLines(bool fully_visible = false);
     S32                             getLeftOffset(S32 width);
     void                            reflow();
+    line_layout_params              getLineLayoutParams() const;
+    // Lays the lines out again from the one containing start_index to the
+    // end of the document, using only the segments' own metrics. Returns
+    // the document index the first new line starts at
+    static S32                      reflowLines(const line_layout_params& params, const segment_set_t& segments,
+                                                S32 start_index, line_list_t& lines);
+    static S32                      getLeftOffset(const line_layout_params& params, S32 width);
+    static segment_set_t::const_iterator getSegIterContaining(const segment_set_t& segments, S32 index);
 
     // cursor
     void                            updateCursorXPos();
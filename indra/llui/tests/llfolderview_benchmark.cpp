@@ -0,0 +1,257 @@
+/**
+ * @file   llfolderview_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times the row layout LLFolderViewFolder::arrange() runs over a
+ *         synthetic tree of 100 open folders holding 100000 items whose
+ *         widgets are not built, and the lookup of the rows in view that
+ *         draw() builds and draws. Only view models are involved, so no
+ *         fonts, GL or LLUI are needed. Built when LL_BENCHMARKS is set,
+ *         run by hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "../llfolderviewmodel.h"
+#include "../llfolderviewitem.h"
+
+#include <iostream>
+
+namespace
+{
+    const S32 GENERATION = 1;
+
+    class NamedItem : public LLFolderViewModelItemCommon
+    {
+    public:
+        NamedItem(const std::string& name, LLFolderViewModelInterface& root_view_model)
+        :   LLFolderViewModelItemCommon(root_view_model),
+            mName(name)
+        {}
+
+        const std::string& getName() const { return mName; }
+        const std::string& getDisplayName() const { return mName; }
+        const std::string& getSearchableName() const { return mName; }
+        std::string getSearchableDescription() const { return std::string(); }
+        std::string getSearchableCreatorName() const { return std::string(); }
+        std::string getSearchableUUIDString() const { return std::string(); }
+        std::string getSearchableAll() const { return std::string(); }
+        LLPointer<LLUIImage> getIcon() const { return NULL; }
+        LLFontGL::StyleFlags getLabelStyle() const { return LLFontGL::NORMAL; }
+        std::string getLabelSuffix() const { return std::string(); }
+        void openItem() {}
+        void closeItem() {}
+        void selectItem() {}
+        void navigateToFolder(bool new_window = false, bool change_mode = false) {}
+        bool isItemRenameable() const { return false; }
+        bool renameItem(const std::string& new_name) { return false; }
+        bool isItemMovable() const { return false; }
+        void move(LLFolderViewModelItem* parent_listener) {}
+        bool isItemRemovable(bool check_worn = true) const { return false; }
+        bool removeItem() { return false; }
+        void removeBatch(std::vector<LLFolderViewModelItem*>& batch) {}
+        bool isItemCopyable(bool can_copy_as_link = true) const { return false; }
+        bool copyToClipboard() const { return false; }
+        bool cutToClipboard() { return false; }
+        bool isClipboardPasteable() const { return false; }
+        void pasteFromClipboard() {}
+        void pasteLinkFromClipboard() {}
+        void buildContextMenu(LLMenuGL& menu, U32 flags) {}
+        bool potentiallyVisible() { return true; }
+        bool filter(LLFolderViewFilter& filter) { return false; }
+        bool hasChildren() const { return false; }
+        bool dragOrDrop(MASK mask, bool drop, EDragAndDropType cargo_type, void* cargo_data, std::string& tooltip_msg) { return false; }
+
+    private:
+        std::string mName;
+    };
+
+    class NameSort
+    {
+    public:
+        bool operator()(const NamedItem* const& a, const NamedItem* const& b) const
+        {
+            return a->getName() < b->getName();
+        }
+    };
+
+    // The items were filtered before, with GENERATION
+    class DoneFilter : public LLFolderViewFilter
+    {
+    public:
+        bool check(const LLFolderViewModelItem* item) { return true; }
+        bool checkFolder(const LLFolderViewModelItem* folder) const { return true; }
+        void setEmptyLookupMessage(const std::string& message) {}
+        std::string getEmptyLookupMessage(bool is_empty_folder = false) const { return mEmpty; }
+        bool showAllResults() const { return true; }
+        std::string::size_type getStringMatchOffset(LLFolderViewModelItem* item) const { return std::string::npos; }
+        std::string::size_type getFilterStringSize() const { return 0; }
+        bool isActive() const { return false; }
+        bool isModified() const { return false; }
+        void clearModified() {}
+        const std::string& getName() const { return mEmpty; }
+        const std::string& getFilterText() { return mEmpty; }
+        void setModified(EFilterModified behavior = FILTER_RESTART) {}
+        void resetTime(S32 timeout) {}
+        bool isTimedOut() { return false; }
+        bool isDefault() const { return true; }
+        bool isNotDefault() const { return false; }
+        void markDefault() {}
+        void resetDefault() {}
+        S32 getCurrentGeneration() const { return GENERATION; }
+        S32 getFirstSuccessGeneration() const { return GENERATION; }
+        S32 getFirstRequiredGeneration() const { return GENERATION; }
+
+    private:
+        std::string mEmpty;
+    };
+
+    class NamedViewModel : public LLFolderViewModel<NameSort, NamedItem, NamedItem, DoneFilter>
+    {
+    public:
+        NamedViewModel()
+        :   LLFolderViewModel<NameSort, NamedItem, NamedItem, DoneFilter>(new NameSort(), new DoneFilter())
+        {}
+
+        bool startDrag(std::vector<LLFolderViewModelItem*>& items) { return false; }
+    };
+}
+
+// Reaches the row layout of LLFolderViewFolder, never constructed
+class LLFolderViewRows : public LLFolderViewFolder
+{
+public:
+    using LLFolderViewFolder::row_t;
+    using LLFolderViewFolder::rows_t;
+    using LLFolderViewFolder::item_layout_params;
+    using LLFolderViewFolder::layoutItemRows;
+    using LLFolderViewFolder::getRowRange;
+};
+
+int main(int argc, char** argv)
+{
+    const S32 FOLDERS = 100;
+    const S32 ITEMS_PER_FOLDER = 1000;
+    const S32 ROW_HEIGHT = 20;
+    const S32 VIEW_HEIGHT = 600;
+    const S32 ARRANGES = 10;
+    const S32 FRAMES = 1000;
+
+    NamedViewModel view_model;
+
+    // every tenth item is filtered out
+    std::vector<LLFolderViewRows::unbuilt_items_t> folders(FOLDERS);
+    S32 passed = 0;
+    U32 seed = 1;
+    for (S32 folder = 0; folder < FOLDERS; ++folder)
+    {
+        for (S32 i = 0; i < ITEMS_PER_FOLDER; ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            NamedItem* item = new NamedItem("item " + std::to_string(seed >> 8), view_model);
+            const bool pass = (seed >> 4) % 10 != 0;
+            item->setPassedFolderFilter(true, GENERATION);
+            item->setPassedFilter(pass, GENERATION);
+            passed += pass ? 1 : 0;
+            folders[folder].push_back(item);
+        }
+    }
+
+    LLTimer timer;
+    for (S32 folder = 0; folder < FOLDERS; ++folder)
+    {
+        folders[folder].sort(NamedViewModel::ViewModelCompare(view_model.getSorter()));
+    }
+    const F64 sort_seconds = timer.getElapsedTimeF64();
+
+    // each folder lays out its rows below its own, as arrange() does, and
+    // the root stacks the folders
+    LLFolderViewRows::item_layout_params params;
+    params.mViewModel = &view_model;
+    params.mFilterGeneration = GENERATION;
+    params.mRowHeight = ROW_HEIGHT;
+    params.mParentItemHeight = ROW_HEIGHT;
+    params.mDeferArrange = true;
+
+    LLFolderViewFolder::items_t no_widgets;
+    std::vector<LLFolderViewRows::rows_t> rows(FOLDERS);
+    std::vector<S32> folder_tops(FOLDERS);
+    std::vector<S32> folder_heights(FOLDERS);
+    S32 total_height = 0;
+    timer.reset();
+    for (S32 pass = 0; pass < ARRANGES; ++pass)
+    {
+        total_height = 0;
+        for (S32 folder = 0; folder < FOLDERS; ++folder)
+        {
+            S32 width = 0;
+            F32 target_height = (F32)ROW_HEIGHT;
+            rows[folder].clear();
+            F32 height = LLFolderViewRows::layoutItemRows(params, no_widgets, folders[folder], (F32)ROW_HEIGHT,
+                                                          target_height, &width, rows[folder]);
+            folder_tops[folder] = total_height;
+            folder_heights[folder] = ll_round(height);
+            total_height += folder_heights[folder];
+        }
+    }
+    const F64 arrange_seconds = timer.getElapsedTimeF64() / ARRANGES;
+
+    // rows in view of each frame, scrolling through the whole tree
+    S64 found_rows = 0;
+    timer.reset();
+    for (S32 frame = 0; frame < FRAMES; ++frame)
+    {
+        const S32 top = (S32)((S64)(total_height - VIEW_HEIGHT) * frame / FRAMES);
+        for (S32 folder = 0; folder < FOLDERS; ++folder)
+        {
+            if (folder_tops[folder] >= top + VIEW_HEIGHT || folder_tops[folder] + folder_heights[folder] <= top)
+            {
+                continue;
+            }
+            LLFolderViewRows::rows_t::size_type first = 0;
+            LLFolderViewRows::rows_t::size_type last = 0;
+            LLFolderViewRows::getRowRange(rows[folder], top - folder_tops[folder], top + VIEW_HEIGHT - folder_tops[folder],
+                                          first, last);
+            found_rows += last - first;
+        }
+    }
+    const F64 search_seconds = timer.getElapsedTimeF64();
+
+    // the same by visiting every row, as drawing every child does
+    S64 visited_rows = 0;
+    timer.reset();
+    for (S32 frame = 0; frame < FRAMES; ++frame)
+    {
+        const S32 top = (S32)((S64)(total_height - VIEW_HEIGHT) * frame / FRAMES);
+        for (S32 folder = 0; folder < FOLDERS; ++folder)
+        {
+            for (const LLFolderViewRows::row_t& row : rows[folder])
+            {
+                const S32 row_top = folder_tops[folder] + row.mTop;
+                if (row_top < top + VIEW_HEIGHT && row_top + row.mHeight > top)
+                {
+                    ++visited_rows;
+                }
+            }
+        }
+    }
+    const F64 visit_seconds = timer.getElapsedTimeF64();
+
+    const bool same = found_rows == visited_rows
+        && total_height == (FOLDERS + passed) * ROW_HEIGHT;
+
+    std::cout << FOLDERS * ITEMS_PER_FOLDER << " items in " << FOLDERS << " folders, "
+              << passed << " pass the filter, no widgets built:\n"
+              << "  sort                      " << sort_seconds << "s\n"
+              << "  arrange                   " << arrange_seconds << "s\n"
+              << "  rows in view, " << FRAMES << " frames of " << VIEW_HEIGHT << " pixels: "
+              << (F64)found_rows / FRAMES << " a frame\n"
+              << "    binary search           " << search_seconds << "s\n"
+              << "    visit every row         " << visit_seconds << "s\n"
+              << "  rows and heights " << (same ? "match" : "DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/**
+ * @file llscrolllistsortkey_test.cpp
+ * @brief Tests for the sort keys of scroll list data provider rows
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llscrolllistsortkey.h"
+#include "lltut.h"
+
+namespace tut
+{
+    struct scrolllistsortkey
+    {
+        typedef std::vector<std::pair<S32, bool> > sort_orders_t;
+
+        // keys of rows of (name, age) for the given sort orders
+        std::vector<LLScrollListSortKey> keys(const std::vector<std::pair<std::string, S32> >& rows,
+                                              const sort_orders_t& sort_orders)
+        {
+            std::vector<LLScrollListSortKey> result;
+            for (const auto& row : rows)
+            {
+                for (const auto& sort_order : sort_orders)
+                {
+                    result.emplace_back(sort_order.first == 0 ? LLSD(row.first) : LLSD(row.second));
+                }
+            }
+            return result;
+        }
+    };
+
+    typedef test_group<scrolllistsortkey> scrolllistsortkey_t;
+    typedef scrolllistsortkey_t::object scrolllistsortkey_object_t;
+    tut::scrolllistsortkey_t tut_scrolllistsortkey("LLScrollListSortKey");
+
+    // strings compare like SortScrollListItem compares cell values
+    template<> template<>
+    void scrolllistsortkey_object_t::test<1>()
+    {
+        const char* values[] = { "apple", "Banana", "item9", "item10", "" };
+        for (const char* a : values)
+        {
+            for (const char* b : values)
+            {
+                const S32 expected = LLStringUtil::compareDict(a, b);
+                const S32 result = LLScrollListSortKey(LLSD(a)).compare(LLScrollListSortKey(LLSD(b)));
+                ensure_equals(std::string("compare ") + a + " with " + b, (result > 0) - (result < 0), (expected > 0) - (expected < 0));
+            }
+        }
+    }
+
+    // numbers compare by value and ahead of strings
+    template<> template<>
+    void scrolllistsortkey_object_t::test<2>()
+    {
+        ensure("9 before 10", LLScrollListSortKey(LLSD(9)).compare(LLScrollListSortKey(LLSD(10))) < 0);
+        ensure("real and integer", LLScrollListSortKey(LLSD(2.5)).compare(LLScrollListSortKey(LLSD(2))) > 0);
+        ensure_equals("equal numbers", LLScrollListSortKey(LLSD(3)).compare(LLScrollListSortKey(LLSD(3.0))), 0);
+        ensure("number before string", LLScrollListSortKey(LLSD(100)).compare(LLScrollListSortKey(LLSD("1"))) < 0);
+        ensure("string after number", LLScrollListSortKey(LLSD("1")).compare(LLScrollListSortKey(LLSD(100))) > 0);
+    }
+
+    // the last sort order takes precedence, earlier ones break ties, and
+    // rows that tie on every key keep their order
+    template<> template<>
+    void scrolllistsortkey_object_t::test<3>()
+    {
+        const std::vector<std::pair<std::string, S32> > rows = {
+            { "carol", 30 }, { "alice", 40 }, { "bob", 30 }, { "alice", 20 }, { "bob", 30 } };
+
+        // by age descending, then by name ascending
+        const sort_orders_t sort_orders = { { 0, true }, { 1, false } };
+        const std::vector<U32> order = ll_sort_scroll_list_keys(keys(rows, sort_orders), sort_orders);
+
+        const std::vector<U32> expected = { 1, 2, 4, 0, 3 };
+        ensure_equals("row count", order.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ensure_equals("row " + std::to_string(i), order[i], expected[i]);
+        }
+    }
+
+    // no sort orders leaves nothing to sort
+    template<> template<>
+    void scrolllistsortkey_object_t::test<4>()
+    {
+        ensure("no rows", ll_sort_scroll_list_keys(std::vector<LLScrollListSortKey>(), sort_orders_t()).empty());
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file   lltextbase_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times the line layout of a chat transcript that grows by 10000
+ *         appended lines, reflowing only the appended text against
+ *         reflowing the whole transcript. Segments measure fixed width
+ *         characters, so no fonts or GL are needed. Built when
+ *         LL_BENCHMARKS is set, run by hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "lltimer.h"
+
+#include "../lltextbase.h"
+
+#include <iostream>
+
+namespace
+{
+    const F32 GLYPH_WIDTH = 7.f;
+    const S32 LINE_HEIGHT = 14;
+
+    // Fixed width text, wrapped at spaces the way LLNormalTextSegment wraps
+    // with LLFontGL::WORD_BOUNDARY_IF_POSSIBLE
+    class FixedWidthSegment : public LLTextSegment
+    {
+    public:
+        FixedWidthSegment(const std::string& text, S32 start, S32 end)
+        :   LLTextSegment(start, end),
+            mText(text)
+        {}
+
+        /*virtual*/ bool getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const
+        {
+            width = num_chars * GLYPH_WIDTH;
+            height = num_chars > 0 ? LINE_HEIGHT : 0;
+            return false;
+        }
+
+        /*virtual*/ S32 getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const
+        {
+            S32 num_chars = llmin(max_chars, getEnd() - getStart() - segment_offset);
+            S32 fits = (S32)((F32)num_pixels / GLYPH_WIDTH);
+            if (num_chars <= fits)
+            {
+                return num_chars;
+            }
+            const S32 start = getStart() + segment_offset;
+            for (S32 i = fits; i > 0; --i)
+            {
+                if (mText[start + i - 1] == ' ')
+                {
+                    return i;
+                }
+            }
+            // a word longer than the line only breaks at the start of a line
+            return line_offset == 0 ? llmax(1, fits) : 0;
+        }
+
+    private:
+        const std::string& mText;
+    };
+
+    // The newline appendText() ends each chat line with, as
+    // LLLineBreakTextSegment
+    class LineBreakSegment : public LLTextSegment
+    {
+    public:
+        LineBreakSegment(S32 pos) : LLTextSegment(pos, pos + 1) {}
+
+        /*virtual*/ bool getDimensionsF32(S32 first_char, S32 num_chars, F32& width, S32& height) const
+        {
+            width = 0;
+            height = LINE_HEIGHT;
+            return true;
+        }
+
+        /*virtual*/ S32 getNumChars(S32 num_pixels, S32 segment_offset, S32 line_offset, S32 max_chars, S32 line_ind) const
+        {
+            return 1;
+        }
+    };
+}
+
+// Reaches the layout types of LLTextBase, never constructed
+class LLTextBaseLayout : public LLTextBase
+{
+public:
+    using LLTextBase::line_list_t;
+    using LLTextBase::segment_set_t;
+    using LLTextBase::line_layout_params;
+    using LLTextBase::reflowLines;
+};
+
+int main(int argc, char** argv)
+{
+    const S32 CHAT_LINES = 10000;
+    const char* const words[] = { "hello", "anyone", "around", "the", "sim", "is", "laggy", "tonight", "lol",
+                                  "http://secondlife.com/destination/some-place", "ok", "brb" };
+
+    LLTextBaseLayout::line_layout_params params;
+    params.mVisibleWidth = 400;
+    params.mHPad = 2;
+    params.mHAlign = LLFontGL::LEFT;
+    params.mWordWrap = true;
+    params.mLineSpacingMult = 1.f;
+    params.mLineSpacingPixels = 0;
+
+    // the transcript, each chat line a text segment and a line break
+    std::string text;
+    std::vector<S32> line_ends;
+    U32 seed = 1;
+    for (S32 i = 0; i < CHAT_LINES; ++i)
+    {
+        text += "[12:34] Resident " + std::to_string(i % 50) + ":";
+        for (U32 count = 0, words_in_line = 1 + (seed >> 8) % 30; count < words_in_line; ++count)
+        {
+            seed = seed * 1664525 + 1013904223;
+            text += std::string(" ") + words[(seed >> 8) % LL_ARRAY_SIZE(words)];
+        }
+        line_ends.push_back((S32)text.size());
+        text += '\n';
+    }
+
+    F64 seconds[2];
+    LLTextBaseLayout::line_list_t lines[2];
+    for (S32 pass = 0; pass < 2; ++pass)
+    {
+        const bool appended_only = pass == 0;
+        LLTextBaseLayout::segment_set_t segments;
+        S32 length = 0;
+        LLTimer timer;
+        for (S32 i = 0; i < CHAT_LINES; ++i)
+        {
+            const S32 start = length;
+            segments.insert(new FixedWidthSegment(text, start, line_ends[i]));
+            segments.insert(new LineBreakSegment(line_ends[i]));
+            length = line_ends[i] + 1;
+            LLTextBaseLayout::reflowLines(params, segments, appended_only ? start : 0, lines[pass]);
+        }
+        seconds[pass] = timer.getElapsedTimeF64();
+    }
+
+    const bool same = lines[0].size() == lines[1].size()
+        && lines[0].back().mDocIndexEnd == lines[1].back().mDocIndexEnd
+        && lines[0].back().mRect == lines[1].back().mRect;
+
+    std::cout << CHAT_LINES << " chat lines appended, " << lines[0].size() << " laid out lines:\n"
+              << "  reflow appended text   " << seconds[0] << "s\n"
+              << "  reflow whole document  " << seconds[1] << "s\n"
+              << "  layouts " << (same ? "match" : "DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
@@ -423,6 +423,26 @@ LLPointer<LLControlVariable> LLControlGroup::getControl(std::string_view name)
     return iter == mNameTable.end() ? LLPointer<LLControlVariable>() : iter->second;
 }
 
+LLControlVariable* LLControlGroup::findControl(const LLControlKey& key)
+{
+    if (mSettingsProfile)
+    {
+        incrCount(key.mName);
+    }
+
+    ctrl_hash_table_t::iterator iter = mHashTable.find(key.mHash);
+    if (iter == mHashTable.end())
+    {
+        return NULL;
+    }
+    if (iter->second->getName() != key.mName)
+    {
+        // two names sharing a hash, the second one only lives in the name table
+        return getControl(key.mName);
+    }
+    return iter->second;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -529,6 +549,7 @@ void LLControlGroup::cleanup()
     }
 
     mNameTable.clear();
+    mHashTable.clear();
 }
 
 eControlType LLControlGroup::typeStringToEnum(const std::string& typestr)
@@ -590,6 +611,8 @@ LLControlVariable* LLControlGroup::declareControl(const std::string& name, eCont
     LLControlVariable* control = new LLControlVariable(name, type, initial_val, comment, sanity_type, sanity_value, sanity_comment, persist, can_backup, hidefromsettingseditor);
     // </FS:Zi>
     mNameTable[name] = control;
+    // keeps the first control of a hash collision, findControl() checks names
+    mHashTable.emplace(LLControlKey::hash(name), control);
     return control;
 }
 
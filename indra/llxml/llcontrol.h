@@ -34,6 +34,7 @@
 #include "llrefcount.h"
 #include "llinstancetracker.h"
 
+#include <unordered_map>
 #include <vector>
 
 #include <boost/bind.hpp>
@@ -196,6 +197,31 @@ T convert_from_llsd(const LLSD& sd, eControlType type, std::string_view control_
     return T(sd);
 }
 
+// Name of a control together with its hash, for LLControlGroup::findControl()
+class LLControlKey
+{
+public:
+    explicit LLControlKey(std::string_view name)
+    :   mName(name),
+        mHash(hash(name))
+    {
+    }
+
+    // 64 bit FNV-1a
+    static constexpr U64 hash(std::string_view name)
+    {
+        U64 hash = 0xcbf29ce484222325ULL;
+        for (char c : name)
+        {
+            hash = (hash ^ (U8)c) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    std::string         mName;
+    U64                 mHash;
+};
+
 //const U32 STRING_CACHE_SIZE = 10000;
 class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 {
@@ -204,6 +230,9 @@ class LLControlGroup : public LLInstanceTracker<LLControlGroup, std::string>
 protected:
     typedef std::map<std::string, LLControlVariablePtr, std::less<> > ctrl_name_table_t;
     ctrl_name_table_t mNameTable;
+    // Same controls by LLControlKey hash, for findControl()
+    typedef std::unordered_map<U64, LLControlVariable*> ctrl_hash_table_t;
+    ctrl_hash_table_t mHashTable;
     static const std::string mTypeString[TYPE_COUNT];
     static const std::string mSanityTypeString[SANITY_TYPE_COUNT];
 
@@ -218,6 +247,8 @@ public:
     void cleanup();
 
     LLControlVariablePtr getControl(std::string_view name);
+    // Hash lookup that skips the string compares of getControl()
+    LLControlVariable* findControl(const LLControlKey& key);
 
     struct ApplyFunctor
     {
@@ -346,27 +377,30 @@ public:
                     const std::string& comment)
     :   LLInstanceTracker<LLControlCache<T>, std::string >(name)
     {
-        if(!group.controlExists(name))
+        LLControlVariable* controlp = group.findControl(LLControlKey(name));
+        if(!controlp)
         {
-            if(!declareTypedControl(group, name, default_value, comment))
+            controlp = declareTypedControl(group, name, default_value, comment);
+            if(!controlp)
             {
                 LL_ERRS() << "The control could not be created!!!" << LL_ENDL;
             }
         }
 
-        bindToControl(group, name);
+        bindToControl(controlp);
     }
 
     LLControlCache(LLControlGroup& group,
                     const std::string& name)
     :   LLInstanceTracker<LLControlCache<T>, std::string >(name)
     {
-        if(!group.controlExists(name))
+        LLControlVariable* controlp = group.findControl(LLControlKey(name));
+        if(!controlp)
         {
             LL_ERRS() << "Control named \"" << name << "\" not found." << LL_ENDL;
         }
 
-        bindToControl(group, name);
+        bindToControl(controlp);
     }
 
     ~LLControlCache()
@@ -376,11 +410,10 @@ public:
     const T& getValue() const { return mCachedValue; }
 
 private:
-    void bindToControl(LLControlGroup& group, const std::string& name)
+    void bindToControl(LLControlVariable* controlp)
     {
-        LLControlVariablePtr controlp = group.getControl(name);
         mType = controlp->type();
-        mCachedValue = convert_from_llsd<T>(controlp->get(), mType, name);
+        mCachedValue = convert_from_llsd<T>(controlp->get(), mType, controlp->getName());
 
         // Add a listener to the controls signal...
         // NOTE: All listeners connected to 0 group, for guaranty that variable handlers (gSavedSettings) call last
@@ -389,7 +422,7 @@ private:
             );
         mType = controlp->type();
     }
-    bool declareTypedControl(LLControlGroup& group,
+    LLControlVariable* declareTypedControl(LLControlGroup& group,
                             const std::string& name,
                              const T& default_value,
                              const std::string& comment)
@@ -401,11 +434,10 @@ private:
         {
             // <FS:Zi> Backup Settings
             // group.declareControl(name, type, init_value, comment, SANITY_TYPE_NONE, LLSD(), std::string(""), LLControlVariable::PERSIST_NO);
-            group.declareControl(name, type, init_value, comment, SANITY_TYPE_NONE, LLSD(), std::string(""), LLControlVariable::PERSIST_NO);
+            return group.declareControl(name, type, init_value, comment, SANITY_TYPE_NONE, LLSD(), std::string(""), LLControlVariable::PERSIST_NO);
             // </FS_Zi>
-            return true;
         }
-        return false;
+        return NULL;
     }
 
     bool handleValueChange(const LLSD& newvalue)
@@ -0,0 +1,72 @@
+/**
+ * @file   llcontrol_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times control lookups by name against lookups by hash, and reads
+ *         by name against reads through an LLCachedControl. Built when
+ *         LL_BENCHMARKS is set, run by hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "stringize.h"
+#include "lltimer.h"
+
+#include "../llcontrol.h"
+
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    const S32 CONTROLS = 2000;
+    const S32 READS = 200000;
+
+    LLControlGroup group("benchmark");
+    for (S32 i = 0; i < CONTROLS; ++i)
+    {
+        group.declareF32(STRINGIZE("BenchmarkSetting" << i), (F32)i, "benchmark");
+    }
+    group.declareBOOL("RenderBenchmark", true, "benchmark");
+
+    LLTimer timer;
+    S32 found = 0;
+    for (S32 i = 0; i < READS; ++i)
+    {
+        found += group.getControl("RenderBenchmark").notNull();
+    }
+    F64 name_lookup_seconds = timer.getElapsedTimeF64();
+
+    const LLControlKey key("RenderBenchmark");
+    timer.reset();
+    for (S32 i = 0; i < READS; ++i)
+    {
+        found += group.findControl(key) != NULL;
+    }
+    F64 hash_lookup_seconds = timer.getElapsedTimeF64();
+
+    timer.reset();
+    S32 by_name = 0;
+    for (S32 i = 0; i < READS; ++i)
+    {
+        by_name += group.getBOOL("RenderBenchmark");
+    }
+    F64 name_seconds = timer.getElapsedTimeF64();
+
+    LLCachedControl<bool> cached(group, "RenderBenchmark");
+    timer.reset();
+    S32 by_cached = 0;
+    for (S32 i = 0; i < READS; ++i)
+    {
+        by_cached += cached();
+    }
+    F64 cached_seconds = timer.getElapsedTimeF64();
+
+    std::cout << READS << " lookups and reads among " << CONTROLS << " controls:\n"
+              << "  lookup by name   " << name_lookup_seconds << "s\n"
+              << "  lookup by hash   " << hash_lookup_seconds << "s (" << found << " found)\n"
+              << "  read by name     " << name_seconds << "s (" << by_name << " true)\n"
+              << "  read cached      " << cached_seconds << "s (" << by_cached << " true)" << std::endl;
+    return 0;
+}
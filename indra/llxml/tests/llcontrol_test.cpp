@@ -151,4 +151,46 @@ namespace tut
         ensure("listener fired on changed setting", mListenerFired);
     }
 
+    //cached controls
+    template<> template<>
+    void control_group_t::test<5>()
+    {
+        mCG->loadFromFile(mTestConfigFile.c_str());
+        LLCachedControl<U32> cached(*mCG, "TestSetting");
+        ensure_equals("cached value", (U32)cached, 12);
+        mCG->setU32("TestSetting", 13);
+        ensure_equals("cached control sees changes", (U32)cached, 13);
+
+        // declared on first use, the group finds it by hash after that
+        LLCachedControl<F32> declared(*mCG, "TestCachedSetting", 2.5f);
+        ensure_equals("declared value", (F32)declared, 2.5f);
+        ensure("declared control", mCG->findControl(LLControlKey("TestCachedSetting")) == mCG->getControl("TestCachedSetting").get());
+    }
+
+    //hash lookups find the same control as names among many
+    template<> template<>
+    void control_group_t::test<6>()
+    {
+        const S32 CONTROLS = 2000;
+        for (S32 i = 0; i < CONTROLS; ++i)
+        {
+            mCG->declareF32(STRINGIZE("HashSetting" << i), (F32)i, "hash lookup");
+        }
+
+        for (S32 i = 0; i < CONTROLS; i += 97)
+        {
+            // the key keeps its own copy of a temporary name
+            LLControlKey key(STRINGIZE("HashSetting" << i));
+            std::string name = STRINGIZE("HashSetting" << i);
+            ensure(STRINGIZE("control " << i), mCG->findControl(key) == mCG->getControl(name).get());
+            LLCachedControl<F32> cached(*mCG, name);
+            ensure_equals(STRINGIZE("value " << i), (F32)cached, (F32)i);
+        }
+        ensure("missing control", mCG->findControl(LLControlKey("HashSettingMissing")) == NULL);
+
+        // cleanup() empties the hash table with the name table
+        mCG->cleanup();
+        ensure("control after cleanup", mCG->findControl(LLControlKey("HashSetting0")) == NULL);
+    }
+
 }
@@ -72,6 +72,169 @@ public:
 };
 
 
+//=============================================================================
+
+FSRadarListDataProvider::FSRadarListDataProvider()
+:   mList(nullptr)
+{
+}
+
+void FSRadarListDataProvider::init(LLPanel* panel, FSRadarListCtrl* list)
+{
+    mList = list;
+    mFlagsColumnType = panel->getString("FlagsColumnType");
+    mFlagsColumnValues[0] = panel->getString("FlagsColumnValue_0");
+    mFlagsColumnValues[1] = panel->getString("FlagsColumnValue_1");
+    mFlagsColumnValues[2] = panel->getString("FlagsColumnValue_2");
+    mNotesColumnIcon = panel->getString("NotesColumnIcon");
+    mSittingColumnIcon = panel->getString("SittingColumnIcon");
+    mTypingColumnIcon = panel->getString("TypingColumnIcon");
+}
+
+LLSD FSRadarListDataProvider::getRowValue(S32 row) const
+{
+    return mEntries[row]["entry"]["id"];
+}
+
+LLSD FSRadarListDataProvider::getRow(S32 row) const
+{
+    constexpr char font_name[] = "SANSSERIF_SMALL";
+
+    const LLSD& entry = mEntries[row]["entry"];
+
+    LLSD row_data;
+    row_data["value"] = entry["id"];
+    row_data["columns"][0]["column"] = "name";
+    row_data["columns"][0]["value"] = entry["name"];
+    row_data["columns"][0]["font"] = font_name;
+
+    row_data["columns"][1]["column"] = "voice_level";
+    row_data["columns"][1]["type"] = "icon";
+    row_data["columns"][1]["value"] = ""; // Need to set it after the row has been created because it's to big for the row
+    row_data["columns"][1]["font"] = font_name;
+
+    row_data["columns"][2]["column"] = "in_region";
+    row_data["columns"][2]["type"] = "icon";
+    row_data["columns"][2]["value"] = getSortKey(row, "in_region");
+
+    row_data["columns"][3]["column"] = "typing_status";
+    row_data["columns"][3]["type"] = "icon";
+    row_data["columns"][3]["value"] = getSortKey(row, "typing_status");
+
+    row_data["columns"][4]["column"] = "sitting_status";
+    row_data["columns"][4]["type"] = "icon";
+    row_data["columns"][4]["value"] = getSortKey(row, "sitting_status");
+
+    row_data["columns"][5]["column"] = "flags";
+    row_data["columns"][5]["type"] = mFlagsColumnType;
+
+    row_data["columns"][6]["column"] = "has_notes";
+    row_data["columns"][6]["type"] = "icon";
+    row_data["columns"][6]["value"] = getSortKey(row, "has_notes");
+    row_data["columns"][6]["tool_tip"] = entry["notes"].asString();
+
+    row_data["columns"][7]["column"] = "age";
+    row_data["columns"][7]["value"] = entry["age"];
+    row_data["columns"][7]["halign"] = "right";
+    row_data["columns"][7]["font"] = font_name;
+
+    row_data["columns"][8]["column"] = "seen";
+    row_data["columns"][8]["value"] = entry["seen"];
+    row_data["columns"][8]["halign"] = "right";
+    row_data["columns"][8]["font"] = font_name;
+
+    row_data["columns"][9]["column"] = "range";
+    row_data["columns"][9]["value"] = entry["range"];
+    row_data["columns"][9]["font"] = font_name;
+
+    row_data["columns"][10]["column"] = "seen_sort";
+    row_data["columns"][10]["value"] = getSortKey(row, "seen_sort");
+
+    return row_data;
+}
+
+// The text the row shows in the column once decorated, which is what the
+// cells would be compared by
+LLSD FSRadarListDataProvider::getSortKey(S32 row, const std::string& column) const
+{
+    const LLSD& entry = mEntries[row]["entry"];
+
+    if (column == "voice_level")
+    {
+        return entry.has("voice_level_icon") ? entry["voice_level_icon"].asString() : LLStringUtil::null;
+    }
+    if (column == "in_region")
+    {
+        if (entry["on_parcel"].asBoolean())
+        {
+            return "avatar_on_parcel";
+        }
+        return entry["in_region"].asBoolean() ? "avatar_in_region" : LLStringUtil::null;
+    }
+    if (column == "typing_status")
+    {
+        return entry["typing"].asBoolean() ? mTypingColumnIcon : LLStringUtil::null;
+    }
+    if (column == "sitting_status")
+    {
+        return entry["sitting"].asBoolean() ? mSittingColumnIcon : LLStringUtil::null;
+    }
+    if (column == "flags")
+    {
+        return entry.has("flags") ? mFlagsColumnValues[entry["flags"].asInteger()] : LLStringUtil::null;
+    }
+    if (column == "has_notes")
+    {
+        return entry["notes"].asBoolean() ? mNotesColumnIcon : LLStringUtil::null;
+    }
+    if (column == "seen_sort")
+    {
+        return entry["seen"].asString() + "_" + entry["name"].asString();
+    }
+    return entry[column].asString();
+}
+
+void FSRadarListDataProvider::decorateRow(S32 row, LLScrollListItem* item) const
+{
+    const LLSD& entry = mEntries[row]["entry"];
+    const LLSD& options = mEntries[row]["options"];
+
+    const S32 rangeColumnIndex = mList->getColumn("range")->mIndex;
+    const S32 nameColumnIndex = mList->getColumn("name")->mIndex;
+    const S32 voiceLevelColumnIndex = mList->getColumn("voice_level")->mIndex;
+    const S32 flagsColumnIndex = mList->getColumn("flags")->mIndex;
+    const S32 ageColumnIndex = mList->getColumn("age")->mIndex;
+
+    LLScrollListText* radarRangeCell = (LLScrollListText*)item->getColumn(rangeColumnIndex);
+    radarRangeCell->setColor(LLColor4(options["range_color"]));
+    radarRangeCell->setFontStyle(options["range_style"].asInteger());
+
+    LLScrollListText* radarNameCell = (LLScrollListText*)item->getColumn(nameColumnIndex);
+    radarNameCell->setFontStyle(options["name_style"].asInteger());
+    if (options.has("name_color"))
+    {
+        radarNameCell->setColor(LLColor4(options["name_color"]));
+    }
+
+    if (entry.has("voice_level_icon"))
+    {
+        LLScrollListText* voiceLevelCell = (LLScrollListText*)item->getColumn(voiceLevelColumnIndex);
+        voiceLevelCell->setValue(entry["voice_level_icon"].asString());
+    }
+
+    if (entry.has("flags"))
+    {
+        LLScrollListText* flagsCell = (LLScrollListText*)item->getColumn(flagsColumnIndex);
+        flagsCell->setValue(mFlagsColumnValues[entry["flags"].asInteger()]);
+    }
+
+    if (options.has("age_color"))
+    {
+        LLScrollListText* ageCell = (LLScrollListText*)item->getColumn(ageColumnIndex);
+        ageCell->setColor(LLColor4(options["age_color"]));
+    }
+}
+
 //=============================================================================
 
 static LLPanelInjector<FSPanelRadar> t_fs_panel_radar("fs_panel_radar");
@@ -107,6 +270,12 @@ FSPanelRadar::FSPanelRadar()
 
 FSPanelRadar::~FSPanelRadar()
 {
+    // the list outlives mRadarListProvider
+    if (mRadarList)
+    {
+        mRadarList->setDataProvider(nullptr);
+    }
+
     if (mUpdateSignalConnection.connected())
     {
         mUpdateSignalConnection.disconnect();
@@ -128,6 +297,7 @@ bool FSPanelRadar::postBuild()
     mRadarList->setContextMenu(&FSFloaterRadarMenu::gFSRadarMenu);
     mRadarList->setDoubleClickCallback(boost::bind(&FSPanelRadar::onRadarListDoubleClicked, this));
     mRadarList->setCommitCallback(boost::bind(&FSPanelRadar::onRadarListCommitted, this));
+    mRadarListProvider.init(this, mRadarList);
 
     mMiniMap = getChild<LLNetMap>("Net Map");
     mAddFriendButton = getChild<LLButton>("add_friend_btn");
@@ -303,12 +473,6 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
         return;
     }
 
-    static const std::string flagsColumnType = getString("FlagsColumnType");
-    static const std::string flagsColumnValues [3] = { getString("FlagsColumnValue_0"), getString("FlagsColumnValue_1"), getString("FlagsColumnValue_2") };
-    static const std::string notesColumnIcon = getString("NotesColumnIcon");
-    static const std::string sittingColumnIcon = getString("SittingColumnIcon");
-    static const std::string typingColumnIcon = getString("TypingColumnIcon");
-
     // Store current selection and scroll position
     LLUUID last_selected_id;
     if (mRadarList->getLastSelectedItem())
@@ -328,110 +492,8 @@ void FSPanelRadar::updateList(const std::vector<LLSD>& entries, const LLSD& stat
     bool needs_sort = mRadarList->isSorted();
     mRadarList->setNeedsSort(false);
 
-    mRadarList->clearRows();
-    for (const auto& avdata : entries)
-    {
-        constexpr char font_name[] = "SANSSERIF_SMALL";
-
-        LLSD entry = avdata["entry"];
-        LLSD options = avdata["options"];
-
-        LLSD row_data;
-        row_data["value"] = entry["id"];
-        row_data["columns"][0]["column"] = "name";
-        row_data["columns"][0]["value"] = entry["name"];
-        row_data["columns"][0]["font"] = font_name;
-
-        row_data["columns"][1]["column"] = "voice_level";
-        row_data["columns"][1]["type"] = "icon";
-        row_data["columns"][1]["value"] = ""; // Need to set it after the row has been created because it's to big for the row
-        row_data["columns"][1]["font"] = font_name;
-
-        row_data["columns"][2]["column"] = "in_region";
-        row_data["columns"][2]["type"] = "icon";
-        if (entry["on_parcel"].asBoolean())
-        {
-            row_data["columns"][2]["value"] = "avatar_on_parcel";
-        }
-        else if (entry["in_region"].asBoolean())
-        {
-            row_data["columns"][2]["value"] = "avatar_in_region";
-        }
-        else
-        {
-            row_data["columns"][2]["value"] = "";
-        }
-
-        row_data["columns"][3]["column"] = "typing_status";
-        row_data["columns"][3]["type"] = "icon";
-        row_data["columns"][3]["value"] = (entry["typing"].asBoolean() ? typingColumnIcon : "");
-
-        row_data["columns"][4]["column"] = "sitting_status";
-        row_data["columns"][4]["type"] = "icon";
-        row_data["columns"][4]["value"] = (entry["sitting"].asBoolean() ? sittingColumnIcon : "");
-
-        row_data["columns"][5]["column"] = "flags";
-        row_data["columns"][5]["type"] = flagsColumnType;
-
-        row_data["columns"][6]["column"] = "has_notes";
-        row_data["columns"][6]["type"] = "icon";
-        row_data["columns"][6]["value"] = (entry["notes"].asBoolean() ? notesColumnIcon : "");
-        row_data["columns"][6]["tool_tip"] = entry["notes"].asString();
-
-        row_data["columns"][7]["column"] = "age";
-        row_data["columns"][7]["value"] = entry["age"];
-        row_data["columns"][7]["halign"] = "right";
-        row_data["columns"][7]["font"] = font_name;
-
-        row_data["columns"][8]["column"] = "seen";
-        row_data["columns"][8]["value"] = entry["seen"];
-        row_data["columns"][8]["halign"] = "right";
-        row_data["columns"][8]["font"] = font_name;
-
-        row_data["columns"][9]["column"] = "range";
-        row_data["columns"][9]["value"] = entry["range"];
-        row_data["columns"][9]["font"] = font_name;
-
-        row_data["columns"][10]["column"] = "seen_sort";
-        row_data["columns"][10]["value"] = entry["seen"].asString() + "_" + entry["name"].asString();
-
-        LLScrollListItem* row = mRadarList->addElement(row_data);
-
-        static S32 rangeColumnIndex = mRadarList->getColumn("range")->mIndex;
-        static S32 nameColumnIndex = mRadarList->getColumn("name")->mIndex;
-        static S32 voiceLevelColumnIndex = mRadarList->getColumn("voice_level")->mIndex;
-        static S32 flagsColumnIndex = mRadarList->getColumn("flags")->mIndex;
-        static S32 ageColumnIndex = mRadarList->getColumn("age")->mIndex;
-
-        LLScrollListText* radarRangeCell = (LLScrollListText*)row->getColumn(rangeColumnIndex);
-        radarRangeCell->setColor(LLColor4(options["range_color"]));
-        radarRangeCell->setFontStyle(options["range_style"].asInteger());
-
-        LLScrollListText* radarNameCell = (LLScrollListText*)row->getColumn(nameColumnIndex);
-        radarNameCell->setFontStyle(options["name_style"].asInteger());
-        if (options.has("name_color"))
-        {
-            radarNameCell->setColor(LLColor4(options["name_color"]));
-        }
-
-        if (entry.has("voice_level_icon"))
-        {
-            LLScrollListText* voiceLevelCell = (LLScrollListText*)row->getColumn(voiceLevelColumnIndex);
-            voiceLevelCell->setValue(entry["voice_level_icon"].asString());
-        }
-
-        if (entry.has("flags"))
-        {
-            LLScrollListText* flagsCell = (LLScrollListText*)row->getColumn(flagsColumnIndex);
-            flagsCell->setValue(flagsColumnValues[entry["flags"].asInteger()]);
-        }
-
-        if (options.has("age_color"))
-        {
-            LLScrollListText* ageCell = (LLScrollListText*)row->getColumn(ageColumnIndex);
-            ageCell->setColor(LLColor4(options["age_color"]));
-        }
-    }
+    mRadarListProvider.setEntries(entries);
+    mRadarList->setDataProvider(&mRadarListProvider);
 
     mRadarList->setNeedsSort(needs_sort);
     mRadarList->updateSort();
@@ -38,6 +38,33 @@ class LLFilterEditor;
 class LLMenuButton;
 class LLNetMap;
 
+// Rows of the radar list from the entries of the last FSRadar update. The
+// list only builds the cells of the rows it draws.
+class FSRadarListDataProvider : public LLScrollListDataProvider
+{
+public:
+    FSRadarListDataProvider();
+
+    void                    init(LLPanel* panel, FSRadarListCtrl* list);
+    void                    setEntries(const std::vector<LLSD>& entries) { mEntries = entries; }
+
+    S32                     getRowCount() const override { return static_cast<S32>(mEntries.size()); }
+    LLSD                    getRowValue(S32 row) const override;
+    LLSD                    getRow(S32 row) const override;
+    LLSD                    getSortKey(S32 row, const std::string& column) const override;
+    void                    decorateRow(S32 row, LLScrollListItem* item) const override;
+
+private:
+    FSRadarListCtrl*        mList;
+    std::vector<LLSD>       mEntries;
+
+    std::string             mFlagsColumnType;
+    std::string             mFlagsColumnValues[3];
+    std::string             mNotesColumnIcon;
+    std::string             mSittingColumnIcon;
+    std::string             mTypingColumnIcon;
+};
+
 class FSPanelRadar
     : public LLPanel
 {
@@ -84,6 +111,7 @@ private:
     bool                    onEnableColumnVisibilityChecked(const LLSD& userdata);
 
     FSRadarListCtrl*        mRadarList;
+    FSRadarListDataProvider mRadarListProvider;
     LLNetMap*               mMiniMap;
     LLButton*               mRadarGearButton;
     LLButton*               mAddFriendButton;
@@ -2441,6 +2441,12 @@ bool LLAppViewer::cleanup()
     delete mGeneralThreadPool;
     mGeneralThreadPool = NULL;
 
+    if (LLTrace::BlockTimer::getTraceEvents())
+    {
+        LLTrace::BlockTimer::setTraceEvents(false);
+        LLTrace::BlockTimer::exportTraceEvents(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "timer_events.json"));
+    }
+
     if (LLFastTimerView::sAnalyzePerformance)
     {
         LL_INFOS() << "Analyzing performance" << LL_ENDL;
@@ -2505,6 +2511,7 @@ bool LLAppViewer::cleanup()
     LLEnvironment::deleteSingleton();
     LLSelectMgr::deleteSingleton();
     LLViewerStatsRecorder::deleteSingleton();
+    LLPerfStats::StatsRecorder::stopRecording();
     LLViewerEventRecorder::deleteSingleton();
     LLWorld::deleteSingleton();
     LLVoiceClient::deleteSingleton();
@@ -2524,6 +2531,8 @@ bool LLAppViewer::cleanup()
     LLSplashScreen::hide();
 
     LL_INFOS() << "Goodbye!" << LL_ENDL;
+    // write out what is still queued for the log writer thread
+    LLError::setAsyncLogging(false);
 
     removeDumpDir();
 
@@ -3223,6 +3232,8 @@ bool LLAppViewer::initConfiguration()
         LLTrace::BlockTimer::sLogName = std::string("performance");
     }
 
+    LLTrace::BlockTimer::setTraceEvents(gSavedSettings.getBOOL("FastTimerTraceEvents"));
+
     std::string test_name(gSavedSettings.getString("LogMetrics"));
     if (!test_name.empty())
     {
@@ -4263,6 +4274,9 @@ void LLAppViewer::cleanupSavedSettings()
 
     gSavedSettings.setBOOL("ShowObjectUpdates", gShowObjectUpdates);
 
+    // don't save what auto tune lowered shadows and reflections to as the user's choice
+    LLPerfStats::tunables.restoreUserSettings();
+
     if (gDebugView)
     {
         gSavedSettings.setBOOL("ShowDebugConsole", gDebugView->mDebugConsolep->getVisible());
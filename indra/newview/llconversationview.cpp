@@ -317,6 +317,7 @@ void LLConversationViewSession::draw()
         updateLabelRotation();
         drawOpenFolderArrow();
     }
+    finishDeferredArranges();
     LLView::draw();
 }
 
@@ -0,0 +1,39 @@
+/**
+ * @file   lldrawsortkey.h
+ * @date   2026-10-16
+ * @brief  ll_draw_sort_key() packs the state a draw batch binds into the key
+ *         LLCullResult::sortRenderMap() orders batches by.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDRAWSORTKEY_H
+#define LL_LLDRAWSORTKEY_H
+
+#include "stdtypes.h"
+
+#include <cstdint>
+
+// Spreads a pointer or hash over the given number of bits
+inline U64 ll_draw_sort_key_bits(U64 value, U32 bits)
+{
+    return (value * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+}
+
+// 12 bits of skinning, 12 of material, 16 of texture, 8 of model matrix and
+// 16 of vertex buffer, most expensive state change first. Unskinned and
+// unmaterialed batches keep zero there and sort ahead of the rest. Colliding
+// hashes only cost some coherence.
+inline U64 ll_draw_sort_key(U64 skin, uintptr_t material, uintptr_t texture,
+                            uintptr_t model_matrix, uintptr_t vertex_buffer)
+{
+    return (skin ? ll_draw_sort_key_bits(skin, 12) << 52 : 0) |
+           (material ? ll_draw_sort_key_bits(material, 12) << 40 : 0) |
+           (ll_draw_sort_key_bits(texture, 16) << 24) |
+           (ll_draw_sort_key_bits(model_matrix, 8) << 16) |
+           ll_draw_sort_key_bits(vertex_buffer, 16);
+}
+
+#endif // LL_LLDRAWSORTKEY_H
@@ -100,6 +100,17 @@ void LLFolderViewModelInventory::sort( LLFolderViewFolder* folder )
                 modelp->setCreationDate(most_recent_item_time);
             }
         }
+        if (child_folderp->getUnbuiltItemsCount() > 0)
+        {
+            time_t most_recent_item_time =
+                static_cast<LLFolderViewModelItemInventory*>(child_folderp->getUnbuiltItemsBegin()->get())->getCreationDate();
+
+            LLFolderViewModelItemInventory* modelp =   static_cast<LLFolderViewModelItemInventory*>(child_folderp->getViewModelItem());
+            if (most_recent_item_time > modelp->getCreationDate())
+            {
+                modelp->setCreationDate(most_recent_item_time);
+            }
+        }
     }
     base_t::sort(folder);
 }
@@ -195,7 +206,17 @@ void LLFolderViewModelItemInventory::setPassedFilter(bool passed, S32 filter_gen
         // Need to rearrange the folder if the filtered state of the item changed,
         // previously passed item skipped filter generation changes while being dirty
         // or previously passed not yet filtered item was marked dirty
-        LLFolderViewFolder* parent_folder = mFolderViewItem->getParentFolder();
+        LLFolderViewFolder* parent_folder = NULL;
+        if (mFolderViewItem)
+        {
+            parent_folder = mFolderViewItem->getParentFolder();
+        }
+        else if (mParent)
+        {
+            // the widget of this item is not built yet, its row is laid out
+            // by the folder of its parent
+            parent_folder = dynamic_cast<LLFolderViewFolder*>(static_cast<LLFolderViewModelItemInventory*>(mParent)->mFolderViewItem);
+        }
         if (parent_folder)
         {
             parent_folder->requestArrange();
@@ -0,0 +1,1031 @@
+/**
+ * @file llinventorycache.cpp
+ * @brief Binary, memory mappable inventory cache and its change log.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycache.h"
+
+#include "hbxxh.h"
+#include "llfile.h"
+#include "llmappedfile.h"
+#include "llviewerinventory.h"
+#include "parallelfor.h"
+#include "workqueue.h"
+
+#include <atomic>
+#include <unordered_map>
+
+static const char * const LOG_INV("Inventory");
+
+static const char CACHE_MAGIC[8] = { 'L', 'L', 'I', 'N', 'V', 'C', 'A', 'C' };
+// Bump whenever the layout below or the decoding in load() changes.
+// 2: removed ids and log segment, for LLInventoryCacheLog
+static const U32 CACHE_FORMAT_VERSION = 2;
+// Records decoded per chunk must be worth handing to another thread.
+static const U32 MIN_CHUNK_RECORDS = 8192;
+
+static const char LOG_BATCH_MAGIC[4] = { 'L', 'L', 'I', 'L' };
+// Longest a change waits before it is logged.
+static const F32 LOG_FLUSH_INTERVAL = 5.f;
+// Logged bytes that trigger a compaction.
+static const size_t LOG_COMPACT_BYTES = 16 * 1024 * 1024;
+
+// Index into the string pool; strings are not nul terminated.
+struct LLInventoryCacheString
+{
+    U32     mOffset;
+    U32     mLength;
+};
+
+// UUIDs are indices into the UUID table, whose first entry is the null id.
+struct LLInventoryCacheCategory
+{
+    U32     mID;
+    U32     mParentID;
+    U32     mOwnerID;
+    U32     mThumbnailID;
+    LLInventoryCacheString mName;
+    S32     mVersion;
+    S32     mPreferredType;
+};
+
+struct LLInventoryCacheItem
+{
+    U32     mID;
+    U32     mParentID;
+    U32     mAssetID;
+    U32     mThumbnailID;
+    U32     mCreatorID;
+    U32     mOwnerID;
+    U32     mLastOwnerID;
+    U32     mGroupID;
+    LLInventoryCacheString mName;
+    LLInventoryCacheString mDescription;
+    U32     mMaskBase;
+    U32     mMaskOwner;
+    U32     mMaskGroup;
+    U32     mMaskEveryone;
+    U32     mMaskNextOwner;
+    U32     mFlags;
+    S32     mCreationDate;
+    S32     mSalePrice;
+    S8      mType;
+    S8      mInventoryType;
+    S8      mSaleType;
+    U8      mPad;
+};
+
+// All offsets are in bytes from the start of the image and 16 byte aligned.
+// Log batches are images of the objects they add, replace or remove.
+struct LLInventoryCacheHeader
+{
+    char    mMagic[8];
+    U32     mFormatVersion;
+    S32     mCacheVersion;          // LLInventoryModel::sCurrentInvCacheVersion
+
+    U32     mNumUUIDs;
+    U32     mNumCategories;
+    U32     mNumItems;
+    U32     mStringPoolSize;
+    U32     mNumRemoved;            // log batches only
+    U32     mLogSegment;            // last log segment included, cache only
+
+    U64     mUUIDsOffset;           // LLUUID[mNumUUIDs]
+    U64     mCategoriesOffset;      // LLInventoryCacheCategory[mNumCategories]
+    U64     mItemsOffset;           // LLInventoryCacheItem[mNumItems]
+    U64     mStringsOffset;         // char[mStringPoolSize]
+    U64     mRemovedOffset;         // U32[mNumRemoved], indices into the UUID table
+};
+
+// Precedes each image in a log segment.
+struct LLInventoryCacheLogBatch
+{
+    char    mMagic[4];
+    U32     mSize;                  // of the image, a multiple of 16
+    U64     mHash;                  // HBXXH64 of the image
+};
+
+static_assert(sizeof(LLUUID) == UUID_BYTES, "LLUUID is stored as raw bytes");
+static_assert(sizeof(LLInventoryCacheCategory) == 32, "unexpected padding");
+static_assert(sizeof(LLInventoryCacheItem) == 84, "unexpected padding");
+static_assert(sizeof(LLInventoryCacheLogBatch) == 16, "images must stay 16 byte aligned");
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+namespace
+{
+    // Appends data to the output buffer at the next 16 byte boundary and
+    // returns its offset.
+    U64 append_block(std::vector<U8>& buffer, const void* data, size_t size)
+    {
+        size_t offset = (buffer.size() + 15) & ~(size_t)15;
+        buffer.resize(offset + size, 0);
+        if (size)
+        {
+            memcpy(&buffer[offset], data, size);
+        }
+        return offset;
+    }
+
+    // Returns a pointer into data if [offset, offset + count * size) lies
+    // within it and offset is suitably aligned, NULL otherwise.
+    template<typename T>
+    const T* map_block(const U8* data, size_t size, U64 offset, U64 count)
+    {
+        if ((offset & 15) || offset > size || count > (size - offset) / sizeof(T))
+        {
+            return NULL;
+        }
+        return reinterpret_cast<const T*>(data + offset);
+    }
+
+    // Calls func(begin, end) over [0, count) in chunks shared between the
+    // caller and the "General" thread pool. Returns false if any call did.
+    template<typename F>
+    bool for_each_chunk(U32 count, const F& func)
+    {
+        std::atomic<bool> success(true);
+        LL::parallel_for("General", count, MIN_CHUNK_RECORDS,
+                         [&](size_t begin, size_t end)
+                         {
+                             if (!func((U32)begin, (U32)end))
+                             {
+                                 success = false;
+                             }
+                         });
+        return success;
+    }
+
+    std::string segment_filename(const std::string& filename, U32 segment)
+    {
+        return llformat("%s.%u.log", filename.c_str(), segment);
+    }
+
+    // Removes segment and the contiguous run of segments before it.
+    void remove_segments(const std::string& filename, U32 segment)
+    {
+        for (; segment > 0; --segment)
+        {
+            const std::string segment_file = segment_filename(filename, segment);
+            if (!LLFile::isfile(segment_file))
+            {
+                break;
+            }
+            LLFile::remove(segment_file);
+        }
+    }
+
+    // Read side view of a cache or log batch, with bounds checks since the
+    // file may be damaged.
+    struct LLInventoryCacheImage
+    {
+        const LLInventoryCacheHeader*   mHeader = NULL;
+        const LLUUID*                   mUUIDs = NULL;
+        const char*                     mStrings = NULL;
+        const LLInventoryCacheCategory* mCategories = NULL;
+        const LLInventoryCacheItem*     mItems = NULL;
+        const U32*                      mRemoved = NULL;
+
+        bool parse(const U8* data, size_t size)
+        {
+            mHeader = map_block<LLInventoryCacheHeader>(data, size, 0, 1);
+            if (!mHeader || memcmp(mHeader->mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC))
+                || mHeader->mFormatVersion != CACHE_FORMAT_VERSION)
+            {
+                return false;
+            }
+            mUUIDs = map_block<LLUUID>(data, size, mHeader->mUUIDsOffset, mHeader->mNumUUIDs);
+            mStrings = map_block<char>(data, size, mHeader->mStringsOffset, mHeader->mStringPoolSize);
+            mCategories = map_block<LLInventoryCacheCategory>(data, size, mHeader->mCategoriesOffset, mHeader->mNumCategories);
+            mItems = map_block<LLInventoryCacheItem>(data, size, mHeader->mItemsOffset, mHeader->mNumItems);
+            mRemoved = map_block<U32>(data, size, mHeader->mRemovedOffset, mHeader->mNumRemoved);
+            return mUUIDs && mHeader->mNumUUIDs && mStrings && mCategories && mItems && mRemoved;
+        }
+
+        bool getUUID(U32 index, LLUUID& id) const
+        {
+            if (index >= mHeader->mNumUUIDs)
+            {
+                return false;
+            }
+            id = mUUIDs[index];
+            return true;
+        }
+
+        bool getString(const LLInventoryCacheString& str, std::string& out) const
+        {
+            if ((U64)str.mOffset + str.mLength > mHeader->mStringPoolSize)
+            {
+                return false;
+            }
+            out.assign(mStrings + str.mOffset, str.mLength);
+            return true;
+        }
+    };
+
+    // Builds a cache or log batch image, storing each UUID and string once.
+    class LLInventoryCacheWriter
+    {
+    public:
+        LLInventoryCacheWriter()
+        {
+            addUUID(LLUUID::null);
+        }
+
+        void addCategory(const LLViewerInventoryCategory* cat)
+        {
+            LLInventoryCacheCategory record;
+            record.mID = addUUID(cat->getUUID());
+            record.mParentID = addUUID(cat->getParentUUID());
+            record.mOwnerID = addUUID(cat->getOwnerID());
+            record.mThumbnailID = addUUID(cat->getThumbnailUUID());
+            record.mName = addString(cat->getName());
+            record.mVersion = cat->getVersion();
+            record.mPreferredType = cat->getPreferredType();
+            mCategories.push_back(record);
+        }
+
+        void addItem(const LLInventoryItem* item)
+        {
+            // LLViewerInventoryItem answers for the target of a link, the
+            // cache needs the link itself.
+            const LLPermissions& perm = item->LLInventoryItem::getPermissions();
+            const LLSaleInfo& sale_info = item->LLInventoryItem::getSaleInfo();
+
+            LLInventoryCacheItem record;
+            record.mID = addUUID(item->getUUID());
+            record.mParentID = addUUID(item->getParentUUID());
+            record.mAssetID = addUUID(item->LLInventoryItem::getAssetUUID());
+            record.mThumbnailID = addUUID(item->LLInventoryItem::getThumbnailUUID());
+            record.mCreatorID = addUUID(perm.getCreator());
+            record.mOwnerID = addUUID(perm.getOwner());
+            record.mLastOwnerID = addUUID(perm.getLastOwner());
+            record.mGroupID = addUUID(perm.getGroup());
+            record.mName = addString(item->LLInventoryItem::getName());
+            record.mDescription = addString(item->LLInventoryItem::getDescription());
+            record.mMaskBase = perm.getMaskBase();
+            record.mMaskOwner = perm.getMaskOwner();
+            record.mMaskGroup = perm.getMaskGroup();
+            record.mMaskEveryone = perm.getMaskEveryone();
+            record.mMaskNextOwner = perm.getMaskNextOwner();
+            record.mFlags = item->LLInventoryItem::getFlags();
+            record.mCreationDate = (S32)item->LLInventoryItem::getCreationDate();
+            record.mSalePrice = sale_info.getSalePrice();
+            record.mType = (S8)item->LLInventoryItem::getType();
+            record.mInventoryType = (S8)item->LLInventoryItem::getInventoryType();
+            record.mSaleType = (S8)sale_info.getSaleType();
+            record.mPad = 0;
+            mItems.push_back(record);
+        }
+
+        void addRemoved(const LLUUID& id)
+        {
+            mRemoved.push_back(addUUID(id));
+        }
+
+        // Copy records from another image, translating their indices.
+        bool copyCategory(const LLInventoryCacheImage& image, const LLInventoryCacheCategory& source)
+        {
+            LLInventoryCacheCategory record = source;
+            if (!copyUUID(image, source.mID, record.mID) || !copyUUID(image, source.mParentID, record.mParentID)
+                || !copyUUID(image, source.mOwnerID, record.mOwnerID) || !copyUUID(image, source.mThumbnailID, record.mThumbnailID)
+                || !copyString(image, source.mName, record.mName))
+            {
+                return false;
+            }
+            mCategories.push_back(record);
+            return true;
+        }
+
+        bool copyItem(const LLInventoryCacheImage& image, const LLInventoryCacheItem& source)
+        {
+            LLInventoryCacheItem record = source;
+            if (!copyUUID(image, source.mID, record.mID) || !copyUUID(image, source.mParentID, record.mParentID)
+                || !copyUUID(image, source.mAssetID, record.mAssetID) || !copyUUID(image, source.mThumbnailID, record.mThumbnailID)
+                || !copyUUID(image, source.mCreatorID, record.mCreatorID) || !copyUUID(image, source.mOwnerID, record.mOwnerID)
+                || !copyUUID(image, source.mLastOwnerID, record.mLastOwnerID) || !copyUUID(image, source.mGroupID, record.mGroupID)
+                || !copyString(image, source.mName, record.mName) || !copyString(image, source.mDescription, record.mDescription))
+            {
+                return false;
+            }
+            mItems.push_back(record);
+            return true;
+        }
+
+        size_t getCategoryCount() const { return mCategories.size(); }
+        size_t getItemCount() const     { return mItems.size(); }
+
+        // The image is padded to a multiple of 16 bytes.
+        void write(std::vector<U8>& buffer, S32 cache_version, U32 log_segment) const
+        {
+            LLInventoryCacheHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.mMagic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+            header.mFormatVersion = CACHE_FORMAT_VERSION;
+            header.mCacheVersion = cache_version;
+            header.mNumUUIDs = (U32)mUUIDs.size();
+            header.mNumCategories = (U32)mCategories.size();
+            header.mNumItems = (U32)mItems.size();
+            header.mStringPoolSize = (U32)mStrings.size();
+            header.mNumRemoved = (U32)mRemoved.size();
+            header.mLogSegment = log_segment;
+
+            buffer.clear();
+            append_block(buffer, &header, sizeof(header));
+            header.mUUIDsOffset = append_block(buffer, mUUIDs.data(), mUUIDs.size() * sizeof(LLUUID));
+            header.mCategoriesOffset = append_block(buffer, mCategories.data(), mCategories.size() * sizeof(LLInventoryCacheCategory));
+            header.mItemsOffset = append_block(buffer, mItems.data(), mItems.size() * sizeof(LLInventoryCacheItem));
+            header.mRemovedOffset = append_block(buffer, mRemoved.data(), mRemoved.size() * sizeof(U32));
+            header.mStringsOffset = append_block(buffer, mStrings.data(), mStrings.size());
+            buffer.resize((buffer.size() + 15) & ~(size_t)15, 0);
+            memcpy(buffer.data(), &header, sizeof(header));
+        }
+
+    private:
+        U32 addUUID(const LLUUID& id)
+        {
+            auto inserted = mUUIDIndex.emplace(id, (U32)mUUIDs.size());
+            if (inserted.second)
+            {
+                mUUIDs.push_back(id);
+            }
+            return inserted.first->second;
+        }
+
+        LLInventoryCacheString addString(const std::string& str)
+        {
+            auto inserted = mStringIndex.emplace(str, (U32)mStrings.size());
+            if (inserted.second)
+            {
+                mStrings.append(str);
+            }
+            return { inserted.first->second, (U32)str.size() };
+        }
+
+        bool copyUUID(const LLInventoryCacheImage& image, U32 index, U32& out)
+        {
+            LLUUID id;
+            if (!image.getUUID(index, id))
+            {
+                return false;
+            }
+            out = addUUID(id);
+            return true;
+        }
+
+        bool copyString(const LLInventoryCacheImage& image, const LLInventoryCacheString& str, LLInventoryCacheString& out)
+        {
+            if (!image.getString(str, mScratch))
+            {
+                return false;
+            }
+            out = addString(mScratch);
+            return true;
+        }
+
+        std::vector<LLUUID>                     mUUIDs;
+        std::string                             mStrings;
+        std::vector<LLInventoryCacheCategory>   mCategories;
+        std::vector<LLInventoryCacheItem>       mItems;
+        std::vector<U32>                        mRemoved;
+        std::unordered_map<LLUUID, U32>         mUUIDIndex;
+        std::unordered_map<std::string, U32>    mStringIndex;
+        std::string                             mScratch;
+    };
+
+    // Maps and validates a cache file.
+    bool map_cache(const std::string& filename, S32 cache_version,
+                   LLPointer<LLMappedFile>& file, LLInventoryCacheImage& image)
+    {
+        if (!LLFile::isfile(filename))
+        {
+            return false;
+        }
+        file = new LLMappedFile();
+        if (!file->map(filename))
+        {
+            LL_WARNS(LOG_INV) << "Unable to map inventory cache " << filename << LL_ENDL;
+            return false;
+        }
+        if (!image.parse(file->getData(), file->getSize()))
+        {
+            LL_INFOS(LOG_INV) << "Ignoring damaged or unknown format inventory cache " << filename << LL_ENDL;
+            return false;
+        }
+        if (image.mHeader->mCacheVersion != cache_version)
+        {
+            LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+            return false;
+        }
+        return true;
+    }
+
+    // Appends the intact batches of a log segment to images, keeping its
+    // mapping alive in mappings. Returns false if the segment does not
+    // exist.
+    bool read_segment(const std::string& filename, S32 cache_version,
+                      std::vector<LLPointer<LLMappedFile> >& mappings,
+                      std::vector<LLInventoryCacheImage>& images)
+    {
+        if (!LLFile::isfile(filename))
+        {
+            return false;
+        }
+        LLPointer<LLMappedFile> file = new LLMappedFile();
+        if (!file->map(filename))
+        {
+            // empty, nothing was logged to this segment
+            return true;
+        }
+        mappings.push_back(file);
+
+        const U8* data = file->getData();
+        const size_t size = file->getSize();
+        size_t offset = 0;
+        while (size - offset >= sizeof(LLInventoryCacheLogBatch))
+        {
+            const LLInventoryCacheLogBatch* batch = reinterpret_cast<const LLInventoryCacheLogBatch*>(data + offset);
+            offset += sizeof(LLInventoryCacheLogBatch);
+            LLInventoryCacheImage image;
+            if (memcmp(batch->mMagic, LOG_BATCH_MAGIC, sizeof(LOG_BATCH_MAGIC))
+                || (batch->mSize & 15) || batch->mSize > size - offset
+                || HBXXH64::digest(data + offset, batch->mSize) != batch->mHash
+                || !image.parse(data + offset, batch->mSize)
+                || image.mHeader->mCacheVersion != cache_version)
+            {
+                // the viewer stopped while writing this batch, the ones
+                // before it are still good
+                LL_WARNS(LOG_INV) << "Ignoring the incomplete end of " << filename << LL_ENDL;
+                break;
+            }
+            images.push_back(image);
+            offset += batch->mSize;
+        }
+        return true;
+    }
+
+    // Applies the log batches following images[0], the cache, in order.
+    // Each object ends up with its state from the last image holding it,
+    // unless that or a later image removed it.
+    bool merge_images(const std::vector<LLInventoryCacheImage>& images, LLInventoryCacheWriter& writer)
+    {
+        typedef std::pair<U32, U32> source_t; // image, record
+        std::unordered_map<LLUUID, source_t> cat_sources;
+        std::unordered_map<LLUUID, source_t> item_sources;
+        LLUUID id;
+        for (U32 i = 0; i < images.size(); ++i)
+        {
+            const LLInventoryCacheImage& image = images[i];
+            for (U32 j = 0; j < image.mHeader->mNumRemoved; ++j)
+            {
+                if (!image.getUUID(image.mRemoved[j], id))
+                {
+                    return false;
+                }
+                cat_sources.erase(id);
+                item_sources.erase(id);
+            }
+            for (U32 j = 0; j < image.mHeader->mNumCategories; ++j)
+            {
+                if (!image.getUUID(image.mCategories[j].mID, id))
+                {
+                    return false;
+                }
+                cat_sources[id] = source_t(i, j);
+            }
+            for (U32 j = 0; j < image.mHeader->mNumItems; ++j)
+            {
+                if (!image.getUUID(image.mItems[j].mID, id))
+                {
+                    return false;
+                }
+                item_sources[id] = source_t(i, j);
+            }
+        }
+
+        // record ids were validated above
+        for (U32 i = 0; i < images.size(); ++i)
+        {
+            const LLInventoryCacheImage& image = images[i];
+            for (U32 j = 0; j < image.mHeader->mNumCategories; ++j)
+            {
+                auto source = cat_sources.find(image.mUUIDs[image.mCategories[j].mID]);
+                if (source != cat_sources.end() && source->second == source_t(i, j)
+                    && !writer.copyCategory(image, image.mCategories[j]))
+                {
+                    return false;
+                }
+            }
+            for (U32 j = 0; j < image.mHeader->mNumItems; ++j)
+            {
+                auto source = item_sources.find(image.mUUIDs[image.mItems[j].mID]);
+                if (source != item_sources.end() && source->second == source_t(i, j)
+                    && !writer.copyItem(image, image.mItems[j]))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Newest log segment on disk for the cache filename, usable or not.
+    U32 get_last_segment(const std::string& filename)
+    {
+        U32 segment = 0;
+        {
+            LLPointer<LLMappedFile> file = new LLMappedFile();
+            LLInventoryCacheImage image;
+            if (file->map(filename) && image.parse(file->getData(), file->getSize()))
+            {
+                segment = image.mHeader->mLogSegment;
+            }
+        }
+        while (LLFile::isfile(segment_filename(filename, segment + 1)))
+        {
+            ++segment;
+        }
+        return segment;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// getFilename()
+//-----------------------------------------------------------------------------
+// static
+std::string LLInventoryCache::getFilename(const std::string& notation_filename)
+{
+    static const std::string NOTATION_SUFFIX(".llsd");
+    std::string filename(notation_filename);
+    if (LLStringUtil::endsWith(filename, NOTATION_SUFFIX))
+    {
+        filename.erase(filename.size() - NOTATION_SUFFIX.size());
+    }
+    return filename + ".bin";
+}
+
+//-----------------------------------------------------------------------------
+// load()
+//-----------------------------------------------------------------------------
+// static
+bool LLInventoryCache::load(const std::string& filename,
+                            S32 cache_version,
+                            LLInventoryModel::cat_array_t& categories,
+                            LLInventoryModel::item_array_t& items,
+                            LLInventoryModel::changed_items_t& cats_to_update,
+                            U32* last_segment)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LLPointer<LLMappedFile> file;
+    LLInventoryCacheImage image;
+    if (!map_cache(filename, cache_version, file, image))
+    {
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+    // Changes logged since the cache was written are merged first, which
+    // leaves a single image to decode.
+    std::vector<LLPointer<LLMappedFile> > segments;
+    std::vector<LLInventoryCacheImage> images(1, image);
+    U32 segment = image.mHeader->mLogSegment;
+    while (read_segment(segment_filename(filename, segment + 1), cache_version, segments, images))
+    {
+        ++segment;
+    }
+    std::vector<U8> merged;
+    if (images.size() > 1)
+    {
+        LLInventoryCacheWriter writer;
+        if (!merge_images(images, writer))
+        {
+            LL_WARNS(LOG_INV) << "Corrupt inventory cache log for " << filename << LL_ENDL;
+            return false;
+        }
+        writer.write(merged, cache_version, segment);
+        image.parse(merged.data(), merged.size());
+        LL_INFOS(LOG_INV) << "Applied " << images.size() - 1 << " logged inventory changes" << LL_ENDL;
+    }
+
+    // Each chunk fills its own slots, so the objects and the pointers
+    // holding them are only ever touched by one thread.
+    LLInventoryModel::cat_array_t loaded_cats(image.mHeader->mNumCategories);
+    bool success = for_each_chunk(image.mHeader->mNumCategories, [&](U32 begin, U32 end)
+    {
+        std::string name;
+        LLUUID id, parent_id, owner_id, thumbnail_id;
+        for (U32 i = begin; i < end; ++i)
+        {
+            const LLInventoryCacheCategory& record = image.mCategories[i];
+            if (!image.getUUID(record.mID, id) || !image.getUUID(record.mParentID, parent_id)
+                || !image.getUUID(record.mOwnerID, owner_id) || !image.getUUID(record.mThumbnailID, thumbnail_id)
+                || !image.getString(record.mName, name))
+            {
+                return false;
+            }
+            LLViewerInventoryCategory* cat = new LLViewerInventoryCategory(
+                id, parent_id, (LLFolderType::EType)record.mPreferredType, name, owner_id);
+            cat->setVersion(record.mVersion);
+            cat->setThumbnailUUID(thumbnail_id);
+            loaded_cats[i] = cat;
+        }
+        return true;
+    });
+
+    LLInventoryModel::item_array_t loaded_items(image.mHeader->mNumItems);
+    success = success && for_each_chunk(image.mHeader->mNumItems, [&](U32 begin, U32 end)
+    {
+        std::string name, desc;
+        LLUUID id, parent_id, asset_id, thumbnail_id, creator_id, owner_id, last_owner_id, group_id;
+        for (U32 i = begin; i < end; ++i)
+        {
+            const LLInventoryCacheItem& record = image.mItems[i];
+            if (!image.getUUID(record.mID, id) || !image.getUUID(record.mParentID, parent_id)
+                || !image.getUUID(record.mAssetID, asset_id) || !image.getUUID(record.mThumbnailID, thumbnail_id)
+                || !image.getUUID(record.mCreatorID, creator_id) || !image.getUUID(record.mOwnerID, owner_id)
+                || !image.getUUID(record.mLastOwnerID, last_owner_id) || !image.getUUID(record.mGroupID, group_id)
+                || !image.getString(record.mName, name) || !image.getString(record.mDescription, desc))
+            {
+                return false;
+            }
+
+            LLPermissions perm;
+            perm.init(creator_id, owner_id, last_owner_id, group_id);
+            perm.setMaskBase(record.mMaskBase);
+            perm.setMaskOwner(record.mMaskOwner);
+            perm.setMaskGroup(record.mMaskGroup);
+            perm.setMaskEveryone(record.mMaskEveryone);
+            perm.setMaskNext(record.mMaskNextOwner);
+            perm.fix();
+
+            LLViewerInventoryItem* item = new LLViewerInventoryItem(
+                id, parent_id, perm, asset_id,
+                (LLAssetType::EType)record.mType,
+                (LLInventoryType::EType)record.mInventoryType,
+                name, desc,
+                LLSaleInfo((LLSaleInfo::EForSale)record.mSaleType, record.mSalePrice),
+                record.mFlags,
+                (time_t)record.mCreationDate);
+            item->setThumbnailUUID(thumbnail_id);
+            loaded_items[i] = item;
+        }
+        return true;
+    });
+
+    if (!success)
+    {
+        LL_WARNS(LOG_INV) << "Corrupt inventory cache " << filename << LL_ENDL;
+        return false;
+    }
+
+    categories.insert(categories.end(), loaded_cats.begin(), loaded_cats.end());
+    items.reserve(items.size() + loaded_items.size());
+    for (LLPointer<LLViewerInventoryItem>& item : loaded_items)
+    {
+        if (item->getUUID().isNull())
+        {
+            continue;
+        }
+        if (item->getType() == LLAssetType::AT_UNKNOWN)
+        {
+            cats_to_update.insert(item->getParentUUID());
+            continue;
+        }
+        item->localizeName();
+        items.push_back(item);
+    }
+
+    if (last_segment)
+    {
+        *last_segment = segment;
+    }
+
+    LL_INFOS(LOG_INV) << "Inventory loaded: " << loaded_cats.size() << " categories, "
+                      << loaded_items.size() << " items." << LL_ENDL;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// save()
+//-----------------------------------------------------------------------------
+// static
+bool LLInventoryCache::save(const std::string& filename,
+                            S32 cache_version,
+                            const LLInventoryModel::cat_array_t& categories,
+                            const LLInventoryModel::item_array_t& items,
+                            U32* last_segment)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    LLInventoryCacheWriter writer;
+    for (const LLPointer<LLViewerInventoryCategory>& cat : categories)
+    {
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            writer.addCategory(cat);
+        }
+    }
+    for (const LLPointer<LLViewerInventoryItem>& item : items)
+    {
+        writer.addItem(item);
+    }
+
+    // The new cache supersedes everything logged so far.
+    const U32 segment = get_last_segment(filename);
+    std::vector<U8> buffer;
+    writer.write(buffer, cache_version, segment);
+    if (!LLFile::replaceContents(filename, buffer.data(), buffer.size()))
+    {
+        return false;
+    }
+    remove_segments(filename, segment);
+    if (last_segment)
+    {
+        *last_segment = segment;
+    }
+
+    LL_INFOS(LOG_INV) << "Inventory saved: " << writer.getCategoryCount() << " categories, "
+                      << writer.getItemCount() << " items to " << filename << LL_ENDL;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// compact()
+//-----------------------------------------------------------------------------
+// static
+bool LLInventoryCache::compact(const std::string& filename, S32 cache_version, U32 last_segment)
+{
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::vector<U8> buffer;
+    U32 segment = 0;
+    size_t num_batches = 0;
+    {
+        LLPointer<LLMappedFile> file;
+        LLInventoryCacheImage image;
+        if (!map_cache(filename, cache_version, file, image))
+        {
+            return false;
+        }
+
+        std::vector<LLPointer<LLMappedFile> > segments;
+        std::vector<LLInventoryCacheImage> images(1, image);
+        segment = image.mHeader->mLogSegment;
+        while (segment < last_segment
+               && read_segment(segment_filename(filename, segment + 1), cache_version, segments, images))
+        {
+            ++segment;
+        }
+        if (segment == image.mHeader->mLogSegment)
+        {
+            // nothing to fold in
+            return true;
+        }
+
+        LLInventoryCacheWriter writer;
+        if (!merge_images(images, writer))
+        {
+            LL_WARNS(LOG_INV) << "Corrupt inventory cache log for " << filename << LL_ENDL;
+            return false;
+        }
+        writer.write(buffer, cache_version, segment);
+        num_batches = images.size() - 1;
+        // the files are unmapped here, before they get replaced
+    }
+
+    if (!LLFile::replaceContents(filename, buffer.data(), buffer.size()))
+    {
+        return false;
+    }
+    remove_segments(filename, segment);
+    LL_INFOS(LOG_INV) << "Compacted " << num_batches << " logged inventory changes into " << filename << LL_ENDL;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// remove()
+//-----------------------------------------------------------------------------
+// static
+void LLInventoryCache::remove(const std::string& filename)
+{
+    remove_segments(filename, get_last_segment(filename));
+    LLFile::remove(filename, ENOENT);
+}
+
+//-----------------------------------------------------------------------------
+// LLInventoryCacheLog
+//-----------------------------------------------------------------------------
+LLInventoryCacheLog::LLInventoryCacheLog(const std::string& filename, S32 cache_version, U32 last_segment)
+:   mFilename(filename),
+    mCacheVersion(cache_version),
+    mFile(NULL),
+    mSegment(last_segment),
+    mUncompactedBytes(0)
+{
+    if (last_segment)
+    {
+        // fold in what previous sessions logged, this returns at once if
+        // the cache already includes it
+        postCompaction(last_segment);
+    }
+    openSegment(last_segment + 1);
+}
+
+LLInventoryCacheLog::~LLInventoryCacheLog()
+{
+    close();
+}
+
+bool LLInventoryCacheLog::openSegment(U32 segment)
+{
+    const std::string segment_file = segment_filename(mFilename, segment);
+    mSegment = segment;
+    mFile = LLFile::fopen(segment_file, "wb");
+    if (!mFile)
+    {
+        LL_WARNS(LOG_INV) << "Unable to open inventory cache log " << segment_file << LL_ENDL;
+        return false;
+    }
+    return true;
+}
+
+void LLInventoryCacheLog::close()
+{
+    if (mFile)
+    {
+        fclose(mFile);
+        mFile = NULL;
+    }
+    if (mCompaction.valid())
+    {
+        mCompaction.get();
+    }
+}
+
+void LLInventoryCacheLog::idle(const LLInventoryModel& model)
+{
+    if (!mChangedIDs.empty() && mFlushTimer.getElapsedTimeF32() > LOG_FLUSH_INTERVAL)
+    {
+        flush(model);
+    }
+}
+
+bool LLInventoryCacheLog::flush(const LLInventoryModel& model)
+{
+    mFlushTimer.reset();
+    if (!mFile)
+    {
+        return false;
+    }
+    if (mChangedIDs.empty())
+    {
+        return true;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    // Only the agent inventory is logged, the library is small and gets
+    // cached on logout.
+    const LLUUID& root_id = model.getRootFolderID();
+    auto in_agent_inventory = [&](const LLUUID& id)
+    {
+        return id == root_id || model.isObjectDescendentOf(id, root_id);
+    };
+    LLInventoryCacheWriter writer;
+    LLInventoryModel::changed_items_t cat_ids;
+    for (const LLUUID& id : mChangedIDs)
+    {
+        if (const LLViewerInventoryItem* item = model.getItem(id))
+        {
+            if (in_agent_inventory(id))
+            {
+                writer.addItem(item);
+                // its folder gained or lost a descendent
+                cat_ids.insert(item->getParentUUID());
+            }
+        }
+        else if (model.getCategory(id))
+        {
+            cat_ids.insert(id);
+        }
+        else
+        {
+            writer.addRemoved(id);
+        }
+    }
+    for (const LLUUID& id : cat_ids)
+    {
+        const LLViewerInventoryCategory* cat = model.getCategory(id);
+        if (!cat || !in_agent_inventory(id))
+        {
+            continue;
+        }
+        // Same test as LLCanCache: a folder is only cached while all of its
+        // contents are known, loadSkeleton() ignores the items of folders
+        // missing from the cache.
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN
+            && cat->getDescendentCount() == cat->getViewerDescendentCount())
+        {
+            writer.addCategory(cat);
+        }
+        else
+        {
+            writer.addRemoved(id);
+        }
+    }
+    mChangedIDs.clear();
+
+    std::vector<U8> buffer;
+    writer.write(buffer, mCacheVersion, 0);
+    LLInventoryCacheLogBatch batch;
+    memcpy(batch.mMagic, LOG_BATCH_MAGIC, sizeof(LOG_BATCH_MAGIC));
+    batch.mSize = (U32)buffer.size();
+    batch.mHash = HBXXH64::digest(buffer.data(), buffer.size());
+    if (fwrite(&batch, sizeof(batch), 1, mFile) != 1
+        || fwrite(buffer.data(), 1, buffer.size(), mFile) != buffer.size()
+        || fflush(mFile) != 0)
+    {
+        LL_WARNS(LOG_INV) << "Unable to write to the inventory cache log, stopped logging" << LL_ENDL;
+        fclose(mFile);
+        mFile = NULL;
+        return false;
+    }
+
+    mUncompactedBytes += sizeof(batch) + buffer.size();
+    if (mUncompactedBytes >= LOG_COMPACT_BYTES)
+    {
+        startCompaction();
+    }
+    return true;
+}
+
+void LLInventoryCacheLog::startCompaction()
+{
+    if (mCompaction.valid())
+    {
+        if (mCompaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            // still busy, try again after the next flush
+            return;
+        }
+        mCompaction.get();
+    }
+
+    // Seal the current segment; new changes go to the next one while the
+    // sealed ones are folded into the cache.
+    const U32 last_segment = mSegment;
+    fclose(mFile);
+    mFile = NULL;
+    if (!openSegment(last_segment + 1))
+    {
+        return;
+    }
+    mUncompactedBytes = 0;
+    postCompaction(last_segment);
+}
+
+void LLInventoryCacheLog::postCompaction(U32 last_segment)
+{
+    auto promise = std::make_shared<std::promise<bool>>();
+    mCompaction = promise->get_future();
+
+    const std::string filename = mFilename;
+    const S32 cache_version = mCacheVersion;
+    auto compact = [promise, filename, cache_version, last_segment]()
+    {
+        promise->set_value(LLInventoryCache::compact(filename, cache_version, last_segment));
+    };
+
+    // Tools and tests run without the viewer's thread pools, and the pool
+    // refuses work once it is shutting down: compact right here then.
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue || !general_queue->post(compact))
+    {
+        compact();
+    }
+}
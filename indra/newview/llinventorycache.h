@@ -0,0 +1,133 @@
+/**
+ * @file llinventorycache.h
+ * @brief Binary, memory mappable inventory cache and its change log.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHE_H
+#define LL_LLINVENTORYCACHE_H
+
+#include "llframetimer.h"
+#include "llinventorymodel.h"
+
+#include <future>
+
+//-----------------------------------------------------------------------------
+// LLInventoryCache
+// Native binary alternative to the line per object notation inventory cache.
+// Every UUID is stored once in a table and every name and description once
+// in a string pool; categories and items are fixed width records of indices
+// into those. Loading maps the file and builds the inventory objects in
+// parallel chunks of records, without parsing any text.
+// The file is only used when both its layout version and the inventory
+// cache version match, anything else makes load() fail so the caller can
+// fall back to the notation cache.
+//
+// Changes made after the cache was written are appended by
+// LLInventoryCacheLog to numbered log segments next to it. load() applies
+// every segment newer than the cache, and compact() folds them into the
+// cache file.
+//-----------------------------------------------------------------------------
+class LLInventoryCache
+{
+public:
+    // Binary cache file corresponding to a notation cache file name as
+    // returned by LLInventoryModel::getInvCacheAddres().
+    static std::string getFilename(const std::string& notation_filename);
+
+    // Same contract as LLInventoryModel::loadFromFile(): items of unknown
+    // type are not returned, their parent goes into cats_to_update instead.
+    // last_segment receives the newest log segment applied, new changes go
+    // to the ones after it.
+    static bool load(const std::string& filename,
+                     S32 cache_version,
+                     LLInventoryModel::cat_array_t& categories,
+                     LLInventoryModel::item_array_t& items,
+                     LLInventoryModel::changed_items_t& cats_to_update,
+                     U32* last_segment = NULL);
+
+    // Writes a complete cache, superseding every existing log segment.
+    // Categories of unknown version are skipped, as in the notation cache.
+    static bool save(const std::string& filename,
+                     S32 cache_version,
+                     const LLInventoryModel::cat_array_t& categories,
+                     const LLInventoryModel::item_array_t& items,
+                     U32* last_segment = NULL);
+
+    // Rewrites the cache with log segments up to and including
+    // last_segment applied, then deletes them. Touches no inventory
+    // objects, so it can run on any thread.
+    static bool compact(const std::string& filename, S32 cache_version, U32 last_segment);
+
+    // Removes the cache and its log.
+    static void remove(const std::string& filename);
+};
+
+//-----------------------------------------------------------------------------
+// LLInventoryCacheLog
+// Write ahead log of agent inventory changes. LLInventoryModel reports the
+// id of everything it changes; the current state of those objects, or
+// their removal, is appended to the log as one batch every few seconds, so
+// a cache is never more than that out of date even if the viewer crashes
+// and logging out only has to write the last batch. Once enough has been
+// logged, the segments written so far are compacted into the cache on the
+// "General" thread pool.
+//-----------------------------------------------------------------------------
+class LLInventoryCacheLog
+{
+public:
+    // Logs changes to the cache filename, whose log runs up to
+    // last_segment. Segments left over from a previous session are
+    // compacted straight away.
+    LLInventoryCacheLog(const std::string& filename, S32 cache_version, U32 last_segment);
+    ~LLInventoryCacheLog();
+
+    void objectChanged(const LLUUID& id)    { mChangedIDs.insert(id); }
+
+    // Flushes pending changes once they are old enough and starts a
+    // compaction when the log has grown large.
+    void idle(const LLInventoryModel& model);
+    // Returns false if the log could not be written, the cache then needs
+    // a full save.
+    bool flush(const LLInventoryModel& model);
+    bool isOpen() const                     { return mFile != NULL; }
+
+    // Waits for any compaction in progress; nothing is logged afterwards.
+    void close();
+
+private:
+    bool openSegment(U32 segment);
+    void startCompaction();
+    void postCompaction(U32 last_segment);
+
+    std::string                         mFilename;
+    S32                                 mCacheVersion;
+    LLFILE*                             mFile;
+    U32                                 mSegment;           // being written to
+    size_t                              mUncompactedBytes;  // logged since the last compaction
+    LLInventoryModel::changed_items_t   mChangedIDs;
+    LLFrameTimer                        mFlushTimer;
+    std::future<bool>                   mCompaction;       // close() waits for it
+};
+
+#endif // LL_LLINVENTORYCACHE_H
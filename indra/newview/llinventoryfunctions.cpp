@@ -3144,6 +3144,14 @@ void LLOpenFilteredFolders::doItem(LLFolderViewItem *item)
     }
 }
 
+void LLOpenFilteredFolders::doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+{
+    if (item->passedFilter())
+    {
+        folder->setOpenArrangeRecursively(true, LLFolderViewFolder::RECURSE_UP);
+    }
+}
+
 void LLOpenFilteredFolders::doFolder(LLFolderViewFolder* folder)
 {
     if (folder->LLFolderViewItem::passedFilter() && folder->getParentFolder())
@@ -3170,6 +3178,20 @@ void LLSelectFirstFilteredItem::doItem(LLFolderViewItem *item)
     }
 }
 
+void LLSelectFirstFilteredItem::doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+{
+    if (item->passedFilter() && !mItemSelected)
+    {
+        LLFolderViewItem* itemp = folder->buildUnbuiltItem(item);
+        if (itemp)
+        {
+            itemp->getRoot()->setSelection(itemp, false, false);
+            folder->setOpenArrangeRecursively(true, LLFolderViewFolder::RECURSE_UP);
+            mItemSelected = true;
+        }
+    }
+}
+
 void LLSelectFirstFilteredItem::doFolder(LLFolderViewFolder* folder)
 {
     // Skip if folder or item already found, if not filtered or if no parent (root folder is not selectable)
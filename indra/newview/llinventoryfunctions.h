@@ -193,9 +193,25 @@ private:
 class LLInventoryCollectFunctor
 {
 public:
+    static const U64 ANY_ITEM_TYPE = ~0ULL;
+
     virtual ~LLInventoryCollectFunctor(){};
     virtual bool operator()(LLInventoryCategory* cat, LLInventoryItem* item) = 0;
 
+    // Hints that let collectDescendentsIf() skip what operator() is known
+    // to reject. They may narrow down what operator() accepts, never widen
+    // it. Links are offered whatever the type mask, since they take the
+    // type of what they point to.
+    virtual U64 getItemTypeMask() const { return ANY_ITEM_TYPE; }
+    virtual bool acceptsCategories() const { return true; }
+    // Lower case text contained in the name of everything accepted.
+    virtual const std::string& getNameHint() const { return LLStringUtil::null; }
+
+    static U64 getTypeBit(LLAssetType::EType type)
+    {
+        return (type >= 0 && type < 64) ? (1ULL << type) : ANY_ITEM_TYPE;
+    }
+
     static bool itemTransferCommonlyAllowed(const LLInventoryItem* item);
 };
 
@@ -248,6 +264,8 @@ public:
     virtual ~LLIsType() {}
     virtual bool operator()(LLInventoryCategory* cat,
                             LLInventoryItem* item);
+    virtual U64 getItemTypeMask() const { return getTypeBit(mType); }
+    virtual bool acceptsCategories() const { return mType == LLAssetType::AT_CATEGORY; }
 protected:
     LLAssetType::EType mType;
 };
@@ -284,6 +302,8 @@ public:
     virtual ~LLIsOfAssetType() {}
     virtual bool operator()(LLInventoryCategory* cat,
                             LLInventoryItem* item);
+    virtual U64 getItemTypeMask() const { return getTypeBit(mType); }
+    virtual bool acceptsCategories() const { return mType == LLAssetType::AT_CATEGORY; }
 protected:
     LLAssetType::EType mType;
 };
@@ -325,6 +345,8 @@ public:
     virtual ~LLIsTypeWithPermissions() {}
     virtual bool operator()(LLInventoryCategory* cat,
                             LLInventoryItem* item);
+    virtual U64 getItemTypeMask() const { return getTypeBit(mType); }
+    virtual bool acceptsCategories() const { return mType == LLAssetType::AT_CATEGORY; }
 protected:
     LLAssetType::EType mType;
     PermissionBit mPerm;
@@ -390,12 +412,18 @@ protected:
 class LLNameCategoryCollector : public LLInventoryCollectFunctor
 {
 public:
-    LLNameCategoryCollector(const std::string& name) : mName(name) {}
+    LLNameCategoryCollector(const std::string& name) : mName(name), mNameHint(name)
+    {
+        LLStringUtil::toLower(mNameHint);
+    }
     virtual ~LLNameCategoryCollector() {}
     virtual bool operator()(LLInventoryCategory* cat,
                             LLInventoryItem* item);
+    virtual U64 getItemTypeMask() const { return 0; }
+    virtual const std::string& getNameHint() const { return mNameHint; }
 protected:
     std::string mName;
+    std::string mNameHint;
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -495,6 +523,11 @@ public:
     virtual ~LLFindWearables() {}
     virtual bool operator()(LLInventoryCategory* cat,
                             LLInventoryItem* item);
+    virtual U64 getItemTypeMask() const
+    {
+        return getTypeBit(LLAssetType::AT_CLOTHING) | getTypeBit(LLAssetType::AT_BODYPART);
+    }
+    virtual bool acceptsCategories() const { return false; }
 };
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -0,0 +1,513 @@
+/**
+ * @file llinventoryindex.cpp
+ * @brief Flat parent-child, type and name index of the inventory model.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventoryindex.h"
+
+#include "llinventoryfunctions.h"
+#include "llviewerinventory.h"
+
+// Guards the walks up the parent chain against a corrupt, cyclic tree.
+static const U32 MAX_DEPTH = 1024;
+// Stale name postings tolerated before the name index is rebuilt.
+static const size_t MIN_STALE_TRIGRAMS = 4096;
+
+static inline U32 trigram_at(const std::string& str, size_t pos)
+{
+    return (U32)(U8)str[pos] | ((U32)(U8)str[pos + 1] << 8) | ((U32)(U8)str[pos + 2] << 16);
+}
+
+static inline size_t trigram_count(const std::string& str)
+{
+    return str.size() >= 3 ? str.size() - 2 : 0;
+}
+
+LLInventoryIndex::LLInventoryIndex()
+:   mLiveTrigrams(0),
+    mStaleTrigrams(0)
+{
+}
+
+void LLInventoryIndex::clear()
+{
+    mEntries.clear();
+    mFreeSlots.clear();
+    mSlots.clear();
+    mOrphans.clear();
+    for (std::vector<U32>& slots : mTypeSlots)
+    {
+        slots.clear();
+    }
+    mTrigrams.clear();
+    mLiveTrigrams = 0;
+    mStaleTrigrams = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Updates
+//-----------------------------------------------------------------------------
+void LLInventoryIndex::update(const LLUUID& id, LLViewerInventoryCategory* cat, LLViewerInventoryItem* item)
+{
+    if (id.isNull())
+    {
+        return;
+    }
+
+    auto found = mSlots.find(id);
+    if (found != mSlots.end())
+    {
+        const Entry& entry = mEntries[found->second];
+        if ((!cat && !item) || (cat && entry.mItem) || (item && entry.mCategory))
+        {
+            // gone, or replaced by an object of the other kind
+            freeSlot(found->second);
+            found = mSlots.end();
+        }
+    }
+    if (!cat && !item)
+    {
+        return;
+    }
+
+    const LLInventoryObject* obj = cat ? (const LLInventoryObject*)cat : (const LLInventoryObject*)item;
+    U32 slot;
+    if (found == mSlots.end())
+    {
+        slot = allocSlot(id);
+        Entry& entry = mEntries[slot];
+        entry.mCategory = cat;
+        entry.mItem = item;
+        entry.mParentID = obj->getParentUUID();
+        attach(slot);
+        if (cat)
+        {
+            adoptOrphans(slot);
+        }
+    }
+    else
+    {
+        slot = found->second;
+        Entry& entry = mEntries[slot];
+        // the model may have replaced the object with a new instance
+        entry.mCategory = cat;
+        entry.mItem = item;
+        if (entry.mParentID != obj->getParentUUID())
+        {
+            detach(slot);
+            mEntries[slot].mParentID = obj->getParentUUID();
+            attach(slot);
+        }
+    }
+
+    S32 type_list = -1;
+    if (item)
+    {
+        const S32 type = item->getActualType();
+        type_list = (type >= 0 && type < OTHER_TYPES) ? type : OTHER_TYPES;
+    }
+    setType(slot, type_list);
+    setName(slot, obj->getName());
+}
+
+U32 LLInventoryIndex::allocSlot(const LLUUID& id)
+{
+    U32 slot;
+    if (mFreeSlots.empty())
+    {
+        slot = (U32)mEntries.size();
+        mEntries.emplace_back();
+    }
+    else
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    mEntries[slot].mID = id;
+    mSlots[id] = slot;
+    return slot;
+}
+
+void LLInventoryIndex::freeSlot(U32 slot)
+{
+    const LLUUID id = mEntries[slot].mID;
+    mSlots.erase(id);
+
+    // The contents of a removed folder wait for it to come back, until
+    // they get removed themselves.
+    std::vector<U32> children(mEntries[slot].mChildCategories);
+    children.insert(children.end(), mEntries[slot].mChildItems.begin(), mEntries[slot].mChildItems.end());
+    for (U32 child : children)
+    {
+        detach(child);
+        attach(child);
+    }
+
+    detach(slot);
+    setType(slot, -1);
+    setName(slot, LLStringUtil::null);
+    mEntries[slot] = Entry();
+    mFreeSlots.push_back(slot);
+}
+
+void LLInventoryIndex::attach(U32 slot)
+{
+    Entry& entry = mEntries[slot];
+    entry.mParent = NO_SLOT;
+    if (entry.mParentID.isNull())
+    {
+        // top level folder
+        return;
+    }
+
+    std::vector<U32>* siblings;
+    auto parent = mSlots.find(entry.mParentID);
+    if (parent != mSlots.end() && mEntries[parent->second].mCategory)
+    {
+        entry.mParent = parent->second;
+        Entry& parent_entry = mEntries[entry.mParent];
+        siblings = entry.mCategory ? &parent_entry.mChildCategories : &parent_entry.mChildItems;
+        addItemCount(entry.mParent, entry.mItem ? 1 : (S32)entry.mItemCount);
+    }
+    else
+    {
+        siblings = &mOrphans[entry.mParentID];
+    }
+    entry.mChildPos = (U32)siblings->size();
+    siblings->push_back(slot);
+}
+
+void LLInventoryIndex::detach(U32 slot)
+{
+    Entry& entry = mEntries[slot];
+    std::vector<U32>* siblings = NULL;
+    if (entry.mParent != NO_SLOT)
+    {
+        Entry& parent_entry = mEntries[entry.mParent];
+        siblings = entry.mCategory ? &parent_entry.mChildCategories : &parent_entry.mChildItems;
+        addItemCount(entry.mParent, entry.mItem ? -1 : -(S32)entry.mItemCount);
+    }
+    else if (entry.mParentID.notNull())
+    {
+        auto orphans = mOrphans.find(entry.mParentID);
+        if (orphans != mOrphans.end())
+        {
+            siblings = &orphans->second;
+        }
+    }
+
+    if (siblings && entry.mChildPos < siblings->size() && (*siblings)[entry.mChildPos] == slot)
+    {
+        const U32 last = siblings->back();
+        (*siblings)[entry.mChildPos] = last;
+        mEntries[last].mChildPos = entry.mChildPos;
+        siblings->pop_back();
+        if (siblings->empty() && entry.mParent == NO_SLOT)
+        {
+            mOrphans.erase(entry.mParentID);
+        }
+    }
+    entry.mParent = NO_SLOT;
+}
+
+void LLInventoryIndex::adoptOrphans(U32 slot)
+{
+    auto orphans = mOrphans.find(mEntries[slot].mID);
+    if (orphans == mOrphans.end())
+    {
+        return;
+    }
+    std::vector<U32> children;
+    children.swap(orphans->second);
+    mOrphans.erase(orphans);
+    for (U32 child : children)
+    {
+        attach(child);
+    }
+}
+
+void LLInventoryIndex::addItemCount(U32 slot, S32 delta)
+{
+    for (U32 depth = 0; slot != NO_SLOT && depth < MAX_DEPTH; ++depth)
+    {
+        Entry& entry = mEntries[slot];
+        entry.mItemCount += delta;
+        slot = entry.mParent;
+    }
+}
+
+void LLInventoryIndex::setType(U32 slot, S32 type_list)
+{
+    Entry& entry = mEntries[slot];
+    if (entry.mTypeList == type_list)
+    {
+        return;
+    }
+    if (entry.mTypeList >= 0)
+    {
+        std::vector<U32>& slots = mTypeSlots[entry.mTypeList];
+        const U32 last = slots.back();
+        slots[entry.mTypePos] = last;
+        mEntries[last].mTypePos = entry.mTypePos;
+        slots.pop_back();
+    }
+    entry.mTypeList = type_list;
+    if (type_list >= 0)
+    {
+        std::vector<U32>& slots = mTypeSlots[type_list];
+        entry.mTypePos = (U32)slots.size();
+        slots.push_back(slot);
+    }
+}
+
+void LLInventoryIndex::setName(U32 slot, const std::string& name)
+{
+    std::string lower_name(name);
+    LLStringUtil::toLower(lower_name);
+    Entry& entry = mEntries[slot];
+    if (entry.mName == lower_name)
+    {
+        return;
+    }
+
+    // the old postings are skipped by lookups from now on
+    const size_t old_count = trigram_count(entry.mName);
+    mStaleTrigrams += old_count;
+    mLiveTrigrams -= old_count;
+
+    entry.mName.swap(lower_name);
+    const size_t count = trigram_count(entry.mName);
+    for (size_t i = 0; i < count; ++i)
+    {
+        mTrigrams[trigram_at(entry.mName, i)].push_back(slot);
+    }
+    mLiveTrigrams += count;
+
+    if (mStaleTrigrams > MIN_STALE_TRIGRAMS && mStaleTrigrams > mLiveTrigrams)
+    {
+        rebuildNames();
+    }
+}
+
+void LLInventoryIndex::rebuildNames()
+{
+    mTrigrams.clear();
+    mLiveTrigrams = 0;
+    mStaleTrigrams = 0;
+    for (U32 slot = 0; slot < mEntries.size(); ++slot)
+    {
+        const std::string& name = mEntries[slot].mName;
+        const size_t count = trigram_count(name);
+        for (size_t i = 0; i < count; ++i)
+        {
+            mTrigrams[trigram_at(name, i)].push_back(slot);
+        }
+        mLiveTrigrams += count;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Lookups
+//-----------------------------------------------------------------------------
+// Like LLInventoryModel::isObjectDescendentOf(), except that anything under
+// exclude is not.
+bool LLInventoryIndex::isDescendent(U32 slot, U32 ancestor, U32 exclude) const
+{
+    slot = mEntries[slot].mParent;
+    for (U32 depth = 0; slot != NO_SLOT && depth < MAX_DEPTH; ++depth)
+    {
+        if (slot == ancestor)
+        {
+            return true;
+        }
+        if (slot == exclude)
+        {
+            return false;
+        }
+        slot = mEntries[slot].mParent;
+    }
+    return false;
+}
+
+bool LLInventoryIndex::acceptItem(const Entry& entry, U64 type_mask) const
+{
+    if (!entry.mItem)
+    {
+        return false;
+    }
+    if (type_mask == LLInventoryCollectFunctor::ANY_ITEM_TYPE
+        || entry.mTypeList == LLAssetType::AT_LINK || entry.mTypeList == LLAssetType::AT_LINK_FOLDER)
+    {
+        return true;
+    }
+    return entry.mTypeList < OTHER_TYPES && (type_mask & (1ULL << entry.mTypeList));
+}
+
+// Same order as the tree walk in LLInventoryModel: each folder, then what it
+// holds, then the items next to it.
+void LLInventoryIndex::collectTree(U32 slot, U32 exclude, LLInventoryCollectFunctor& add,
+                                   cat_array_t& cats, item_array_t& items, bool items_too) const
+{
+    const Entry& entry = mEntries[slot];
+    for (U32 child : entry.mChildCategories)
+    {
+        LLViewerInventoryCategory* cat = mEntries[child].mCategory;
+        if (add(cat, NULL))
+        {
+            cats.push_back(cat);
+        }
+        if (child != exclude)
+        {
+            collectTree(child, exclude, add, cats, items, items_too);
+        }
+    }
+    if (items_too)
+    {
+        for (U32 child : entry.mChildItems)
+        {
+            LLViewerInventoryItem* item = mEntries[child].mItem;
+            if (add(NULL, item))
+            {
+                items.push_back(item);
+            }
+        }
+    }
+}
+
+bool LLInventoryIndex::collectDescendentsIf(const LLUUID& id,
+                                            const LLUUID& exclude_id,
+                                            LLInventoryCollectFunctor& add,
+                                            cat_array_t& cats,
+                                            item_array_t& items) const
+{
+    auto found = mSlots.find(id);
+    if (found == mSlots.end() || !mEntries[found->second].mCategory)
+    {
+        return false;
+    }
+    const U32 root = found->second;
+    U32 exclude = NO_SLOT;
+    if (exclude_id.notNull())
+    {
+        auto excluded = mSlots.find(exclude_id);
+        if (excluded != mSlots.end())
+        {
+            exclude = excluded->second;
+        }
+    }
+    if (root == exclude)
+    {
+        return true;
+    }
+
+    const U64 type_mask = add.getItemTypeMask();
+    const bool want_categories = add.acceptsCategories();
+
+    // Only what contains the rarest three letters of the name can match.
+    const std::string& name = add.getNameHint();
+    if (name.size() >= 3)
+    {
+        const std::vector<U32>* postings = NULL;
+        for (size_t i = 0, count = trigram_count(name); i < count; ++i)
+        {
+            auto trigram = mTrigrams.find(trigram_at(name, i));
+            if (trigram == mTrigrams.end())
+            {
+                return true;
+            }
+            if (!postings || trigram->second.size() < postings->size())
+            {
+                postings = &trigram->second;
+            }
+        }
+
+        // stale postings may repeat a slot
+        std::vector<U32> candidates(*postings);
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        for (U32 slot : candidates)
+        {
+            const Entry& entry = mEntries[slot];
+            if (entry.mName.find(name) == std::string::npos
+                || !(entry.mCategory ? want_categories : acceptItem(entry, type_mask))
+                || !isDescendent(slot, root, exclude))
+            {
+                continue;
+            }
+            if (entry.mCategory)
+            {
+                if (add(entry.mCategory, NULL))
+                {
+                    cats.push_back(entry.mCategory);
+                }
+            }
+            else if (add(NULL, entry.mItem))
+            {
+                items.push_back(entry.mItem);
+            }
+        }
+        return true;
+    }
+
+    // Going through the items of the wanted types is cheaper than walking
+    // the tree when there are fewer of them than items under the folder.
+    if (type_mask != LLInventoryCollectFunctor::ANY_ITEM_TYPE)
+    {
+        std::vector<S32> type_lists;
+        size_t candidates = 0;
+        for (S32 type = 0; type < OTHER_TYPES; ++type)
+        {
+            if ((type_mask & (1ULL << type)) || type == LLAssetType::AT_LINK || type == LLAssetType::AT_LINK_FOLDER)
+            {
+                type_lists.push_back(type);
+                candidates += mTypeSlots[type].size();
+            }
+        }
+
+        if (candidates < mEntries[root].mItemCount)
+        {
+            if (want_categories)
+            {
+                collectTree(root, exclude, add, cats, items, false);
+            }
+            for (S32 type : type_lists)
+            {
+                for (U32 slot : mTypeSlots[type])
+                {
+                    LLViewerInventoryItem* item = mEntries[slot].mItem;
+                    if (isDescendent(slot, root, exclude) && add(NULL, item))
+                    {
+                        items.push_back(item);
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    collectTree(root, exclude, add, cats, items, true);
+    return true;
+}
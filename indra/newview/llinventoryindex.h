@@ -0,0 +1,127 @@
+/**
+ * @file llinventoryindex.h
+ * @brief Flat parent-child, type and name index of the inventory model.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYINDEX_H
+#define LL_LLINVENTORYINDEX_H
+
+#include "llassettype.h"
+#include "llpointer.h"
+#include "lluuid.h"
+
+#include <unordered_map>
+#include <vector>
+
+class LLInventoryCollectFunctor;
+class LLViewerInventoryCategory;
+class LLViewerInventoryItem;
+
+//-----------------------------------------------------------------------------
+// LLInventoryIndex
+// Secondary index of every object in LLInventoryModel, kept up to date one
+// object at a time as the model reports changes. Objects live in a slot
+// table and refer to each other by slot, so walking a folder tree needs no
+// UUID lookups. On top of it, items are listed by asset type and names by
+// their three letter substrings, which lets collectDescendentsIf() visit
+// only the candidates a functor could accept rather than a whole subtree.
+//-----------------------------------------------------------------------------
+class LLInventoryIndex
+{
+public:
+    typedef std::vector<LLPointer<LLViewerInventoryCategory> > cat_array_t;
+    typedef std::vector<LLPointer<LLViewerInventoryItem> > item_array_t;
+
+    LLInventoryIndex();
+
+    void clear();
+
+    // Brings the entry for id in line with the model's object, which is
+    // either cat or item; removes it when both are NULL.
+    void update(const LLUUID& id, LLViewerInventoryCategory* cat, LLViewerInventoryItem* item);
+
+    // Same results as the tree walk of LLInventoryModel::collectDescendentsIf(),
+    // in no particular order. exclude_id is a folder whose contents are
+    // skipped, normally the trash. Returns false if id is not an indexed
+    // folder.
+    bool collectDescendentsIf(const LLUUID& id,
+                              const LLUUID& exclude_id,
+                              LLInventoryCollectFunctor& add,
+                              cat_array_t& cats,
+                              item_array_t& items) const;
+
+    size_t size() const                     { return mSlots.size(); }
+
+private:
+    static const U32 NO_SLOT = (U32)-1;
+    // Items whose asset type does not fit a type mask.
+    static const S32 OTHER_TYPES = LLAssetType::AT_COUNT;
+
+    struct Entry
+    {
+        LLUUID                              mID;
+        LLUUID                              mParentID;
+        LLPointer<LLViewerInventoryCategory> mCategory;
+        LLPointer<LLViewerInventoryItem>    mItem;
+        std::string                         mName;          // lower case
+        U32                                 mParent = NO_SLOT;
+        U32                                 mChildPos = 0;  // in the parent's or orphan list
+        U32                                 mTypePos = 0;   // in mTypeSlots
+        S32                                 mTypeList = -1;
+        U32                                 mItemCount = 0; // items in the subtree of a folder
+        std::vector<U32>                    mChildCategories;
+        std::vector<U32>                    mChildItems;
+    };
+
+    U32 allocSlot(const LLUUID& id);
+    void freeSlot(U32 slot);
+
+    void attach(U32 slot);
+    void detach(U32 slot);
+    void adoptOrphans(U32 slot);
+    void addItemCount(U32 slot, S32 delta);
+
+    void setType(U32 slot, S32 type_list);
+    void setName(U32 slot, const std::string& name);
+    void rebuildNames();
+
+    bool isDescendent(U32 slot, U32 ancestor, U32 exclude) const;
+    void collectTree(U32 slot, U32 exclude, LLInventoryCollectFunctor& add,
+                     cat_array_t& cats, item_array_t& items, bool items_too) const;
+    bool acceptItem(const Entry& entry, U64 type_mask) const;
+
+    std::vector<Entry>                      mEntries;
+    std::vector<U32>                        mFreeSlots;
+    std::unordered_map<LLUUID, U32>         mSlots;
+    // Objects whose parent folder is not in the index (yet), by parent id.
+    std::unordered_map<LLUUID, std::vector<U32> > mOrphans;
+    std::vector<U32>                        mTypeSlots[OTHER_TYPES + 1];
+    // Slots by trigram of their name. Renamed and removed objects are left
+    // in place until enough of them pile up, lookups check the name anyway.
+    std::unordered_map<U32, std::vector<U32> > mTrigrams;
+    size_t                                  mLiveTrigrams;
+    size_t                                  mStaleTrigrams;
+};
+
+#endif // LL_LLINVENTORYINDEX_H
@@ -40,6 +40,7 @@
 #include "lldispatcher.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
+#include "llinventorycache.h"
 #include "llinventoryfunctions.h"
 #include "llinventorymodelbackgroundfetch.h"
 #include "llinventoryobserver.h"
@@ -1371,6 +1372,16 @@ void LLInventoryModel::collectDescendentsIf(const LLUUID& id,
         if(trash_id.notNull() && (trash_id == id))
             return;
     }
+
+    // The index covers the whole subtree at once, folder links aside.
+    static LLCachedControl<bool> use_index(gSavedSettings, "InventoryUseIndex", true);
+    if (use_index && !follow_folder_links && isInventoryUsable()
+        && mIndex.collectDescendentsIf(id, include_trash ? LLUUID::null : findCategoryUUIDForType(LLFolderType::FT_TRASH),
+                                       add, cats, items))
+    {
+        return;
+    }
+
     cat_array_t* cat_array = get_ptr_in_map(mParentChildCategoryTree, id);
     if(cat_array)
     {
@@ -2278,6 +2289,11 @@ bool LLInventoryModel::containsObserver(LLInventoryObserver* observer) const
 
 void LLInventoryModel::idleNotifyObservers()
 {
+    if (mCacheLog)
+    {
+        mCacheLog->idle(*this);
+    }
+
     // *FIX:  Think I want this conditional or moved elsewhere...
     handleResponses(true);
 
@@ -2385,6 +2401,12 @@ void LLInventoryModel::addChangedMask(U32 mask, const LLUUID& referent)
         mModifyMask |= mask;
     }
 
+    if (mCacheLog && referent.notNull())
+    {
+        mCacheLog->objectChanged(referent);
+    }
+    mIndex.update(referent, getCategory(referent), getItem(referent));
+
     bool needs_update = false;
     if (referent.notNull())
     {
@@ -2501,6 +2523,17 @@ void LLInventoryModel::cache(
 {
     LL_DEBUGS(LOG_INV) << "Caching " << parent_folder_id << " for " << agent_id
                        << LL_ENDL;
+    if (mCacheLog && parent_folder_id == getRootFolderID())
+    {
+        // Everything else is on disk already, only the last changes are
+        // left to write.
+        bool flushed = mCacheLog->flush(*this);
+        mCacheLog.reset();
+        if (flushed)
+        {
+            return;
+        }
+    }
     LLViewerInventoryCategory* root_cat = getCategory(parent_folder_id);
     if(!root_cat) return;
     cat_array_t categories;
@@ -2515,12 +2548,24 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
+    const std::string inventory_filename = getInvCacheAddres(agent_id);
+    const std::string binary_filename = LLInventoryCache::getFilename(inventory_filename);
+    std::string gzip_filename(inventory_filename);
+    gzip_filename.append(".gz");
+    if (gSavedSettings.getBOOL("InventoryBinaryCache")
+        && LLInventoryCache::save(binary_filename, sCurrentInvCacheVersion, categories, items))
+    {
+        // Only one of the two caches is kept, so an old copy of the other
+        // can't be loaded later on.
+        LLFile::remove(gzip_filename, ENOENT);
+        return;
+    }
+    LLInventoryCache::remove(binary_filename);
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
     saveToFile(temp_file, categories, items);
-    std::string gzip_filename = getInvCacheAddres(agent_id);
-    gzip_filename.append(".gz");
     if(gzip_file(temp_file, gzip_filename))
     {
         LL_DEBUGS(LOG_INV) << "Successfully compressed " << temp_file << " to " << gzip_filename << LL_ENDL;
@@ -2549,6 +2594,7 @@ void LLInventoryModel::addCategory(LLViewerInventoryCategory* category)
 
         // Insert category uniquely into the map
         mCategoryMap[category->getUUID()] = category; // LLPointer will deref and delete the old one
+        mIndex.update(category->getUUID(), category, NULL);
         //mInventory[category->getUUID()] = category;
     }
 }
@@ -2682,6 +2728,7 @@ void LLInventoryModel::addItem(LLViewerInventoryItem* item)
             addBacklinkInfo(link_id, target_id);
         }
         mItemMap[item->getUUID()] = item;
+        mIndex.update(item->getUUID(), NULL, item);
     }
 }
 
@@ -2702,6 +2749,7 @@ void LLInventoryModel::empty()
     mBacklinkMMap.clear(); // forget all backlink information.
     mCategoryMap.clear(); // remove all references (should delete entries)
     mItemMap.clear(); // remove all references (should delete entries)
+    mIndex.clear();
     mLastItem = NULL;
     //mInventory.clear();
 }
@@ -2851,6 +2899,7 @@ bool LLInventoryModel::loadSkeleton(
             LL_INFOS("LLInventoryModel") << "Purging inventory cache file: " << inventory_filename << LL_ENDL;
             LLFile::remove(inventory_filename);
         }
+        LLInventoryCache::remove(LLInventoryCache::getFilename(getInvCacheAddres(owner_id)));
 
         // also delete library cache if inventory cache is purged, so issues with EEP settings going missing
         // and bridge objects not being found can be resolved
@@ -2870,6 +2919,7 @@ bool LLInventoryModel::loadSkeleton(
             LL_INFOS("LLInventoryModel") << "Purging library cache file: " << inventory_filename << LL_ENDL;
             LLFile::remove(inventory_filename);
         }
+        LLInventoryCache::remove(LLInventoryCache::getFilename(getInvCacheAddres(gInventory.getLibraryOwnerID())));
 
         LL_INFOS("LLInventoryModel") << "Clear inventory cache marker removed: " << delete_cache_marker << LL_ENDL;
         LLFile::remove(delete_cache_marker);
@@ -2932,37 +2982,48 @@ bool LLInventoryModel::loadSkeleton(
         const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
         std::string gzip_filename(inventory_filename);
         gzip_filename.append(".gz");
-        LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
         bool remove_inventory_file = false;
-        if (LLAppViewer::instance()->isSecondInstance())
-        {
-            // Safeguard viewer against trying to unpack file twice
-            // ex: user logs into two accounts simultaneously, so two
-            // viewers are trying to unpack library into same file
-            //
-            // Would be better to do it in gunzip_file, but it doesn't
-            // have access to llfilesystem
-            inventory_filename = gDirUtilp->getTempFilename();
-            remove_inventory_file = true;
-        }
-        if(fp)
-        {
-            fclose(fp);
-            fp = NULL;
-            if(gunzip_file(gzip_filename, inventory_filename))
+        bool is_cache_obsolete = false;
+        // The binary cache is mapped read only, so it needs none of the
+        // unpacking below and is safe to share with a second instance.
+        U32 last_log_segment = 0;
+        const bool binary_cache_loaded = gSavedSettings.getBOOL("InventoryBinaryCache")
+            && LLInventoryCache::load(LLInventoryCache::getFilename(inventory_filename), sCurrentInvCacheVersion,
+                                      categories, items, categories_to_update, &last_log_segment);
+        bool cache_loaded = binary_cache_loaded;
+        if (!cache_loaded)
+        {
+            LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+            if (LLAppViewer::instance()->isSecondInstance())
             {
-                // we only want to remove the inventory file if it was
-                // gzipped before we loaded, and we successfully
-                // gunziped it.
+                // Safeguard viewer against trying to unpack file twice
+                // ex: user logs into two accounts simultaneously, so two
+                // viewers are trying to unpack library into same file
+                //
+                // Would be better to do it in gunzip_file, but it doesn't
+                // have access to llfilesystem
+                inventory_filename = gDirUtilp->getTempFilename();
                 remove_inventory_file = true;
             }
-            else
+            if(fp)
             {
-                LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                fclose(fp);
+                fp = NULL;
+                if(gunzip_file(gzip_filename, inventory_filename))
+                {
+                    // we only want to remove the inventory file if it was
+                    // gzipped before we loaded, and we successfully
+                    // gunziped it.
+                    remove_inventory_file = true;
+                }
+                else
+                {
+                    LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                }
             }
+            cache_loaded = loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
         }
-        bool is_cache_obsolete = false;
-        if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        if (cache_loaded)
         {
             // We were able to find a cache of files. So, use what we
             // found to generate a set of categories we should add. We
@@ -3157,6 +3218,30 @@ bool LLInventoryModel::loadSkeleton(
             LL_WARNS(LOG_INV) << "Inv cache out of date, removing" << LL_ENDL;
             LLFile::remove(gzip_filename);
         }
+        if (binary_cache_loaded && owner_id == gAgent.getID()
+            && gSavedSettings.getBOOL("InventoryCacheLog")
+            && !LLAppViewer::instance()->isSecondInstance())
+        {
+            // Log changes from here on. Whatever was loaded but not taken
+            // into the model is out of date, so the first batch drops it.
+            mCacheLog.reset(new LLInventoryCacheLog(LLInventoryCache::getFilename(getInvCacheAddres(owner_id)),
+                                                    sCurrentInvCacheVersion, last_log_segment));
+            for (const LLPointer<LLViewerInventoryCategory>& cat : categories)
+            {
+                const LLViewerInventoryCategory* model_cat = getCategory(cat->getUUID());
+                if (!model_cat || model_cat->getVersion() == NO_VERSION)
+                {
+                    mCacheLog->objectChanged(cat->getUUID());
+                }
+            }
+            for (const LLPointer<LLViewerInventoryItem>& item : items)
+            {
+                if (!getItem(item->getUUID()))
+                {
+                    mCacheLog->objectChanged(item->getUUID());
+                }
+            }
+        }
         categories.clear(); // will unref and delete entries
     }
 
@@ -3378,6 +3463,16 @@ void LLInventoryModel::buildParentChildMap()
         }
     }
 
+    // Lost categories and items were moved above without telling the index.
+    for (auto& cat : mCategoryMap)
+    {
+        mIndex.update(cat.first, cat.second, NULL);
+    }
+    for (auto& item : mItemMap)
+    {
+        mIndex.update(item.first, NULL, item.second);
+    }
+
     const LLUUID &agent_inv_root_id = gInventory.getRootFolderID();
     if (agent_inv_root_id.notNull())
     {
@@ -4895,6 +4990,15 @@ LLPointer<LLInventoryValidationInfo> LLInventoryModel::validate() const
         validation_info->mWarnings["category_map_size"]++;
         warning_count++;
     }
+    if (mIndex.size() != mCategoryMap.size() + mItemMap.size())
+    {
+        LL_INFOS("Inventory") << "unexpected sizes: index size " << mIndex.size()
+                              << " cat map size " << mCategoryMap.size()
+                              << " item map size " << mItemMap.size() << LL_ENDL;
+
+        validation_info->mWarnings["index_size"]++;
+        warning_count++;
+    }
     S32 cat_lock = 0;
     S32 item_lock = 0;
     S32 desc_unknown_count = 0;
@@ -28,6 +28,7 @@
 #define LL_LLINVENTORYMODEL_H
 
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -35,6 +36,7 @@
 #include "llassettype.h"
 #include "llfoldertype.h"
 #include "llframetimer.h"
+#include "llinventoryindex.h"
 #include "lluuid.h"
 #include "llpermissionsflags.h"
 #include "llviewerinventory.h"
@@ -57,6 +59,7 @@ class LLInventoryItem;
 class LLInventoryCategory;
 class LLMessageSystem;
 class LLInventoryCollectFunctor;
+class LLInventoryCacheLog;
 
 ///----------------------------------------------------------------------------
 /// LLInventoryValidationInfo
@@ -729,6 +732,11 @@ protected:
     static bool saveToFile(const std::string& filename,
                            const cat_array_t& categories,
                            const item_array_t& items);
+private:
+    // Agent inventory changes logged since the binary cache was loaded
+    std::unique_ptr<LLInventoryCacheLog> mCacheLog;
+    // Flat copy of the parent-child maps for collectDescendentsIf()
+    LLInventoryIndex mIndex;
 
     //--------------------------------------------------------------------
     // Message handling functionality
@@ -329,6 +329,10 @@ void LLInventoryPanel::initFolderRoot()
     addChild(mScroller);
     mScroller->addChild(mFolderRoot.get());
     mFolderRoot.get()->setScrollContainer(mScroller);
+    if (mParams.build_items_lazily)
+    {
+        mFolderRoot.get()->setBuildItemCallback(boost::bind(&LLInventoryPanel::buildUnbuiltItem, this, _1, _2));
+    }
     mFolderRoot.get()->setFollowsAll();
     mFolderRoot.get()->addChild(mFolderRoot.get()->mStatusTextBox);
 
@@ -889,6 +893,10 @@ struct DirtyFilterFunctor : public LLFolderViewFunctor
     {
         item->getViewModelItem()->dirtyFilter();
     }
+    /*virtual*/ void doUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+    {
+        item->dirtyFilter();
+    }
 };
 
 void LLInventoryPanel::idle(void* user_data)
@@ -1230,6 +1238,13 @@ LLFolderViewItem* LLInventoryPanel::buildViewsTree(const LLUUID& id,
 
                 if (new_listener)
                 {
+                    if (mFolderRoot.get()->buildsItemsLazily())
+                    {
+                        // the widget is built once the item is drawn or looked up
+                        parent_folder->addUnbuiltItem(new_listener);
+                        mUnbuiltItemMap[id] = parent_folder->getDerivedHandle<LLFolderViewFolder>();
+                        return NULL;
+                    }
                 folder_view_item = createFolderViewItem(new_listener);
                 }
             }
@@ -1376,7 +1391,8 @@ LLFolderViewItem* LLInventoryPanel::buildViewsTree(const LLUUID& id,
             {
                 // At the moment we have to build folder's items in bulk and ignore mBuildViewsEndTime
                 const LLViewerInventoryItem* item = (*item_iter);
-                if (typedViewsFilter(item->getUUID(), item))
+                if (typedViewsFilter(item->getUUID(), item)
+                    && mUnbuiltItemMap.find(item->getUUID()) == mUnbuiltItemMap.end())
                 {
                     // This can be optimized: we don't need to call getItemByID()
                     // each time, especially since content is growing, we can just
@@ -2330,6 +2346,7 @@ void LLInventoryPanel::removeItemID(const LLUUID& id)
     gInventory.collectDescendents(id, categories, items, true);
 
     mItemMap.erase(id);
+    mUnbuiltItemMap.erase(id);
 
     for (LLInventoryModel::cat_array_t::iterator it = categories.begin(),    end_it = categories.end();
         it != end_it;
@@ -2343,6 +2360,7 @@ void LLInventoryPanel::removeItemID(const LLUUID& id)
         ++it)
     {
         mItemMap.erase((*it)->getUUID());
+        mUnbuiltItemMap.erase((*it)->getUUID());
     }
 }
 
@@ -2357,9 +2375,44 @@ LLFolderViewItem* LLInventoryPanel::getItemByID(const LLUUID& id)
         return map_it->second;
     }
 
+    // callers want the widget, build it
+    std::map<LLUUID, LLHandle<LLFolderViewFolder> >::iterator unbuilt_it = mUnbuiltItemMap.find(id);
+    if (unbuilt_it != mUnbuiltItemMap.end())
+    {
+        LLFolderViewFolder* folder = unbuilt_it->second.get();
+        mUnbuiltItemMap.erase(unbuilt_it);
+        if (folder)
+        {
+            for (LLFolderViewFolder::unbuilt_items_t::const_iterator it = folder->getUnbuiltItemsBegin();
+                it != folder->getUnbuiltItemsEnd();
+                ++it)
+            {
+                if (static_cast<LLFolderViewModelItemInventory*>(it->get())->getUUID() == id)
+                {
+                    return folder->buildUnbuiltItem(*it);
+                }
+            }
+        }
+    }
+
     return NULL;
 }
 
+LLFolderViewItem* LLInventoryPanel::buildUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item)
+{
+    LLInvFVBridge* bridge = static_cast<LLInvFVBridge*>(item);
+    const LLUUID id = bridge->getUUID();
+    mUnbuiltItemMap.erase(id);
+
+    LLFolderViewItem* folder_view_item = createFolderViewItem(bridge);
+    if (folder_view_item)
+    {
+        folder_view_item->addToFolder(folder);
+        addItemID(id, folder_view_item);
+    }
+    return folder_view_item;
+}
+
 LLFolderViewFolder* LLInventoryPanel::getFolderByID(const LLUUID& id)
 {
     LLFolderViewItem* item = getItemByID(id);
@@ -2686,6 +2739,7 @@ void LLInventorySingleFolderPanel::updateSingleFolderRoot()
         if (mFolderRoot.get())
         {
             mItemMap.clear();
+            mUnbuiltItemMap.clear();
             mFolderRoot.get()->destroyRoot();
         }
 
@@ -2712,6 +2766,10 @@ void LLInventorySingleFolderPanel::updateSingleFolderRoot()
             addChild(mScroller);
             mScroller->addChild(mFolderRoot.get());
             mFolderRoot.get()->setScrollContainer(mScroller);
+            if (mParams.build_items_lazily)
+            {
+                mFolderRoot.get()->setBuildItemCallback(boost::bind(&LLInventorySingleFolderPanel::buildUnbuiltItem, this, _1, _2));
+            }
             mFolderRoot.get()->setFollowsAll();
             mFolderRoot.get()->addChild(mFolderRoot.get()->mStatusTextBox);
 
@@ -108,6 +108,8 @@ public:
         Optional<LLFolderViewFolder::Params> folder;
         Optional<LLFolderViewItem::Params>   item;
         Optional<bool>                       open_first_folder;
+        // Item widgets are built once they scroll into view
+        Optional<bool>                       build_items_lazily;
 
         // All item and folder views will be initialized on init if true (default)
         // Will initialize on visibility change otherwise.
@@ -128,6 +130,7 @@ public:
             allow_drop_on_root("allow_drop_on_root", true),
             use_marketplace_folders("use_marketplace_folders", false),
             open_first_folder("open_first_folder", true),
+            build_items_lazily("build_items_lazily", true),
             scroll("scroll"),
             accepts_drag_and_drop("accepts_drag_and_drop"),
             folder_view("folder_view"),
@@ -316,6 +319,8 @@ protected:
     Params                      mParams;    // stored copy of parameter block
 
     std::map<LLUUID, LLFolderViewItem*> mItemMap;
+    // folders of the items whose widgets are not built yet
+    std::map<LLUUID, LLHandle<LLFolderViewFolder> > mUnbuiltItemMap;
     /**
      * Pointer to LLInventoryFolderViewModelBuilder.
      *
@@ -388,6 +393,8 @@ protected:
     virtual LLFolderView * createFolderRoot(LLUUID root_id );
     virtual LLFolderViewFolder* createFolderViewFolder(LLInvFVBridge * bridge, bool allow_drop);
     virtual LLFolderViewItem*   createFolderViewItem(LLInvFVBridge * bridge);
+    // Builds the widget of an item added to folder by its model alone
+    LLFolderViewItem*           buildUnbuiltItem(LLFolderViewFolder* folder, LLFolderViewModelItem* item);
 
     boost::function<void(const std::deque<LLFolderViewItem*>& items, bool user_action)> mSelectionCallback;
 private:
@@ -97,6 +97,11 @@ use_substring(if_use_substring)
     }
 
 public:
+    /*virtual*/ U64 getItemTypeMask() const { return getTypeBit(LLAssetType::AT_LANDMARK); }
+    /*virtual*/ bool acceptsCategories() const { return false; }
+    // exact matches contain the name too
+    /*virtual*/ const std::string& getNameHint() const { return name; }
+
     /*virtual*/ bool operator()(LLInventoryCategory* cat, LLInventoryItem* item)
     {
         if (!item || item->getType() != LLAssetType::AT_LANDMARK)
@@ -0,0 +1,276 @@
+/**
+* @file llobjectkinematics.cpp
+* @brief Dense motion state of the active objects for idle motion prediction.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llobjectkinematics.h"
+
+#include "llviewerregion.h"
+
+// Same threshold as LLViewerObject::getAngularVelocityRot()
+static const F32 MIN_ANGULAR_VELOCITY_SQUARED = 0.00001f;
+
+LLObjectKinematics::LLObjectKinematics()
+:   mSize(0)
+{
+}
+
+void LLObjectKinematics::push(const LLViewerObject* objectp)
+{
+    sync(pushSlot(), objectp);
+}
+
+S32 LLObjectKinematics::pushSlot()
+{
+    S32 slot = mSize++;
+    if (getNumBlocks() > (S32)mChannels[0].size())
+    {
+        for (S32 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            mChannels[channel].emplace_back(0.f);
+        }
+    }
+    mLastInterpUpdateSecs.resize(mSize);
+    mRegions.resize(mSize);
+    mDeltaRot.resize(mSize);
+    mState.resize(mSize);
+
+    setMotion(slot, LLVector3::zero, LLVector3::zero, LLVector3::zero, F64Seconds(0.0), NULL);
+    return slot;
+}
+
+void LLObjectKinematics::remove(S32 slot)
+{
+    llassert(slot >= 0 && slot < mSize);
+
+    S32 last = mSize - 1;
+    if (slot != last)
+    {
+        copySlot(slot, last);
+    }
+
+    mSize = last;
+    mLastInterpUpdateSecs.resize(mSize);
+    mRegions.resize(mSize);
+    mDeltaRot.resize(mSize);
+    mState.resize(mSize);
+    if (getNumBlocks() < (S32)mChannels[0].size())
+    {
+        for (S32 channel = 0; channel < NUM_CHANNELS; ++channel)
+        {
+            mChannels[channel].pop_back();
+        }
+    }
+}
+
+void LLObjectKinematics::clear()
+{
+    for (S32 channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        mChannels[channel].clear();
+    }
+    mLastInterpUpdateSecs.clear();
+    mRegions.clear();
+    mDeltaRot.clear();
+    mState.clear();
+    mSize = 0;
+}
+
+void LLObjectKinematics::forgetRegion(const LLViewerRegion* regionp)
+{
+    for (S32 slot = 0; slot < mSize; ++slot)
+    {
+        if (mRegions[slot] == regionp)
+        {
+            mRegions[slot] = NULL;
+        }
+    }
+}
+
+void LLObjectKinematics::sync(S32 slot, const LLViewerObject* objectp)
+{
+    setMotion(slot, objectp->getVelocity(), objectp->getAcceleration(), objectp->getAngularVelocity(),
+              objectp->mLastInterpUpdateSecs, objectp->getRegion());
+}
+
+void LLObjectKinematics::setMotion(S32 slot, const LLVector3& velocity, const LLVector3& acceleration,
+                                   const LLVector3& angular_velocity, F64Seconds last_update, const LLViewerRegion* regionp)
+{
+    llassert(slot >= 0 && slot < mSize);
+
+    setVector(VEL_X, slot, velocity);
+    setVector(ACCEL_X, slot, acceleration);
+    setVector(OMEGA_X, slot, angular_velocity);
+    mLastInterpUpdateSecs[slot] = last_update;
+    mRegions[slot] = regionp;
+    mState[slot] = SYNCED;
+}
+
+void LLObjectKinematics::predict(const F64 frame_time, S32 begin, S32 end)
+{
+    const LLVector4a half(0.5f);
+    const LLVector4a physics_timestep(PHYSICS_TIMESTEP);
+    const LLVector4a min_omega_squared(MIN_ANGULAR_VELOCITY_SQUARED);
+
+    for (S32 block = begin; block < end; ++block)
+    {
+        const S32 first = block * 4;
+        const S32 last = llmin(first + 4, mSize);
+
+        // Time since the last interpolation, as in LLViewerObject::predictIdleMotion()
+        F32* dt = mChannels[DT][block].getF32ptr();
+        for (S32 slot = first; slot < first + 4; ++slot)
+        {
+            if (slot < last)
+            {
+                const LLViewerRegion* regionp = mRegions[slot];
+                F32 time_dilation = regionp ? regionp->getTimeDilation() : 1.0f;
+                F32 dt_raw = (F32)((F64Seconds)frame_time - mLastInterpUpdateSecs[slot]).value();
+                dt[slot & 3] = time_dilation * dt_raw;
+            }
+            else
+            {
+                dt[slot & 3] = 0.f;
+            }
+        }
+
+        // Same operations in the same order as LLViewerObject::predictLinearMotion()
+        const LLVector4a& step = mChannels[DT][block];
+        LLVector4a half_step;
+        half_step.setSub(step, physics_timestep);
+        half_step.mul(half);
+        for (S32 axis = 0; axis < 3; ++axis)
+        {
+            const LLVector4a& vel = mChannels[VEL_X + axis][block];
+            const LLVector4a& accel = mChannels[ACCEL_X + axis][block];
+
+            LLVector4a& delta_pos = mChannels[DELTA_POS_X + axis][block];
+            delta_pos.setMul(half_step, accel);
+            delta_pos.add(vel);
+            delta_pos.mul(step);
+
+            mChannels[DELTA_VEL_X + axis][block].setMul(accel, step);
+        }
+
+        // Only spinning objects need the trigonometry
+        LLVector4a omega_squared;
+        LLVector4a component;
+        omega_squared.setMul(mChannels[OMEGA_X][block], mChannels[OMEGA_X][block]);
+        component.setMul(mChannels[OMEGA_Y][block], mChannels[OMEGA_Y][block]);
+        omega_squared.add(component);
+        component.setMul(mChannels[OMEGA_Z][block], mChannels[OMEGA_Z][block]);
+        omega_squared.add(component);
+        U32 spinning = omega_squared.greaterThan(min_omega_squared).getGatheredBits();
+
+        for (S32 slot = first; slot < last; ++slot)
+        {
+            U8 state = (mState[slot] & SYNCED) | PREDICTED;
+            if ((spinning & (1 << (slot & 3)))
+                && LLViewerObject::getAngularVelocityRot(getVector(OMEGA_X, slot), dt[slot & 3], mDeltaRot[slot]))
+            {
+                state |= ROTATE;
+            }
+            mState[slot] = state;
+        }
+    }
+}
+
+bool LLObjectKinematics::getIdleMotion(S32 slot, const LLViewerObject* objectp, LLViewerObject::IdleMotion& motion) const
+{
+    if (slot < 0 || slot >= mSize)
+    {
+        return false;
+    }
+
+    // Objects that don't interpolate are left to LLViewerObject::predictIdleMotion()
+    if (objectp->isDead() || objectp->mStatic || !LLViewerObject::sVelocityInterpolate || objectp->isSelected())
+    {
+        return false;
+    }
+
+    if (mRegions[slot] != objectp->getRegion()
+        || mLastInterpUpdateSecs[slot] != objectp->mLastInterpUpdateSecs
+        || !matches(VEL_X, slot, objectp->getVelocity())
+        || !matches(ACCEL_X, slot, objectp->getAcceleration())
+        || !matches(OMEGA_X, slot, objectp->getAngularVelocity()))
+    {
+        return false;
+    }
+
+    return getPredictedMotion(slot, motion);
+}
+
+bool LLObjectKinematics::getPredictedMotion(S32 slot, LLViewerObject::IdleMotion& motion) const
+{
+    if (slot < 0 || slot >= mSize || (mState[slot] & (SYNCED | PREDICTED)) != (SYNCED | PREDICTED))
+    {
+        return false;
+    }
+
+    motion.mInterpolate = true;
+    motion.mDt = lane(DT, slot);
+    motion.mRotate = (mState[slot] & ROTATE) != 0;
+    if (motion.mRotate)
+    {
+        motion.mDeltaRot = mDeltaRot[slot];
+    }
+    motion.mDeltaPos = getVector(DELTA_POS_X, slot);
+    motion.mDeltaVel = getVector(DELTA_VEL_X, slot);
+    motion.mPredictedLinear = true;
+    return true;
+}
+
+void LLObjectKinematics::setVector(S32 channel, S32 slot, const LLVector3& vec)
+{
+    lane(channel, slot) = vec.mV[VX];
+    lane(channel + 1, slot) = vec.mV[VY];
+    lane(channel + 2, slot) = vec.mV[VZ];
+}
+
+LLVector3 LLObjectKinematics::getVector(S32 channel, S32 slot) const
+{
+    return LLVector3(lane(channel, slot), lane(channel + 1, slot), lane(channel + 2, slot));
+}
+
+bool LLObjectKinematics::matches(S32 channel, S32 slot, const LLVector3& vec) const
+{
+    return lane(channel, slot) == vec.mV[VX]
+        && lane(channel + 1, slot) == vec.mV[VY]
+        && lane(channel + 2, slot) == vec.mV[VZ];
+}
+
+void LLObjectKinematics::copySlot(S32 dst, S32 src)
+{
+    for (S32 channel = 0; channel < NUM_CHANNELS; ++channel)
+    {
+        lane(channel, dst) = lane(channel, src);
+    }
+    mLastInterpUpdateSecs[dst] = mLastInterpUpdateSecs[src];
+    mRegions[dst] = mRegions[src];
+    mDeltaRot[dst] = mDeltaRot[src];
+    mState[dst] = mState[src];
+}
@@ -0,0 +1,120 @@
+/**
+* @file llobjectkinematics.h
+* @brief Dense motion state of the active objects for idle motion prediction.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#ifndef LL_LLOBJECTKINEMATICS_H
+#define LL_LLOBJECTKINEMATICS_H
+
+#include "llmath.h"
+#include "llvector4a.h"
+#include "llviewerobject.h"
+
+#include <vector>
+
+class LLViewerRegion;
+
+// Velocity, acceleration and angular velocity of every object on the active
+// list, one slot per entry of LLViewerObjectList::mActiveObjects in the same
+// order. Components are stored four slots to an LLVector4a, so predicting the
+// idle motion of all objects is a few SIMD operations per four objects
+// rather than a walk over scattered LLViewerObject members.
+//
+// Slots are copied from their object after an object update message and
+// after each idle update. Anything else that changes an object's motion is
+// caught by getIdleMotion(), which turns down predictions made from a stale
+// copy.
+class LLObjectKinematics
+{
+public:
+    LLObjectKinematics();
+
+    // A new object was appended to the active list
+    void push(const LLViewerObject* objectp);
+    // Appends a slot at rest and returns it
+    S32 pushSlot();
+    // The object in slot left the active list and the last one took its place
+    void remove(S32 slot);
+    void clear();
+    // Regions are about to be deleted, slots still pointing at one stop
+    // reading its time dilation
+    void forgetRegion(const LLViewerRegion* regionp);
+
+    S32 size() const                        { return mSize; }
+    S32 getNumBlocks() const                { return (mSize + 3) / 4; }
+
+    void sync(S32 slot, const LLViewerObject* objectp);
+    // What sync() copies from the object
+    void setMotion(S32 slot, const LLVector3& velocity, const LLVector3& acceleration,
+                   const LLVector3& angular_velocity, F64Seconds last_update, const LLViewerRegion* regionp);
+
+    // Predicts the motion of the slots in blocks [begin, end) of four at
+    // frame_time. Blocks don't share data, so different ranges may be
+    // predicted on different threads at once.
+    void predict(const F64 frame_time, S32 begin, S32 end);
+
+    // The motion predicted for slot, if it was predicted from the object's
+    // current state and the object interpolates at all.
+    bool getIdleMotion(S32 slot, const LLViewerObject* objectp, LLViewerObject::IdleMotion& motion) const;
+    // The motion predicted for slot from the state last set, whether or not
+    // that is still the object's.
+    bool getPredictedMotion(S32 slot, LLViewerObject::IdleMotion& motion) const;
+
+private:
+    enum
+    {
+        VEL_X, VEL_Y, VEL_Z,
+        ACCEL_X, ACCEL_Y, ACCEL_Z,
+        OMEGA_X, OMEGA_Y, OMEGA_Z,
+        // Predictions
+        DT,
+        DELTA_POS_X, DELTA_POS_Y, DELTA_POS_Z,
+        DELTA_VEL_X, DELTA_VEL_Y, DELTA_VEL_Z,
+        NUM_CHANNELS
+    };
+
+    enum
+    {
+        SYNCED = 0x1,
+        PREDICTED = 0x2,
+        ROTATE = 0x4
+    };
+
+    F32& lane(S32 channel, S32 slot)        { return mChannels[channel][slot >> 2].getF32ptr()[slot & 3]; }
+    F32 lane(S32 channel, S32 slot) const   { return mChannels[channel][slot >> 2].getF32ptr()[slot & 3]; }
+    void setVector(S32 channel, S32 slot, const LLVector3& vec);
+    LLVector3 getVector(S32 channel, S32 slot) const;
+    bool matches(S32 channel, S32 slot, const LLVector3& vec) const;
+    void copySlot(S32 dst, S32 src);
+
+    std::vector<LLVector4a>             mChannels[NUM_CHANNELS];
+    std::vector<F64Seconds>             mLastInterpUpdateSecs;
+    std::vector<const LLViewerRegion*>  mRegions;
+    std::vector<LLQuaternion>           mDeltaRot;
+    std::vector<U8>                     mState;
+    S32                                 mSize;
+};
+
+#endif // LL_LLOBJECTKINEMATICS_H
@@ -74,7 +74,10 @@ LLInboxInventoryPanel::~LLInboxInventoryPanel()
 
 void LLInboxInventoryPanel::initFromParams(const LLInventoryPanel::Params& params)
 {
-    LLInventoryPanel::initFromParams(params);
+    // the freshness of the inbox is counted on its item widgets
+    LLInventoryPanel::Params inbox_params(params);
+    inbox_params.build_items_lazily = false;
+    LLInventoryPanel::initFromParams(inbox_params);
     getFilter().setFilterCategoryTypes(getFilter().getFilterCategoryTypes() | (1ULL << LLFolderType::FT_INBOX));
 }
 
@@ -0,0 +1,212 @@
+/**
+* @file llperfcostmodel.cpp
+* @brief Online frame cost model used by the predictive autotuner.
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llperfcostmodel.h"
+
+// initial covariance, i.e. how little we trust the zero starting weights
+static constexpr F64 INITIAL_COVARIANCE{1000.0};
+// stop discounting old data once the covariance gets this large, otherwise
+// it grows without bound while settings are not changing
+static constexpr F64 MAX_COVARIANCE_TRACE{1.0e6};
+// smallest draw distance cost, in ms per (256m)^2, we consider meaningful
+static constexpr F64 MIN_FAR_CLIP_COST{0.01};
+static constexpr F32 FAR_CLIP_SCALE{256.f};
+// bound a single draw distance change to this factor either way
+static constexpr F32 MAX_FAR_CLIP_RATIO{1.5f};
+
+LLPerfCostModel::LLPerfCostModel(F64 forgetting)
+:   mForgetting(forgetting)
+{
+    reset();
+}
+
+void LLPerfCostModel::reset()
+{
+    mWeights.fill(0.0);
+    mCovariance.fill(0.0);
+    for (S32 i = 0; i < FEATURE_COUNT; ++i)
+    {
+        mCovariance[i * FEATURE_COUNT + i] = INITIAL_COVARIANCE;
+    }
+    mSamples = 0;
+}
+
+// static
+void LLPerfCostModel::getFeatures(const Settings& settings, feature_vec_t& x)
+{
+    const F64 far_clip = settings.farClip / FAR_CLIP_SCALE;
+    x[FEATURE_BIAS] = 1.0;
+    x[FEATURE_FAR_CLIP] = far_clip * far_clip;
+    x[FEATURE_SHADOWS] = settings.shadowDetail;
+    x[FEATURE_REFLECTIONS] = settings.reflectionDetail + 1;
+    x[FEATURE_AVATARS] = settings.avatarMs;
+}
+
+void LLPerfCostModel::addSample(const Settings& settings, F32 frame_ms)
+{
+    feature_vec_t x;
+    getFeatures(settings, x);
+
+    // P x
+    feature_vec_t px;
+    F64 denom = mForgetting;
+    for (S32 i = 0; i < FEATURE_COUNT; ++i)
+    {
+        px[i] = 0.0;
+        for (S32 j = 0; j < FEATURE_COUNT; ++j)
+        {
+            px[i] += mCovariance[i * FEATURE_COUNT + j] * x[j];
+        }
+        denom += x[i] * px[i];
+    }
+
+    const F64 error = frame_ms - predict(settings);
+    F64 trace = 0.0;
+    for (S32 i = 0; i < FEATURE_COUNT; ++i)
+    {
+        const F64 gain = px[i] / denom;
+        mWeights[i] += gain * error;
+        for (S32 j = 0; j < FEATURE_COUNT; ++j)
+        {
+            mCovariance[i * FEATURE_COUNT + j] -= gain * px[j];
+        }
+        trace += mCovariance[i * FEATURE_COUNT + i];
+    }
+
+    if (trace < MAX_COVARIANCE_TRACE)
+    {
+        for (F64& p : mCovariance)
+        {
+            p /= mForgetting;
+        }
+    }
+    ++mSamples;
+}
+
+F32 LLPerfCostModel::predict(const Settings& settings) const
+{
+    feature_vec_t x;
+    getFeatures(settings, x);
+    F64 result = 0.0;
+    for (S32 i = 0; i < FEATURE_COUNT; ++i)
+    {
+        result += mWeights[i] * x[i];
+    }
+    return (F32)result;
+}
+
+bool LLPerfCostModel::isTrained() const
+{
+    return mSamples >= MIN_SAMPLES && mWeights[FEATURE_FAR_CLIP] > MIN_FAR_CLIP_COST;
+}
+
+// Cost of one step of a feature, never negative so noise can't make the
+// controller believe that raising detail speeds things up.
+F64 LLPerfCostModel::getCost(EFeature feature) const
+{
+    return llmax(mWeights[feature], 0.0);
+}
+
+LLPerfCostModel::EDecision LLPerfCostModel::choose(const Settings& current, F32 frame_ms, F32 target_ms,
+                                                   const Limits& limits, Settings& next) const
+{
+    next = current;
+    if (!isTrained())
+    {
+        return DECISION_UNTRAINED;
+    }
+
+    const F64 far_cost = mWeights[FEATURE_FAR_CLIP];
+    const F64 far_clip = current.farClip / FAR_CLIP_SCALE;
+    const F64 far_feature = far_clip * far_clip;
+
+    if (frame_ms > target_ms * (1.f + DEADBAND))
+    {
+        // too slow, solve for the draw distance that removes the excess
+        if (current.farClip > limits.minFarClip)
+        {
+            const F64 wanted = llmax(far_feature - (frame_ms - target_ms) / far_cost, 0.0);
+            next.farClip = llclamp((F32)(sqrt(wanted) * FAR_CLIP_SCALE),
+                                   llmax(limits.minFarClip, current.farClip / MAX_FAR_CLIP_RATIO),
+                                   current.farClip);
+            return DECISION_FAR_CLIP_DOWN;
+        }
+        if (current.reflectionDetail > -1)
+        {
+            next.reflectionDetail = current.reflectionDetail - 1;
+            return DECISION_REFLECTIONS_DOWN;
+        }
+        if (current.shadowDetail > 0)
+        {
+            next.shadowDetail = current.shadowDetail - 1;
+            return DECISION_SHADOWS_DOWN;
+        }
+        return DECISION_NONE;
+    }
+
+    if (frame_ms >= target_ms * (1.f - DEADBAND))
+    {
+        return DECISION_HOLD;
+    }
+
+    // headroom, restore what we took away, each only if predicted to fit
+    const F64 headroom = (target_ms - frame_ms) * HEADROOM;
+    if (current.shadowDetail < limits.maxShadowDetail && getCost(FEATURE_SHADOWS) < headroom)
+    {
+        next.shadowDetail = current.shadowDetail + 1;
+        return DECISION_SHADOWS_UP;
+    }
+    if (current.reflectionDetail < limits.maxReflectionDetail && getCost(FEATURE_REFLECTIONS) < headroom)
+    {
+        next.reflectionDetail = current.reflectionDetail + 1;
+        return DECISION_REFLECTIONS_UP;
+    }
+    if (current.farClip < limits.maxFarClip)
+    {
+        const F64 wanted = far_feature + headroom / far_cost;
+        const F32 far_clip_up = llclamp((F32)(sqrt(wanted) * FAR_CLIP_SCALE),
+                                        current.farClip,
+                                        llmin(limits.maxFarClip, current.farClip * MAX_FAR_CLIP_RATIO));
+        // ignore changes too small to matter
+        if (far_clip_up - current.farClip >= 1.f)
+        {
+            next.farClip = far_clip_up;
+            return DECISION_FAR_CLIP_UP;
+        }
+    }
+    return DECISION_NONE;
+}
+
+// static
+const char* LLPerfCostModel::getDecisionName(EDecision decision)
+{
+    static constexpr std::array<const char*, DECISION_COUNT> names{
+        "none", "hold", "untrained", "far_clip_down", "far_clip_up",
+        "reflections_down", "reflections_up", "shadows_down", "shadows_up" };
+    return decision < DECISION_COUNT ? names[decision] : "unknown";
+}
@@ -0,0 +1,125 @@
+/**
+* @file llperfcostmodel.h
+* @brief Online frame cost model used by the predictive autotuner.
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#ifndef LL_LLPERFCOSTMODEL_H
+#define LL_LLPERFCOSTMODEL_H
+
+#include <array>
+
+// Linear model of the frame time as a function of the settings the
+// autotuner controls, fitted online by recursive least squares with
+// exponential forgetting so it follows changes of scene:
+//
+//   frame_ms = w0 + w1 * (far_clip / 256)^2 + w2 * shadow_detail
+//            + w3 * (reflection_detail + 1) + w4 * avatar_ms
+//
+// Draw distance enters squared since the amount of scene drawn grows with
+// the visible area. choose() uses the fitted weights to pick the single
+// settings change predicted to bring the frame time to the target, rather
+// than stepping a fixed amount and waiting to see what happened.
+class LLPerfCostModel
+{
+public:
+    enum EFeature
+    {
+        FEATURE_BIAS = 0,
+        FEATURE_FAR_CLIP,
+        FEATURE_SHADOWS,
+        FEATURE_REFLECTIONS,
+        FEATURE_AVATARS,
+        FEATURE_COUNT
+    };
+
+    enum EDecision
+    {
+        DECISION_NONE = 0,      // nothing left to change
+        DECISION_HOLD,          // within the target band
+        DECISION_UNTRAINED,     // not enough data yet, legacy stepping applies
+        DECISION_FAR_CLIP_DOWN,
+        DECISION_FAR_CLIP_UP,
+        DECISION_REFLECTIONS_DOWN,
+        DECISION_REFLECTIONS_UP,
+        DECISION_SHADOWS_DOWN,
+        DECISION_SHADOWS_UP,
+        DECISION_COUNT
+    };
+
+    struct Settings
+    {
+        F32 farClip{0.f};
+        S32 shadowDetail{0};        // RenderShadowDetail
+        S32 reflectionDetail{0};    // RenderReflectionProbeDetail, -1 is disabled
+        F32 avatarMs{0.f};          // measured avatar render time, not a setting
+    };
+
+    struct Limits
+    {
+        F32 minFarClip{64.f};
+        F32 maxFarClip{256.f};
+        S32 maxShadowDetail{0};     // never raised above these
+        S32 maxReflectionDetail{-1};
+    };
+
+    // Fraction of the target frame time inside which no change is made
+    static constexpr F32 DEADBAND{0.1f};
+    // Fraction of the predicted headroom used when raising settings
+    static constexpr F32 HEADROOM{0.75f};
+    static constexpr U32 MIN_SAMPLES{120};
+
+    LLPerfCostModel(F64 forgetting = 0.995);
+
+    void reset();
+    void addSample(const Settings& settings, F32 frame_ms);
+    F32 predict(const Settings& settings) const;
+
+    // The model is only used once it has seen enough frames and attributes
+    // a positive cost to draw distance; until then draw distance has not
+    // varied enough for its cost to be known.
+    bool isTrained() const;
+    U32 getSampleCount() const { return mSamples; }
+    F64 getWeight(EFeature feature) const { return mWeights[feature]; }
+
+    // Picks at most one change to current, returned in next, given the
+    // measured frame time. Scene detail is traded away in the order draw
+    // distance, reflections, shadows and restored in the opposite order.
+    EDecision choose(const Settings& current, F32 frame_ms, F32 target_ms, const Limits& limits, Settings& next) const;
+
+    static const char* getDecisionName(EDecision decision);
+    static bool isChange(EDecision decision) { return decision >= DECISION_FAR_CLIP_DOWN; }
+
+private:
+    typedef std::array<F64, FEATURE_COUNT> feature_vec_t;
+
+    static void getFeatures(const Settings& settings, feature_vec_t& x);
+    F64 getCost(EFeature feature) const;
+
+    feature_vec_t mWeights;
+    std::array<F64, FEATURE_COUNT * FEATURE_COUNT> mCovariance;
+    F64 mForgetting;
+    U32 mSamples;
+};
+
+#endif // LL_LLPERFCOSTMODEL_H
@@ -27,6 +27,7 @@
 #include "llviewerprecompiledheaders.h"
 #include "llperfstats.h"
 #include "llcontrol.h"
+#include "lldate.h"
 #include "pipeline.h"
 #include "llagentcamera.h"
 #include "llviewerwindow.h"
@@ -74,6 +75,15 @@ namespace LLPerfStats
     std::array<StatsRecorder::StatsTypeMatrix,2>  StatsRecorder::statsDoubleBuffer{ {} };
     std::array<StatsRecorder::StatsSummaryArray,2> StatsRecorder::max{ {} };
     std::array<StatsRecorder::StatsSummaryArray,2> StatsRecorder::sum{ {} };
+    LLFILE*             StatsRecorder::recordFile{nullptr};
+    std::string         StatsRecorder::recordBuffer{};
+    U64                 StatsRecorder::recordStartTime{0};
+    LLPerfCostModel     StatsRecorder::costModel{};
+    LLPerfCostModel::EDecision StatsRecorder::lastDecision{LLPerfCostModel::DECISION_NONE};
+    F32                 StatsRecorder::lastPredictedMs{0.f};
+
+    // flush the recording buffer to disk once it grows past this size
+    static constexpr size_t RECORD_FLUSH_BYTES{64 * 1024};
 
     void Tunables::applyUpdates()
     {
@@ -82,6 +92,8 @@ namespace LLPerfStats
         if( tuningFlag & NonImpostors ){ gSavedSettings.setU32("RenderAvatarMaxNonImpostors", nonImpostors); };
         if( tuningFlag & ReflectionDetail ){ gSavedSettings.setS32("RenderReflectionDetail", reflectionDetail); };
         if( tuningFlag & FarClip ){ gSavedSettings.setF32("RenderFarClip", farClip); };
+        if( tuningFlag & ShadowDetail ){ gSavedSettings.setS32("RenderShadowDetail", shadowDetail); };
+        if( tuningFlag & ReflectionProbeDetail ){ gSavedSettings.setS32("RenderReflectionProbeDetail", reflectionProbeDetail); };
         if( tuningFlag & UserMinDrawDistance ){ gSavedSettings.setF32("AutoTuneRenderFarClipMin", userMinDrawDistance); };
         if( tuningFlag & UserTargetDrawDistance ){ gSavedSettings.setF32("AutoTuneRenderFarClipTarget", userTargetDrawDistance); };
         if( tuningFlag & UserImpostorDistance ){ gSavedSettings.setF32("AutoTuneImpostorFarAwayDistance", userImpostorDistance); };
@@ -92,9 +104,33 @@ namespace LLPerfStats
         if( tuningFlag & UserTargetFPS ){ gSavedSettings.setU32("TargetFPS", userTargetFPS); };
         // Note: The Max ART slider is logarithmic and thus we have an intermediate proxy value
         if( tuningFlag & UserARTCutoff ){ gSavedSettings.setF32("RenderAvatarMaxART", userARTCutoffSliderValue); };
+        if( tuningFlag & UserShadowDetail ){ gSavedSettings.setS32("AutoTuneRestoreShadowDetail", userShadowDetail); };
+        if( tuningFlag & UserReflectionProbeDetail ){ gSavedSettings.setS32("AutoTuneRestoreReflectionProbeDetail", userReflectionProbeDetail); };
         resetChanges();
     }
 
+    // Puts back the shadow and reflection probe detail the tuner lowered.
+    // Called when auto tune is switched off and at exit, so the lowered
+    // values are never what gets saved as the user's own.
+    void Tunables::restoreUserSettings()
+    {
+        assert_main_thread();
+        // drop pending tuner changes, they would lower the settings again
+        tuningFlag &= ~(ShadowDetail | ReflectionProbeDetail | UserShadowDetail | UserReflectionProbeDetail);
+        if (userShadowDetail >= 0)
+        {
+            gSavedSettings.setS32("RenderShadowDetail", userShadowDetail);
+            userShadowDetail = -1;
+        }
+        if (userReflectionProbeDetail >= 0)
+        {
+            gSavedSettings.setS32("RenderReflectionProbeDetail", userReflectionProbeDetail);
+            userReflectionProbeDetail = -1;
+        }
+        gSavedSettings.setS32("AutoTuneRestoreShadowDetail", -1);
+        gSavedSettings.setS32("AutoTuneRestoreReflectionProbeDetail", -1);
+    }
+
     void Tunables::updateRenderCostLimitFromSettings()
     {
         assert_main_thread();
@@ -136,6 +172,9 @@ namespace LLPerfStats
         LLPerfStats::tunables.userFPSTuningStrategy = gSavedSettings.getU32("TuningFPSStrategy");
         LLPerfStats::tunables.userTargetFPS = gSavedSettings.getU32("TargetFPS");
         LLPerfStats::tunables.vsyncEnabled = gSavedSettings.getBOOL("RenderVSyncEnable");
+        LLPerfStats::tunables.userPredictiveTuning = gSavedSettings.getBOOL("AutoTunePredictive");
+        LLPerfStats::tunables.userShadowDetail = gSavedSettings.getS32("AutoTuneRestoreShadowDetail");
+        LLPerfStats::tunables.userReflectionProbeDetail = gSavedSettings.getS32("AutoTuneRestoreReflectionProbeDetail");
 
         LLPerfStats::tunables.userAutoTuneLock = gSavedSettings.getBOOL("AutoTuneLock") && gSavedSettings.getU32("KeepAutoTuneLock");
 
@@ -151,6 +190,12 @@ namespace LLPerfStats
             gSavedSettings.setBOOL("AutoTuneFPS", true);
         }
 
+        // a session that ended without restoring (a crash) left the tuned down values behind
+        if (!LLPerfStats::tunables.userAutoTuneEnabled)
+        {
+            restoreUserSettings();
+        }
+
         // Note: The Max ART slider is logarithmic and thus we have an intermediate proxy value
         updateRenderCostLimitFromSettings();
         resetChanges();
@@ -162,6 +207,134 @@ namespace LLPerfStats
         tunables.initialiseFromSettings();
         LLPerfStats::cpu_hertz = (F64)LLTrace::BlockTimer::countsPerSecond();
         LLPerfStats::vsync_max_fps = gViewerWindow->getWindow()->getRefreshRate();
+        if (gSavedSettings.getBOOL("PerfStatsRecordToFile"))
+        {
+            startRecording();
+        }
+    }
+
+    // static
+    const char* StatsRecorder::getStatTypeName(StatType_t type)
+    {
+        static constexpr std::array<const char*, static_cast<size_t>(StatType_t::STATS_COUNT)> names{
+            "geometry", "shadows", "huds", "ui", "combined", "swap", "frame", "display",
+            "sleep", "lfs", "meshrepo", "fpslimit", "fps", "idle", "done" };
+        return names[static_cast<size_t>(type)];
+    }
+
+    // static
+    bool StatsRecorder::startRecording(const std::string& filename)
+    {
+        assert_main_thread();
+        stopRecording();
+
+        std::string path{filename};
+        if (path.empty())
+        {
+            std::string date_str = LLDate::now().asString();
+            std::replace(date_str.begin(), date_str.end(), ':', '-');  // Make it valid for a filename
+            path = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "perfstats." + date_str + ".csv");
+        }
+
+        recordFile = LLFile::fopen(path, "wb");
+        if (!recordFile)
+        {
+            LL_WARNS("PerfStats") << "Couldn't open " << path << " for recording" << LL_ENDL;
+            return false;
+        }
+        LL_INFOS("PerfStats") << "Recording frame stats to " << path << LL_ENDL;
+
+        // one row per avatar rendered in a frame followed by one for the scene.
+        // Times are in microseconds, the trailing tuning columns are only set on
+        // scene rows and describe the tuning decision taken at the end of that frame.
+        recordBuffer = "frame_id,seconds,kind,id";
+        for (size_t i = 0; i < static_cast<size_t>(StatType_t::RENDER_DONE); i++)
+        {
+            recordBuffer += ',';
+            recordBuffer += getStatTypeName(static_cast<StatType_t>(i));
+        }
+        recordBuffer += ",far_clip,max_art_us,non_impostors,target_fps,tuned_avatars,predicted_ms,decision\n";
+        recordStartTime = LLTrace::BlockTimer::getCPUClockCount64();
+        return true;
+    }
+
+    // static
+    void StatsRecorder::stopRecording()
+    {
+        assert_main_thread();
+        if (recordFile)
+        {
+            flushRecording();
+            LLFile::close(recordFile);
+            recordFile = nullptr;
+            LL_INFOS("PerfStats") << "Stopped recording frame stats" << LL_ENDL;
+        }
+        recordBuffer.clear();
+    }
+
+    // static
+    void StatsRecorder::flushRecording()
+    {
+        if (recordFile && !recordBuffer.empty())
+        {
+            if (fwrite(recordBuffer.data(), 1, recordBuffer.size(), recordFile) != recordBuffer.size())
+            {
+                LL_WARNS("PerfStats") << "Failed writing frame stats, recording stopped" << LL_ENDL;
+                LLFile::close(recordFile);
+                recordFile = nullptr;
+            }
+        }
+        recordBuffer.clear();
+    }
+
+    // Appends the frame held in the write buffer, before smoothing is applied.
+    // The scene row is completed by finishRecordedFrame() once tuning has run.
+    // static
+    void StatsRecorder::recordFrame()
+    {
+        LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
+        const auto& frameStats = statsDoubleBuffer[writeBuffer];
+        const F64 seconds = (F64)(LLTrace::BlockTimer::getCPUClockCount64() - recordStartTime) / cpu_hertz;
+        constexpr size_t stat_count = static_cast<size_t>(StatType_t::RENDER_DONE);
+
+        auto append_row = [seconds](const char* kind, const LLUUID& id, const StatsArray& stats)
+        {
+            recordBuffer += llformat("%u,%.4f,%s,%s", gFrameCount, seconds, kind, id.asString().c_str());
+            for (size_t i = 0; i < stat_count; i++)
+            {
+                recordBuffer += llformat(",%.1f", raw_to_us(stats[i]));
+            }
+        };
+
+        for (const auto& entry : frameStats[static_cast<size_t>(ObjType_t::OT_AVATAR)])
+        {
+            append_row("avatar", entry.first, entry.second);
+            recordBuffer += ",,,,,,,\n";
+        }
+
+        const auto& scene = frameStats[static_cast<size_t>(ObjType_t::OT_GENERAL)];
+        const auto scene_it = scene.find(LLUUID::null);
+        append_row("scene", LLUUID::null, scene_it != scene.end() ? scene_it->second : StatsArray{});
+    }
+
+    // static
+    void StatsRecorder::finishRecordedFrame()
+    {
+        recordBuffer += llformat(",%.1f,%.1f,%u,%u,%lld,%.3f,%s\n",
+                                 LLPipeline::RenderFarClip,
+                                 (F64)renderAvatarMaxART_ns / 1000.0,
+                                 LLVOAvatar::sMaxNonImpostors,
+                                 tunables.userTargetFPS,
+                                 (long long)tunedAvatars.load(),
+                                 lastPredictedMs,
+                                 LLPerfCostModel::getDecisionName(lastDecision));
+        lastDecision = LLPerfCostModel::DECISION_NONE;
+        lastPredictedMs = 0.f;
+
+        if (recordBuffer.size() >= RECORD_FLUSH_BYTES)
+        {
+            flushRecording();
+        }
     }
 
     // static
@@ -170,6 +343,12 @@ namespace LLPerfStats
         LL_PROFILE_ZONE_SCOPED_CATEGORY_STATS;
         using ST = StatType_t;
 
+        const bool recording{recordFile != nullptr};
+        if (recording)
+        {
+            recordFrame();
+        }
+
         bool unreliable{false};
         LLPerfStats::StatsRecorder::getSceneStat(LLPerfStats::StatType_t::RENDER_FRAME);
         auto& sceneStats = statsDoubleBuffer[writeBuffer][static_cast<size_t>(ObjType_t::OT_GENERAL)][LLUUID::null];
@@ -247,6 +426,11 @@ namespace LLPerfStats
         {
             updateAvatarParams();
         }
+
+        if (recording && recordFile)
+        {
+            finishRecordedFrame();
+        }
     }
 
     // clear buffers when we change region or need a hard reset.
@@ -337,6 +521,83 @@ namespace LLPerfStats
         return LLPerfStats::meanFrameTime;
     }
 
+    // static
+    LLPerfCostModel::Settings StatsRecorder::getSceneSettings()
+    {
+        static LLCachedControl<S32> reflection_probe_detail(gSavedSettings, "RenderReflectionProbeDetail", -1);
+        LLPerfCostModel::Settings settings;
+        settings.farClip = LLPipeline::RenderFarClip;
+        settings.shadowDetail = LLPipeline::RenderShadowDetail;
+        settings.reflectionDetail = reflection_probe_detail;
+        settings.avatarMs = sTotalAvatarTime;
+        return settings;
+    }
+
+    // Lets the cost model pick and apply the next scene change. Returns
+    // DECISION_UNTRAINED when predictive tuning is off or the model has not
+    // learnt enough yet, in which case the fixed step tuning applies (and
+    // provides the variation in draw distance the model needs to learn).
+    // static
+    LLPerfCostModel::EDecision StatsRecorder::tuneScenePredictive(const LLPerfCostModel::Settings& current, U64 target_frame_time_raw)
+    {
+        if (!tunables.userPredictiveTuning)
+        {
+            return LLPerfCostModel::DECISION_UNTRAINED;
+        }
+
+        // never raise shadows or reflections beyond what the user had before we lowered them
+        LLPerfCostModel::Limits limits;
+        limits.minFarClip = tunables.userMinDrawDistance;
+        limits.maxFarClip = tunables.userTargetDrawDistance;
+        limits.maxShadowDetail = tunables.userShadowDetail >= 0 ? tunables.userShadowDetail : current.shadowDetail;
+        limits.maxReflectionDetail = tunables.userReflectionProbeDetail >= 0 ? tunables.userReflectionProbeDetail : current.reflectionDetail;
+
+        LLPerfCostModel::Settings next;
+        const F32 frame_ms = (F32)raw_to_ms(getMeanTotalFrameTime());
+        const F32 target_ms = (F32)raw_to_ms(target_frame_time_raw);
+        const auto decision = costModel.choose(current, frame_ms, target_ms, limits, next);
+        lastDecision = decision;
+
+        switch (decision)
+        {
+            case LLPerfCostModel::DECISION_FAR_CLIP_DOWN:
+            case LLPerfCostModel::DECISION_FAR_CLIP_UP:
+                tunables.updateFarClip(next.farClip);
+                break;
+            case LLPerfCostModel::DECISION_SHADOWS_DOWN:
+            case LLPerfCostModel::DECISION_SHADOWS_UP:
+                if (tunables.userShadowDetail < 0)
+                {
+                    tunables.updateUserShadowDetail(current.shadowDetail);
+                }
+                else if (next.shadowDetail >= tunables.userShadowDetail)
+                {
+                    tunables.updateUserShadowDetail(-1);
+                }
+                tunables.updateShadowDetail(next.shadowDetail);
+                break;
+            case LLPerfCostModel::DECISION_REFLECTIONS_DOWN:
+            case LLPerfCostModel::DECISION_REFLECTIONS_UP:
+                if (tunables.userReflectionProbeDetail < 0)
+                {
+                    tunables.updateUserReflectionProbeDetail(current.reflectionDetail);
+                }
+                else if (next.reflectionDetail >= tunables.userReflectionProbeDetail)
+                {
+                    tunables.updateUserReflectionProbeDetail(-1);
+                }
+                tunables.updateReflectionProbeDetail(next.reflectionDetail);
+                break;
+            default:
+                return decision;
+        }
+
+        LL_DEBUGS("AutoTune") << LLPerfCostModel::getDecisionName(decision) << ": frame " << frame_ms << "ms target " << target_ms
+                              << "ms predicted " << costModel.predict(next) << "ms far clip " << next.farClip
+                              << " shadows " << next.shadowDetail << " reflections " << next.reflectionDetail << LL_ENDL;
+        return decision;
+    }
+
     // static
     void StatsRecorder::updateAvatarParams()
     {
@@ -411,6 +672,14 @@ namespace LLPerfStats
             tot_frame_time_raw -= tot_limit_time_raw;
         }// <FS:Beq/> restore FPSLimit reporting
 
+        // keep the cost model current, recording how well it predicted this frame
+        const LLPerfCostModel::Settings scene_settings{getSceneSettings()};
+        if (tunables.userPredictiveTuning)
+        {
+            lastPredictedMs = costModel.predict(scene_settings);
+            costModel.addSample(scene_settings, (F32)raw_to_ms(tot_frame_time_raw));
+        }
+
         F64 time_buf = target_frame_time_raw * 0.1;
 
         // 1) Is the target frame time lower than current?
@@ -454,14 +723,28 @@ namespace LLPerfStats
                         else // deliberately "else" here so we only do one of these in any given frame
 #endif
                         {
-                            // step down the DD by 10m per update
-                            auto new_dd = (LLPipeline::RenderFarClip - DD_STEP > tunables.userMinDrawDistance)?(LLPipeline::RenderFarClip - DD_STEP) : tunables.userMinDrawDistance;
-                            if(new_dd != LLPipeline::RenderFarClip)
+                            const auto decision = tuneScenePredictive(scene_settings, target_frame_time_raw);
+                            if (LLPerfCostModel::isChange(decision))
                             {
-                                LLPerfStats::tunables.updateFarClip( new_dd );
                                 LLPerfStats::lastGlobalPrefChange = gFrameCount;
                                 return;
                             }
+                            if (decision == LLPerfCostModel::DECISION_HOLD)
+                            {
+                                // the smoothed frame time is close enough, don't overreact to a spike
+                                return;
+                            }
+                            if (decision == LLPerfCostModel::DECISION_UNTRAINED)
+                            {
+                                // step down the DD by 10m per update
+                                auto new_dd = (LLPipeline::RenderFarClip - DD_STEP > tunables.userMinDrawDistance)?(LLPipeline::RenderFarClip - DD_STEP) : tunables.userMinDrawDistance;
+                                if(new_dd != LLPipeline::RenderFarClip)
+                                {
+                                    LLPerfStats::tunables.updateFarClip( new_dd );
+                                    LLPerfStats::lastGlobalPrefChange = gFrameCount;
+                                    return;
+                                }
+                            }
                         }
                     }
                     // if we reach here, we've no more changes to make to tune scenery so we'll resort to agressive Avatar tuning
@@ -539,6 +822,16 @@ namespace LLPerfStats
                 }
                 if (tunables.userFPSTuningStrategy != TUNE_AVATARS_ONLY)
                 {
+                    // the cost model raises draw distance only as far as it predicts will fit
+                    const auto decision = tuneScenePredictive(scene_settings, target_frame_time_raw);
+                    if (decision != LLPerfCostModel::DECISION_UNTRAINED)
+                    {
+                        if (LLPerfCostModel::isChange(decision))
+                        {
+                            LLPerfStats::lastGlobalPrefChange = gFrameCount;
+                        }
+                        return;
+                    }
                     if (LLPipeline::RenderFarClip < tunables.userTargetDrawDistance)
                     {
                         LLPerfStats::tunables.updateFarClip( std::min(LLPipeline::RenderFarClip + DD_STEP, tunables.userTargetDrawDistance) );
@@ -34,8 +34,10 @@
 #include <mutex>
 #include "lluuid.h"
 #include "llfasttimer.h"
+#include "llfile.h"
 #include "blockingconcurrentqueue.h" // <FS:Beq/> reinstate faster queues
 #include "llapp.h"
+#include "llperfcostmodel.h"
 #include "llprofiler.h"
 #include "pipeline.h"
 
@@ -142,12 +144,18 @@ namespace LLPerfStats
         static constexpr U32 UserTargetFPS{512};
         static constexpr U32 UserARTCutoff{1024};
         static constexpr U32 UserAutoTuneLock{4096};
+        static constexpr U32 ShadowDetail{8192};
+        static constexpr U32 ReflectionProbeDetail{16384};
+        static constexpr U32 UserShadowDetail{32768};
+        static constexpr U32 UserReflectionProbeDetail{65536};
 
         U32 tuningFlag{0}; // bit mask for changed settings
 
         // proxy variables, used to pas the new value to be set via the mainthread
         U32 nonImpostors{0}; 
         S32 reflectionDetail{0}; 
+        S32 shadowDetail{0};
+        S32 reflectionProbeDetail{0};
         F32 farClip{0.0}; 
         F32 userMinDrawDistance{0.0}; 
         F32 userTargetDrawDistance{0.0};
@@ -160,9 +168,14 @@ namespace LLPerfStats
         F32 userARTCutoffSliderValue{0};
         bool autoTuneTimeout{true};
         bool vsyncEnabled{true};
+        bool userPredictiveTuning{false};
+        S32 userShadowDetail{-1};           // RenderShadowDetail before the tuner lowered it, -1 when not lowered
+        S32 userReflectionProbeDetail{-1};  // RenderReflectionProbeDetail before the tuner lowered it, -1 when not lowered
 
         void updateNonImposters(U32 nv){nonImpostors=nv; tuningFlag |= NonImpostors;};
         void updateReflectionDetail(S32 nv){reflectionDetail=nv; tuningFlag |= ReflectionDetail;};
+        void updateShadowDetail(S32 nv){shadowDetail=nv; tuningFlag |= ShadowDetail;};
+        void updateReflectionProbeDetail(S32 nv){reflectionProbeDetail=nv; tuningFlag |= ReflectionProbeDetail;};
         void updateFarClip(F32 nv){farClip=nv; tuningFlag |= FarClip;};
         void updateUserMinDrawDistance(F32 nv){userMinDrawDistance=nv; tuningFlag |= UserMinDrawDistance;};
         void updateUserTargetDrawDistance(F32 nv){userTargetDrawDistance=nv; tuningFlag |= UserTargetDrawDistance;};
@@ -173,12 +186,15 @@ namespace LLPerfStats
         void updateUserARTCutoffSlider(F32 nv){userARTCutoffSliderValue=nv; tuningFlag |= UserARTCutoff;};
         void updateUserAutoTuneEnabled(bool nv){userAutoTuneEnabled=nv; tuningFlag |= UserAutoTuneEnabled;};
         void updateUserAutoTuneLock(bool nv){userAutoTuneLock=nv; tuningFlag |= UserAutoTuneLock;};
+        void updateUserShadowDetail(S32 nv){userShadowDetail=nv; tuningFlag |= UserShadowDetail;};
+        void updateUserReflectionProbeDetail(S32 nv){userReflectionProbeDetail=nv; tuningFlag |= UserReflectionProbeDetail;};
 
         void resetChanges(){tuningFlag=Nothing;};
         void initialiseFromSettings();
         void updateRenderCostLimitFromSettings();
         void updateSettingsFromRenderCostLimit();
         void applyUpdates();
+        void restoreUserSettings();
     };
 
     extern Tunables tunables;
@@ -237,9 +253,25 @@ namespace LLPerfStats
             return max[getReadBufferIndex()][static_cast<size_t>(otype)][static_cast<size_t>(type)];
         }
         static void updateAvatarParams();
+
+        // Frame recording: streams the raw scene and per-avatar stats of every
+        // frame to a CSV file for offline analysis (scripts/perf/perfstats_summary.py).
+        // An empty filename records to a timestamped file in the logs directory.
+        // Main thread only.
+        static bool startRecording(const std::string& filename = std::string());
+        static void stopRecording();
+        static inline bool isRecording() { return recordFile != nullptr; };
+        static const char* getStatTypeName(StatType_t type);
     private:
         StatsRecorder();
 
+        static void recordFrame();
+        static void finishRecordedFrame();
+        static void flushRecording();
+
+        static LLPerfCostModel::Settings getSceneSettings();
+        static LLPerfCostModel::EDecision tuneScenePredictive(const LLPerfCostModel::Settings& current, U64 target_frame_time_raw);
+
         static int countNearbyAvatars(S32 distance);
         static U64 getMeanTotalFrameTime();
         static void updateMeanFrameTime(U64 tot_frame_time_raw);
@@ -256,6 +288,14 @@ namespace LLPerfStats
         static std::array<StatsSummaryArray,2> max;
         static std::array<StatsSummaryArray,2> sum;
         static bool collectionEnabled;
+        static LLFILE* recordFile;
+        static std::string recordBuffer;
+        static U64 recordStartTime;
+
+        // predictive tuning (AutoTunePredictive)
+        static LLPerfCostModel costModel;
+        static LLPerfCostModel::EDecision lastDecision;
+        static F32 lastPredictedMs;
 
 
         void processUpdate(const StatsRecord& upd) const
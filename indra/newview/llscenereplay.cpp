@@ -0,0 +1,514 @@
+/**
+* @file llscenereplay.cpp
+* @brief Recording of the spatial partitions and camera path of a session,
+* and a headless replay of culling over it.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llscenereplay.h"
+
+#include "llfile.h"
+#include "llvieweroctree.h"
+#include "llplane.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "lltimer.h"
+
+#include <algorithm>
+
+static const S32 SCENE_RECORDING_VERSION = 1;
+
+// Floats stored per element in a partition's "bounds" blob
+static const S32 ELEMENT_FLOATS = 10;
+
+//-----------------------------------------------------------------------------
+// LLSceneRecording
+//-----------------------------------------------------------------------------
+
+void LLSceneRecording::Partition::addElement(const LLVector4a* extents, const LLVector4a& position_group, F32 bin_radius, S32 render_type)
+{
+    Element& element = mElements.emplace_back();
+    element.mExtents[0] = extents[0];
+    element.mExtents[1] = extents[1];
+    element.mPositionGroup = position_group;
+    element.mBinRadius = bin_radius;
+    element.mRenderType = render_type;
+}
+
+LLSceneRecording::LLSceneRecording()
+:   mOctreeMaxCapacity(128),
+    mOctreeMinSize(0.01f)
+{
+}
+
+void LLSceneRecording::clear()
+{
+    mPartitions.clear();
+    mFrames.clear();
+}
+
+LLSceneRecording::Partition& LLSceneRecording::addPartition(U32 region, U32 type)
+{
+    Partition& partition = mPartitions.emplace_back();
+    partition.mRegion = region;
+    partition.mType = type;
+    return partition;
+}
+
+void LLSceneRecording::addFrame(const LLCamera& camera, const LLPlane* clip_plane)
+{
+    Frame& frame = mFrames.emplace_back();
+    frame.mOrigin = camera.getOrigin();
+    for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; i++)
+    {
+        frame.mFrustum[i] = camera.mAgentFrustum[i];
+    }
+    frame.mUseClipPlane = clip_plane != NULL;
+    if (clip_plane)
+    {
+        frame.mClipPlane.set((*clip_plane)[0], (*clip_plane)[1], (*clip_plane)[2], (*clip_plane)[3]);
+    }
+}
+
+// static
+void LLSceneRecording::setupCamera(const Frame& frame, LLCamera& camera)
+{
+    LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM];
+    for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; i++)
+    {
+        frust[i] = frame.mFrustum[i];
+    }
+
+    camera.setOrigin(frame.mOrigin);
+    camera.calcAgentFrustumPlanes(frust);
+
+    if (frame.mUseClipPlane)
+    {
+        LLPlane plane(LLVector3(frame.mClipPlane.mV), frame.mClipPlane.mV[VW]);
+        camera.setUserClipPlane(plane);
+    }
+    else
+    {
+        camera.disableUserClipPlane();
+    }
+}
+
+U32 LLSceneRecording::getNumElements() const
+{
+    size_t count = 0;
+    for (const Partition& partition : mPartitions)
+    {
+        count += partition.mElements.size();
+    }
+    return (U32)count;
+}
+
+LLSD LLSceneRecording::asLLSD() const
+{
+    LLSD sd;
+    sd["version"] = SCENE_RECORDING_VERSION;
+    sd["octree_max_capacity"] = (LLSD::Integer)mOctreeMaxCapacity;
+    sd["octree_min_size"] = mOctreeMinSize;
+
+    LLSD& partitions = sd["partitions"];
+    partitions = LLSD::emptyArray();
+    for (const Partition& partition : mPartitions)
+    {
+        // Elements are packed into binary blobs, a scene has far too many
+        // of them for an LLSD map each
+        const size_t count = partition.mElements.size();
+        LLSD::Binary bounds(count * ELEMENT_FLOATS * sizeof(F32));
+        LLSD::Binary render_types(count * sizeof(S32));
+        F32* bp = (F32*)bounds.data();
+        S32* rp = (S32*)render_types.data();
+        for (const Element& element : partition.mElements)
+        {
+            const F32* min = element.mExtents[0].getF32ptr();
+            const F32* max = element.mExtents[1].getF32ptr();
+            const F32* pos = element.mPositionGroup.getF32ptr();
+            *bp++ = min[0]; *bp++ = min[1]; *bp++ = min[2];
+            *bp++ = max[0]; *bp++ = max[1]; *bp++ = max[2];
+            *bp++ = pos[0]; *bp++ = pos[1]; *bp++ = pos[2];
+            *bp++ = element.mBinRadius;
+            *rp++ = element.mRenderType;
+        }
+
+        LLSD entry;
+        entry["region"] = (LLSD::Integer)partition.mRegion;
+        entry["type"] = (LLSD::Integer)partition.mType;
+        entry["bounds"] = bounds;
+        entry["render_types"] = render_types;
+        partitions.append(entry);
+    }
+
+    LLSD& frames = sd["frames"];
+    frames = LLSD::emptyArray();
+    for (const Frame& frame : mFrames)
+    {
+        LLSD entry;
+        entry["origin"] = frame.mOrigin.getValue();
+        for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; i++)
+        {
+            entry["frustum"].append(frame.mFrustum[i].getValue());
+        }
+        if (frame.mUseClipPlane)
+        {
+            entry["clip_plane"] = frame.mClipPlane.getValue();
+        }
+        frames.append(entry);
+    }
+
+    return sd;
+}
+
+bool LLSceneRecording::fromLLSD(const LLSD& sd)
+{
+    clear();
+
+    if (sd["version"].asInteger() != SCENE_RECORDING_VERSION)
+    {
+        LL_WARNS() << "Unsupported scene recording version " << sd["version"].asInteger() << LL_ENDL;
+        return false;
+    }
+
+    mOctreeMaxCapacity = (U32)sd["octree_max_capacity"].asInteger();
+    mOctreeMinSize = (F32)sd["octree_min_size"].asReal();
+
+    for (const LLSD& entry : llsd::inArray(sd["partitions"]))
+    {
+        const LLSD::Binary& bounds = entry["bounds"].asBinary();
+        const LLSD::Binary& render_types = entry["render_types"].asBinary();
+        const size_t count = render_types.size() / sizeof(S32);
+        if (bounds.size() != count * ELEMENT_FLOATS * sizeof(F32))
+        {
+            LL_WARNS() << "Malformed partition in scene recording" << LL_ENDL;
+            clear();
+            return false;
+        }
+
+        Partition& partition = addPartition((U32)entry["region"].asInteger(), (U32)entry["type"].asInteger());
+        partition.mElements.reserve(count);
+
+        const F32* bp = (const F32*)bounds.data();
+        const S32* rp = (const S32*)render_types.data();
+        for (size_t i = 0; i < count; i++, bp += ELEMENT_FLOATS)
+        {
+            LLVector4a extents[2];
+            LLVector4a position_group;
+            extents[0].set(bp[0], bp[1], bp[2]);
+            extents[1].set(bp[3], bp[4], bp[5]);
+            position_group.set(bp[6], bp[7], bp[8]);
+            partition.addElement(extents, position_group, bp[9], rp[i]);
+        }
+    }
+
+    for (const LLSD& entry : llsd::inArray(sd["frames"]))
+    {
+        const LLSD& frustum = entry["frustum"];
+        if (frustum.size() != LLCamera::AGENT_FRUSTRUM_NUM)
+        {
+            LL_WARNS() << "Malformed frame in scene recording" << LL_ENDL;
+            clear();
+            return false;
+        }
+
+        Frame& frame = mFrames.emplace_back();
+        frame.mOrigin.setValue(entry["origin"]);
+        for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; i++)
+        {
+            frame.mFrustum[i].setValue(frustum[i]);
+        }
+        frame.mUseClipPlane = entry.has("clip_plane");
+        if (frame.mUseClipPlane)
+        {
+            frame.mClipPlane.setValue(entry["clip_plane"]);
+        }
+    }
+
+    return true;
+}
+
+bool LLSceneRecording::save(const std::string& filename) const
+{
+    llofstream out(filename.c_str(), std::ios::out | std::ios::binary);
+    if (!out.is_open())
+    {
+        LL_WARNS() << "Unable to open " << filename << " for writing" << LL_ENDL;
+        return false;
+    }
+
+    LLSDSerialize::toBinary(asLLSD(), out);
+    return out.good();
+}
+
+bool LLSceneRecording::load(const std::string& filename)
+{
+    llifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        LL_WARNS() << "Unable to open " << filename << LL_ENDL;
+        return false;
+    }
+
+    LLSD sd;
+    if (LLSDSerialize::fromBinary(sd, in, LLSDSerialize::SIZE_UNLIMITED) <= 0)
+    {
+        LL_WARNS() << "Unable to parse scene recording " << filename << LL_ENDL;
+        return false;
+    }
+
+    return fromLLSD(sd);
+}
+
+//-----------------------------------------------------------------------------
+// Replay partitions
+//-----------------------------------------------------------------------------
+
+// Stands in for the LLDrawable of a recorded element
+class LLSceneReplayDrawable : public LLViewerOctreeEntryData
+{
+public:
+    LLSceneReplayDrawable(const LLSceneRecording::Element* element)
+    :   LLViewerOctreeEntryData(LLViewerOctreeEntry::LLDRAWABLE),
+        mElement(element)
+    {
+        setOctreeEntry(NULL);
+        setSpatialExtents(element->mExtents[0], element->mExtents[1]);
+        setPositionGroup(element->mPositionGroup);
+        setBinRadius(element->mBinRadius);
+    }
+
+    const LLSceneRecording::Element* mElement;
+
+protected:
+    ~LLSceneReplayDrawable() = default;
+};
+
+// The frustum checks of LLOctreeCull, without occlusion, appending the
+// elements of visible groups as LLPipeline::markNotCulled() followed by
+// stateSort() would visit their drawables
+class LLSceneReplayCull : public LLViewerOctreeCull
+{
+public:
+    LLSceneReplayCull(LLCamera* camera, std::vector<LLSceneReplay::Visible>* results)
+    :   LLViewerOctreeCull(camera),
+        mResults(results),
+        mGroups(0)
+    {
+        mOrigin.load3(camera->getOrigin().mV);
+    }
+
+    S32 frustumCheck(const LLViewerOctreeGroup* group) override
+    {
+        S32 res = AABBInFrustumNoFarClipGroupBounds(group);
+        if (res != 0)
+        {
+            res = llmin(res, AABBSphereIntersectGroupExtents(group));
+        }
+        return res;
+    }
+
+    S32 frustumCheckObjects(const LLViewerOctreeGroup* group) override
+    {
+        S32 res = AABBInFrustumNoFarClipObjectBounds(group);
+        if (res != 0)
+        {
+            res = llmin(res, AABBSphereIntersectObjectExtents(group));
+        }
+        return res;
+    }
+
+    void processGroup(LLViewerOctreeGroup* group) override
+    {
+        mGroups++;
+        if (!mResults)
+        {
+            return;
+        }
+
+        for (LLViewerOctreeGroup::element_iter i = group->getDataBegin(); i != group->getDataEnd(); ++i)
+        {
+            const LLSceneReplayDrawable* drawable = (const LLSceneReplayDrawable*)(*i)->getDrawable();
+            LLVector4a delta;
+            delta.setSub(drawable->getPositionGroup(), mOrigin);
+            mResults->push_back({ drawable->mElement, delta.getLength3().getF32() });
+        }
+    }
+
+    U32 getGroupCount() const { return mGroups; }
+
+private:
+    std::vector<LLSceneReplay::Visible>* mResults;
+    LLVector4a mOrigin;
+    U32 mGroups;
+};
+
+// The octree of one recorded partition, with the groups and bounds of
+// LLViewerOctreeGroup
+class LLSceneReplayPartition : public LLViewerOctreePartition
+{
+public:
+    LLSceneReplayPartition(const LLSceneRecording::Partition& partition)
+    {
+        mPartitionType = partition.mType;
+        mOcclusionEnabled = false;
+        new LLViewerOctreeGroup(mOctree);
+
+        mDrawables.reserve(partition.mElements.size());
+        for (const LLSceneRecording::Element& element : partition.mElements)
+        {
+            LLSceneReplayDrawable* drawable = new LLSceneReplayDrawable(&element);
+            mDrawables.push_back(drawable);
+            mOctree->insert(drawable->getEntry());
+        }
+
+        ((LLViewerOctreeGroup*)mOctree->getListener(0))->rebound();
+    }
+
+    ~LLSceneReplayPartition()
+    {
+        cleanup();
+    }
+
+    // As LLSpatialPartition::cull(), appending visible elements to results
+    // when given, returns the number of visible groups
+    S32 cull(LLCamera& camera, std::vector<LLSceneReplay::Visible>* results)
+    {
+        LLSceneReplayCull culler(&camera, results);
+        culler.traverse(mOctree);
+        return (S32)culler.getGroupCount();
+    }
+
+    S32 cull(LLCamera& camera, bool do_occlusion) override
+    {
+        return cull(camera, nullptr);
+    }
+
+private:
+    std::vector<LLPointer<LLSceneReplayDrawable> > mDrawables;
+};
+
+//-----------------------------------------------------------------------------
+// LLSceneReplay
+//-----------------------------------------------------------------------------
+
+LLSceneReplay::LLSceneReplay(const LLSceneRecording& recording)
+:   mRecording(recording)
+{
+}
+
+LLSceneReplay::~LLSceneReplay()
+{
+    clearPartitions();
+}
+
+void LLSceneReplay::clearPartitions()
+{
+    for (LLSceneReplayPartition* partition : mPartitions)
+    {
+        delete partition;
+    }
+    mPartitions.clear();
+}
+
+void LLSceneReplay::rebuild()
+{
+    clearPartitions();
+
+    // Build with the node limits of the recording session
+    U32 max_capacity = gOctreeMaxCapacity;
+    F32 min_size = gOctreeMinSize;
+    gOctreeMaxCapacity = mRecording.mOctreeMaxCapacity;
+    gOctreeMinSize = mRecording.mOctreeMinSize;
+
+    mPartitions.reserve(mRecording.mPartitions.size());
+    for (const LLSceneRecording::Partition& partition : mRecording.mPartitions)
+    {
+        mPartitions.push_back(new LLSceneReplayPartition(partition));
+    }
+
+    gOctreeMaxCapacity = max_capacity;
+    gOctreeMinSize = min_size;
+}
+
+U32 LLSceneReplay::cull(LLCamera& camera, std::vector<Visible>& visible) const
+{
+    U32 groups = 0;
+    for (LLSceneReplayPartition* partition : mPartitions)
+    {
+        groups += partition->cull(camera, &visible);
+    }
+    return groups;
+}
+
+// static
+void LLSceneReplay::sort(std::vector<Visible>& visible)
+{
+    std::sort(visible.begin(), visible.end(),
+        [](const Visible& lhs, const Visible& rhs)
+        {
+            if (lhs.mElement->mRenderType != rhs.mElement->mRenderType)
+            {
+                return lhs.mElement->mRenderType < rhs.mElement->mRenderType;
+            }
+            return lhs.mDistance < rhs.mDistance;
+        });
+}
+
+LLSceneReplay::Stats LLSceneReplay::run(U32 passes)
+{
+    Stats stats = {};
+
+    LLCamera camera;
+    std::vector<Visible> visible;
+    LLTimer timer;
+
+    for (U32 pass = 0; pass < passes; pass++)
+    {
+        timer.reset();
+        rebuild();
+        stats.mRebuildSecs += timer.getElapsedTimeF64();
+
+        for (const LLSceneRecording::Frame& frame : mRecording.mFrames)
+        {
+            LLSceneRecording::setupCamera(frame, camera);
+            visible.clear();
+
+            timer.reset();
+            stats.mVisibleGroups += cull(camera, visible);
+            stats.mCullSecs += timer.getElapsedTimeF64();
+
+            timer.reset();
+            sort(visible);
+            stats.mSortSecs += timer.getElapsedTimeF64();
+
+            stats.mVisibleElements += visible.size();
+            stats.mFrames++;
+        }
+    }
+
+    return stats;
+}
@@ -0,0 +1,143 @@
+/**
+* @file llscenereplay.h
+* @brief Recording of the spatial partitions and camera path of a session,
+* and a headless replay of culling over it.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#ifndef LL_LLSCENEREPLAY_H
+#define LL_LLSCENEREPLAY_H
+
+#include "llcamera.h"
+#include "llsd.h"
+#include "llvector4a.h"
+#include "v4math.h"
+
+#include <string>
+#include <vector>
+
+// The octree entries of every spatial partition and the world camera of a
+// number of frames, captured by LLPipeline::updateCull(). Only bounding
+// boxes and render types are kept, no GL state, so a recording can be
+// replayed by LLSceneReplay on a machine without a GPU.
+class LLSceneRecording
+{
+public:
+    struct Element
+    {
+        LL_ALIGN_16(LLVector4a mExtents[2]);    // min, max
+        LL_ALIGN_16(LLVector4a mPositionGroup);
+        F32 mBinRadius;
+        S32 mRenderType;
+    };
+
+    // One spatial partition of one region
+    struct Partition
+    {
+        void addElement(const LLVector4a* extents, const LLVector4a& position_group, F32 bin_radius, S32 render_type);
+
+        U32 mRegion;
+        U32 mType;
+        std::vector<Element> mElements;
+    };
+
+    struct Frame
+    {
+        LLVector3 mOrigin;
+        LLVector3 mFrustum[LLCamera::AGENT_FRUSTRUM_NUM];
+        bool mUseClipPlane;
+        LLVector4 mClipPlane;
+    };
+
+    LLSceneRecording();
+
+    void clear();
+    Partition& addPartition(U32 region, U32 type);
+    // camera must have its agent frustum planes up to date
+    void addFrame(const LLCamera& camera, const LLPlane* clip_plane);
+    // Puts camera where it was in frame, with the same frustum planes
+    static void setupCamera(const Frame& frame, LLCamera& camera);
+
+    U32 getNumElements() const;
+
+    LLSD asLLSD() const;
+    bool fromLLSD(const LLSD& sd);
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    U32 mOctreeMaxCapacity;
+    F32 mOctreeMinSize;
+    std::vector<Partition> mPartitions;
+    std::vector<Frame> mFrames;
+};
+
+class LLSceneReplayPartition;
+
+// Replays a recording through LLViewerOctreePartition octrees of
+// LLViewerOctreeGroup, culled by an LLViewerOctreeCull with the frustum
+// checks of LLOctreeCull, timing each stage. Only the octree is replayed:
+// stateSort(), the LLSpatialPartition geometry rebuild, LLCullResult and
+// occlusion culling all work on drawables, faces and vertex buffers and need
+// GL, so they are left out. The sort stage stands in for stateSort()
+// ordering visible drawables by render type and distance.
+class LLSceneReplay
+{
+public:
+    struct Visible
+    {
+        const LLSceneRecording::Element* mElement;
+        F32 mDistance;
+    };
+
+    struct Stats
+    {
+        F64 mRebuildSecs;       // building the octrees and their bounds
+        F64 mCullSecs;          // frustum culling, all frames
+        F64 mSortSecs;          // sorting visible elements, all frames
+        U32 mFrames;
+        U64 mVisibleGroups;
+        U64 mVisibleElements;
+    };
+
+    LLSceneReplay(const LLSceneRecording& recording);
+    ~LLSceneReplay();
+
+    // Builds one octree per recorded partition from scratch
+    void rebuild();
+    // Appends the elements in groups visible from camera, returns the number
+    // of visible groups
+    U32 cull(LLCamera& camera, std::vector<Visible>& visible) const;
+    static void sort(std::vector<Visible>& visible);
+
+    // Rebuilds and replays every recorded frame passes times
+    Stats run(U32 passes = 1);
+
+private:
+    void clearPartitions();
+
+    const LLSceneRecording& mRecording;
+    std::vector<LLSceneReplayPartition*> mPartitions;
+};
+
+#endif // LL_LLSCENEREPLAY_H
@@ -53,6 +53,8 @@
 #include "llvolumemgr.h"
 #include "llviewershadermgr.h"
 #include "llcontrolavatar.h"
+#include "lldrawsortkey.h"
+#include "llradixsort.h"
 
 #include "llvotree.h"
 // <FS:Beq> improved normals debug
@@ -1065,8 +1067,8 @@ public:
         if (group->getOctreeNode() &&
             group->getOctreeNode()->getParent() &&  //never occlusion cull the root node
             LLPipeline::sUseOcclusion &&            //ignore occlusion if disabled
-            group->isOcclusionState(LLSpatialGroup::OCCLUDED))
-        {
+            (group->isOcclusionState(LLSpatialGroup::OCCLUDED) || gPipeline.isSoftwareOccluded(group)))
+        { //a software occluded group gets a query to confirm it
             gPipeline.markOccluder(group);
             return true;
         }
@@ -1476,6 +1478,161 @@ S32 LLSpatialPartition::cull(LLCamera &camera, bool do_occlusion)
     return 0;
 }
 
+// Records the groups a culler of type T reaches into an LLCullFragment
+// instead of checking occlusion and marking them not culled
+template <class T>
+class LLOctreeCullRecord : public T
+{
+public:
+    LLOctreeCullRecord(LLCamera* camera, LLCullFragment& fragment, std::vector<LLCullFragment>* subtrees)
+        : T(camera), mFragment(fragment), mSubtrees(subtrees)
+    {
+        this->mRes = fragment.mRes;
+    }
+
+    virtual bool earlyFail(LLViewerOctreeGroup* group)
+    { //occlusion is checked by applyCullFragment
+        return false;
+    }
+
+    virtual void traverse(const OctreeNode* n)
+    {
+        if (mSubtrees && n != mFragment.mRoot)
+        { //children of the root get fragments of their own, only an only child
+          //can skip its frustum check so they all inherit the root's result
+            mSubtrees->emplace_back();
+            LLCullFragment& subtree = mSubtrees->back();
+            subtree.mRoot = n;
+            subtree.mRes = this->mRes;
+            subtree.mCuller = mFragment.mCuller;
+            subtree.mPartitionType = mFragment.mPartitionType;
+            return;
+        }
+
+        size_t index = mFragment.mNodes.size();
+        mFragment.mNodes.push_back({ (LLSpatialGroup*) n->getListener(0), 0, false });
+        T::traverse(n);
+        mFragment.mNodes[index].mSubtreeEnd = (U32) mFragment.mNodes.size();
+    }
+
+    virtual void processGroup(LLViewerOctreeGroup* group)
+    { //visit() comes right after the group's node was recorded
+        mFragment.mNodes.back().mProcess = true;
+    }
+
+private:
+    LLCullFragment& mFragment;
+    std::vector<LLCullFragment>* mSubtrees;
+};
+
+template <class T>
+static void record_cull_fragment(LLCamera& camera, LLCullFragment& fragment, std::vector<LLCullFragment>* subtrees)
+{
+    LLOctreeCullRecord<T> culler(&camera, fragment, subtrees);
+    culler.traverse(fragment.mRoot);
+}
+
+static void record_cull_fragment(LLCamera& camera, LLCullFragment& fragment, std::vector<LLCullFragment>* subtrees)
+{
+    switch (fragment.mCuller)
+    {
+    case LLCullFragment::CULL_SHADOW:
+        record_cull_fragment<LLOctreeCullShadow>(camera, fragment, subtrees);
+        break;
+    case LLCullFragment::CULL_NO_FAR_CLIP:
+        record_cull_fragment<LLOctreeCullNoFarClip>(camera, fragment, subtrees);
+        break;
+    default:
+        record_cull_fragment<LLOctreeCull>(camera, fragment, subtrees);
+        break;
+    }
+}
+
+void LLSpatialPartition::cullRoot(LLCamera& camera, std::vector<LLCullFragment>& fragments)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SPATIAL;
+    LLSpatialGroup* group = (LLSpatialGroup*) mOctree->getListener(0);
+    group->rebound();
+
+#if LL_OCTREE_PARANOIA_CHECK
+    ((LLSpatialGroup*)mOctree->getListener(0))->validate();
+#endif
+
+    // same choice of culler as cull()
+    LLCullFragment root;
+    root.mRoot = mOctree;
+    root.mPartitionType = mPartitionType;
+    if (LLPipeline::sShadowRender)
+    {
+        root.mCuller = LLCullFragment::CULL_SHADOW;
+    }
+    else if (mInfiniteFarClip || (!LLPipeline::sUseFarClip && !gCubeSnapshot))
+    {
+        root.mCuller = LLCullFragment::CULL_NO_FAR_CLIP;
+    }
+
+    std::vector<LLCullFragment> subtrees;
+    record_cull_fragment(camera, root, &subtrees);
+
+    fragments.push_back(std::move(root));
+    fragments.insert(fragments.end(), std::make_move_iterator(subtrees.begin()), std::make_move_iterator(subtrees.end()));
+}
+
+//static
+void LLSpatialPartition::cullFragment(LLCamera& camera, LLCullFragment& fragment)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SPATIAL;
+    if (!fragment.mNodes.empty())
+    { //root fragments come back from cullRoot() already checked
+        return;
+    }
+
+    F64 start = LLTimer::getTotalSeconds();
+    record_cull_fragment(camera, fragment, nullptr);
+    fragment.mSeconds = LLTimer::getTotalSeconds() - start;
+}
+
+template <class T>
+static void apply_cull_fragment(LLCamera& camera, const LLCullFragment& fragment)
+{
+    T culler(&camera);
+    const std::vector<LLCullFragment::Node>& nodes = fragment.mNodes;
+    U32 i = 0;
+    while (i < nodes.size())
+    {
+        const LLCullFragment::Node& node = nodes[i];
+        if (culler.earlyFail(node.mGroup))
+        { //occluded, skip the whole subtree as traverse() would
+            i = node.mSubtreeEnd;
+            continue;
+        }
+
+        if (node.mProcess)
+        {
+            culler.processGroup(node.mGroup);
+        }
+        i++;
+    }
+}
+
+//static
+void LLSpatialPartition::applyCullFragment(LLCamera& camera, const LLCullFragment& fragment)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_SPATIAL;
+    switch (fragment.mCuller)
+    {
+    case LLCullFragment::CULL_SHADOW:
+        apply_cull_fragment<LLOctreeCullShadow>(camera, fragment);
+        break;
+    case LLCullFragment::CULL_NO_FAR_CLIP:
+        apply_cull_fragment<LLOctreeCullNoFarClip>(camera, fragment);
+        break;
+    default:
+        apply_cull_fragment<LLOctreeCull>(camera, fragment);
+        break;
+    }
+}
+
 void pushVerts(LLDrawInfo* params)
 {
     LLRenderPass::applyModelMatrix(*params);
@@ -4128,6 +4285,14 @@ U64 LLDrawInfo::getSkinHash()
     return mSkinInfo ? mSkinInfo->mHash : 0;
 }
 
+void LLDrawInfo::updateSortKey()
+{
+    U64 skin = (U64) (uintptr_t) mAvatar.get() ^ getSkinHash();
+    const void* material = mGLTFMaterial.notNull() ? (const void*) mGLTFMaterial.get() : (const void*) mMaterial.get();
+    mSortKey = ll_draw_sort_key(skin, (uintptr_t) material, (uintptr_t) mTexture.get(),
+                                (uintptr_t) mModelMatrix, (uintptr_t) mVertexBuffer.get());
+}
+
 LLCullResult::LLCullResult()
 {
     mVisibleGroupsAllocated = 0;
@@ -4419,6 +4584,32 @@ void LLCullResult::pushDrawInfo(U32 type, LLDrawInfo* draw_info)
 }
 
 
+void LLCullResult::sortRenderMap(U32 type)
+{
+    U32 count = mRenderMapSize[type];
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Sorting the keys with their draw infos reads each draw info once
+    mSortKeys.resize(count);
+    mSortScratch.resize(count);
+    LLDrawInfo** render_map = &mRenderMap[type][0];
+    for (U32 i = 0; i < count; ++i)
+    {
+        mSortKeys[i] = { render_map[i]->mSortKey, render_map[i] };
+    }
+
+    LL::radix_sort(mSortKeys.data(), mSortKeys.data() + count, mSortScratch.data(),
+                   [](const std::pair<U64, LLDrawInfo*>& entry) { return entry.first; });
+
+    for (U32 i = 0; i < count; ++i)
+    {
+        render_map[i] = mSortKeys[i].second;
+    }
+}
+
 void LLCullResult::assertDrawMapsEmpty()
 {
     for (U32 i = 0; i < LLRenderPass::NUM_RENDER_TYPES; i++)
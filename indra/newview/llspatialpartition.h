@@ -108,6 +108,9 @@ public:
     // return mSkinHash->mHash, or 0 if mSkinHash is null
     U64 getSkinHash();
 
+    // recompute mSortKey, call once the state below is set
+    void updateSortKey();
+
     LLPointer<LLVertexBuffer> mVertexBuffer;
     U16 mStart = 0;
     U16 mEnd = 0;
@@ -150,6 +153,11 @@ public:
     bool mFullbright = false;
     bool mHasGlow = false;
 
+    // Order of this batch within its render pass, grouping batches sharing
+    // skinning, material, texture, model matrix and vertex buffer, most
+    // expensive state change first
+    U64 mSortKey = 0;
+
     struct CompareTexture
     {
         bool operator()(const LLDrawInfo& lhs, const LLDrawInfo& rhs)
@@ -395,6 +403,36 @@ public:
     virtual void addGeometryCount(LLSpatialGroup* group, U32 &vertex_count, U32 &index_count);
 };
 
+// The groups of one octree subtree reached by a frustum cull, in traversal
+// order. The frustum checks of a fragment can run on a worker thread, while
+// the occlusion checks and LLPipeline::markNotCulled() calls, which need the
+// main thread, are applied afterwards in the order a serial cull would have
+// made them. See LLPipeline::updateCull().
+class LLCullFragment
+{
+public:
+    typedef enum
+    {
+        CULL_DEFAULT = 0,   // LLOctreeCull
+        CULL_NO_FAR_CLIP,   // LLOctreeCullNoFarClip
+        CULL_SHADOW,        // LLOctreeCullShadow
+    } eCuller;
+
+    struct Node
+    {
+        LLSpatialGroup* mGroup;
+        U32 mSubtreeEnd;    // index of the first node past this node's subtree
+        bool mProcess;      // passed the frustum checks, to be marked not culled
+    };
+
+    const OctreeNode* mRoot = nullptr;
+    S32 mRes = 0;           // frustum check result inherited from the parent of mRoot
+    eCuller mCuller = CULL_DEFAULT;
+    U32 mPartitionType = 0;
+    F64 mSeconds = 0.0;     // time spent frustum checking this fragment
+    std::vector<Node> mNodes;
+};
+
 class LLSpatialPartition: public LLViewerOctreePartition, public LLGeometryManager
 {
 public:
@@ -431,6 +469,15 @@ public:
     /*virtual*/ S32 cull(LLCamera &camera, bool do_occlusion=false); // Cull on arbitrary frustum
     S32 cull(LLCamera &camera, std::vector<LLDrawable *>* results, bool for_select); // Cull on arbitrary frustum
 
+    // Parallel culling. cullRoot() rebounds the octree and checks its root on
+    // the main thread, appending a fragment for the root and one for each
+    // child subtree left to check. cullFragment() checks one of those and is
+    // safe on any thread; applyCullFragment() marks the visible groups of a
+    // fragment, main thread only.
+    void cullRoot(LLCamera& camera, std::vector<LLCullFragment>& fragments);
+    static void cullFragment(LLCamera& camera, LLCullFragment& fragment);
+    static void applyCullFragment(LLCamera& camera, const LLCullFragment& fragment);
+
     bool isVisible(const LLVector3& v);
     bool isHUDPartition() ;
 
@@ -556,6 +603,8 @@ public:
     void pushDrawable(LLDrawable* drawable);
     void pushBridge(LLSpatialBridge* bridge);
     void pushDrawInfo(U32 type, LLDrawInfo* draw_info);
+    // Radix sorts the render map of type by LLDrawInfo::mSortKey
+    void sortRenderMap(U32 type);
 
     U32 getVisibleGroupsSize()      { return mVisibleGroupsSize; }
     U32 getAlphaGroupsSize()        { return mAlphaGroupsSize; }
@@ -607,6 +656,9 @@ private:
     U32                 mRenderMapAllocated[LLRenderPass::NUM_RENDER_TYPES];
     drawinfo_iterator mRenderMapEnd[LLRenderPass::NUM_RENDER_TYPES];
 
+    // (sort key, draw info) pairs for sortRenderMap()
+    std::vector<std::pair<U64, LLDrawInfo*> > mSortKeys;
+    std::vector<std::pair<U64, LLDrawInfo*> > mSortScratch;
 };
 
 
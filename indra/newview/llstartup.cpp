@@ -189,6 +189,7 @@
 #include "llnamelistctrl.h"
 #include "llnamebox.h"
 #include "llnameeditor.h"
+#include "llpolymeshcache.h"
 #include "llpostprocess.h"
 #include "llagentlanguage.h"
 #include "llwearable.h"
@@ -1984,6 +1985,7 @@ bool idle_startup()
         LLPostProcess::initClass();
         display_startup();
 
+        LLPolyMeshCache::sEnabled = gSavedSettings.getBOOL("AvatarMeshCache");
         LLAvatarAppearance::initClass("avatar_lad.xml","avatar_skeleton.xml");
         display_startup();
 
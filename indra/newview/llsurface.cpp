@@ -55,6 +55,7 @@
 #include "lldrawpoolterrain.h"
 #include "lldrawable.h"
 #include "llworldmipmap.h"
+#include "parallelfor.h"
 
 extern LLPipeline gPipeline;
 extern bool gShiftFrame;
@@ -776,9 +777,50 @@ void LLSurface::updatePatchVisibilities(LLAgent &agent)
     }
 }
 
+// Dirty patches per job on the worker threads
+constexpr size_t PATCH_UPDATE_GRAIN = 8;
+
+// Calls update(patchp) for each dirty patch on the "General" thread pool.
+// Patch updates read and write the data of neighboring patches, so patches
+// go in four waves by the parity of their position, with no two neighbors
+// in the same wave.
+template<typename UPDATE>
+void LLSurface::updateDirtyPatches(const UPDATE& update)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    std::vector<LLSurfacePatch*> waves[4];
+    for (LLSurfacePatch* patchp : mDirtyPatchList)
+    {
+        const S32 index = (S32)(patchp - mPatchList);
+        const S32 x = index % mPatchesPerEdge;
+        const S32 y = index / mPatchesPerEdge;
+        waves[(x & 1) | ((y & 1) << 1)].push_back(patchp);
+    }
+
+    for (const std::vector<LLSurfacePatch*>& wave : waves)
+    {
+        LL::parallel_for("General", wave.size(), PATCH_UPDATE_GRAIN,
+                         [&wave, &update](size_t begin, size_t end)
+                         {
+                             for (size_t i = begin; i < end; ++i)
+                             {
+                                 update(wave[i]);
+                             }
+                         });
+    }
+}
+
 template<bool PBR>
 bool LLSurface::idleUpdate(F32 max_update_time)
 {
+    // Copy the edges of newly arrived patches even with terrain hidden, as
+    // height queries along them rely on it.
+    if (mDirtyPatchEdges)
+    {
+        updateDirtyPatches([](LLSurfacePatch* patchp) { patchp->updateEdges(); });
+        mDirtyPatchEdges = false;
+    }
+
     if (!gPipeline.hasRenderType(LLPipeline::RENDER_TYPE_TERRAIN))
     {
         return false;
@@ -794,16 +836,27 @@ bool LLSurface::idleUpdate(F32 max_update_time)
     if (mDirtyPatchList.size() > 0)
     {
         getRegion()->dirtyHeights();
+
+        // Always update normals every frame to avoid artifacts, off the
+        // main thread and after all the edges they read are in place
+        updateDirtyPatches([](LLSurfacePatch* patchp) { patchp->updateNormals<PBR>(); });
+
+        // Likewise the composition values under the patches, leaving only the
+        // materials to the texture updates below
+        if (std::any_of(mDirtyPatchList.begin(), mDirtyPatchList.end(),
+                        [](const LLSurfacePatch* patchp) { return !patchp->isHeightsGenerated(); }))
+        {
+            noise_init(); // before the workers read the noise tables
+            updateDirtyPatches([](LLSurfacePatch* patchp) { patchp->generateHeights(); });
+        }
     }
 
-    // Always call updateNormals() / updateVerticalStats()
-    //  every frame to avoid artifacts
+    // Vertical stats feed the surface and region, so stay here
     for(std::set<LLSurfacePatch *>::iterator iter = mDirtyPatchList.begin();
         iter != mDirtyPatchList.end(); )
     {
         std::set<LLSurfacePatch *>::iterator curiter = iter++;
         LLSurfacePatch *patchp = *curiter;
-        patchp->updateNormals<PBR>();
         patchp->updateVerticalStats();
         if (max_update_time == 0.f || update_timer.getElapsedTimeF32() < max_update_time)
         {
@@ -884,20 +937,20 @@ void LLSurface::decompressDCTPatch(LLBitPack &bitpack, LLGroupHeader *gopp, bool
         decompress_patch(patchp->getDataZ(), patch, &ph);
 
         // Update edges for neighbors.  Need to guarantee that this gets done before we generate vertical stats.
-        patchp->updateNorthEdge();
-        patchp->updateEastEdge();
+        // Each surface copies them in its idleUpdate(), neighbors of other regions included, and dirtyZ()
+        // below puts all of these patches on their surfaces' dirty lists.
+        patchp->dirtyEdges(NORTH_EDGE | EAST_EDGE);
         if (patchp->getNeighborPatch(WEST))
         {
-            patchp->getNeighborPatch(WEST)->updateEastEdge();
+            patchp->getNeighborPatch(WEST)->dirtyEdges(EAST_EDGE);
         }
         if (patchp->getNeighborPatch(SOUTHWEST))
         {
-            patchp->getNeighborPatch(SOUTHWEST)->updateEastEdge();
-            patchp->getNeighborPatch(SOUTHWEST)->updateNorthEdge();
+            patchp->getNeighborPatch(SOUTHWEST)->dirtyEdges(NORTH_EDGE | EAST_EDGE);
         }
         if (patchp->getNeighborPatch(SOUTH))
         {
-            patchp->getNeighborPatch(SOUTH)->updateNorthEdge();
+            patchp->getNeighborPatch(SOUTH)->dirtyEdges(NORTH_EDGE);
         }
 
         // Dirty patch statistics, and flag that the patch has data.
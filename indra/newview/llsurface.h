@@ -180,6 +180,9 @@ protected:
     void createPatchData();     // Allocates memory for patches.
     void destroyPatchData();    // Deallocates memory for patches.
 
+    template<typename UPDATE>
+    void updateDirtyPatches(const UPDATE& update);
+
 protected:
     LLVector3d  mOriginGlobal;      // In absolute frame
     LLSurfacePatch *mPatchList;     // Array of all patches
@@ -191,6 +194,7 @@ protected:
     LLVector3 *mNorm;
 
     std::set<LLSurfacePatch *> mDirtyPatchList;
+    bool mDirtyPatchEdges = false;  // Some patch on the dirty list has edges to copy
 
 
     // The textures should never be directly initialized - use the setter methods!
@@ -53,6 +53,7 @@ LLSurfacePatch::LLSurfacePatch()
     mDirty(false),
     mDirtyZStats(true),
     mHeightsGenerated(false),
+    mDirtyEdges(NO_EDGE),
     mDataOffset(0),
     mDataZ(NULL),
     mDataNorm(NULL),
@@ -673,11 +674,11 @@ void LLSurfacePatch::updateVerticalStats()
 
 
 template<bool PBR>
-void LLSurfacePatch::updateNormals()
+bool LLSurfacePatch::updateNormals()
 {
     if (mSurfacep->mType == 'w')
     {
-        return;
+        return false;
     }
     U32 grids_per_patch_edge = mSurfacep->getGridsPerPatchEdge();
     U32 grids_per_edge = mSurfacep->getGridsPerEdge();
@@ -880,19 +881,39 @@ void LLSurfacePatch::updateNormals()
         dirty_patch = true;
     }
 
-    if (dirty_patch)
-    {
-        mSurfacep->dirtySurfacePatch(this);
-    }
-
     for (i = 0; i < 9; i++)
     {
         mNormalsInvalid[i] = false;
     }
+
+    // Patches are only updated from the surface's dirty list, which they
+    // stay on until their texture is updated.
+    return dirty_patch;
+}
+
+template bool LLSurfacePatch::updateNormals</*PBR=*/false>();
+template bool LLSurfacePatch::updateNormals</*PBR=*/true>();
+
+void LLSurfacePatch::dirtyEdges(const U8 edges)
+{
+    mDirtyEdges |= edges;
+    // Copied on the next idle update of our own surface, which isn't the one
+    // being decompressed when this is a neighboring region's patch
+    mSurfacep->mDirtyPatchEdges = true;
 }
 
-template void LLSurfacePatch::updateNormals</*PBR=*/false>();
-template void LLSurfacePatch::updateNormals</*PBR=*/true>();
+void LLSurfacePatch::updateEdges()
+{
+    if (mDirtyEdges & NORTH_EDGE)
+    {
+        updateNorthEdge();
+    }
+    if (mDirtyEdges & EAST_EDGE)
+    {
+        updateEastEdge();
+    }
+    mDirtyEdges = NO_EDGE;
+}
 
 void LLSurfacePatch::updateEastEdge()
 {
@@ -968,35 +989,51 @@ void LLSurfacePatch::updateNorthEdge()
     }
 }
 
+bool LLSurfacePatch::neighborsHaveData() const
+{
+    return (!getNeighborPatch(EAST) || getNeighborPatch(EAST)->getHasReceivedData())
+        && (!getNeighborPatch(WEST) || getNeighborPatch(WEST)->getHasReceivedData())
+        && (!getNeighborPatch(SOUTH) || getNeighborPatch(SOUTH)->getHasReceivedData())
+        && (!getNeighborPatch(NORTH) || getNeighborPatch(NORTH)->getHasReceivedData());
+}
+
+bool LLSurfacePatch::generateHeights()
+{
+    if (mHeightsGenerated)
+    {
+        return true;
+    }
+    if (!mSTexUpdate || !neighborsHaveData())
+    {
+        return false;
+    }
+
+    F32 meters_per_grid = getSurface()->getMetersPerGrid();
+    F32 grids_per_patch_edge = (F32)getSurface()->getGridsPerPatchEdge();
+    LLVector3d origin_region = getOriginGlobal() - getSurface()->getOriginGlobal();
+
+    // Have to figure out a better way to deal with these edge conditions...
+    LLVLComposition* comp = getSurface()->getRegion()->getComposition();
+    F32 patch_size = meters_per_grid*(grids_per_patch_edge+1);
+    if (comp->generateHeights((F32)origin_region[VX], (F32)origin_region[VY],
+                              patch_size, patch_size))
+    {
+        mHeightsGenerated = true;
+    }
+    return mHeightsGenerated;
+}
+
 bool LLSurfacePatch::updateTexture()
 {
     if (mSTexUpdate)        //  Update texture as needed
     {
-        F32 meters_per_grid = getSurface()->getMetersPerGrid();
-        F32 grids_per_patch_edge = (F32)getSurface()->getGridsPerPatchEdge();
-
-        if ((!getNeighborPatch(EAST) || getNeighborPatch(EAST)->getHasReceivedData())
-            && (!getNeighborPatch(WEST) || getNeighborPatch(WEST)->getHasReceivedData())
-            && (!getNeighborPatch(SOUTH) || getNeighborPatch(SOUTH)->getHasReceivedData())
-            && (!getNeighborPatch(NORTH) || getNeighborPatch(NORTH)->getHasReceivedData()))
+        if (neighborsHaveData())
         {
             LLViewerRegion *regionp = getSurface()->getRegion();
-            LLVector3d origin_region = getOriginGlobal() - getSurface()->getOriginGlobal();
-
-            // Have to figure out a better way to deal with these edge conditions...
             LLVLComposition* comp = regionp->getComposition();
-            if (!mHeightsGenerated)
+            if (!generateHeights())
             {
-                F32 patch_size = meters_per_grid*(grids_per_patch_edge+1);
-                if (comp->generateHeights((F32)origin_region[VX], (F32)origin_region[VY],
-                                          patch_size, patch_size))
-                {
-                    mHeightsGenerated = true;
-                }
-                else
-                {
-                    return false;
-                }
+                return false;
             }
 
             if (comp->generateComposition())
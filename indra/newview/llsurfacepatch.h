@@ -74,14 +74,26 @@ public:
     void colorPatch(const U8 r, const U8 g, const U8 b);
 
     bool updateTexture();
+    // Generates the composition values under this patch once its neighbors
+    // have data. Writes the values it shares with neighboring patches, so
+    // runs on worker threads with the same constraints as updateNormals().
+    bool generateHeights();
+    bool neighborsHaveData() const;
 
     void updateVerticalStats();
     void updateCompositionStats();
+    // Returns true if any normal was recalculated. Touches the heights and
+    // normals of neighboring patches, but no other state, so that patches
+    // no two of which are neighbors can be updated on separate threads.
     template<bool PBR>
-    void updateNormals();
+    bool updateNormals();
 
     void updateEastEdge();
     void updateNorthEdge();
+    // Edges are copied from the neighbors in updateEdges(), which runs on
+    // worker threads with the same constraints as updateNormals()
+    void dirtyEdges(const U8 edges);
+    void updateEdges();
 
     void updateCameraDistanceRegion( const LLVector3 &pos_region);
     void updateVisibility();
@@ -161,6 +173,7 @@ protected:
     bool mDirty;
     bool mDirtyZStats;
     bool mHeightsGenerated;
+    U8 mDirtyEdges;         // EAST_EDGE and NORTH_EDGE bits of edges to update
 
     U32 mDataOffset;
     F32 *mDataZ;
@@ -193,8 +206,8 @@ protected:
     LLSurface *mSurfacep; // Pointer to "parent" surface
 };
 
-extern template void LLSurfacePatch::updateNormals</*PBR=*/false>();
-extern template void LLSurfacePatch::updateNormals</*PBR=*/true>();
+extern template bool LLSurfacePatch::updateNormals</*PBR=*/false>();
+extern template bool LLSurfacePatch::updateNormals</*PBR=*/true>();
 
 
 #endif // LL_LLSURFACEPATCH_H
@@ -625,6 +625,12 @@ static bool handleDebugViewsChanged(const LLSD& newvalue)
     return true;
 }
 
+static bool handleFastTimerTraceEventsChanged(const LLSD& newvalue)
+{
+    LLTrace::BlockTimer::setTraceEvents(newvalue.asBoolean());
+    return true;
+}
+
 static bool handleLogFileChanged(const LLSD& newvalue)
 {
     std::string log_filename = newvalue.asString();
@@ -1131,12 +1137,21 @@ void handleAutoTuneFPSChanged(const LLSD& newValue)
 {
     const auto newval = gSavedSettings.getBOOL("AutoTuneFPS");
     LLPerfStats::tunables.userAutoTuneEnabled = newval;
+    if (!newval)
+    {
+        LLPerfStats::tunables.restoreUserSettings();
+    }
     if(newval && LLPerfStats::renderAvatarMaxART_ns == 0) // If we've enabled autotune we override "unlimited" to max
     {
         gSavedSettings.setF32("RenderAvatarMaxART", (F32)log10(LLPerfStats::ART_UNLIMITED_NANOS-1000));//triggers callback to update static var
     }
 }
 
+void handleAutoTunePredictiveChanged(const LLSD& newValue)
+{
+    LLPerfStats::tunables.userPredictiveTuning = newValue.asBoolean();
+}
+
 void handleRenderAvatarMaxARTChanged(const LLSD& newValue)
 {
     LLPerfStats::tunables.updateRenderCostLimitFromSettings();
@@ -1159,6 +1174,17 @@ void handlePerformanceStatsEnabledChanged(const LLSD& newValue)
     const auto newval = gSavedSettings.getBOOL("PerfStatsCaptureEnabled");
     LLPerfStats::StatsRecorder::setEnabled(newval);
 }
+void handlePerformanceStatsRecordToFileChanged(const LLSD& newValue)
+{
+    if (newValue.asBoolean())
+    {
+        LLPerfStats::StatsRecorder::startRecording();
+    }
+    else
+    {
+        LLPerfStats::StatsRecorder::stopRecording();
+    }
+}
 void handleUserImpostorByDistEnabledChanged(const LLSD& newValue)
 {
     bool auto_tune_newval = false;
@@ -1391,6 +1417,7 @@ void settings_setup_listeners()
     setting_setup_signal_listener(gSavedSettings, "BuildAxisDeadZone5", handleJoystickChanged);
     setting_setup_signal_listener(gSavedSettings, "DebugViews", handleDebugViewsChanged);
     setting_setup_signal_listener(gSavedSettings, "UserLogFile", handleLogFileChanged);
+    setting_setup_signal_listener(gSavedSettings, "FastTimerTraceEvents", handleFastTimerTraceEventsChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderHideGroupTitle", handleHideGroupTitleChanged);
     setting_setup_signal_listener(gSavedSettings, "HighResSnapshot", handleHighResSnapshotChanged);
     setting_setup_signal_listener(gSavedSettings, "EnableVoiceChat", handleVoiceClientPrefsChanged);
@@ -1429,8 +1456,10 @@ void settings_setup_listeners()
     setting_setup_signal_listener(gSavedSettings, "TargetFPS", handleTargetFPSChanged);
     setting_setup_signal_listener(gSavedSettings, "AutoTuneFPS", handleAutoTuneFPSChanged);
     setting_setup_signal_listener(gSavedSettings, "AutoTuneLock", handleAutoTuneLockChanged);
+    setting_setup_signal_listener(gSavedSettings, "AutoTunePredictive", handleAutoTunePredictiveChanged);
     setting_setup_signal_listener(gSavedSettings, "RenderAvatarMaxART", handleRenderAvatarMaxARTChanged);
     setting_setup_signal_listener(gSavedSettings, "PerfStatsCaptureEnabled", handlePerformanceStatsEnabledChanged);
+    setting_setup_signal_listener(gSavedSettings, "PerfStatsRecordToFile", handlePerformanceStatsRecordToFileChanged);
     setting_setup_signal_listener(gSavedSettings, "AutoTuneRenderFarClipTarget", handleUserTargetDrawDistanceChanged);
     setting_setup_signal_listener(gSavedSettings, "AutoTuneRenderFarClipMin", handleUserMinDrawDistanceChanged);
     setting_setup_signal_listener(gSavedSettings, "AutoTuneImpostorFarAwayDistance", handleUserImpostorDistanceChanged);
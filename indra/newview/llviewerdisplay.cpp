@@ -224,7 +224,8 @@ void display_update_camera()
     F32 final_far = gAgentCamera.mDrawDistance;
     if (gCubeSnapshot)
     {
-        final_far = gSavedSettings.getF32("RenderReflectionProbeDrawDistance");
+        static LLCachedControl<F32> probe_draw_distance(gSavedSettings, "RenderReflectionProbeDrawDistance");
+        final_far = probe_draw_distance;
     }
     else if (CAMERA_MODE_CUSTOMIZE_AVATAR == gAgentCamera.getCameraMode())
 
@@ -712,11 +713,11 @@ void display(bool rebuild, F32 zoom_factor, int subfield, bool for_snapshot)
             gSavedSettings.setF32("FSSavedRenderFarClip", 0.0f);
         }
 
-        if (gTeleportArrivalTimer.getElapsedTimeF32() >=
-            (F32)gSavedSettings.getU32("FSRenderFarClipSteppingInterval"))
+        static LLCachedControl<U32> stepping_interval(gSavedSettings, "FSRenderFarClipSteppingInterval");
+        if (gTeleportArrivalTimer.getElapsedTimeF32() >= (F32)stepping_interval)
         {
             gTeleportArrivalTimer.reset();
-            F32 current = gSavedSettings.getF32("RenderFarClip");
+            F32 current = renderFarClip;
             if (gSavedDrawDistance > current)
             {
                 current *= 2.0f;
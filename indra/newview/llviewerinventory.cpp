@@ -559,6 +559,11 @@ bool LLViewerInventoryItem::unpackMessage(LLMessageSystem* msg, const char* bloc
     return rv;
 }
 
+void LLViewerInventoryItem::localizeName()
+{
+    LLLocalizedInventoryItemsDictionary::getInstance()->localizeInventoryObjectName(mName);
+}
+
 void LLViewerInventoryItem::setTransactionID(const LLTransactionID& transaction_id)
 {
     mTransactionID = transaction_id;
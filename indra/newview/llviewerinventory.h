@@ -137,6 +137,7 @@ public:
     // new methods
     bool isFinished() const { return mIsComplete; }
     void setComplete(bool complete) { mIsComplete = complete; }
+    void localizeName(); // for items not built through unpackMessage() or fromLLSD()
     //void updateAssetOnServer() const;
 
     virtual void setTransactionID(const LLTransactionID& transaction_id);
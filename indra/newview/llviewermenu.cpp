@@ -10841,6 +10841,18 @@ void handle_dump_timers()
     LLTrace::BlockTimer::dumpCurTimes();
 }
 
+void handle_export_timer_events()
+{
+    if (!LLTrace::BlockTimer::getTraceEvents())
+    {
+        // start collecting, the next export has something to show
+        gSavedSettings.setBOOL("FastTimerTraceEvents", true);
+        LL_INFOS("FastTimers") << "Timer events turned on, export again to write them" << LL_ENDL;
+        return;
+    }
+    LLTrace::BlockTimer::exportTraceEvents(gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "timer_events.json"));
+}
+
 void handle_debug_avatar_textures()
 {
     LLViewerObject* objectp = LLSelectMgr::getInstance()->getSelection()->getPrimaryObject();
@@ -12617,6 +12629,7 @@ void initialize_menus()
     view_listener_t::addMenu(new LLAdvancedDumpSelectMgr(), "Advanced.DumpSelectMgr");
     view_listener_t::addMenu(new LLAdvancedDumpInventory(), "Advanced.DumpInventory");
     commit.add("Advanced.DumpTimers", boost::bind(&handle_dump_timers) );
+    commit.add("Advanced.ExportTimerEvents", boost::bind(&handle_export_timer_events) );
     commit.add("Advanced.DumpFocusHolder", boost::bind(&handle_dump_focus) );
     view_listener_t::addMenu(new LLAdvancedPrintSelectedObjectInfo(), "Advanced.PrintSelectedObjectInfo");
     view_listener_t::addMenu(new LLAdvancedPrintAgentInfo(), "Advanced.PrintAgentInfo");
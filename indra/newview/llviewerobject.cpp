@@ -125,6 +125,7 @@
 
 bool        LLViewerObject::sVelocityInterpolate = true;
 bool        LLViewerObject::sPingInterpolate = true;
+const LLViewerObject::MessageTiming* LLViewerObject::sQueuedMessageTiming = NULL;
 
 U32         LLViewerObject::sNumZombieObjects = 0;
 S32         LLViewerObject::sNumObjects = 0;
@@ -147,11 +148,6 @@ std::map<std::string, U32> LLViewerObject::sObjectDataMap;
 // The maximum size of an object extra parameters binary (packed) block
 #define MAX_OBJECT_PARAMS_SIZE 1024
 
-// At 45 Hz collisions seem stable and objects seem
-// to settle down at a reasonable rate.
-// JC 3/18/2003
-
-const F32 PHYSICS_TIMESTEP = 1.f / 45.f;
 const U32 MAX_INV_FILE_READ_FAILS = 25;
 const S32 MAX_OBJECT_BINARY_DATA_SIZE = 60 + 16;
 
@@ -1291,6 +1287,10 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
         time_dilation = ((F32) time_dilation16) / 65535.f;
         mRegionp->setTimeDilation(time_dilation);
     }
+    else if (sQueuedMessageTiming)
+    {
+        time_dilation = sQueuedMessageTiming->mTimeDilation;
+    }
 
     // this will be used to determine if we've really changed position
     // Use getPosition, not getPositionRegion, since this is what we're comparing directly against.
@@ -2318,6 +2318,14 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
             LL_WARNS() << "findCircuit() returned NULL; skipping interpolation" << LL_ENDL;
         }
     }
+    else if (sPingInterpolate && sQueuedMessageTiming)
+    {
+        // As above, and the object kept moving while the update was queued
+        F32 queued = (F32)(LLFrameTimer::getElapsedSeconds() - sQueuedMessageTiming->mReceived).value();
+        F32 ping_delay = 0.5f * time_dilation * (sQueuedMessageTiming->mPingDelay + gFrameDTClamped) + time_dilation * queued;
+        LLVector3 diff = getVelocity() * ping_delay;
+        new_pos_parent += diff;
+    }
 
     //////////////////////////
     //
@@ -2538,26 +2546,52 @@ void LLViewerObject::loadFlags(U32 flags)
 }
 
 void LLViewerObject::idleUpdate(LLAgent &agent, const F64 &frame_time)
+{
+    IdleMotion motion;
+    predictIdleMotion(frame_time, motion);
+    applyIdleMotion(frame_time, motion);
+}
+
+void LLViewerObject::predictIdleMotion(const F64 &frame_time, IdleMotion& motion) const
+{
+    motion.mInterpolate = !mDead && !mStatic && sVelocityInterpolate && !isSelected();
+    motion.mRotate = false;
+    if (motion.mInterpolate)
+    {
+        // calculate dt from last update
+        F32 time_dilation = mRegionp ? mRegionp->getTimeDilation() : 1.0f;
+        F32 dt_raw = (F32)((F64Seconds)frame_time - mLastInterpUpdateSecs).value();
+        motion.mDt = time_dilation * dt_raw;
+        motion.mRotate = getAngularVelocityRot(getAngularVelocity(), motion.mDt, motion.mDeltaRot);
+        motion.mPredictedLinear = false;
+    }
+}
+
+void LLViewerObject::applyIdleMotion(const F64 &frame_time, const IdleMotion& motion)
 {
     if (!mDead)
     {
-        if (!mStatic && sVelocityInterpolate && !isSelected())
+        if (motion.mInterpolate)
         {
-            // calculate dt from last update
-            F32 time_dilation = mRegionp ? mRegionp->getTimeDilation() : 1.0f;
-            F32 dt_raw = (F32)((F64Seconds)frame_time - mLastInterpUpdateSecs).value();
-            F32 dt = time_dilation * dt_raw;
-
-            applyAngularVelocity(dt);
+            //do target omega here
+            mRotTime += motion.mDt;
+            if (motion.mRotate)
+            {
+                applyAngularVelocityRot(motion.mDeltaRot);
+            }
 
             if (isAttachment())
             {
                 mLastInterpUpdateSecs = (F64Seconds)frame_time;
                 return;
             }
-            else
+            else if (motion.mPredictedLinear)
             {   // Move object based on it's velocity and rotation
-                interpolateLinearMotion(frame_time, dt);
+                interpolateLinearMotion(frame_time, motion.mDt, motion.mDeltaPos, motion.mDeltaVel);
+            }
+            else
+            {
+                interpolateLinearMotion(frame_time, motion.mDt);
             }
         }
 
@@ -2566,14 +2600,19 @@ void LLViewerObject::idleUpdate(LLAgent &agent, const F64 &frame_time)
 }
 
 
-// Move an object due to idle-time viewer side updates by interpolating motion
 void LLViewerObject::interpolateLinearMotion(const F64SecondsImplicit& frame_time, const F32SecondsImplicit& dt_seconds)
+{
+    LLVector3 delta_pos;
+    LLVector3 delta_vel;
+    predictLinearMotion(getVelocity(), getAcceleration(), dt_seconds, delta_pos, delta_vel);
+    interpolateLinearMotion(frame_time, dt_seconds, delta_pos, delta_vel);
+}
+
+// Move an object due to idle-time viewer side updates by interpolating motion
+void LLViewerObject::interpolateLinearMotion(const F64SecondsImplicit& frame_time, const F32SecondsImplicit& dt_seconds,
+                                             const LLVector3& delta_pos, const LLVector3& delta_vel)
 {
     // linear motion
-    // PHYSICS_TIMESTEP is used below to correct for the fact that the velocity in object
-    // updates represents the average velocity of the last timestep, rather than the final velocity.
-    // the time dilation above should guarantee that dt is never less than PHYSICS_TIMESTEP, theoretically
-    //
     // *TODO: should also wrap linear accel/velocity in check
     // to see if object is selected, instead of explicitly
     // zeroing it out
@@ -2592,11 +2631,9 @@ void LLViewerObject::interpolateLinearMotion(const F64SecondsImplicit& frame_tim
     {   // Old code path ... unbounded, simple interpolation
         if (!(accel.isExactlyZero() && vel.isExactlyZero()))
         {
-            LLVector3 pos   = (vel + (0.5f * (dt-PHYSICS_TIMESTEP)) * accel) * dt;
-
             // region local
-            setPositionRegion(pos + getPositionRegion());
-            setVelocity(vel + accel*dt);
+            setPositionRegion(delta_pos + getPositionRegion());
+            setVelocity(vel + delta_vel);
 
             // for objects that are spinning but not translating, make sure to flag them as having moved
             setChanged(MOVED | SILHOUETTE);
@@ -2605,9 +2642,9 @@ void LLViewerObject::interpolateLinearMotion(const F64SecondsImplicit& frame_tim
     else if (!accel.isExactlyZero() || !vel.isExactlyZero())        // object is moving
     {   // Object is moving, and hasn't been too long since we got an update from the server
 
-        // Calculate predicted position and velocity
-        LLVector3 new_pos = (vel + (0.5f * (dt-PHYSICS_TIMESTEP)) * accel) * dt;
-        LLVector3 new_v = accel * dt;
+        // Predicted position and velocity
+        LLVector3 new_pos = delta_pos;
+        LLVector3 new_v = delta_vel;
 
         if (time_since_last_update > sPhaseOutUpdateInterpolationTime &&
             sPhaseOutUpdateInterpolationTime > (F64Seconds)0.0)
@@ -7161,27 +7198,21 @@ void LLViewerObject::applyAngularVelocity(F32 dt)
 {
     //do target omega here
     mRotTime += dt;
-    LLVector3 ang_vel = getAngularVelocity();
-    F32 omega = ang_vel.magVecSquared();
-    F32 angle = 0.0f;
     LLQuaternion dQ;
-    if (omega > 0.00001f)
+    if (getAngularVelocityRot(getAngularVelocity(), dt, dQ))
     {
-        omega = sqrt(omega);
-        angle = omega * dt;
-
-        ang_vel *= 1.f/omega;
-
-        // calculate the delta increment based on the object's angular velocity
-        dQ.setQuat(angle, ang_vel);
+        applyAngularVelocityRot(dQ);
+    }
+}
 
-        // accumulate the angular velocity rotations to re-apply in the case of an object update
-        mAngularVelocityRot *= dQ;
+void LLViewerObject::applyAngularVelocityRot(const LLQuaternion& dQ)
+{
+    // accumulate the angular velocity rotations to re-apply in the case of an object update
+    mAngularVelocityRot *= dQ;
 
-        // Just apply the delta increment to the current rotation
-        setRotation(getRotation()*dQ);
-        setChanged(MOVED | SILHOUETTE);
-    }
+    // Just apply the delta increment to the current rotation
+    setRotation(getRotation()*dQ);
+    setChanged(MOVED | SILHOUETTE);
 }
 
 void LLViewerObject::resetRotTime()
@@ -84,6 +84,12 @@ class LLWorld;
 
 class LLMeshCostData;
 
+// At 45 Hz collisions seem stable and objects seem
+// to settle down at a reasonable rate.
+// JC 3/18/2003
+
+const F32 PHYSICS_TIMESTEP = 1.f / 45.f;
+
 typedef enum e_object_update_type
 {
     OUT_FULL,
@@ -163,6 +169,34 @@ public:
     // Object create and update functions
     virtual void    idleUpdate(LLAgent &agent, const F64 &time);
 
+    // The stock idleUpdate() in two steps. Predicting the motion only reads
+    // the object and may run on any thread, applying it is main thread only.
+    struct IdleMotion
+    {
+        F32             mDt = 0.f;
+        LLQuaternion    mDeltaRot;
+        LLVector3       mDeltaPos;          // from predictLinearMotion() when mPredictedLinear
+        LLVector3       mDeltaVel;
+        bool            mInterpolate = false;
+        bool            mRotate = false;
+        bool            mPredictedLinear = false;
+    };
+    // True if idleUpdate() is just predictIdleMotion() and applyIdleMotion()
+    virtual bool    hasPredictableIdleUpdate() const    { return false; }
+    void            predictIdleMotion(const F64 &frame_time, IdleMotion& motion) const;
+    void            applyIdleMotion(const F64 &frame_time, const IdleMotion& motion);
+
+    // Timing of an update message applied after the message is gone, see
+    // LLViewerObjectList::processPendingObjectUpdates(). processUpdateMessage()
+    // uses sQueuedMessageTiming in place of the message when it is set.
+    struct MessageTiming
+    {
+        F32             mTimeDilation = 1.f;
+        F32             mPingDelay = 0.f;   // seconds, of the circuit when the message came in
+        F64Seconds      mReceived;          // LLFrameTimer::getElapsedSeconds() then
+    };
+    static const MessageTiming* sQueuedMessageTiming;
+
     // Types of media we can associate
     enum { MEDIA_NONE = 0, MEDIA_SET = 1 };
 
@@ -243,6 +277,12 @@ private:
 public:
     void                resetRot();
     void                applyAngularVelocity(F32 dt);
+    // Rotation over dt at angular velocity ang_vel, false if negligible
+    static bool         getAngularVelocityRot(LLVector3 ang_vel, F32 dt, LLQuaternion& dQ);
+    // Change of position and velocity over dt, before any clamping
+    static void         predictLinearMotion(const LLVector3& vel, const LLVector3& accel, F32 dt,
+                                            LLVector3& delta_pos, LLVector3& delta_vel);
+    void                applyAngularVelocityRot(const LLQuaternion& dQ);
 
     void setLineWidthForWindowSize(S32 window_width);
 
@@ -658,6 +698,7 @@ public:
     void shrinkWrap();
 
     friend class LLViewerObjectList;
+    friend class LLObjectKinematics;
     friend class LLViewerMediaList;
 
 public:
@@ -696,6 +737,8 @@ private:
 
     // Motion prediction between updates
     void interpolateLinearMotion(const F64SecondsImplicit & frame_time, const F32SecondsImplicit & dt);
+    void interpolateLinearMotion(const F64SecondsImplicit & frame_time, const F32SecondsImplicit & dt,
+                                 const LLVector3& delta_pos, const LLVector3& delta_vel);
 
     static void initObjectDataMap();
 
@@ -1029,6 +1072,35 @@ inline void LLViewerObject::setRotation(const F32 x, const F32 y, const F32 z, b
     updateDrawable(damped);
 }
 
+// static
+inline bool LLViewerObject::getAngularVelocityRot(LLVector3 ang_vel, F32 dt, LLQuaternion& dQ)
+{
+    F32 omega = ang_vel.magVecSquared();
+    if (omega > 0.00001f)
+    {
+        omega = sqrt(omega);
+        F32 angle = omega * dt;
+
+        ang_vel *= 1.f/omega;
+
+        // calculate the delta increment based on the object's angular velocity
+        dQ.setQuat(angle, ang_vel);
+        return true;
+    }
+    return false;
+}
+
+// static
+inline void LLViewerObject::predictLinearMotion(const LLVector3& vel, const LLVector3& accel, F32 dt,
+                                                LLVector3& delta_pos, LLVector3& delta_vel)
+{
+    // PHYSICS_TIMESTEP is used below to correct for the fact that the velocity in object
+    // updates represents the average velocity of the last timestep, rather than the final velocity.
+    // the time dilation in idleUpdate() should guarantee that dt is never less than PHYSICS_TIMESTEP, theoretically
+    delta_pos = (vel + (0.5f * (dt-PHYSICS_TIMESTEP)) * accel) * dt;
+    delta_vel = accel * dt;
+}
+
 class LLViewerObjectMedia
 {
 public:
@@ -79,6 +79,7 @@
 #include "llfloaterperms.h"
 #include "llvocache.h"
 #include "llcorehttputil.h"
+#include "parallelfor.h"
 #include "llstartup.h"
 
 #include <algorithm>
@@ -131,6 +132,7 @@ void LLViewerObjectList::destroy()
 
     resetObjectBeacons();
     mActiveObjects.clear();
+    mKinematics.clear();
     mDeadObjects.clear();
     mMapObjects.clear();
     mUUIDObjectMap.clear();
@@ -270,6 +272,10 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
     }
 
     updateActive(objectp);
+    if (objectp->onActiveList())
+    {
+        mKinematics.sync(objectp->getListIndex(), objectp);
+    }
 
     if (just_created)
     {
@@ -512,10 +518,13 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
     LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
     LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
 
+    static LLCachedControl<F32> object_update_batch_time(gSavedSettings, "ObjectUpdateBatchTime", 2.f);
+
     for (i = 0; i < num_objects; i++)
     {
         bool justCreated = false;
         bool update_cache = false; //update object cache if it is a full-update or terse update
+        U32 flags = 0;
 
         if (compressed)
         {
@@ -528,7 +537,6 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 
             if (update_type != OUT_TERSE_IMPROVED) // OUT_FULL_COMPRESSED only?
             {
-                U32 flags = 0;
                 mesgsys->getU32Fast(_PREHASH_ObjectData, _PREHASH_UpdateFlags, flags, i);
 
                 compressed_dp.unpackUUID(fullid, "ID");
@@ -690,6 +698,15 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
             }
             // </FS:Ansariel>
 
+            // A compressed full update has everything needed to create the
+            // object later, when processPendingObjectUpdates() gets to it.
+            if (compressed && object_update_batch_time > 0.f && pcode != LL_PCODE_LEGACY_AVATAR)
+            {
+                queuePendingObjectUpdate(regionp, fullid, local_id, pcode, flags,
+                                         compressed_dpbuffer, compressed_dp.getBufferSize());
+                continue;
+            }
+
             objectp = createObject(pcode, regionp, fullid, local_id, gMessageSystem->getSender());
 
             LL_DEBUGS("ObjectUpdate") << "creating object " << fullid << " result " << objectp << LL_ENDL;
@@ -760,6 +777,211 @@ void LLViewerObjectList::processCompressedObjectUpdate(LLMessageSystem *mesgsys,
     processObjectUpdate(mesgsys, user_data, update_type, true);
 }
 
+void LLViewerObjectList::queuePendingObjectUpdate(LLViewerRegion* regionp, const LLUUID& id, U32 local_id, LLPCode pcode, U32 flags,
+                                                  const U8* data, S32 size)
+{
+    PendingObjectUpdate& update = mPendingObjectUpdates[id];
+    update.mRegionHandle = regionp->getHandle();
+    update.mLocalID = local_id;
+    update.mPCode = pcode;
+    update.mFlags = flags;
+    update.mData.assign(data, data + size);
+
+    // Peek at the placement for the priority, the layout is the one
+    // LLViewerObject::processUpdateMessage() unpacks
+    LLDataPackerBinaryBuffer dp(update.mData.data(), size);
+    LLUUID uuid;
+    U32 value = 0;
+    U8 byte = 0;
+    LLVector3 scale;
+    LLVector3 vec;
+    dp.unpackUUID(uuid, "ID");
+    dp.unpackU32(value, "LocalID");
+    dp.unpackU8(byte, "PCode");
+    dp.unpackU8(byte, "State");
+    dp.unpackU32(value, "CRC");
+    dp.unpackU8(byte, "Material");
+    dp.unpackU8(byte, "ClickAction");
+    dp.unpackVector3(scale, "Scale");
+    dp.unpackVector3(update.mPosition, "Pos");
+    dp.unpackVector3(vec, "Rot");
+    dp.unpackU32(value, "SpecialCode");
+    dp.setPassFlags(value);
+    dp.unpackUUID(uuid, "Owner");
+    if (value & 0x80)
+    {
+        dp.unpackVector3(vec, "Omega");
+    }
+    update.mParentID = 0;
+    if (value & 0x20)
+    {
+        dp.unpackU32(update.mParentID, "ParentID");
+    }
+    update.mRadius = scale.magVec() * 0.5f;
+
+    // What processUpdateMessage() would have read from the message
+    U16 time_dilation16 = 0;
+    gMessageSystem->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+    update.mTiming.mTimeDilation = ((F32)time_dilation16) / 65535.f;
+    LLCircuitData* cdp = gMessageSystem->mCircuitInfo.findCircuit(gMessageSystem->getSender());
+    update.mTiming.mPingDelay = cdp ? (F32)cdp->getPingDelay().value() * 0.001f : 0.f;
+    update.mTiming.mReceived = LLFrameTimer::getElapsedSeconds();
+
+    // Kills and terse updates find the object by its local id
+    setUUIDAndLocal(id,
+                    local_id,
+                    gMessageSystem->getSenderIP(),
+                    gMessageSystem->getSenderPort());
+}
+
+F32 LLViewerObjectList::getPendingObjectPriority(const PendingObjectUpdate& update, const LLVector3& camera_agent, bool follow_parent)
+{
+    LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(update.mRegionHandle);
+    if (!regionp)
+    {
+        return 0.f;
+    }
+
+    LLVector3 pos_agent = regionp->getPosAgentFromRegion(update.mPosition);
+    if (update.mParentID)
+    {
+        LLUUID parent_id;
+        getUUIDFromLocal(parent_id, update.mParentID, regionp->getHost().getAddress(), regionp->getHost().getPort());
+
+        // Children come right after a parent that is still queued
+        std::unordered_map<LLUUID, PendingObjectUpdate>::const_iterator parent_iter = mPendingObjectUpdates.find(parent_id);
+        if (follow_parent && parent_iter != mPendingObjectUpdates.end())
+        {
+            return getPendingObjectPriority(parent_iter->second, camera_agent, false) * 0.999f;
+        }
+
+        // Not findObject(), that would create the parent while the queue is
+        // being walked
+        std::map<LLUUID, LLPointer<LLViewerObject> >::const_iterator object_iter = mUUIDObjectMap.find(parent_id);
+        if (object_iter != mUUIDObjectMap.end())
+        {
+            const LLViewerObject* parentp = object_iter->second;
+            pos_agent = parentp->getPositionAgent() + update.mPosition * parentp->getRotation();
+        }
+    }
+
+    // Roughly the apparent size, as for the object cache
+    return update.mRadius / llmax((pos_agent - camera_agent).magVec(), 1.f);
+}
+
+void LLViewerObjectList::flushPendingObjectUpdate(const LLUUID& id)
+{
+    if (mPendingObjectUpdates.empty())
+    {
+        return;
+    }
+
+    std::unordered_map<LLUUID, PendingObjectUpdate>::iterator iter = mPendingObjectUpdates.find(id);
+    if (iter == mPendingObjectUpdates.end())
+    {
+        return;
+    }
+
+    PendingObjectUpdate update = std::move(iter->second);
+    mPendingObjectUpdates.erase(iter);
+
+    LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(update.mRegionHandle);
+    if (!regionp || mDerendered.end() != mDerendered.find(id))
+    {
+        return;
+    }
+
+    LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
+
+    bool just_created = false;
+    LLViewerObject* objectp = findObject(id);
+    if (!objectp)
+    {
+        objectp = createObjectFromCache(update.mPCode, regionp, id, update.mLocalID);
+        if (!objectp)
+        {
+            LL_INFOS() << "createObject failure for object: " << id << LL_ENDL;
+            recorder.objectUpdateFailure();
+            return;
+        }
+        regionp->addToCreatedList(update.mLocalID);
+        just_created = true;
+        mNumNewObjects++;
+    }
+
+    LLDataPackerBinaryBuffer dp(update.mData.data(), (S32)update.mData.size());
+    LLUUID fullid;
+    U32 local_id;
+    LLPCode pcode;
+    dp.unpackUUID(fullid, "ID");
+    dp.unpackU32(local_id, "LocalID");
+    dp.unpackU8(pcode, "PCode");
+
+    objectp->mLocalID = update.mLocalID;
+    // The message is gone, so load the flags processUpdateMessage() would
+    // have, before processUpdateCore() checks mCreateSelected
+    objectp->loadFlags(update.mFlags);
+    LLViewerObject::sQueuedMessageTiming = &update.mTiming;
+    processUpdateCore(objectp, NULL, 0, OUT_FULL_COMPRESSED, &dp, just_created, true);
+    LLViewerObject::sQueuedMessageTiming = NULL;
+
+    recorder.objectUpdateEvent(OUT_FULL_COMPRESSED);
+    objectp->setLastUpdateType(OUT_FULL_COMPRESSED);
+}
+
+void LLViewerObjectList::processPendingObjectUpdates(F32 max_time)
+{
+    if (mPendingObjectUpdates.empty())
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+
+    LLTimer update_timer;
+
+    // Biggest on screen first
+    const LLVector3 camera_agent = LLViewerCamera::getInstance()->getOrigin();
+    std::vector<std::pair<F32, LLUUID> > order;
+    order.reserve(mPendingObjectUpdates.size());
+    for (const auto& [id, update] : mPendingObjectUpdates)
+    {
+        order.emplace_back(getPendingObjectPriority(update, camera_agent, true), id);
+    }
+    std::sort(order.begin(), order.end(),
+              [](const std::pair<F32, LLUUID>& lhs, const std::pair<F32, LLUUID>& rhs)
+              {
+                  return lhs.first > rhs.first;
+              });
+
+    for (const std::pair<F32, LLUUID>& entry : order)
+    {
+        flushPendingObjectUpdate(entry.second);
+        if (update_timer.getElapsedTimeF32() > max_time)
+        {
+            break;
+        }
+    }
+
+    LLVOAvatar::cullAvatarsByPixelArea();
+}
+
+void LLViewerObjectList::clearPendingObjectUpdates(const LLViewerRegion* regionp)
+{
+    for (std::unordered_map<LLUUID, PendingObjectUpdate>::iterator iter = mPendingObjectUpdates.begin();
+         iter != mPendingObjectUpdates.end(); )
+    {
+        if (!regionp || iter->second.mRegionHandle == regionp->getHandle())
+        {
+            iter = mPendingObjectUpdates.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
 void LLViewerObjectList::processCachedObjectUpdate(LLMessageSystem *mesgsys,
                                              void **user_data,
                                              const EObjectUpdateType update_type)
@@ -919,6 +1141,9 @@ void LLViewerObjectList::updateApparentAngles(LLAgent &agent)
     LLVOAvatar::cullAvatarsByPixelArea();
 }
 
+// Blocks of four active objects per job when predicting their idle motion
+constexpr size_t IDLE_PREDICT_GRAIN = 16;
+
 void LLViewerObjectList::update(LLAgent &agent)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
@@ -984,6 +1209,9 @@ void LLViewerObjectList::update(LLAgent &agent)
     //clear avatar LOD change counter
     LLVOAvatar::sNumLODChangesThisFrame = 0;
 
+    static LLCachedControl<F32> object_update_batch_time(gSavedSettings, "ObjectUpdateBatchTime", 2.f);
+    processPendingObjectUpdates(llmax((F32)object_update_batch_time, 0.f) * 0.001f);
+
     const F64 frame_time = LLFrameTimer::getElapsedSeconds();
 
     LLViewerObject *objectp = NULL;
@@ -1025,6 +1253,10 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
 
+    U32 predicted_count = 0;
+    U32 repredicted_count = 0;
+    U32 serial_count = 0;
+
     // <FS:Ansariel> Speed up debug settings
     //if (gSavedSettings.getBOOL("FreezeTime"))
     if (freezeTime)
@@ -1038,17 +1270,54 @@ void LLViewerObjectList::update(LLAgent &agent)
             if (objectp->isAvatar())
             {
                 objectp->idleUpdate(agent, frame_time);
+                ++serial_count;
             }
         }
     }
     else
     {
-        for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
-            idle_iter != idle_end; idle_iter++)
+        // The worker threads only predict from the kinematics store: the
+        // interpolation time, the rotation and the linear step of every
+        // active object. Everything else, moving the object by that step
+        // with its circuit and region crossing checks included, runs here in
+        // list order. An earlier update in this loop can change a later
+        // object, so a prediction is only used while the velocity,
+        // acceleration, angular velocity, region and last interpolation time
+        // it was made from still match the object. Otherwise the object is
+        // predicted again from its current state, as a serial update would.
+        LL::parallel_for("General", mKinematics.getNumBlocks(), IDLE_PREDICT_GRAIN,
+            [&](size_t begin, size_t end)
+            {
+                mKinematics.predict(frame_time, (S32)begin, (S32)end);
+            });
+
+        for (U32 i = 0; i < idle_count; ++i)
         {
-            objectp = *idle_iter;
+            objectp = idle_list[i];
             llassert(objectp->isActive());
+            if (objectp->hasPredictableIdleUpdate())
+            {
+                LLViewerObject::IdleMotion motion;
+                if (mKinematics.getIdleMotion(objectp->getListIndex(), objectp, motion))
+                {
+                    ++predicted_count;
+                }
+                else
+                {
+                    objectp->predictIdleMotion(frame_time, motion);
+                    ++repredicted_count;
+                }
+                objectp->applyIdleMotion(frame_time, motion);
+                if (objectp->onActiveList())
+                {
+                    mKinematics.sync(objectp->getListIndex(), objectp);
+                }
+            }
+            else
+            {
                 objectp->idleUpdate(agent, frame_time);
+                ++serial_count;
+            }
         }
 
         //update flexible objects
@@ -1127,6 +1396,9 @@ void LLViewerObjectList::update(LLAgent &agent)
 
     sample(LLStatViewer::NUM_OBJECTS, mObjects.size());
     sample(LLStatViewer::NUM_ACTIVE_OBJECTS, idle_count);
+    sample(LLStatViewer::NUM_IDLE_PREDICTED_OBJECTS, predicted_count);
+    sample(LLStatViewer::NUM_IDLE_REPREDICTED_OBJECTS, repredicted_count);
+    sample(LLStatViewer::NUM_IDLE_SERIAL_OBJECTS, serial_count);
 }
 
 void LLViewerObjectList::fetchObjectCosts()
@@ -1564,6 +1836,8 @@ void LLViewerObjectList::killObjects(LLViewerRegion *regionp)
     LL_PROFILE_ZONE_SCOPED;
     LLViewerObject *objectp;
 
+    // First, so that no lookup during the kills creates one of them
+    clearPendingObjectUpdates(regionp);
 
     for (vobj_list_t::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
     {
@@ -1577,6 +1851,7 @@ void LLViewerObjectList::killObjects(LLViewerRegion *regionp)
 
     // Have to clean right away because the region is becoming invalid.
     cleanDeadObjects(false);
+    mKinematics.forgetRegion(regionp);
 }
 
 void LLViewerObjectList::killAllObjects()
@@ -1584,6 +1859,8 @@ void LLViewerObjectList::killAllObjects()
     // Used only on global destruction.
     LLViewerObject *objectp;
 
+    clearPendingObjectUpdates(NULL);
+
     for (vobj_list_t::iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
     {
         objectp = *iter;
@@ -1604,6 +1881,7 @@ void LLViewerObjectList::killAllObjects()
     {
         LL_WARNS() << "Some objects still on active object list!" << LL_ENDL;
         mActiveObjects.clear();
+        mKinematics.clear();
     }
 
     if (!mMapObjects.empty())
@@ -1722,6 +2000,7 @@ void LLViewerObjectList::removeFromActiveList(LLViewerObject* objectp)
         }
 
         mActiveObjects.pop_back();
+        mKinematics.remove(idx);
     }
 }
 
@@ -1745,6 +2024,7 @@ void LLViewerObjectList::updateActive(LLViewerObject *objectp)
             {
                 mActiveObjects.push_back(objectp);
                 objectp->setListIndex(static_cast<S32>(mActiveObjects.size()) - 1);
+                mKinematics.push(objectp);
             objectp->setOnActiveList(true);
             }
             else
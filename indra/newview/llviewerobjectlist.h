@@ -29,12 +29,14 @@
 
 #include <map>
 #include <set>
+#include <unordered_map>
 
 // common includes
 #include "llstring.h"
 #include "lltrace.h"
 
 // project includes
+#include "llobjectkinematics.h"
 #include "llviewerobject.h"
 #include "lleventcoro.h"
 #include "llcoros.h"
@@ -66,6 +68,8 @@ public:
     // an internal dynamic array.
     inline LLViewerObject *getObject(const S32 index);
 
+    // Creates the object first if its full update is still queued, so an
+    // object waiting in processPendingObjectUpdates() is never missing.
     inline LLViewerObject *findObject(const LLUUID &id);
     LLViewerObject *createObjectViewer(const LLPCode pcode, LLViewerRegion *regionp, S32 flags = 0); // Create a viewer-side object
     LLViewerObject *createObjectFromCache(const LLPCode pcode, LLViewerRegion *regionp, const LLUUID &uuid, const U32 local_id);
@@ -89,6 +93,12 @@ public:
     void processObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type, bool compressed=false);
     void processCompressedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
     void processCachedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
+    // Creates objects queued by compressed full updates, most important
+    // first, until max_time seconds have passed.
+    void processPendingObjectUpdates(F32 max_time);
+    // Creates id right away if it is still queued, so that a message about it
+    // applies after its full update. findObject() calls this.
+    void flushPendingObjectUpdate(const LLUUID& id);
     void updateApparentAngles(LLAgent &agent);
     void update(LLAgent &agent);
 
@@ -210,6 +220,7 @@ protected:
 
     vobj_list_t mObjects;
     std::vector<LLPointer<LLViewerObject> > mActiveObjects;
+    LLObjectKinematics mKinematics;         // same order as mActiveObjects
 
     vobj_list_t mMapObjects;
 
@@ -220,6 +231,21 @@ protected:
 
     std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
 
+    // Compressed full update of an object that does not exist yet
+    struct PendingObjectUpdate
+    {
+        U64             mRegionHandle = 0;
+        U32             mLocalID = 0;
+        U32             mParentID = 0;
+        U32             mFlags = 0;
+        LLPCode         mPCode = 0;
+        LLVector3       mPosition;      // relative to the parent if there is one
+        F32             mRadius = 0.f;
+        LLViewerObject::MessageTiming mTiming;
+        std::vector<U8> mData;
+    };
+    std::unordered_map<LLUUID, PendingObjectUpdate> mPendingObjectUpdates;
+
     //set of objects that need to update their cost
     uuid_set_t   mStaleObjectCost;
     uuid_set_t   mPendingObjectCost;
@@ -240,6 +266,11 @@ protected:
     friend class LLViewerObject;
 
 private:
+    void queuePendingObjectUpdate(LLViewerRegion* regionp, const LLUUID& id, U32 local_id, LLPCode pcode, U32 flags,
+                                  const U8* data, S32 size);
+    F32 getPendingObjectPriority(const PendingObjectUpdate& update, const LLVector3& camera_agent, bool follow_parent);
+    void clearPendingObjectUpdates(const LLViewerRegion* regionp);
+
     static void reportObjectCostFailure(LLSD &objectList);
     // <FS:Ansariel> FIRE-5496: Missing LI for objects outside agent's region
     //void fetchObjectCostsCoro(std::string url);
@@ -297,6 +328,16 @@ inline LLViewerObject *LLViewerObjectList::findObject(const LLUUID &id)
         return iter->second;
     }
 
+    if (!mPendingObjectUpdates.empty())
+    {
+        flushPendingObjectUpdate(id);
+        iter = mUUIDObjectMap.find(id);
+        if (iter != mUUIDObjectMap.end())
+        {
+            return iter->second;
+        }
+    }
+
     return NULL;
 }
 
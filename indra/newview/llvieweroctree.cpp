@@ -1106,7 +1106,7 @@ U32 LLOcclusionCullingGroup::getLastOcclusionIssuedTime()
 
 void LLOcclusionCullingGroup::checkOcclusion()
 {
-    if (LLPipeline::sUseOcclusion < 2) return;  // 0 - NoOcclusion, 1 = ReadOnly, 2 = ModifyOcclusionState  TODO: DJH 11-2021 ENUM this
+    if (get_occlusion_mode() < 2) return;  // 0 - NoOcclusion, 1 = ReadOnly, 2 = ModifyOcclusionState  TODO: DJH 11-2021 ENUM this
 
     LL_PROFILE_ZONE_SCOPED_CATEGORY_OCTREE;
     LLOcclusionCullingGroup* parent = (LLOcclusionCullingGroup*)getParent();
@@ -1172,7 +1172,7 @@ void LLOcclusionCullingGroup::checkOcclusion()
 void LLOcclusionCullingGroup::doOcclusion(LLCamera* camera, const LLVector4a* shift)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_OCTREE;
-    if (mSpatialPartition->isOcclusionEnabled() && LLPipeline::sUseOcclusion > 1)
+    if (mSpatialPartition->isOcclusionEnabled() && get_occlusion_mode() > 1)
     {
         //move mBounds to the agent space if necessary
         LLVector4a bounds[2];
@@ -1254,12 +1254,12 @@ void LLOcclusionCullingGroup::doOcclusion(LLCamera* camera, const LLVector4a* sh
                             LLGLSquashToFarClip squash;
                             if (camera->getOrigin().isExactlyZero())
                             { //origin is invalid, draw entire box
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, 0);
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, b111*8);
+                                draw_occlusion_box(0);
+                                draw_occlusion_box(b111*8);
                             }
                             else
                             {
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, get_box_fan_indices(camera, bounds[0]));
+                                draw_occlusion_box(get_box_fan_indices(camera, bounds[0]));
                             }
                         }
                         else
@@ -1267,12 +1267,12 @@ void LLOcclusionCullingGroup::doOcclusion(LLCamera* camera, const LLVector4a* sh
                             LL_PROFILE_ZONE_NAMED_CATEGORY_OCTREE("doOcclusion - draw");
                             if (camera->getOrigin().isExactlyZero())
                             { //origin is invalid, draw entire box
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, 0);
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, b111*8);
+                                draw_occlusion_box(0);
+                                draw_occlusion_box(b111*8);
                             }
                             else
                             {
-                                gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, get_box_fan_indices(camera, bounds[0]));
+                                draw_occlusion_box(get_box_fan_indices(camera, bounds[0]));
                             }
                         }
 
@@ -1326,7 +1326,7 @@ void LLViewerOctreePartition::cleanup()
 
 bool LLViewerOctreePartition::isOcclusionEnabled()
 {
-    return mOcclusionEnabled || LLPipeline::sUseOcclusion > 2;
+    return mOcclusionEnabled || get_occlusion_mode() > 2;
 }
 
 
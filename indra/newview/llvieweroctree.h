@@ -69,6 +69,11 @@ S32 AABBSphereIntersectR2(const LLVector4a& min, const LLVector4a& max, const LL
 S32 AABBSphereIntersect(const LLVector3& min, const LLVector3& max, const LLVector3 &origin, const F32 &rad);
 S32 AABBSphereIntersectR2(const LLVector3& min, const LLVector3& max, const LLVector3 &origin, const F32 &radius_squared);
 
+// Occlusion culling reaches the render pipeline only through these, defined
+// in pipeline.cpp, so that the octree can be linked without LLPipeline.
+S32 get_occlusion_mode();                       // LLPipeline::sUseOcclusion
+void draw_occlusion_box(U32 index_offset);      // fan of the pipeline's unit cube
+
 //defines data needed for octree of an entry
 //LL_ALIGN_PREFIX(16)
 class LLViewerOctreeEntry : public LLRefCount
@@ -191,6 +191,9 @@ LLTrace::SampleStatHandle<> FPS_SAMPLE("fpssample"),
                             NUM_MATERIALS("nummaterials"),
                             NUM_OBJECTS("numobjectsstat"),
                             NUM_ACTIVE_OBJECTS("numactiveobjectsstat"),
+                            NUM_IDLE_PREDICTED_OBJECTS("numidlepredictedobjectsstat", "Active objects updated by the parallel motion prediction"),
+                            NUM_IDLE_REPREDICTED_OBJECTS("numidlerepredictedobjectsstat", "Active objects whose parallel motion prediction was stale and redone serially"),
+                            NUM_IDLE_SERIAL_OBJECTS("numidleserialobjectsstat", "Active objects updated by their own idle update"),
                             ENABLE_VBO("enablevbo", "Vertex Buffers Enabled"),
                             VISIBLE_AVATARS("visibleavatars", "Visible Avatars"),
                             SHADER_OBJECTS("shaderobjects", "Object Shaders"),
@@ -182,6 +182,9 @@ extern LLTrace::SampleStatHandle<>      FPS_SAMPLE,
                                         NUM_OBJECTS,
                                         NUM_MATERIALS,
                                         NUM_ACTIVE_OBJECTS,
+                                        NUM_IDLE_PREDICTED_OBJECTS,
+                                        NUM_IDLE_REPREDICTED_OBJECTS,
+                                        NUM_IDLE_SERIAL_OBJECTS,
                                         ENABLE_VBO,
                                         LIGHTING_DETAIL,
                                         VISIBLE_AVATARS,
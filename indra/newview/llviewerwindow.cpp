@@ -2043,6 +2043,8 @@ LLViewerWindow::LLViewerWindow(const Params& p)
     }
 
     LLFontManager::initClass();
+    LLFontFreetype::setGlyphCacheDir(gSavedSettings.getBOOL("FontGlyphCache") ? gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "fonts") : LLStringUtil::null);
+    LLFontFreetype::setPrefetchRanges(gSavedSettings.getString("FontGlyphPrefetchRanges"));
 
     // fonts use an GL_UNSIGNED_BYTE image format,
     // so they need convertion, init buffers if needed
@@ -39,34 +39,21 @@
 #include "llfetchedgltfmaterial.h"
 #include "llgltfmateriallist.h"
 #include "llviewerregion.h"
-#include "noise.h"
+#include "llvlcompositiongenerator.h"
 #include "llregionhandle.h" // for from_region_handle
 #include "llviewercontrol.h"
+#include "parallelfor.h"
 
 
 extern LLColor4U MAX_WATER_COLOR;
 
 static const U32 BASE_SIZE = 128;
 static const F32 TERRAIN_DECODE_PRIORITY = 2048.f * 2048.f;
+// Fewest texels worth handing to a worker thread in generateHeights()
+static const S32 MIN_TEXELS_PER_JOB = 2048;
 
 namespace
 {
-    F32 bilinear(const F32 v00, const F32 v01, const F32 v10, const F32 v11, const F32 x_frac, const F32 y_frac)
-    {
-        // Not sure if this is the right math...
-        // Take weighted average of all four points (bilinear interpolation)
-        F32 result;
-
-        const F32 inv_x_frac = 1.f - x_frac;
-        const F32 inv_y_frac = 1.f - y_frac;
-        result = inv_x_frac*inv_y_frac*v00
-                + x_frac*inv_y_frac*v10
-                + inv_x_frac*y_frac*v01
-                + x_frac*y_frac*v11;
-
-        return result;
-    }
-
     void boost_minimap_texture(LLViewerFetchedTexture* tex, F32 virtual_size)
     {
         llassert(tex);
@@ -491,72 +478,34 @@ bool LLVLComposition::generateHeights(const F32 x, const F32 y,
         y_end = mWidth;
     }
 
-    LLVector3d origin_global = from_region_handle(mSurfacep->getRegion()->getHandle());
-
-    // For perlin noise generation...
-    const F32 slope_squared = 1.5f*1.5f;
-    const F32 xyScale = 4.9215f; //0.93284f;
-    const F32 zScale = 4; //0.92165f;
-    const F32 z_offset = 0.f;
-    const F32 noise_magnitude = 2.f;        //  Degree to which noise modulates composition layer (versus
-                                            //  simple height)
-
-    const F32 xyScaleInv = (1.f / xyScale);
-    const F32 zScaleInv = (1.f / zScale);
+    if (x_end <= x_begin || y_end <= y_begin)
+    {
+        return true;
+    }
 
-// <FS:CR> Aurora Sim
-    //const F32 inv_width = 1.f/mWidth;
-    const F32 inv_width = 1.f/(F32)mWidth;
-// </FS:CR> Aurora Sim
+    LLVector3d origin_global = from_region_handle(mSurfacep->getRegion()->getHandle());
+    const LLVLCompositionGenerator generator(mStartHeight, mHeightRange, mWidth, mScale,
+                                             origin_global.mdV[VX], origin_global.mdV[VY]);
 
     // OK, for now, just have the composition value equal the height at the point.
-    for (S32 j = y_begin; j < y_end; j++)
-    {
-        for (S32 i = x_begin; i < x_end; i++)
-        {
-
-            F32 vec[3];
-            F32 vec1[3];
-            F32 twiddle;
-
-            // Bilinearly interpolate the start height and height range of the textures
-            F32 start_height = bilinear(mStartHeight[SOUTHWEST],
-                                        mStartHeight[SOUTHEAST],
-                                        mStartHeight[NORTHWEST],
-                                        mStartHeight[NORTHEAST],
-                                        i*inv_width, j*inv_width); // These will be bilinearly interpolated
-            F32 height_range = bilinear(mHeightRange[SOUTHWEST],
-                                        mHeightRange[SOUTHEAST],
-                                        mHeightRange[NORTHWEST],
-                                        mHeightRange[NORTHEAST],
-                                        i*inv_width, j*inv_width); // These will be bilinearly interpolated
-
-            LLVector3 location(i*mScale, j*mScale, 0.f);
-
-            F32 height = mSurfacep->resolveHeightRegion(location) + z_offset;
-
-            // Step 0: Measure the exact height at this texel
-            vec[0] = (F32)(origin_global.mdV[VX]+location.mV[VX])*xyScaleInv;   //  Adjust to non-integer lattice
-            vec[1] = (F32)(origin_global.mdV[VY]+location.mV[VY])*xyScaleInv;
-            vec[2] = height*zScaleInv;
-            //
-            //  Choose material value by adding to the exact height a random value
-            //
-            vec1[0] = vec[0]*(0.2222222222f);
-            vec1[1] = vec[1]*(0.2222222222f);
-            vec1[2] = vec[2]*(0.2222222222f);
-            twiddle = noise2(vec1)*6.5f;                    //  Low freq component for large divisions
-
-            twiddle += turbulence2(vec, 2)*slope_squared;   //  High frequency component
-            twiddle *= noise_magnitude;
-
-            F32 scaled_noisy_height = (height + twiddle - start_height) * F32(ASSET_COUNT) / height_range;
-
-            scaled_noisy_height = llmax(0.f, scaled_noisy_height);
-            scaled_noisy_height = llmin(3.f, scaled_noisy_height);
-            *(mDatap + i + j*mWidth) = scaled_noisy_height;
-        }
-    }
+    // Rows are independent, so large areas go to the worker threads in bands.
+    // A single patch is small enough to stay on the calling thread.
+    const S32 columns = x_end - x_begin;
+    const size_t rows_per_job = llmax(1, MIN_TEXELS_PER_JOB / columns);
+    LL::parallel_for("General", y_end - y_begin, rows_per_job,
+                     [&](size_t begin, size_t end)
+                     {
+                         LL_PROFILE_ZONE_NAMED("generateHeights rows");
+                         std::vector<F32> heights(columns);
+                         for (S32 j = y_begin + (S32)begin; j < y_begin + (S32)end; j++)
+                         {
+                             for (S32 i = x_begin; i < x_end; i++)
+                             {
+                                 heights[i - x_begin] = mSurfacep->resolveHeightRegion(i*mScale, j*mScale);
+                             }
+                             generator.generateRow(j, x_begin, x_end, heights.data(), mDatap + x_begin + j*mWidth);
+                         }
+                     });
     return true;
 }
 
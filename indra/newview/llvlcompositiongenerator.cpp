@@ -0,0 +1,225 @@
+/**
+* @file llvlcompositiongenerator.cpp
+* @brief Terrain composition values from heights and noise.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llvlcompositiongenerator.h"
+
+#include "llvector4a.h"
+#include "noise.h"
+
+// Indices into the corner arrays, as LLVLComposition::ECorner
+static constexpr S32 CORNER_SOUTHWEST = 0;
+static constexpr S32 CORNER_SOUTHEAST = 1;
+static constexpr S32 CORNER_NORTHWEST = 2;
+static constexpr S32 CORNER_NORTHEAST = 3;
+
+// Number of terrain assets, as LLVLComposition::ASSET_COUNT
+static constexpr F32 ASSET_COUNT = 4.f;
+
+// For perlin noise generation...
+static constexpr F32 SLOPE_SQUARED = 1.5f*1.5f;
+static constexpr F32 XY_SCALE = 4.9215f; //0.93284f;
+static constexpr F32 XY_SCALE_INV = (1.f / XY_SCALE);
+static constexpr F32 LOW_FREQUENCY = 0.2222222222f;
+static constexpr F32 NOISE_MAGNITUDE = 2.f;     //  Degree to which noise modulates composition layer (versus
+                                                //  simple height)
+
+static F32 bilinear(const F32 v00, const F32 v01, const F32 v10, const F32 v11, const F32 x_frac, const F32 y_frac)
+{
+    // Not sure if this is the right math...
+    // Take weighted average of all four points (bilinear interpolation)
+    F32 result;
+
+    const F32 inv_x_frac = 1.f - x_frac;
+    const F32 inv_y_frac = 1.f - y_frac;
+    result = inv_x_frac*inv_y_frac*v00
+            + x_frac*inv_y_frac*v10
+            + inv_x_frac*y_frac*v01
+            + x_frac*y_frac*v11;
+
+    return result;
+}
+
+// bilinear() of four texels of a row, in the same order of operations
+static inline void bilinear_4(const F32 corners[4], const LLVector4a& inv_x_frac, const LLVector4a& x_frac,
+                              const LLVector4a& inv_y_frac, const LLVector4a& y_frac, LLVector4a& result)
+{
+    LLVector4a term;
+    result.setMul(inv_x_frac, inv_y_frac);
+    result.mul(LLVector4a(corners[CORNER_SOUTHWEST]));
+    term.setMul(x_frac, inv_y_frac);
+    term.mul(LLVector4a(corners[CORNER_NORTHWEST]));
+    result.add(term);
+    term.setMul(inv_x_frac, y_frac);
+    term.mul(LLVector4a(corners[CORNER_SOUTHEAST]));
+    result.add(term);
+    term.setMul(x_frac, y_frac);
+    term.mul(LLVector4a(corners[CORNER_NORTHEAST]));
+    result.add(term);
+}
+
+LLVLCompositionGenerator::LLVLCompositionGenerator(const F32 start_height[4], const F32 height_range[4],
+                                                   S32 width, F32 scale, F64 origin_x, F64 origin_y)
+:   mInvWidth(1.f/(F32)width),
+    mScale(scale),
+    mOriginX(origin_x),
+    mOriginY(origin_y)
+{
+    for (S32 i = 0; i < 4; i++)
+    {
+        mStartHeight[i] = start_height[i];
+        mHeightRange[i] = height_range[i];
+    }
+    noise_init();
+}
+
+F32 LLVLCompositionGenerator::generate(S32 i, S32 j, F32 height) const
+{
+    F32 vec[3];
+    F32 vec1[3];
+    F32 twiddle;
+
+    // Bilinearly interpolate the start height and height range of the textures
+    F32 start_height = bilinear(mStartHeight[CORNER_SOUTHWEST],
+                                mStartHeight[CORNER_SOUTHEAST],
+                                mStartHeight[CORNER_NORTHWEST],
+                                mStartHeight[CORNER_NORTHEAST],
+                                i*mInvWidth, j*mInvWidth); // These will be bilinearly interpolated
+    F32 height_range = bilinear(mHeightRange[CORNER_SOUTHWEST],
+                                mHeightRange[CORNER_SOUTHEAST],
+                                mHeightRange[CORNER_NORTHWEST],
+                                mHeightRange[CORNER_NORTHEAST],
+                                i*mInvWidth, j*mInvWidth); // These will be bilinearly interpolated
+
+    // Step 0: Measure the exact height at this texel
+    vec[0] = (F32)(mOriginX + i*mScale)*XY_SCALE_INV;   //  Adjust to non-integer lattice
+    vec[1] = (F32)(mOriginY + j*mScale)*XY_SCALE_INV;
+    vec[2] = 0.f; // noise2() only uses x and y
+    //
+    //  Choose material value by adding to the exact height a random value
+    //
+    vec1[0] = vec[0]*LOW_FREQUENCY;
+    vec1[1] = vec[1]*LOW_FREQUENCY;
+    vec1[2] = vec[2]*LOW_FREQUENCY;
+    twiddle = noise2(vec1)*6.5f;                    //  Low freq component for large divisions
+
+    twiddle += turbulence2(vec, 2)*SLOPE_SQUARED;   //  High frequency component
+    twiddle *= NOISE_MAGNITUDE;
+
+    F32 scaled_noisy_height = (height + twiddle - start_height) * ASSET_COUNT / height_range;
+
+    scaled_noisy_height = llmax(0.f, scaled_noisy_height);
+    scaled_noisy_height = llmin(3.f, scaled_noisy_height);
+    return scaled_noisy_height;
+}
+
+void LLVLCompositionGenerator::generateRow(S32 j, S32 x_begin, S32 x_end, const F32* heights, F32* out) const
+{
+    static const LLVector4a low_frequency(LOW_FREQUENCY);
+    static const LLVector4a low_weight(6.5f);
+    static const LLVector4a slope_squared(SLOPE_SQUARED);
+    static const LLVector4a noise_magnitude(NOISE_MAGNITUDE);
+    static const LLVector4a asset_count(ASSET_COUNT);
+    static const LLVector4a half(0.5f);
+    static const LLVector4a two(2.f);
+    static const LLVector4a max_value(3.f);
+    static const LLVector4a one(1.f);
+    static const __m128i lane_offsets = _mm_set_epi32(3, 2, 1, 0);
+
+    const F32 y = (F32)(mOriginY + j*mScale)*XY_SCALE_INV;
+    const LLVector4a vec_y(y);
+    LLVector4a low_y, high_y;
+    low_y.setMul(vec_y, low_frequency);
+    high_y.setMul(vec_y, two);
+
+    const LLVector4a inv_width(mInvWidth);
+    const LLVector4a y_frac(j*mInvWidth);
+    LLVector4a inv_y_frac;
+    inv_y_frac.setSub(one, y_frac);
+
+    S32 i = x_begin;
+    for (; i + 4 <= x_end; i += 4)
+    {
+        LL_ALIGN_16(F32 xs[4]);
+        for (S32 lane = 0; lane < 4; lane++)
+        {
+            xs[lane] = (F32)(mOriginX + (i + lane)*mScale)*XY_SCALE_INV;
+        }
+        LLVector4a vec_x;
+        vec_x.load4a(xs);
+
+        // noise2(vec1)*6.5f
+        LLVector4a low_x, twiddle;
+        low_x.setMul(vec_x, low_frequency);
+        noise2_4(low_x, low_y, twiddle);
+        twiddle.mul(low_weight);
+
+        // turbulence2(vec, 2), i.e. noise2(2*vec)/2 + noise2(vec)
+        LLVector4a high_x, turbulence, octave;
+        high_x.setMul(vec_x, two);
+        noise2_4(high_x, high_y, turbulence);
+        turbulence.mul(half);
+        noise2_4(vec_x, vec_y, octave);
+        turbulence.add(octave);
+
+        turbulence.mul(slope_squared);
+        twiddle.add(turbulence);
+        twiddle.mul(noise_magnitude);
+
+        // Bilinearly interpolate the start height and height range of the textures
+        const LLVector4a x_frac(_mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(i), lane_offsets)), inv_width));
+        LLVector4a inv_x_frac;
+        inv_x_frac.setSub(one, x_frac);
+        LLVector4a start_height, height_range;
+        bilinear_4(mStartHeight, inv_x_frac, x_frac, inv_y_frac, y_frac, start_height);
+        bilinear_4(mHeightRange, inv_x_frac, x_frac, inv_y_frac, y_frac, height_range);
+
+        LLVector4a height;
+        height.loadua(heights + (i - x_begin));
+
+        LLVector4a scaled_noisy_height;
+        scaled_noisy_height.setAdd(height, twiddle);
+        scaled_noisy_height.sub(start_height);
+        scaled_noisy_height.mul(asset_count);
+        scaled_noisy_height.div(height_range);
+        scaled_noisy_height.setMax(LLVector4a::getZero(), scaled_noisy_height);
+        scaled_noisy_height.setMin(max_value, scaled_noisy_height);
+
+        LL_ALIGN_16(F32 values[4]);
+        scaled_noisy_height.store4a(values);
+        for (S32 lane = 0; lane < 4; lane++)
+        {
+            out[i - x_begin + lane] = values[lane];
+        }
+    }
+
+    for (; i < x_end; i++)
+    {
+        out[i - x_begin] = generate(i, j, heights[i - x_begin]);
+    }
+}
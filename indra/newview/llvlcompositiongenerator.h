@@ -0,0 +1,61 @@
+/**
+* @file llvlcompositiongenerator.h
+* @brief Terrain composition values from heights and noise.
+*
+*
+* $LicenseInfo:firstyear=2024&license=viewerlgpl$
+* Second Life Viewer Source Code
+* Copyright (C) 2024, Linden Research, Inc.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation;
+* version 2.1 of the License only.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+* $/LicenseInfo$
+*/
+
+#ifndef LL_LLVLCOMPOSITIONGENERATOR_H
+#define LL_LLVLCOMPOSITIONGENERATOR_H
+
+// The height to composition mapping of LLVLComposition::generateHeights(),
+// kept apart from the region and surface so that it can run on worker
+// threads and be tested on synthetic terrain. A texel's composition value
+// is its height, twiddled by Perlin noise, placed in the start height and
+// height range interpolated from the region corners and scaled to 0-3.
+class LLVLCompositionGenerator
+{
+public:
+    // Corner arrays are indexed by LLVLComposition::ECorner. The noise
+    // tables are filled here, on the calling thread, if they aren't yet.
+    LLVLCompositionGenerator(const F32 start_height[4], const F32 height_range[4],
+                             S32 width, F32 scale, F64 origin_x, F64 origin_y);
+
+    // Composition value of texel (i, j) at the given terrain height
+    F32 generate(S32 i, S32 j, F32 height) const;
+
+    // Composition values of texels [x_begin, x_end) of row j, four at a
+    // time. heights and out hold one value per texel of the range. Safe to
+    // call from several threads at once.
+    void generateRow(S32 j, S32 x_begin, S32 x_end, const F32* heights, F32* out) const;
+
+private:
+    F32 mStartHeight[4];
+    F32 mHeightRange[4];
+    F32 mInvWidth;
+    F32 mScale;
+    F64 mOriginX;
+    F64 mOriginY;
+};
+
+#endif // LL_LLVLCOMPOSITIONGENERATOR_H
@@ -2158,6 +2158,17 @@ void LLVOAvatarSelf::invalidateComposite( LLTexLayerSet* layerset, bool upload_r
     // </FS:Ansariel> [Legacy Bake]
 }
 
+// virtual
+LLImageRaw* LLVOAvatarSelf::getLocalTextureRaw(const LLLocalTextureObject* lto) const
+{
+    LLViewerFetchedTexture* tex = lto ? LLViewerTextureManager::staticCastToFetchedTexture(lto->getImage(), true) : NULL;
+    if (tex && tex->hasSavedRawImage())
+    {
+        return tex->getSavedRawImage();
+    }
+    return NULL;
+}
+
 void LLVOAvatarSelf::invalidateAll()
 {
     for (U32 i = 0; i < mBakedTextureDatas.size(); i++)
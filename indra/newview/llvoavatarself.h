@@ -275,6 +275,7 @@ public:
     // <FS:Ansariel> [Legacy Bake]
     ///* virtual */ void    invalidateComposite(LLTexLayerSet* layerset);
     /* virtual */ void  invalidateComposite(LLTexLayerSet* layerset, bool upload_result);
+    /* virtual */ LLImageRaw* getLocalTextureRaw(const LLLocalTextureObject* lto) const;
     /* virtual */ void  invalidateAll();
     /* virtual */ void  setCompositeUpdatesEnabled(bool b); // only works for self
     /* virtual */ void  setCompositeUpdatesEnabled(U32 index, bool b);
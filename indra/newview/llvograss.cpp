@@ -767,6 +767,7 @@ void LLGrassPartition::getGeometry(LLSpatialGroup* group)
             LLDrawInfo* info = new LLDrawInfo(start,end,count,offset,facep->getTexture(),
                 //facep->getTexture(),
                 buffer, object->isSelected(), fullbright);
+            info->updateSortKey();
 
             draw_vec.push_back(info);
             //for alpha sorting
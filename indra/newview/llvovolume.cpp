@@ -5807,6 +5807,7 @@ void LLVolumeGeometryManager::registerFace(LLSpatialGroup* group, LLFace* facep,
             draw_info->mTextureList.resize(index+1);
             draw_info->mTextureList[index] = tex;
         }
+        draw_info->updateSortKey();
         draw_info->validate();
     }
 
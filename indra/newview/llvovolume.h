@@ -135,6 +135,7 @@ public:
 
                 bool    isVisible() const ;
     bool isActive() const override;
+    bool hasPredictableIdleUpdate() const override  { return true; }
     bool isAttachment() const override;
     bool isRootEdit() const override; // overridden for sake of attachments treating themselves as a root object
     bool isHUDAttachment() const override;
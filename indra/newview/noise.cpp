@@ -29,6 +29,7 @@
 #include "noise.h"
 
 #include "llrand.h"
+#include "llvector4a.h"
 
 
 // static
@@ -83,3 +84,112 @@ F32 noise2(F32 *vec)
     return lerp_m(sy, a, b);
 }
 
+void noise_init()
+{
+    if (gNoiseStart) {
+        gNoiseStart = 0;
+        init();
+    }
+}
+
+// fast_setup() of four lanes, the same operations in the same order
+static inline void fast_setup_4(const LLVector4a& vec, S32* b0, S32* b1, LLVector4a& r0, LLVector4a& r1)
+{
+    static const LLVector4a offset(4096.f); // NF32
+    static const LLVector4a one(1.f);
+    static const __m128i byte_mask = _mm_set1_epi32(0xff);
+
+    r1.setAdd(vec, offset);
+    const __m128i t_S32 = _mm_cvttps_epi32(r1);
+    const __m128i lattice0 = _mm_and_si128(t_S32, byte_mask);
+    const __m128i lattice1 = _mm_and_si128(_mm_add_epi32(lattice0, _mm_set1_epi32(1)), byte_mask);
+    _mm_store_si128((__m128i*)b0, lattice0);
+    _mm_store_si128((__m128i*)b1, lattice1);
+    r0.setSub(r1, LLVector4a(_mm_cvtepi32_ps(t_S32)));
+    r1.setSub(r0, one);
+}
+
+// lerp_m() of four lanes
+static inline void lerp_4(const LLVector4a& t, const LLVector4a& a, const LLVector4a& b, LLVector4a& result)
+{
+    LLVector4a diff;
+    diff.setSub(b, a);
+    diff.mul(t);
+    result.setAdd(a, diff);
+}
+
+// s_curve() of four lanes
+static inline void s_curve_4(const LLVector4a& t, LLVector4a& result)
+{
+    static const LLVector4a two(2.f);
+    static const LLVector4a three(3.f);
+    LLVector4a slope;
+    slope.setMul(two, t);
+    slope.setSub(three, slope);
+    result.setMul(t, t);
+    result.mul(slope);
+}
+
+// fast_at2() of four lanes
+static inline void fast_at2_4(const LLVector4a& rx, const LLVector4a& ry, const LLVector4a& qx, const LLVector4a& qy, LLVector4a& result)
+{
+    LLVector4a y;
+    y.setMul(ry, qy);
+    result.setMul(rx, qx);
+    result.add(y);
+}
+
+void noise2_4(const LLVector4a& x, const LLVector4a& y, LLVector4a& result)
+{
+    llassert(!gNoiseStart);
+
+    LL_ALIGN_16(S32 bx0[4]);
+    LL_ALIGN_16(S32 bx1[4]);
+    LL_ALIGN_16(S32 by0[4]);
+    LL_ALIGN_16(S32 by1[4]);
+    LLVector4a rx0, rx1, ry0, ry1;
+    fast_setup_4(x, bx0, bx1, rx0, rx1);
+    fast_setup_4(y, by0, by1, ry0, ry1);
+
+    // Only the table lookups are done a lane at a time
+    LL_ALIGN_16(F32 q[8][4]);
+    for (S32 lane = 0; lane < 4; lane++) {
+        const S32 i = *(p + bx0[lane]);
+        const S32 j = *(p + bx1[lane]);
+        const F32* q00 = *(g2 + *(p + i + by0[lane]));
+        const F32* q10 = *(g2 + *(p + j + by0[lane]));
+        const F32* q01 = *(g2 + *(p + i + by1[lane]));
+        const F32* q11 = *(g2 + *(p + j + by1[lane]));
+        q[0][lane] = q00[0];
+        q[1][lane] = q00[1];
+        q[2][lane] = q10[0];
+        q[3][lane] = q10[1];
+        q[4][lane] = q01[0];
+        q[5][lane] = q01[1];
+        q[6][lane] = q11[0];
+        q[7][lane] = q11[1];
+    }
+    LLVector4a q00x, q00y, q10x, q10y, q01x, q01y, q11x, q11y;
+    q00x.load4a(q[0]);
+    q00y.load4a(q[1]);
+    q10x.load4a(q[2]);
+    q10y.load4a(q[3]);
+    q01x.load4a(q[4]);
+    q01y.load4a(q[5]);
+    q11x.load4a(q[6]);
+    q11y.load4a(q[7]);
+
+    LLVector4a sx, sy, u, v, a, b;
+    s_curve_4(rx0, sx);
+    s_curve_4(ry0, sy);
+
+    fast_at2_4(rx0, ry0, q00x, q00y, u);
+    fast_at2_4(rx1, ry0, q10x, q10y, v);
+    lerp_4(sx, u, v, a);
+
+    fast_at2_4(rx0, ry1, q01x, q01y, u);
+    fast_at2_4(rx1, ry1, q11x, q11y, v);
+    lerp_4(sx, u, v, b);
+
+    lerp_4(sy, a, b, result);
+}
@@ -35,6 +35,14 @@ F32 clouds3(float *v, float freq);
 F32 noise2(float *vec);
 F32 noise3(float *vec);
 
+class LLVector4a;
+
+// Fills the noise tables now rather than on first use. Must be called on
+// one thread before noise2_4() is called from several.
+void noise_init();
+// noise2() at four points at once, x and y holding their coordinates
+void noise2_4(const LLVector4a& x, const LLVector4a& y, LLVector4a& result);
+
 inline F32 bias(F32 a, F32 b)
 {
     return (F32)pow(a, (F32)(log(b) / log(0.5f)));
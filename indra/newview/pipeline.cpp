@@ -47,6 +47,7 @@
 #include "llrender.h"
 #include "llstartup.h"
 #include "llwindow.h"   // swapBuffers()
+#include "parallelfor.h"
 
 // newview includes
 #include "llagent.h"
@@ -92,6 +93,8 @@
 #include "llvotree.h"
 #include "llvovolume.h"
 #include "llvosurfacepatch.h"
+#include "llsurface.h"
+#include "llsurfacepatch.h"
 #include "llvowater.h"
 #include "llvotree.h"
 #include "llvopartgroup.h"
@@ -101,6 +104,7 @@
 #include "llviewerstats.h"
 #include "llviewerjoystick.h"
 #include "llviewerdisplay.h"
+#include "llscenereplay.h"
 #include "llspatialpartition.h"
 #include "llmutelist.h"
 #include "lltoolpie.h"
@@ -255,6 +259,16 @@ bool    gDebugPipeline = false;
 LLPipeline gPipeline;
 const LLMatrix4* gGLLastMatrix = NULL;
 
+S32 get_occlusion_mode()
+{
+    return LLPipeline::sUseOcclusion;
+}
+
+void draw_occlusion_box(U32 index_offset)
+{
+    gPipeline.mCubeVB->drawRange(LLRender::TRIANGLE_FAN, 0, 7, 8, index_offset);
+}
+
 LLTrace::BlockTimerStatHandle FTM_RENDER_GEOMETRY("Render Geometry");
 LLTrace::BlockTimerStatHandle FTM_RENDER_GRASS("Grass");
 LLTrace::BlockTimerStatHandle FTM_RENDER_INVISIBLE("Invisible");
@@ -333,6 +347,9 @@ bool    LLPipeline::sRenderTransparentWater = true;
 bool    LLPipeline::sBakeSunlight = false;
 bool    LLPipeline::sNoAlpha = false;
 bool    LLPipeline::sUseFarClip = true;
+bool    LLPipeline::sParallelCull = false;
+bool    LLPipeline::sSortBatches = false;
+bool    LLPipeline::sSoftwareOcclusion = false;
 bool    LLPipeline::sShadowRender = false;
 bool    LLPipeline::sRenderGlow = false;
 bool    LLPipeline::sReflectionRender = false;
@@ -552,6 +569,9 @@ void LLPipeline::init()
     connectRefreshCachedSettingsSafe("RenderAutoMaskAlphaDeferred");
     connectRefreshCachedSettingsSafe("RenderAutoMaskAlphaNonDeferred");
     connectRefreshCachedSettingsSafe("RenderUseFarClip");
+    connectRefreshCachedSettingsSafe("RenderParallelCull");
+    connectRefreshCachedSettingsSafe("RenderSortBatches");
+    connectRefreshCachedSettingsSafe("RenderSoftwareOcclusion");
     connectRefreshCachedSettingsSafe("RenderAvatarMaxNonImpostors");
     connectRefreshCachedSettingsSafe("UseOcclusion");
     // DEPRECATED -- connectRefreshCachedSettingsSafe("WindLightUseAtmosShaders");
@@ -700,6 +720,10 @@ void LLPipeline::cleanup()
         LL_WARNS() << "Tree Pools not cleaned up" << LL_ENDL;
     }
 
+    delete mSceneRecording;
+    mSceneRecording = nullptr;
+
+    mSoftwareOccluders.clear();
     delete mAlphaPoolPreWater;
     mAlphaPoolPreWater = nullptr;
     delete mAlphaPoolPostWater;
@@ -1119,6 +1143,9 @@ void LLPipeline::refreshCachedSettings()
     LLPipeline::sAutoMaskAlphaDeferred = gSavedSettings.getBOOL("RenderAutoMaskAlphaDeferred");
     LLPipeline::sAutoMaskAlphaNonDeferred = gSavedSettings.getBOOL("RenderAutoMaskAlphaNonDeferred");
     LLPipeline::sUseFarClip = gSavedSettings.getBOOL("RenderUseFarClip");
+    LLPipeline::sParallelCull = gSavedSettings.getBOOL("RenderParallelCull");
+    LLPipeline::sSortBatches = gSavedSettings.getBOOL("RenderSortBatches");
+    LLPipeline::sSoftwareOcclusion = gSavedSettings.getBOOL("RenderSoftwareOcclusion");
     LLPipeline::sShowJellyDollAsImpostor = gSavedSettings.getBOOL("RenderJellyDollsAsImpostors");
     LLVOAvatar::sMaxNonImpostors = gSavedSettings.getU32("RenderAvatarMaxNonImpostors");
     LLVOAvatar::updateImpostorRendering(LLVOAvatar::sMaxNonImpostors);
@@ -2564,30 +2591,45 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
 
     sCull->clear();
 
-    for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin();
-            iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+    bool world_camera = LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD && !gCubeSnapshot && !hud_attachments;
+    mSoftwareDepthValid = world_camera && updateSoftwareOcclusion(camera);
+
+    if (world_camera)
     {
-        LLViewerRegion* region = *iter;
+        recordScene(camera, water_clip);
+    }
 
-        for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+    if (sParallelCull)
+    {
+        cullPartitionsParallel(camera, hud_attachments);
+    }
+    else
+    {
+        for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin();
+                iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
         {
-            LLSpatialPartition* part = region->getSpatialPartition(i);
-            if (part)
+            LLViewerRegion* region = *iter;
+
+            for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
             {
-                if (!hud_attachments ? LLViewerRegion::PARTITION_BRIDGE == i || hasRenderType(part->mDrawableType) : hasRenderType(part->mDrawableType))
+                LLSpatialPartition* part = region->getSpatialPartition(i);
+                if (part)
                 {
-                    part->cull(camera);
+                    if (!hud_attachments ? LLViewerRegion::PARTITION_BRIDGE == i || hasRenderType(part->mDrawableType) : hasRenderType(part->mDrawableType))
+                    {
+                        part->cull(camera);
+                    }
                 }
             }
-        }
 
-        //scan the VO Cache tree
-        LLVOCachePartition* vo_part = region->getVOCachePartition();
-        if(vo_part)
-        {
-            // <FS:Beq> Fix area search again
-            //vo_part->cull(camera, sUseOcclusion > 0);
-            vo_part->cull(camera, sUseOcclusion > 0 && !gAgent.getFSAreaSearchActive());
+            //scan the VO Cache tree
+            LLVOCachePartition* vo_part = region->getVOCachePartition();
+            if(vo_part)
+            {
+                // <FS:Beq> Fix area search again
+                //vo_part->cull(camera, sUseOcclusion > 0);
+                vo_part->cull(camera, sUseOcclusion > 0 && !gAgent.getFSAreaSearchActive());
+            }
         }
     }
 
@@ -2609,6 +2651,381 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, bool hud_att
         gSky.mVOWLSkyp->mDrawable->setVisible(camera);
         sCull->pushDrawable(gSky.mVOWLSkyp->mDrawable);
     }
+
+    if (world_camera)
+    {
+        gatherSoftwareOccluders();
+    }
+    mSoftwareDepthValid = false;
+}
+
+// Worker time spent frustum culling each partition type per world camera cull
+// with RenderParallelCull, in LLViewerRegion::eObjectPartitions order
+static LLTrace::SampleStatHandle<F64Milliseconds> sPartitionCullTime[LLViewerRegion::PARTITION_VO_CACHE] =
+{
+    { "cullhudtime", "Parallel cull time of HUD partitions" },
+    { "cullterraintime", "Parallel cull time of terrain partitions" },
+    { "cullvoidwatertime", "Parallel cull time of void water partitions" },
+    { "cullwatertime", "Parallel cull time of water partitions" },
+    { "culltreetime", "Parallel cull time of tree partitions" },
+    { "cullparticletime", "Parallel cull time of particle partitions" },
+    { "cullgrasstime", "Parallel cull time of grass partitions" },
+    { "cullvolumetime", "Parallel cull time of volume partitions" },
+    { "cullbridgetime", "Parallel cull time of bridge partitions" },
+    { "cullavatartime", "Parallel cull time of avatar partitions" },
+    { "cullcontrolavtime", "Parallel cull time of animesh partitions" },
+    { "cullhudparticletime", "Parallel cull time of HUD particle partitions" },
+};
+
+void LLPipeline::cullPartitionsParallel(LLCamera& camera, bool hud_attachments)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    // Roots are rebounded and checked here, since rebound() changes the
+    // octrees, then every child subtree is frustum checked on its own
+    const LLWorld::region_list_t& regions = LLWorld::getInstance()->getRegionList();
+    std::vector<LLCullFragment> fragments;
+    std::vector<size_t> region_end;
+    region_end.reserve(regions.size());
+    for (LLViewerRegion* region : regions)
+    {
+        for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+        {
+            LLSpatialPartition* part = region->getSpatialPartition(i);
+            if (part)
+            {
+                if (!hud_attachments ? LLViewerRegion::PARTITION_BRIDGE == i || hasRenderType(part->mDrawableType) : hasRenderType(part->mDrawableType))
+                {
+                    part->cullRoot(camera, fragments);
+                }
+            }
+        }
+        region_end.push_back(fragments.size());
+    }
+
+    LL::parallel_for("General", fragments.size(), 1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                LLSpatialPartition::cullFragment(camera, fragments[i]);
+            }
+        });
+
+    // Occlusion checks and markNotCulled() go through GL and sCull, apply
+    // them in the same order as the serial loop in updateCull()
+    F64 seconds[LLViewerRegion::PARTITION_VO_CACHE] = { 0.0 };
+    size_t fragment = 0;
+    size_t region_index = 0;
+    for (LLViewerRegion* region : regions)
+    {
+        for (; fragment < region_end[region_index]; ++fragment)
+        {
+            LLSpatialPartition::applyCullFragment(camera, fragments[fragment]);
+            seconds[fragments[fragment].mPartitionType] += fragments[fragment].mSeconds;
+        }
+        ++region_index;
+
+        //scan the VO Cache tree
+        LLVOCachePartition* vo_part = region->getVOCachePartition();
+        if(vo_part)
+        {
+            vo_part->cull(camera, sUseOcclusion > 0 && !gAgent.getFSAreaSearchActive());
+        }
+    }
+
+    if (LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD && !gCubeSnapshot && !hud_attachments)
+    {
+        for (U32 i = 0; i < LLViewerRegion::PARTITION_VO_CACHE; i++)
+        {
+            sample(sPartitionCullTime[i], F64Seconds(seconds[i]));
+        }
+    }
+}
+
+class LLOctreeRecordScene : public OctreeTraveler
+{
+public:
+    LLSceneRecording::Partition& mPartition;
+
+    LLOctreeRecordScene(LLSceneRecording::Partition& partition) : mPartition(partition) { }
+
+    virtual void visit(const OctreeNode* node)
+    {
+        for (OctreeNode::const_element_iter i = node->getDataBegin(); i != node->getDataEnd(); ++i)
+        {
+            const LLViewerOctreeEntry* entry = *i;
+            LLDrawable* drawable = (LLDrawable*)entry->getDrawable();
+            mPartition.addElement(entry->getSpatialExtents(), entry->getPositionGroup(), entry->getBinRadius(),
+                                  drawable ? drawable->getRenderType() : 0);
+        }
+    }
+};
+
+void LLPipeline::recordScene(LLCamera& camera, bool water_clip)
+{
+    static LLCachedControl<U32> scene_recording_frames(gSavedSettings, "SceneRecordingFrames", 0);
+
+    if (!mSceneRecording)
+    {
+        if (!scene_recording_frames)
+        {
+            return;
+        }
+
+        // The partitions are captured once, at the first recorded frame
+        mSceneRecording = new LLSceneRecording();
+        mSceneRecording->mOctreeMaxCapacity = gOctreeMaxCapacity;
+        mSceneRecording->mOctreeMinSize = gOctreeMinSize;
+
+        U32 region_index = 0;
+        for (LLViewerRegion* region : LLWorld::getInstance()->getRegionList())
+        {
+            for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+            {
+                LLSpatialPartition* part = region->getSpatialPartition(i);
+                if (part)
+                {
+                    LLOctreeRecordScene recorder(mSceneRecording->addPartition(region_index, i));
+                    recorder.traverse(part->mOctree);
+                }
+            }
+            region_index++;
+        }
+    }
+
+    LLPlane clip_plane = camera.getUserClipPlane();
+    mSceneRecording->addFrame(camera, water_clip ? &clip_plane : NULL);
+
+    if (mSceneRecording->mFrames.size() >= scene_recording_frames)
+    {
+        std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "scene_recording.llsd");
+        if (mSceneRecording->save(filename))
+        {
+            LL_INFOS() << "Recorded " << mSceneRecording->mFrames.size() << " frames of "
+                       << mSceneRecording->getNumElements() << " octree entries to " << filename << LL_ENDL;
+        }
+
+        delete mSceneRecording;
+        mSceneRecording = NULL;
+        gSavedSettings.setU32("SceneRecordingFrames", 0);
+    }
+}
+
+static const U16 SOFTWARE_OCCLUDER_QUAD[] = { 0, 1, 2, 0, 2, 3 };
+
+// Terrain never dips below the lowest height sample of a patch, so each patch
+// occludes as a flat square at that height, joined to its neighbours by walls
+// where their heights step
+static void rasterize_terrain_occluders(LLSoftwareDepthBuffer& depth, const LLSurface& land, const LLCamera& camera)
+{
+    const S32 patches_per_edge = land.getPatchesPerEdge();
+    const F32 patch_width = land.getGridsPerPatchEdge() * land.getMetersPerGrid();
+    const F32 max_distance = camera.getFar() + patch_width;
+
+    LLVector4a vertices[4];
+    for (S32 j = 0; j < patches_per_edge; ++j)
+    {
+        for (S32 i = 0; i < patches_per_edge; ++i)
+        {
+            const LLSurfacePatch* patch = land.getPatch(i, j);
+            if (!patch || !patch->getHasReceivedData())
+            {
+                continue;
+            }
+
+            LLVector3 origin = patch->getOriginAgent();
+            F32 x0 = origin.mV[VX];
+            F32 y0 = origin.mV[VY];
+            F32 x1 = x0 + patch_width;
+            F32 y1 = y0 + patch_width;
+            F32 z = patch->getMinZ();
+            if (dist_vec(LLVector3(x0 + patch_width * 0.5f, y0 + patch_width * 0.5f, z), camera.getOrigin()) > max_distance)
+            {
+                continue;
+            }
+
+            vertices[0].set(x0, y0, z);
+            vertices[1].set(x1, y0, z);
+            vertices[2].set(x1, y1, z);
+            vertices[3].set(x0, y1, z);
+            depth.rasterizeTriangles(vertices, SOFTWARE_OCCLUDER_QUAD, 6, true);
+
+            const LLSurfacePatch* east = i + 1 < patches_per_edge ? land.getPatch(i + 1, j) : NULL;
+            if (east && east->getHasReceivedData() && east->getMinZ() != z)
+            {
+                F32 low = llmin(z, east->getMinZ());
+                F32 high = llmax(z, east->getMinZ());
+                vertices[0].set(x1, y0, low);
+                vertices[1].set(x1, y1, low);
+                vertices[2].set(x1, y1, high);
+                vertices[3].set(x1, y0, high);
+                depth.rasterizeTriangles(vertices, SOFTWARE_OCCLUDER_QUAD, 6, false);
+            }
+
+            const LLSurfacePatch* north = j + 1 < patches_per_edge ? land.getPatch(i, j + 1) : NULL;
+            if (north && north->getHasReceivedData() && north->getMinZ() != z)
+            {
+                F32 low = llmin(z, north->getMinZ());
+                F32 high = llmax(z, north->getMinZ());
+                vertices[0].set(x0, y1, low);
+                vertices[1].set(x1, y1, low);
+                vertices[2].set(x1, y1, high);
+                vertices[3].set(x0, y1, high);
+                depth.rasterizeTriangles(vertices, SOFTWARE_OCCLUDER_QUAD, 6, false);
+            }
+        }
+    }
+}
+
+// Static plain boxes with every face opaque are drawn exactly as their
+// bounding box, the only prims solid enough to occlude without their meshes
+static bool is_software_occluder(LLDrawable* drawable)
+{
+    const F32 MIN_OCCLUDER_SIZE = 2.f;
+
+    if (drawable->isDead() || !drawable->isStatic() || drawable->isState(LLDrawable::RIGGED | LLDrawable::FORCE_INVISIBLE))
+    {
+        return false;
+    }
+
+    LLVOVolume* vobj = drawable->getVOVolume();
+    if (!vobj || !vobj->getVolume() || vobj->isAttachment() || vobj->isFlexible() || vobj->isSculpted() || vobj->isMesh())
+    {
+        return false;
+    }
+
+    // At least a wall, two sides large enough to hide something
+    const LLVector3& scale = vobj->getScale();
+    S32 large_sides = (scale.mV[VX] >= MIN_OCCLUDER_SIZE) + (scale.mV[VY] >= MIN_OCCLUDER_SIZE) + (scale.mV[VZ] >= MIN_OCCLUDER_SIZE);
+    if (large_sides < 2)
+    {
+        return false;
+    }
+
+    static LLVolumeParams box_params;
+    box_params.setType(LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE);
+    const LLVolumeParams& params = vobj->getVolume()->getParams();
+    if (!(params.getProfileParams() == box_params.getProfileParams()) ||
+        !(params.getPathParams() == box_params.getPathParams()))
+    {
+        return false;
+    }
+
+    if (drawable->getNumFaces() == 0)
+    {
+        return false;
+    }
+
+    for (S32 i = 0; i < drawable->getNumFaces(); ++i)
+    {
+        LLFace* face = drawable->getFace(i);
+        const LLTextureEntry* te = face ? face->getTextureEntry() : NULL;
+        LLViewerTexture* tex = face ? face->getTexture() : NULL;
+        if (!te || !tex || face->isInAlphaPool() || te->getAlpha() < 1.f ||
+            te->getMaterialParams().notNull() || te->getGLTFRenderMaterial() ||
+            tex->getComponents() != 3)
+        { //anything that could be see through or alpha masked
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LLPipeline::updateSoftwareOcclusion(LLCamera& camera)
+{
+    if (!sSoftwareOcclusion || sUseOcclusion < 2 || sShadowRender || sReflectionRender)
+    {
+        return false;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    static LLCachedControl<U32> software_occlusion_resolution(gSavedSettings, "RenderSoftwareOcclusionResolution", 256);
+    U32 width = llclamp((U32) software_occlusion_resolution, 16U, 1024U);
+    U32 height = llmax((U32) (width / camera.getAspect()), 1U);
+    mSoftwareDepth.resize(width, height);
+    mSoftwareDepth.clear(camera);
+
+    const LLVector3& origin = camera.getOrigin();
+    if (hasRenderType(LLPipeline::RENDER_TYPE_TERRAIN) &&
+        origin.mV[VZ] > LLWorld::getInstance()->resolveLandHeightAgent(origin))
+    { //from under the ground the terrain faces away
+        for (LLViewerRegion* region : LLWorld::getInstance()->getRegionList())
+        {
+            rasterize_terrain_occluders(mSoftwareDepth, region->getLand(), camera);
+        }
+    }
+
+    if (hasRenderType(LLPipeline::RENDER_TYPE_VOLUME))
+    {
+        LLMatrix4a mat;
+        LLVector4a corners[8];
+        for (LLDrawable* drawable : mSoftwareOccluders)
+        {
+            if (!is_software_occluder(drawable))
+            { //changed since it was gathered
+                continue;
+            }
+
+            mat.loadu(drawable->getWorldMatrix());
+            for (U32 i = 0; i < 8; ++i)
+            {
+                LLVector4a corner(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+                mat.affineTransform(corner, corners[i]);
+            }
+            mSoftwareDepth.rasterizeBox(corners);
+        }
+    }
+
+    mSoftwareDepth.buildHierarchy();
+    return mSoftwareDepth.getNumTriangles() > 0;
+}
+
+void LLPipeline::gatherSoftwareOccluders()
+{
+    mSoftwareOccluders.clear();
+    if (!sSoftwareOcclusion || sUseOcclusion < 2)
+    {
+        return;
+    }
+
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
+
+    for (LLCullResult::sg_iterator iter = sCull->beginVisibleGroups(); iter != sCull->endVisibleGroups(); ++iter)
+    {
+        LLSpatialGroup* group = *iter;
+        if (group->getSpatialPartition()->mPartitionType != LLViewerRegion::PARTITION_VOLUME)
+        {
+            continue;
+        }
+
+        for (LLSpatialGroup::element_iter i = group->getDataBegin(); i != group->getDataEnd(); ++i)
+        {
+            LLDrawable* drawable = (LLDrawable*)(*i)->getDrawable();
+            if (drawable && is_software_occluder(drawable))
+            {
+                mSoftwareOccluders.push_back(drawable);
+            }
+        }
+    }
+}
+
+bool LLPipeline::isSoftwareOccluded(LLSpatialGroup* group)
+{
+    // Frames an occlusion query takes to come back
+    const U32 QUERY_LATENCY_FRAMES = 4;
+
+    if (!mSoftwareDepthValid ||
+        group->getSpatialPartition()->isBridge() || //bridges are culled in their own frame
+        group->isRecentlyVisible() ||
+        gFrameCount - group->getLastOcclusionIssuedTime() < QUERY_LATENCY_FRAMES)
+    { //a query result is on its way or the group was just drawn, trust the GPU
+        return false;
+    }
+
+    return mSoftwareDepth.isOccluded(group->getBounds());
 }
 
 void LLPipeline::markNotCulled(LLSpatialGroup* group, LLCamera& camera)
@@ -3634,6 +4051,27 @@ void renderSoundHighlights(LLDrawable *drawablep)
     }
 }
 
+// Blended passes keep the order their batches were collected in
+static bool is_sortable_render_pass(U32 type)
+{
+    switch (type)
+    {
+    case LLRenderPass::PASS_ALPHA:
+    case LLRenderPass::PASS_ALPHA_RIGGED:
+    case LLRenderPass::PASS_MATERIAL_ALPHA:
+    case LLRenderPass::PASS_MATERIAL_ALPHA_RIGGED:
+    case LLRenderPass::PASS_SPECMAP_BLEND:
+    case LLRenderPass::PASS_SPECMAP_BLEND_RIGGED:
+    case LLRenderPass::PASS_NORMMAP_BLEND:
+    case LLRenderPass::PASS_NORMMAP_BLEND_RIGGED:
+    case LLRenderPass::PASS_NORMSPEC_BLEND:
+    case LLRenderPass::PASS_NORMSPEC_BLEND_RIGGED:
+        return false;
+    default:
+        return true;
+    }
+}
+
 void LLPipeline::postSort(LLCamera &camera)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
@@ -3784,6 +4222,18 @@ void LLPipeline::postSort(LLCamera &camera)
 
     mMeshDirtyGroup.clear();
 
+    if (sSortBatches)
+    {
+        LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("sort render maps");
+        for (U32 type = LLRenderPass::PASS_SIMPLE; type < LLRenderPass::NUM_RENDER_TYPES; ++type)
+        {
+            if (is_sortable_render_pass(type))
+            {
+                sCull->sortRenderMap(type);
+            }
+        }
+    }
+
     {
         LL_PROFILE_ZONE_NAMED_CATEGORY_PIPELINE("sort alpha groups");
     if (!sShadowRender)
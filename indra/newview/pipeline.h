@@ -40,6 +40,7 @@
 #include "llrendertarget.h"
 #include "llreflectionmapmanager.h"
 #include "llheroprobemanager.h"
+#include "llsoftwaredepthbuffer.h"
 
 #include <stack>
 
@@ -53,6 +54,7 @@ class LLVOPartGroup;
 class LLGLSLShader;
 class LLDrawPoolAlpha;
 class LLSettingsSky;
+class LLSceneRecording;
 
 typedef enum e_avatar_skinning_method
 {
@@ -195,6 +197,9 @@ public:
     // Object related methods
     void        markVisible(LLDrawable *drawablep, LLCamera& camera);
     void        markOccluder(LLSpatialGroup* group);
+    // True if group is hidden behind the terrain and prims rasterized by
+    // updateSoftwareOcclusion() while no occlusion query result is available
+    bool        isSoftwareOccluded(LLSpatialGroup* group);
 
     void        doOcclusion(LLCamera& camera);
     void        markNotCulled(LLSpatialGroup* group, LLCamera &camera);
@@ -482,6 +487,15 @@ private:
     void hideDrawable( LLDrawable *pDrawable );
     void unhideDrawable( LLDrawable *pDrawable );
     void skipRenderingShadows();
+    // Captures the scene and camera for SceneRecordingFrames
+    void recordScene(LLCamera& camera, bool water_clip);
+    // Frustum culls the partitions of every region on the worker threads
+    void cullPartitionsParallel(LLCamera& camera, bool hud_attachments);
+    // Rasterizes the terrain and the prims kept by gatherSoftwareOccluders()
+    // as seen from camera for isSoftwareOccluded()
+    bool updateSoftwareOcclusion(LLCamera& camera);
+    // Keeps the large opaque boxes of the groups the world camera sees
+    void gatherSoftwareOccluders();
 
     // <FS:Ansariel> Reset VB during TP
     void initDeferredVB();
@@ -669,6 +683,9 @@ public:
     static bool             sBakeSunlight;
     static bool             sNoAlpha;
     static bool             sUseFarClip;
+    static bool             sParallelCull;
+    static bool             sSortBatches;
+    static bool             sSoftwareOcclusion;
     static bool             sShadowRender;
     static bool             sDynamicLOD;
     static bool             sPickAvatar;
@@ -973,6 +990,14 @@ protected:
     LLDrawPool*                 mPBROpaquePool = nullptr;
     LLDrawPool*                 mPBRAlphaMaskPool = nullptr;
 
+    // Scene being captured by recordScene(), if any
+    LLSceneRecording*           mSceneRecording = nullptr;
+
+    // CPU depth buffer of large occluders for the world camera cull
+    LLSoftwareDepthBuffer       mSoftwareDepth;
+    bool                        mSoftwareDepthValid = false;
+    std::vector<LLPointer<LLDrawable> > mSoftwareOccluders;
+
     // Note: no need to keep an quick-lookup to avatar pools, since there's only one per avatar
 
 public:
@@ -0,0 +1,137 @@
+/**
+ * @file   lldrawsortkey_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times radix sorting render batches by ll_draw_sort_key() against
+ *         a comparison sort over the batch state, and counts the state
+ *         changes each order leaves. Built when LL_BENCHMARKS is set, run by
+ *         hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldrawsortkey.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "llradixsort.h"
+
+namespace
+{
+    // Batches as LLSpatialGroup::rebuildGeom() leaves them: objects in group
+    // order, each drawing a few faces with its own vertex buffer and model
+    // matrix, and textures and materials shared across the scene
+    struct Batch
+    {
+        const U64* mMaterial;
+        const U64* mTexture;
+        const U64* mMatrix;
+        const U64* mBuffer;
+        U64 mSortKey;
+    };
+
+    U32 sSeed = 1;
+
+    U32 next_random()
+    {
+        sSeed = sSeed * 1664525 + 1013904223;
+        return sSeed >> 8;
+    }
+
+    U32 state_changes(const std::vector<const Batch*>& order)
+    {
+        U32 changes = 0;
+        for (size_t i = 1; i < order.size(); ++i)
+        {
+            changes += order[i]->mMaterial != order[i - 1]->mMaterial;
+            changes += order[i]->mTexture != order[i - 1]->mTexture;
+            changes += order[i]->mBuffer != order[i - 1]->mBuffer;
+        }
+        return changes;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const U32 NUM_BATCHES = 65536;
+    const U32 NUM_TEXTURES = 2048;
+    const U32 NUM_MATERIALS = 256;
+    const U32 PASSES = 10;
+
+    // stand-ins for the objects the batches point at
+    std::vector<U64> materials(NUM_MATERIALS);
+    std::vector<U64> textures(NUM_TEXTURES);
+    std::vector<U64> matrices(NUM_BATCHES / 64);
+    std::vector<U64> buffers(NUM_BATCHES / 8);
+
+    std::vector<Batch> batches(NUM_BATCHES);
+    for (U32 i = 0; i < NUM_BATCHES; ++i)
+    {
+        Batch& b = batches[i];
+        b.mMaterial = next_random() % 4 ? NULL : &materials[next_random() % NUM_MATERIALS];
+        b.mTexture = &textures[next_random() % NUM_TEXTURES];
+        b.mMatrix = &matrices[i / 64];
+        b.mBuffer = &buffers[i / 8];
+        b.mSortKey = ll_draw_sort_key(0, (uintptr_t) b.mMaterial, (uintptr_t) b.mTexture,
+                                      (uintptr_t) b.mMatrix, (uintptr_t) b.mBuffer);
+    }
+
+    std::vector<const Batch*> unsorted;
+    for (const Batch& b : batches)
+    {
+        unsorted.push_back(&b);
+    }
+
+    typedef std::chrono::steady_clock clock_t;
+
+    // what a comparison sort over the batch state costs
+    std::vector<const Batch*> compared;
+    clock_t::time_point start = clock_t::now();
+    for (U32 pass = 0; pass < PASSES; ++pass)
+    {
+        compared = unsorted;
+        std::sort(compared.begin(), compared.end(),
+                  [](const Batch* a, const Batch* b)
+                  {
+                      if (a->mMaterial != b->mMaterial) return a->mMaterial < b->mMaterial;
+                      if (a->mTexture != b->mTexture) return a->mTexture < b->mTexture;
+                      if (a->mMatrix != b->mMatrix) return a->mMatrix < b->mMatrix;
+                      return a->mBuffer < b->mBuffer;
+                  });
+    }
+    F64 compare_secs = std::chrono::duration<F64>(clock_t::now() - start).count();
+
+    // the cached keys radix sorted as LLCullResult::sortRenderMap() does
+    std::vector<std::pair<U64, const Batch*> > keyed(NUM_BATCHES);
+    std::vector<std::pair<U64, const Batch*> > scratch(NUM_BATCHES);
+    std::vector<const Batch*> sorted(NUM_BATCHES);
+    start = clock_t::now();
+    for (U32 pass = 0; pass < PASSES; ++pass)
+    {
+        for (U32 i = 0; i < NUM_BATCHES; ++i)
+        {
+            keyed[i] = { unsorted[i]->mSortKey, unsorted[i] };
+        }
+        LL::radix_sort(keyed.data(), keyed.data() + NUM_BATCHES, scratch.data(),
+                       [](const std::pair<U64, const Batch*>& e) { return e.first; });
+        for (U32 i = 0; i < NUM_BATCHES; ++i)
+        {
+            sorted[i] = keyed[i].second;
+        }
+    }
+    F64 radix_secs = std::chrono::duration<F64>(clock_t::now() - start).count();
+
+    std::cout << NUM_BATCHES << " batches:\n"
+              << "  comparison sort " << compare_secs * 1000.0 / PASSES << "ms, "
+              << state_changes(compared) << " state changes\n"
+              << "  radix sort      " << radix_secs * 1000.0 / PASSES << "ms, "
+              << state_changes(sorted) << " state changes\n"
+              << "  unsorted        " << state_changes(unsorted) << " state changes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file   lldrawsortkey_test.cpp
+ * @date   2026-10-16
+ * @brief  Test for lldrawsortkey.h.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../lldrawsortkey.h"
+// STL headers
+// std headers
+#include <set>
+#include <vector>
+// external library headers
+// other Linden headers
+#include "llradixsort.h"
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct lldrawsortkey_data
+    {
+        // stand-ins for the objects a draw batch points at
+        std::vector<U64> mAvatars = std::vector<U64>(4);
+        std::vector<U64> mMaterials = std::vector<U64>(4);
+        std::vector<U64> mTextures = std::vector<U64>(16);
+        std::vector<U64> mMatrices = std::vector<U64>(16);
+        std::vector<U64> mBuffers = std::vector<U64>(64);
+
+        U64 key(U64 skin, const U64* material, const U64* texture, const U64* matrix, const U64* buffer)
+        {
+            return ll_draw_sort_key(skin, (uintptr_t) material, (uintptr_t) texture,
+                                    (uintptr_t) matrix, (uintptr_t) buffer);
+        }
+    };
+    typedef test_group<lldrawsortkey_data> lldrawsortkey_group;
+    typedef lldrawsortkey_group::object object;
+    lldrawsortkey_group lldrawsortkeygrp("lldrawsortkey");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("unskinned and unmaterialed batches sort first");
+
+        U64 plain = key(0, NULL, &mTextures[0], &mMatrices[0], &mBuffers[0]);
+        U64 materialed = key(0, &mMaterials[1], &mTextures[0], &mMatrices[0], &mBuffers[0]);
+        U64 skinned = key((uintptr_t) &mAvatars[1], NULL, &mTextures[0], &mMatrices[0], &mBuffers[0]);
+
+        ensure_equals("no skin bits", plain >> 52, 0ULL);
+        ensure_equals("no material bits", (plain >> 40) & 0xfff, 0ULL);
+        // a hash can land on zero, so equal keys are as good
+        ensure("material after plain", plain <= materialed);
+        ensure("skinned after unskinned", materialed <= skinned);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("same state, same key; each field in its own bits");
+
+        U64 a = key(0, &mMaterials[1], &mTextures[3], &mMatrices[5], &mBuffers[7]);
+        ensure_equals("deterministic", key(0, &mMaterials[1], &mTextures[3], &mMatrices[5], &mBuffers[7]), a);
+
+        U64 other_buffer = key(0, &mMaterials[1], &mTextures[3], &mMatrices[5], &mBuffers[8]);
+        ensure_equals("buffer only changes the low bits", other_buffer >> 16, a >> 16);
+
+        U64 other_texture = key(0, &mMaterials[1], &mTextures[4], &mMatrices[5], &mBuffers[7]);
+        ensure_equals("texture leaves material alone", other_texture >> 40, a >> 40);
+        ensure_equals("texture leaves matrix and buffer alone", other_texture & 0xffffff, a & 0xffffff);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("sorting by key groups batches by texture within a material");
+
+        typedef std::pair<U64, U32> entry_t;
+        std::vector<entry_t> entries;
+        std::vector<const U64*> textures;
+        for (U32 i = 0; i < 256; ++i)
+        {
+            const U64* texture = &mTextures[(i * 7) % mTextures.size()];
+            textures.push_back(texture);
+            entries.emplace_back(key(0, &mMaterials[1], texture, &mMatrices[i / 16], &mBuffers[i / 4]), i);
+        }
+
+        std::vector<entry_t> scratch(entries.size());
+        LL::radix_sort(entries.data(), entries.data() + entries.size(), scratch.data(),
+                       [](const entry_t& e) { return e.first; });
+
+        // every texture is bound in one run
+        std::set<U64> texture_bits;
+        U32 runs = 1;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            texture_bits.insert((entries[i].first >> 24) & 0xffff);
+            runs += i && textures[entries[i].second] != textures[entries[i - 1].second];
+        }
+        if (texture_bits.size() < mTextures.size())
+        {
+            // two textures share 16 hash bits and may interleave
+            return;
+        }
+        ensure_equals("one run per texture", runs, (U32) mTextures.size());
+    }
+} // namespace tut
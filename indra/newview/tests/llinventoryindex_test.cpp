@@ -0,0 +1,516 @@
+/**
+ * @file llinventoryindex_test.cpp
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "../llviewerprecompiledheaders.h"
+
+#include "../llinventoryindex.h"
+#include "../llinventoryfunctions.h"
+#include "../llviewerinventory.h"
+
+#include "../test/lltut.h"
+
+#include <map>
+#include <set>
+
+// Link seams.
+
+//-----------------------------------------------------------------------------
+// The index only reads ids, parents, names and types, which LLInventoryItem
+// and LLInventoryCategory hold.
+LLViewerInventoryItem::LLViewerInventoryItem(const LLUUID& item_id, const LLUUID& parent_id,
+                                             const std::string& name, LLInventoryType::EType inv_type)
+:   LLInventoryItem(),
+    mIsComplete(true)
+{
+    mUUID = item_id;
+    mParentUUID = parent_id;
+    mName = name;
+    mInventoryType = inv_type;
+}
+LLViewerInventoryItem::~LLViewerInventoryItem() {}
+LLAssetType::EType LLViewerInventoryItem::getType() const { return LLInventoryItem::getType(); }
+const LLUUID& LLViewerInventoryItem::getAssetUUID() const { return LLInventoryItem::getAssetUUID(); }
+const LLUUID& LLViewerInventoryItem::getProtectedAssetUUID() const { return LLUUID::null; }
+const std::string& LLViewerInventoryItem::getName() const { return LLInventoryItem::getName(); }
+S32 LLViewerInventoryItem::getSortField() const { return 0; }
+void LLViewerInventoryItem::getSLURL() {}
+const LLPermissions& LLViewerInventoryItem::getPermissions() const { return LLInventoryItem::getPermissions(); }
+const bool LLViewerInventoryItem::getIsFullPerm() const { return true; }
+const LLUUID& LLViewerInventoryItem::getCreatorUUID() const { return LLInventoryItem::getCreatorUUID(); }
+const std::string& LLViewerInventoryItem::getDescription() const { return LLInventoryItem::getDescription(); }
+const LLSaleInfo& LLViewerInventoryItem::getSaleInfo() const { return LLInventoryItem::getSaleInfo(); }
+const LLUUID& LLViewerInventoryItem::getThumbnailUUID() const { return LLUUID::null; }
+LLInventoryType::EType LLViewerInventoryItem::getInventoryType() const { return LLInventoryItem::getInventoryType(); }
+bool LLViewerInventoryItem::isWearableType() const { return false; }
+LLWearableType::EType LLViewerInventoryItem::getWearableType() const { return LLWearableType::WT_INVALID; }
+bool LLViewerInventoryItem::isSettingsType() const { return false; }
+LLSettingsType::type_e LLViewerInventoryItem::getSettingsType() const { return LLSettingsType::ST_NONE; }
+U32 LLViewerInventoryItem::getFlags() const { return LLInventoryItem::getFlags(); }
+time_t LLViewerInventoryItem::getCreationDate() const { return LLInventoryItem::getCreationDate(); }
+U32 LLViewerInventoryItem::getCRC32() const { return 0; }
+void LLViewerInventoryItem::copyItem(const LLInventoryItem* other) {}
+void LLViewerInventoryItem::updateParentOnServer(bool restamp) const {}
+void LLViewerInventoryItem::updateServer(bool is_new) const {}
+void LLViewerInventoryItem::packMessage(LLMessageSystem* msg) const {}
+bool LLViewerInventoryItem::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) { return false; }
+bool LLViewerInventoryItem::unpackMessage(const LLSD& item) { return false; }
+bool LLViewerInventoryItem::importLegacyStream(std::istream& input_stream) { return false; }
+void LLViewerInventoryItem::setTransactionID(const LLTransactionID& transaction_id) {}
+
+LLViewerInventoryCategory::LLViewerInventoryCategory(const LLUUID& uuid, const LLUUID& parent_uuid,
+                                                     LLFolderType::EType preferred_type,
+                                                     const std::string& name,
+                                                     const LLUUID& owner_id)
+:   LLInventoryCategory(uuid, parent_uuid, preferred_type, name),
+    mOwnerID(owner_id),
+    mVersion(VERSION_UNKNOWN),
+    mDescendentCount(DESCENDENT_COUNT_UNKNOWN),
+    mFetching(FETCH_NONE)
+{
+}
+LLViewerInventoryCategory::~LLViewerInventoryCategory() {}
+void LLViewerInventoryCategory::updateParentOnServer(bool restamp_children) const {}
+void LLViewerInventoryCategory::updateServer(bool is_new) const {}
+void LLViewerInventoryCategory::packMessage(LLMessageSystem* msg) const {}
+void LLViewerInventoryCategory::unpackMessage(LLMessageSystem* msg, const char* block, S32 block_num) {}
+bool LLViewerInventoryCategory::unpackMessage(const LLSD& category) { return false; }
+
+namespace
+{
+    // Hints like LLIsType: items of some asset types, no folders
+    class TypeCollector : public LLInventoryCollectFunctor
+    {
+    public:
+        TypeCollector(LLAssetType::EType type) : mType(type) {}
+        bool operator()(LLInventoryCategory* cat, LLInventoryItem* item)
+        {
+            return item && item->getActualType() == mType;
+        }
+        U64 getItemTypeMask() const { return getTypeBit(mType); }
+        bool acceptsCategories() const { return false; }
+
+    private:
+        LLAssetType::EType mType;
+    };
+
+    // Hints like the name filters: folders and items containing some text
+    class NameCollector : public LLInventoryCollectFunctor
+    {
+    public:
+        NameCollector(const std::string& text) : mText(text) {}
+        bool operator()(LLInventoryCategory* cat, LLInventoryItem* item)
+        {
+            std::string name = cat ? cat->getName() : item->getName();
+            LLStringUtil::toLower(name);
+            return name.find(mText) != std::string::npos;
+        }
+        const std::string& getNameHint() const { return mText; }
+
+    private:
+        std::string mText;
+    };
+
+    // No hints at all
+    class EveryCollector : public LLInventoryCollectFunctor
+    {
+    public:
+        bool operator()(LLInventoryCategory* cat, LLInventoryItem* item) { return true; }
+    };
+}
+
+namespace tut
+{
+    struct inventoryindex
+    {
+        typedef std::map<LLUUID, LLPointer<LLViewerInventoryCategory> > cat_map_t;
+        typedef std::map<LLUUID, LLPointer<LLViewerInventoryItem> > item_map_t;
+
+        LLInventoryIndex mIndex;
+        cat_map_t mCategories;
+        item_map_t mItems;
+        LLUUID mRootID;
+        LLUUID mTrashID;
+        U32 mSeed = 1;
+        U32 mNextID = 1;
+
+        inventoryindex()
+        {
+            mRootID = addCategory(LLUUID::null, "My Inventory");
+            mTrashID = addCategory(mRootID, "Trash");
+        }
+
+        U32 random(U32 range)
+        {
+            mSeed = mSeed * 1664525 + 1013904223;
+            return (mSeed >> 8) % range;
+        }
+
+        LLUUID newID()
+        {
+            LLUUID id;
+            id.mData[0] = 1;
+            memcpy(&id.mData[12], &mNextID, sizeof(mNextID));
+            ++mNextID;
+            return id;
+        }
+
+        // What LLInventoryModel does after every change: hand the index the
+        // current object for the id, or nothing once it is gone
+        void apply(const LLUUID& id)
+        {
+            cat_map_t::iterator cat = mCategories.find(id);
+            item_map_t::iterator item = mItems.find(id);
+            mIndex.update(id,
+                          cat != mCategories.end() ? cat->second.get() : NULL,
+                          item != mItems.end() ? item->second.get() : NULL);
+        }
+
+        LLUUID addCategory(const LLUUID& parent_id, const std::string& name)
+        {
+            LLUUID id = newID();
+            mCategories[id] = new LLViewerInventoryCategory(id, parent_id, LLFolderType::FT_NONE, name, LLUUID::null);
+            apply(id);
+            return id;
+        }
+
+        LLUUID addItem(const LLUUID& parent_id, const std::string& name, LLAssetType::EType type)
+        {
+            LLUUID id = newID();
+            LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem(id, parent_id, name, LLInventoryType::IT_NONE);
+            item->setType(type);
+            mItems[id] = item;
+            apply(id);
+            return id;
+        }
+
+        LLInventoryObject* getObject(const LLUUID& id)
+        {
+            cat_map_t::iterator cat = mCategories.find(id);
+            if (cat != mCategories.end())
+            {
+                return cat->second;
+            }
+            return mItems[id];
+        }
+
+        void move(const LLUUID& id, const LLUUID& parent_id)
+        {
+            getObject(id)->setParent(parent_id);
+            apply(id);
+        }
+
+        void rename(const LLUUID& id, const std::string& name)
+        {
+            getObject(id)->rename(name);
+            apply(id);
+        }
+
+        // Removes id and everything under it, children first
+        void remove(const LLUUID& id)
+        {
+            if (mCategories.count(id))
+            {
+                std::vector<LLUUID> children;
+                for (const auto& [child_id, cat] : mCategories)
+                {
+                    if (cat->getParentUUID() == id)
+                    {
+                        children.push_back(child_id);
+                    }
+                }
+                for (const auto& [child_id, item] : mItems)
+                {
+                    if (item->getParentUUID() == id)
+                    {
+                        children.push_back(child_id);
+                    }
+                }
+                for (const LLUUID& child_id : children)
+                {
+                    remove(child_id);
+                }
+            }
+            mCategories.erase(id);
+            mItems.erase(id);
+            apply(id);
+        }
+
+        bool isAncestor(const LLUUID& ancestor_id, const LLUUID& id)
+        {
+            for (LLUUID cur = id; cur.notNull(); cur = getObject(cur)->getParentUUID())
+            {
+                if (cur == ancestor_id)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // The tree walk of LLInventoryModel::collectDescendentsIf()
+        void walk(const LLUUID& id, const LLUUID& exclude_id, LLInventoryCollectFunctor& add,
+                  std::set<LLUUID>& found)
+        {
+            if (id == exclude_id)
+            {
+                return;
+            }
+            for (const auto& [cat_id, cat] : mCategories)
+            {
+                if (cat->getParentUUID() == id)
+                {
+                    if (add(cat, NULL))
+                    {
+                        found.insert(cat_id);
+                    }
+                    walk(cat_id, exclude_id, add, found);
+                }
+            }
+            for (const auto& [item_id, item] : mItems)
+            {
+                if (item->getParentUUID() == id && add(NULL, item))
+                {
+                    found.insert(item_id);
+                }
+            }
+        }
+
+        void ensure_same_as_walk(const std::string& msg, const LLUUID& id, const LLUUID& exclude_id,
+                                 LLInventoryCollectFunctor& add)
+        {
+            std::set<LLUUID> expected;
+            walk(id, exclude_id, add, expected);
+
+            LLInventoryIndex::cat_array_t cats;
+            LLInventoryIndex::item_array_t items;
+            ensure(msg + " indexed", mIndex.collectDescendentsIf(id, exclude_id, add, cats, items));
+
+            std::set<LLUUID> found;
+            for (const auto& cat : cats)
+            {
+                ensure(msg + " folder found once", found.insert(cat->getUUID()).second);
+            }
+            for (const auto& item : items)
+            {
+                ensure(msg + " item found once", found.insert(item->getUUID()).second);
+            }
+            ensure_equals(msg + " count", found.size(), expected.size());
+            ensure(msg + " same objects", found == expected);
+        }
+
+        void ensure_all_same_as_walk(const std::string& msg)
+        {
+            ensure_equals(msg + " size", mIndex.size(), mCategories.size() + mItems.size());
+
+            TypeCollector notecards(LLAssetType::AT_NOTECARD);
+            TypeCollector objects(LLAssetType::AT_OBJECT);
+            NameCollector red("red");
+            NameCollector blue_box("blue box");
+            EveryCollector every;
+            LLInventoryCollectFunctor* functors[] = { &notecards, &objects, &red, &blue_box, &every };
+
+            // the root with and without the trash, and a few folders
+            std::vector<LLUUID> roots = { mRootID };
+            for (const auto& [cat_id, cat] : mCategories)
+            {
+                if (cat_id != mRootID && roots.size() < 6 && (cat_id == mTrashID || random(4) == 0))
+                {
+                    roots.push_back(cat_id);
+                }
+            }
+
+            for (size_t f = 0; f < LL_ARRAY_SIZE(functors); ++f)
+            {
+                for (const LLUUID& root : roots)
+                {
+                    const std::string where = llformat("%s functor %d root %s", msg.c_str(), (S32)f, root.asString().c_str());
+                    ensure_same_as_walk(where, root, LLUUID::null, *functors[f]);
+                    ensure_same_as_walk(where + " without trash", root, mTrashID, *functors[f]);
+                }
+            }
+        }
+
+        std::string randomName()
+        {
+            static const char* const words[] = { "Red", "blue", "Box", "shirt", "Hair", "notes", "redwood", "BLUE BOX" };
+            std::string name;
+            for (U32 i = 0, count = 1 + random(3); i < count; ++i)
+            {
+                name += i ? " " : "";
+                name += words[random((U32)LL_ARRAY_SIZE(words))];
+            }
+            return name;
+        }
+
+        LLAssetType::EType randomType()
+        {
+            static const LLAssetType::EType types[] = { LLAssetType::AT_NOTECARD, LLAssetType::AT_OBJECT,
+                                                        LLAssetType::AT_CLOTHING, LLAssetType::AT_LINK };
+            return types[random((U32)LL_ARRAY_SIZE(types))];
+        }
+
+        template<typename MAP>
+        LLUUID randomID(const MAP& map)
+        {
+            typename MAP::const_iterator iter = map.begin();
+            std::advance(iter, random((U32)map.size()));
+            return iter->first;
+        }
+    };
+
+    typedef test_group<inventoryindex> inventoryindex_t;
+    typedef inventoryindex_t::object inventoryindex_object_t;
+    tut::inventoryindex_t tut_inventoryindex("LLInventoryIndex");
+
+    // adds, moves, renames and removes keep the index matching the tree
+    template<> template<>
+    void inventoryindex_object_t::test<1>()
+    {
+        LLUUID clothes = addCategory(mRootID, "Clothes");
+        LLUUID red_shirts = addCategory(clothes, "Red shirts");
+        LLUUID shirt = addItem(red_shirts, "Red shirt", LLAssetType::AT_CLOTHING);
+        LLUUID note = addItem(clothes, "Blue box notes", LLAssetType::AT_NOTECARD);
+        addItem(mTrashID, "Red notes", LLAssetType::AT_NOTECARD);
+        addItem(mRootID, "Link to red shirt", LLAssetType::AT_LINK);
+        ensure_all_same_as_walk("added");
+
+        move(note, mTrashID);
+        ensure_all_same_as_walk("note trashed");
+        move(red_shirts, mRootID);
+        ensure_all_same_as_walk("folder moved up");
+
+        rename(shirt, "Green shirt");
+        rename(clothes, "Blue box of clothes");
+        ensure_all_same_as_walk("renamed");
+
+        remove(red_shirts);
+        ensure_all_same_as_walk("folder removed");
+        remove(mTrashID);
+        ensure_all_same_as_walk("trash emptied");
+    }
+
+    // contents that arrive before their folder, as when the cache is loaded,
+    // are adopted by it
+    template<> template<>
+    void inventoryindex_object_t::test<2>()
+    {
+        LLUUID folder_id = newID();
+        LLUUID sub_id = newID();
+        mCategories[sub_id] = new LLViewerInventoryCategory(sub_id, folder_id, LLFolderType::FT_NONE, "Red stuff", LLUUID::null);
+        apply(sub_id);
+        addItem(sub_id, "Red notes", LLAssetType::AT_NOTECARD);
+        addItem(folder_id, "Blue box", LLAssetType::AT_OBJECT);
+
+        LLInventoryIndex::cat_array_t cats;
+        LLInventoryIndex::item_array_t items;
+        EveryCollector every;
+        ensure("missing folder not indexed", !mIndex.collectDescendentsIf(folder_id, LLUUID::null, every, cats, items));
+        ensure_same_as_walk("orphans not under the root", mRootID, LLUUID::null, every);
+
+        mCategories[folder_id] = new LLViewerInventoryCategory(folder_id, mRootID, LLFolderType::FT_NONE, "Boxes", LLUUID::null);
+        apply(folder_id);
+        ensure_all_same_as_walk("adopted");
+
+        // a folder replaced by an item leaves its contents waiting again
+        mCategories.erase(folder_id);
+        LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem(folder_id, mRootID, "Boxes", LLInventoryType::IT_NONE);
+        item->setType(LLAssetType::AT_OBJECT);
+        mItems[folder_id] = item;
+        apply(folder_id);
+        ensure_same_as_walk("replaced by an item", mRootID, LLUUID::null, every);
+    }
+
+    // a long random sequence, enough renames for the name index to be
+    // rebuilt on the way
+    template<> template<>
+    void inventoryindex_object_t::test<3>()
+    {
+        std::vector<LLUUID> folders = { mRootID };
+        for (S32 i = 0; i < 40; ++i)
+        {
+            folders.push_back(addCategory(folders[random((U32)folders.size())], randomName()));
+        }
+        for (S32 i = 0; i < 400; ++i)
+        {
+            addItem(folders[random((U32)folders.size())], randomName(), randomType());
+        }
+        ensure_all_same_as_walk("built");
+
+        for (S32 step = 0; step < 3000; ++step)
+        {
+            switch (random(8))
+            {
+            case 0:
+                addItem(randomID(mCategories), randomName(), randomType());
+                break;
+            case 1:
+                addCategory(randomID(mCategories), randomName());
+                break;
+            case 2:
+            {
+                // never into its own subtree, never the root
+                LLUUID id = randomID(mCategories);
+                LLUUID parent_id = randomID(mCategories);
+                if (id != mRootID && id != mTrashID && !isAncestor(id, parent_id))
+                {
+                    move(id, parent_id);
+                }
+                break;
+            }
+            case 3:
+                move(randomID(mItems), randomID(mCategories));
+                break;
+            case 4:
+            {
+                LLUUID id = randomID(mCategories);
+                if (id != mRootID && id != mTrashID && random(4) == 0)
+                {
+                    remove(id);
+                }
+                break;
+            }
+            case 5:
+                if (mItems.size() > 100)
+                {
+                    remove(randomID(mItems));
+                }
+                break;
+            default:
+                rename(random(2) ? randomID(mItems) : randomID(mCategories), randomName() + " " + randomName());
+                break;
+            }
+
+            if (step % 250 == 0)
+            {
+                ensure_all_same_as_walk(llformat("step %d", step));
+            }
+        }
+        ensure_all_same_as_walk("done");
+
+        mIndex.clear();
+        ensure_equals("cleared", mIndex.size(), (size_t)0);
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * @file llobjectkinematics_test.cpp
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llobjectkinematics.h"
+
+#include <vector>
+
+// Read by LLObjectKinematics::getIdleMotion(), which needs a live object
+bool LLViewerObject::sVelocityInterpolate = true;
+
+namespace tut
+{
+    struct objectkinematics
+    {
+        static const S32 NUM_SLOTS = 4001;  // leaves the last block part full
+
+        struct Motion
+        {
+            LLVector3   mVelocity;
+            LLVector3   mAcceleration;
+            LLVector3   mAngularVelocity;
+            F64Seconds  mLastUpdate;
+        };
+
+        const F64 mFrameTime = 1000.0;
+        std::vector<Motion> mMotions;
+        LLObjectKinematics mKinematics;
+        U32 mSeed = 1;
+
+        F32 random()
+        {
+            mSeed = mSeed * 1664525 + 1013904223;
+            return (F32)(mSeed >> 8) / (F32)(1 << 24);
+        }
+
+        LLVector3 randomVector(F32 scale)
+        {
+            return LLVector3(random() - 0.5f, random() - 0.5f, random() - 0.5f) * scale;
+        }
+
+        objectkinematics()
+        {
+            // Deterministic so failures reproduce. Some objects don't spin,
+            // some spin below the threshold and some sit still.
+            for (S32 i = 0; i < NUM_SLOTS; i++)
+            {
+                Motion motion;
+                motion.mVelocity = randomVector(20.f);
+                motion.mAcceleration = randomVector(10.f);
+                switch (i % 5)
+                {
+                case 0:
+                    break;
+                case 1:
+                    motion.mAngularVelocity = randomVector(0.001f);
+                    break;
+                case 2:
+                    motion.mVelocity.clear();
+                    motion.mAcceleration.clear();
+                    break;
+                default:
+                    motion.mAngularVelocity = randomVector(6.f);
+                    break;
+                }
+                motion.mLastUpdate = F64Seconds(mFrameTime - random() * 0.5);
+                mMotions.push_back(motion);
+
+                S32 slot = mKinematics.pushSlot();
+                ensure_equals("slots are appended", slot, i);
+                setMotion(slot, motion);
+            }
+        }
+
+        void setMotion(S32 slot, const Motion& motion)
+        {
+            mKinematics.setMotion(slot, motion.mVelocity, motion.mAcceleration, motion.mAngularVelocity,
+                                  motion.mLastUpdate, NULL);
+        }
+
+        // What LLViewerObject::predictIdleMotion() and interpolateLinearMotion()
+        // work out one object at a time
+        void ensure_scalar_motion(const std::string& msg, S32 slot, const Motion& motion)
+        {
+            LLViewerObject::IdleMotion predicted;
+            ensure(msg + " predicted", mKinematics.getPredictedMotion(slot, predicted));
+
+            F32 dt = 1.0f * (F32)((F64Seconds)mFrameTime - motion.mLastUpdate).value();
+            LLVector3 delta_pos;
+            LLVector3 delta_vel;
+            LLViewerObject::predictLinearMotion(motion.mVelocity, motion.mAcceleration, dt, delta_pos, delta_vel);
+            LLQuaternion delta_rot;
+            bool rotate = LLViewerObject::getAngularVelocityRot(motion.mAngularVelocity, dt, delta_rot);
+
+            ensure(msg + " interpolates", predicted.mInterpolate);
+            ensure(msg + " linear motion predicted", predicted.mPredictedLinear);
+            ensure_equals(msg + " dt", predicted.mDt, dt);
+            ensure_equals(msg + " position", predicted.mDeltaPos, delta_pos);
+            ensure_equals(msg + " velocity", predicted.mDeltaVel, delta_vel);
+            ensure_equals(msg + " rotates", predicted.mRotate, rotate);
+            if (rotate)
+            {
+                ensure_equals(msg + " rotation", predicted.mDeltaRot, delta_rot);
+            }
+        }
+    };
+
+    typedef test_group<objectkinematics> objectkinematics_t;
+    typedef objectkinematics_t::object objectkinematics_object_t;
+    tut::objectkinematics_t tut_objectkinematics("LLObjectKinematics");
+
+    // predict() gives the scalar results bit for bit
+    template<> template<>
+    void objectkinematics_object_t::test<1>()
+    {
+        ensure_equals("slots", mKinematics.size(), NUM_SLOTS);
+        ensure_equals("blocks", mKinematics.getNumBlocks(), (NUM_SLOTS + 3) / 4);
+
+        LLViewerObject::IdleMotion motion;
+        ensure("nothing predicted yet", !mKinematics.getPredictedMotion(0, motion));
+
+        mKinematics.predict(mFrameTime, 0, mKinematics.getNumBlocks());
+        for (S32 slot = 0; slot < NUM_SLOTS; slot++)
+        {
+            ensure_scalar_motion(llformat("slot %d", slot), slot, mMotions[slot]);
+        }
+        ensure("past the end", !mKinematics.getPredictedMotion(NUM_SLOTS, motion));
+    }
+
+    // predicting block ranges separately, as the workers do, is the same as
+    // predicting them all at once
+    template<> template<>
+    void objectkinematics_object_t::test<2>()
+    {
+        S32 num_blocks = mKinematics.getNumBlocks();
+        mKinematics.predict(mFrameTime, num_blocks / 2, num_blocks);
+        mKinematics.predict(mFrameTime, 0, num_blocks / 2);
+        for (S32 slot = 0; slot < NUM_SLOTS; slot++)
+        {
+            ensure_scalar_motion(llformat("slot %d", slot), slot, mMotions[slot]);
+        }
+
+        // a new motion state waits for the next prediction
+        setMotion(7, mMotions[8]);
+        LLViewerObject::IdleMotion motion;
+        ensure("stale prediction dropped", !mKinematics.getPredictedMotion(7, motion));
+        mKinematics.predict(mFrameTime, 7 / 4, 7 / 4 + 1);
+        ensure_scalar_motion("repredicted", 7, mMotions[8]);
+    }
+
+    // removing a slot moves the last one into it, the lanes of every channel
+    // and the prediction move together
+    template<> template<>
+    void objectkinematics_object_t::test<3>()
+    {
+        mKinematics.predict(mFrameTime, 0, mKinematics.getNumBlocks());
+
+        // the same swap-remove LLViewerObjectList::removeFromActiveList() does
+        std::vector<S32> removals = { 5, 0, NUM_SLOTS - 3, 2, 1000 };
+        for (S32 slot : removals)
+        {
+            mKinematics.remove(slot);
+            mMotions[slot] = mMotions.back();
+            mMotions.pop_back();
+        }
+        ensure_equals("slots", mKinematics.size(), (S32)mMotions.size());
+
+        // the last block held a single slot and went away
+        ensure_equals("blocks", mKinematics.getNumBlocks(), (NUM_SLOTS - (S32)removals.size() + 3) / 4);
+
+        for (S32 slot = 0; slot < mKinematics.size(); slot++)
+        {
+            ensure_scalar_motion(llformat("slot %d", slot), slot, mMotions[slot]);
+        }
+
+        // the last slot goes without moving anything
+        mKinematics.remove(mKinematics.size() - 1);
+        mMotions.pop_back();
+        ensure_scalar_motion("after removing the last", mKinematics.size() - 1, mMotions.back());
+
+        // and a slot pushed into the freed lanes starts unpredicted
+        S32 slot = mKinematics.pushSlot();
+        LLViewerObject::IdleMotion motion;
+        ensure("new slot unpredicted", !mKinematics.getPredictedMotion(slot, motion));
+    }
+
+    template<> template<>
+    void objectkinematics_object_t::test<4>()
+    {
+        mKinematics.clear();
+        ensure_equals("no slots", mKinematics.size(), 0);
+        ensure_equals("no blocks", mKinematics.getNumBlocks(), 0);
+        mKinematics.predict(mFrameTime, 0, mKinematics.getNumBlocks());
+
+        S32 slot = mKinematics.pushSlot();
+        setMotion(slot, mMotions[3]);
+        mKinematics.predict(mFrameTime, 0, mKinematics.getNumBlocks());
+        ensure_scalar_motion("after clear", slot, mMotions[3]);
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * @file llperfcostmodel_test.cpp
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llperfcostmodel.h"
+
+namespace tut
+{
+    struct perfcostmodel
+    {
+        typedef LLPerfCostModel::Settings Settings;
+
+        // frame time of a synthetic scene with known costs
+        static F32 frameTime(const Settings& s)
+        {
+            const F32 far_clip = s.farClip / 256.f;
+            return 4.f + 3.f * far_clip * far_clip + 2.f * s.shadowDetail
+                 + 1.f * (s.reflectionDetail + 1) + s.avatarMs;
+        }
+
+        void train(LLPerfCostModel& model, U32 count)
+        {
+            // deterministic sweep over every setting with a little jitter
+            for (U32 i = 0; i < count; ++i)
+            {
+                Settings s;
+                s.farClip = 64.f + (F32)((i * 37) % 449);
+                s.shadowDetail = i % 3;
+                s.reflectionDetail = (S32)((i / 3) % 3) - 1;
+                s.avatarMs = (F32)((i * 7) % 5);
+                const F32 jitter = ((S32)((i * 13) % 7) - 3) * 0.05f;
+                model.addSample(s, frameTime(s) + jitter);
+            }
+        }
+
+        static Settings current()
+        {
+            Settings s;
+            s.farClip = 256.f;
+            s.shadowDetail = 2;
+            s.reflectionDetail = 1;
+            s.avatarMs = 2.f;
+            return s;
+        }
+
+        static LLPerfCostModel::Limits limits()
+        {
+            LLPerfCostModel::Limits l;
+            l.minFarClip = 64.f;
+            l.maxFarClip = 512.f;
+            l.maxShadowDetail = 2;
+            l.maxReflectionDetail = 1;
+            return l;
+        }
+    };
+    typedef test_group<perfcostmodel> perfcostmodel_t;
+    typedef perfcostmodel_t::object perfcostmodel_object_t;
+    tut::perfcostmodel_t tut_perfcostmodel("LLPerfCostModel");
+
+    template<> template<>
+    void perfcostmodel_object_t::test<1>()
+    {
+        set_test_name("learns the cost of each setting");
+        LLPerfCostModel model;
+        train(model, 600);
+        ensure("trained", model.isTrained());
+        ensure_approximately_equals("bias", (F32)model.getWeight(LLPerfCostModel::FEATURE_BIAS), 4.f, 4);
+        ensure_approximately_equals("far clip", (F32)model.getWeight(LLPerfCostModel::FEATURE_FAR_CLIP), 3.f, 4);
+        ensure_approximately_equals("shadows", (F32)model.getWeight(LLPerfCostModel::FEATURE_SHADOWS), 2.f, 4);
+        ensure_approximately_equals("avatars", (F32)model.getWeight(LLPerfCostModel::FEATURE_AVATARS), 1.f, 4);
+        ensure_approximately_equals("prediction", model.predict(current()), frameTime(current()), 4);
+    }
+
+    template<> template<>
+    void perfcostmodel_object_t::test<2>()
+    {
+        set_test_name("no decisions before training");
+        LLPerfCostModel model;
+        Settings next;
+        ensure_equals(model.choose(current(), 40.f, 16.f, limits(), next), LLPerfCostModel::DECISION_UNTRAINED);
+        ensure_equals("unchanged", next.farClip, current().farClip);
+    }
+
+    template<> template<>
+    void perfcostmodel_object_t::test<3>()
+    {
+        set_test_name("solves draw distance for the target");
+        LLPerfCostModel model;
+        train(model, 600);
+        Settings next;
+
+        // inside the dead band nothing changes
+        const F32 frame_ms = frameTime(current());
+        ensure_equals(model.choose(current(), frame_ms, frame_ms * 1.05f, limits(), next), LLPerfCostModel::DECISION_HOLD);
+
+        // a little slow: one step straight to the predicted draw distance
+        const F32 target_ms = frame_ms - 1.5f;
+        ensure_equals(model.choose(current(), frame_ms, target_ms, limits(), next), LLPerfCostModel::DECISION_FAR_CLIP_DOWN);
+        ensure("draw distance reduced", next.farClip < current().farClip);
+        ensure_approximately_equals("hits target", frameTime(next), target_ms, 4);
+
+        // fast: raise draw distance but stay under the target
+        const F32 relaxed_ms = frame_ms + 4.f;
+        ensure_equals(model.choose(current(), frame_ms, relaxed_ms, limits(), next), LLPerfCostModel::DECISION_FAR_CLIP_UP);
+        ensure("draw distance raised", next.farClip > current().farClip);
+        ensure("below target", frameTime(next) < relaxed_ms);
+    }
+
+    template<> template<>
+    void perfcostmodel_object_t::test<4>()
+    {
+        set_test_name("trades reflections then shadows at minimum draw distance");
+        LLPerfCostModel model;
+        train(model, 600);
+        Settings cur = current();
+        cur.farClip = limits().minFarClip;
+        Settings next;
+
+        ensure_equals(model.choose(cur, 40.f, 16.f, limits(), next), LLPerfCostModel::DECISION_REFLECTIONS_DOWN);
+        ensure_equals(next.reflectionDetail, 0);
+
+        cur.reflectionDetail = -1;
+        ensure_equals(model.choose(cur, 40.f, 16.f, limits(), next), LLPerfCostModel::DECISION_SHADOWS_DOWN);
+        ensure_equals(next.shadowDetail, 1);
+
+        // and restores shadows first once there is room
+        cur.shadowDetail = 0;
+        ensure_equals(model.choose(cur, 8.f, 16.f, limits(), next), LLPerfCostModel::DECISION_SHADOWS_UP);
+        ensure_equals(next.shadowDetail, 1);
+    }
+}
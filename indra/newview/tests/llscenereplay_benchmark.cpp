@@ -0,0 +1,119 @@
+/**
+ * @file   llscenereplay_benchmark.cpp
+ * @date   2026-10-16
+ * @brief  Times rebuilding, culling and sorting a scene recording through
+ *         LLSceneReplay. Pass the scene_recording.llsd saved with
+ *         SceneRecordingFrames, or nothing for a synthetic scene. Built when
+ *         LL_BENCHMARKS is set, run by hand.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Copyright (c) 2026, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llscenereplay.h"
+
+#include <iostream>
+
+#include "llscenereplay_stub.cpp"
+
+namespace
+{
+    U32 sSeed = 1;
+
+    F32 next_random()
+    {
+        sSeed = sSeed * 1664525 + 1013904223;
+        return (F32)(sSeed >> 8) / (F32)(1 << 24);
+    }
+
+    // A region full of boxes in a few partitions and a camera circling it
+    // looking outwards, with corners computed as
+    // LLViewerCamera::updateFrustumPlanes() does
+    void make_scene(LLSceneRecording& recording)
+    {
+        const U32 NUM_PARTITIONS = 4;
+        const U32 NUM_ELEMENTS = 25000;
+        const U32 NUM_FRAMES = 120;
+
+        for (U32 type = 0; type < NUM_PARTITIONS; type++)
+        {
+            LLSceneRecording::Partition& partition = recording.addPartition(0, type);
+            for (U32 i = 0; i < NUM_ELEMENTS; i++)
+            {
+                LLVector4a center(next_random() * 256.f, next_random() * 256.f, next_random() * 64.f);
+                F32 radius = 0.1f + next_random() * 8.f;
+                LLVector4a size(radius);
+                LLVector4a extents[2];
+                extents[0].setSub(center, size);
+                extents[1].setAdd(center, size);
+                partition.addElement(extents, center, radius, i % 16);
+            }
+        }
+
+        LLCamera camera(1.f, 1.5f, 768, 0.5f, 128.f);
+        for (U32 f = 0; f < NUM_FRAMES; f++)
+        {
+            F32 angle = f * F_TWO_PI / NUM_FRAMES;
+            LLVector3 at(cosf(angle), sinf(angle), -0.2f);
+            LLVector3 left(-sinf(angle), cosf(angle), 0.f);
+            at.normVec();
+            LLVector3 up = at % left;
+            up.normVec();
+            LLVector3 origin(128.f - 40.f * sinf(angle), 128.f + 40.f * cosf(angle), 40.f);
+            camera.setOrigin(origin);
+            camera.setAxes(at, left, up);
+
+            F32 half_height = tanf(camera.getView() * 0.5f) * camera.getNear();
+            F32 half_width = half_height * camera.getAspect();
+            LLVector3 near_center = origin + at * camera.getNear();
+            LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM];
+            frust[0] = near_center + left * half_width - up * half_height;
+            frust[1] = near_center - left * half_width - up * half_height;
+            frust[2] = near_center - left * half_width + up * half_height;
+            frust[3] = near_center + left * half_width + up * half_height;
+            for (S32 i = 0; i < 4; i++)
+            {
+                LLVector3 vec = frust[i] - origin;
+                vec.normVec();
+                frust[i + 4] = origin + vec * camera.getFar();
+            }
+            camera.calcAgentFrustumPlanes(frust);
+            recording.addFrame(camera, NULL);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const U32 PASSES = 5;
+
+    LLSceneRecording recording;
+    if (argc > 1)
+    {
+        if (!recording.load(argv[1]))
+        {
+            std::cerr << "Unable to load scene recording " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        make_scene(recording);
+    }
+
+    LLSceneReplay replay(recording);
+    LLSceneReplay::Stats stats = replay.run(PASSES);
+
+    const F64 frames = llmax(stats.mFrames, 1U);
+    std::cout << recording.getNumElements() << " octree entries in " << recording.mPartitions.size()
+              << " partitions, " << recording.mFrames.size() << " frames, " << PASSES << " passes:\n"
+              << "  rebuild " << stats.mRebuildSecs * 1000.0 / PASSES << "ms per pass\n"
+              << "  cull    " << stats.mCullSecs * 1000.0 / frames << "ms per frame\n"
+              << "  sort    " << stats.mSortSecs * 1000.0 / frames << "ms per frame\n"
+              << "  " << stats.mVisibleGroups / frames << " groups, "
+              << stats.mVisibleElements / frames << " elements visible per frame" << std::endl;
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file llscenereplay_test.cpp
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "../llscenereplay.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "llscenereplay_stub.cpp"
+
+namespace tut
+{
+    struct scenereplay
+    {
+        static const S32 NUM_ELEMENTS = 5000;
+        static const S32 NUM_FRAMES = 40;
+
+        LLSceneRecording mRecording;
+
+        scenereplay()
+        {
+            // Two partitions of boxes scattered over a region, deterministic
+            // so failures reproduce
+            U32 seed = 1;
+            auto random = [&seed]()
+            {
+                seed = seed * 1664525 + 1013904223;
+                return (F32)(seed >> 8) / (F32)(1 << 24);
+            };
+
+            for (U32 type = 0; type < 2; type++)
+            {
+                LLSceneRecording::Partition& partition = mRecording.addPartition(0, type);
+                for (S32 i = 0; i < NUM_ELEMENTS; i++)
+                {
+                    LLVector4a center(random() * 256.f, random() * 256.f, random() * 64.f);
+                    F32 radius = 0.1f + random() * 8.f;
+                    LLVector4a size(radius);
+                    LLVector4a extents[2];
+                    extents[0].setSub(center, size);
+                    extents[1].setAdd(center, size);
+                    partition.addElement(extents, center, radius, i % 5);
+                }
+            }
+
+            // A camera circling the region looking outwards, with corners
+            // computed as LLViewerCamera::updateFrustumPlanes() does
+            LLCamera camera(1.f, 1.5f, 768, 0.5f, 96.f);
+            for (S32 f = 0; f < NUM_FRAMES; f++)
+            {
+                F32 angle = f * F_TWO_PI / NUM_FRAMES;
+                LLVector3 at(cosf(angle), sinf(angle), -0.2f);
+                LLVector3 left(-sinf(angle), cosf(angle), 0.f);
+                at.normVec();
+                LLVector3 up = at % left;
+                up.normVec();
+                LLVector3 origin(128.f - 40.f * sinf(angle), 128.f + 40.f * cosf(angle), 40.f);
+                camera.setOrigin(origin);
+                camera.setAxes(at, left, up);
+
+                F32 half_height = tanf(camera.getView() * 0.5f) * camera.getNear();
+                F32 half_width = half_height * camera.getAspect();
+                LLVector3 near_center = origin + at * camera.getNear();
+                LLVector3 frust[LLCamera::AGENT_FRUSTRUM_NUM];
+                frust[0] = near_center + left * half_width - up * half_height;
+                frust[1] = near_center - left * half_width - up * half_height;
+                frust[2] = near_center - left * half_width + up * half_height;
+                frust[3] = near_center + left * half_width + up * half_height;
+                for (S32 i = 0; i < 4; i++)
+                {
+                    LLVector3 vec = frust[i] - origin;
+                    vec.normVec();
+                    frust[i + 4] = origin + vec * camera.getFar();
+                }
+                camera.calcAgentFrustumPlanes(frust);
+                mRecording.addFrame(camera, NULL);
+            }
+        }
+    };
+
+    typedef test_group<scenereplay> scenereplay_t;
+    typedef scenereplay_t::object scenereplay_object_t;
+    tut::scenereplay_t tut_scenereplay("LLSceneReplay");
+
+    // every element well inside the frustum survives culling
+    template<> template<>
+    void scenereplay_object_t::test<1>()
+    {
+        LLSceneReplay replay(mRecording);
+        replay.rebuild();
+
+        LLCamera camera;
+        std::vector<LLSceneReplay::Visible> visible;
+        for (const LLSceneRecording::Frame& frame : mRecording.mFrames)
+        {
+            LLSceneRecording::setupCamera(frame, camera);
+            visible.clear();
+            U32 groups = replay.cull(camera, visible);
+            ensure("something visible", groups > 0 && !visible.empty());
+
+            std::vector<const LLSceneRecording::Element*> found;
+            for (const LLSceneReplay::Visible& v : visible)
+            {
+                found.push_back(v.mElement);
+            }
+            std::sort(found.begin(), found.end());
+
+            for (const LLSceneRecording::Partition& partition : mRecording.mPartitions)
+            {
+                for (const LLSceneRecording::Element& element : partition.mElements)
+                {
+                    LLVector4a center, size;
+                    center.setAdd(element.mExtents[0], element.mExtents[1]);
+                    center.mul(0.5f);
+                    size.setSub(element.mExtents[1], element.mExtents[0]);
+                    size.mul(0.5f);
+                    LLVector3 offset = LLVector3(center.getF32ptr()) - frame.mOrigin;
+                    if (camera.AABBInFrustumNoFarClip(center, size) == 2
+                        && offset.magVec() + size[0] * 2.f < camera.mFrustumCornerDist)
+                    {
+                        ensure("visible element culled", std::binary_search(found.begin(), found.end(), &element));
+                    }
+                }
+            }
+        }
+    }
+
+    // a recording read back from LLSD replays the same
+    template<> template<>
+    void scenereplay_object_t::test<2>()
+    {
+        LLSceneRecording copy;
+        ensure("recording parsed", copy.fromLLSD(mRecording.asLLSD()));
+        ensure_equals("frame count", copy.mFrames.size(), mRecording.mFrames.size());
+        ensure_equals("element count", copy.getNumElements(), mRecording.getNumElements());
+
+        LLSceneReplay replay(mRecording);
+        LLSceneReplay replay_copy(copy);
+        replay.rebuild();
+        replay_copy.rebuild();
+
+        LLCamera camera;
+        LLCamera camera_copy;
+        std::vector<LLSceneReplay::Visible> visible;
+        std::vector<LLSceneReplay::Visible> visible_copy;
+        for (size_t f = 0; f < mRecording.mFrames.size(); f++)
+        {
+            LLSceneRecording::setupCamera(mRecording.mFrames[f], camera);
+            LLSceneRecording::setupCamera(copy.mFrames[f], camera_copy);
+            visible.clear();
+            visible_copy.clear();
+            ensure_equals("visible groups", replay_copy.cull(camera_copy, visible_copy), replay.cull(camera, visible));
+            ensure_equals("visible elements", visible_copy.size(), visible.size());
+            for (size_t i = 0; i < visible.size(); i++)
+            {
+                ensure_equals("distance", visible_copy[i].mDistance, visible[i].mDistance);
+            }
+        }
+    }
+
+    // a full run replays every frame of every pass and sorts by render type
+    // then distance; tests/llscenereplay_benchmark.cpp times it
+    template<> template<>
+    void scenereplay_object_t::test<3>()
+    {
+        const U32 PASSES = 2;
+        LLSceneReplay replay(mRecording);
+        LLSceneReplay::Stats stats = replay.run(PASSES);
+        ensure_equals("frames replayed", stats.mFrames, (U32)mRecording.mFrames.size() * PASSES);
+
+        std::vector<LLSceneReplay::Visible> visible;
+        LLCamera camera;
+        LLSceneRecording::setupCamera(mRecording.mFrames[0], camera);
+        replay.cull(camera, visible);
+        LLSceneReplay::sort(visible);
+        for (size_t i = 1; i < visible.size(); i++)
+        {
+            const LLSceneReplay::Visible& a = visible[i - 1];
+            const LLSceneReplay::Visible& b = visible[i];
+            ensure("sorted by render type then distance",
+                   a.mElement->mRenderType < b.mElement->mRenderType ||
+                   (a.mElement->mRenderType == b.mElement->mRenderType && a.mDistance <= b.mDistance));
+        }
+    }
+}
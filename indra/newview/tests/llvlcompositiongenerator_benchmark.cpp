@@ -0,0 +1,105 @@
+/**
+ * @file llvlcompositiongenerator_benchmark.cpp
+ * @brief Times a region composition one value at a time, by rows and by
+ *        rows on a thread pool. Built when LL_BENCHMARKS is set, run by hand.
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltimer.h"
+#include "parallelfor.h"
+#include "threadpool.h"
+
+#include "../llvlcompositiongenerator.h"
+
+#include <iostream>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    const S32 WIDTH = 256;
+    const S32 COUNT = 20;
+
+    const F32 start_height[4] = { 10.f, 12.f, 8.f, 15.f };
+    const F32 height_range[4] = { 40.f, 35.f, 50.f, 45.f };
+    const LLVLCompositionGenerator generator(start_height, height_range, WIDTH, 1.f, 256000.0, 254976.0);
+
+    // synthetic hills, from below water to over the height ranges
+    std::vector<F32> heights(WIDTH * WIDTH);
+    for (S32 j = 0; j < WIDTH; j++)
+    {
+        for (S32 i = 0; i < WIDTH; i++)
+        {
+            heights[j*WIDTH + i] = 25.f + 30.f*sinf(i*0.05f) * cosf(j*0.07f) + 5.f*sinf((i + j)*0.3f);
+        }
+    }
+
+    std::vector<F32> out(WIDTH * WIDTH);
+    auto generate_rows = [&](S32 begin, S32 end)
+    {
+        for (S32 j = begin; j < end; j++)
+        {
+            generator.generateRow(j, 0, WIDTH, &heights[j*WIDTH], &out[j*WIDTH]);
+        }
+    };
+
+    LLTimer timer;
+    for (S32 n = 0; n < COUNT; n++)
+    {
+        for (S32 j = 0; j < WIDTH; j++)
+        {
+            for (S32 i = 0; i < WIDTH; i++)
+            {
+                out[j*WIDTH + i] = generator.generate(i, j, heights[j*WIDTH + i]);
+            }
+        }
+    }
+    const F64 scalar_seconds = timer.getElapsedTimeF64();
+
+    timer.reset();
+    for (S32 n = 0; n < COUNT; n++)
+    {
+        generate_rows(0, WIDTH);
+    }
+    const F64 rows_seconds = timer.getElapsedTimeF64();
+
+    LL::ThreadPool pool("CompositionBenchmark", 3);
+    pool.start();
+    timer.reset();
+    for (S32 n = 0; n < COUNT; n++)
+    {
+        LL::parallel_for("CompositionBenchmark", WIDTH, 8,
+                         [&](size_t begin, size_t end)
+                         {
+                             generate_rows((S32)begin, (S32)end);
+                         });
+    }
+    const F64 parallel_seconds = timer.getElapsedTimeF64();
+    pool.close();
+
+    std::cout << COUNT << " compositions of " << WIDTH << "x" << WIDTH << ": scalar "
+              << scalar_seconds << "s, vectorized " << rows_seconds << "s, parallel "
+              << parallel_seconds << "s" << std::endl;
+    return 0;
+}
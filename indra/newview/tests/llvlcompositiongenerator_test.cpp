@@ -0,0 +1,130 @@
+/**
+ * @file llvlcompositiongenerator_test.cpp
+ *
+ *
+ * $LicenseInfo:firstyear=2024&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2024, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../test/lltut.h"
+
+#include "parallelfor.h"
+#include "threadpool.h"
+
+#include "../llvlcompositiongenerator.h"
+
+#include <vector>
+
+namespace tut
+{
+    struct vlcompositiongenerator
+    {
+        static const S32 WIDTH = 256;
+
+        const F32 mStartHeight[4] = { 10.f, 12.f, 8.f, 15.f };
+        const F32 mHeightRange[4] = { 40.f, 35.f, 50.f, 45.f };
+        // a region away from the grid origin, where the noise lattice has
+        // large coordinates
+        LLVLCompositionGenerator mGenerator{ mStartHeight, mHeightRange, WIDTH, 1.f, 256000.0, 254976.0 };
+        std::vector<F32> mHeights;
+
+        vlcompositiongenerator()
+        {
+            // synthetic hills, from below water to over the height ranges
+            mHeights.resize(WIDTH * WIDTH);
+            for (S32 j = 0; j < WIDTH; j++)
+            {
+                for (S32 i = 0; i < WIDTH; i++)
+                {
+                    mHeights[j*WIDTH + i] = 25.f + 30.f*sinf(i*0.05f) * cosf(j*0.07f) + 5.f*sinf((i + j)*0.3f);
+                }
+            }
+        }
+
+        void generateRows(S32 begin, S32 end, std::vector<F32>& out) const
+        {
+            for (S32 j = begin; j < end; j++)
+            {
+                mGenerator.generateRow(j, 0, WIDTH, &mHeights[j*WIDTH], &out[j*WIDTH]);
+            }
+        }
+    };
+
+    typedef test_group<vlcompositiongenerator> vlcompositiongenerator_t;
+    typedef vlcompositiongenerator_t::object vlcompositiongenerator_object_t;
+    tut::vlcompositiongenerator_t tut_vlcompositiongenerator("LLVLCompositionGenerator");
+
+    // four at a time matches one at a time, including partial rows
+    template<> template<>
+    void vlcompositiongenerator_object_t::test<1>()
+    {
+        std::vector<F32> out(WIDTH);
+        for (S32 j = 0; j < WIDTH; j += 7)
+        {
+            const S32 x_begin = j % 5;
+            const S32 x_end = WIDTH - (j % 3);
+            mGenerator.generateRow(j, x_begin, x_end, &mHeights[j*WIDTH + x_begin], &out[0]);
+            for (S32 i = x_begin; i < x_end; i++)
+            {
+                const F32 expected = mGenerator.generate(i, j, mHeights[j*WIDTH + i]);
+                ensure_approximately_equals_range("composition value", out[i - x_begin], expected, 0.0001f);
+                ensure("composition in range", out[i - x_begin] >= 0.f && out[i - x_begin] <= 3.f);
+            }
+        }
+    }
+
+    // a 256x256 region composition by rows, and by rows on a thread pool,
+    // matches the composition one value at a time
+    template<> template<>
+    void vlcompositiongenerator_object_t::test<2>()
+    {
+        std::vector<F32> scalar(WIDTH * WIDTH);
+        std::vector<F32> rows(WIDTH * WIDTH);
+        std::vector<F32> parallel(WIDTH * WIDTH);
+
+        for (S32 j = 0; j < WIDTH; j++)
+        {
+            for (S32 i = 0; i < WIDTH; i++)
+            {
+                scalar[j*WIDTH + i] = mGenerator.generate(i, j, mHeights[j*WIDTH + i]);
+            }
+        }
+
+        generateRows(0, WIDTH, rows);
+
+        LL::ThreadPool pool("CompositionTest", 3);
+        pool.start();
+        LL::parallel_for("CompositionTest", WIDTH, 8,
+                         [this, &parallel](size_t begin, size_t end)
+                         {
+                             generateRows((S32)begin, (S32)end, parallel);
+                         });
+        pool.close();
+
+        for (S32 i = 0; i < WIDTH * WIDTH; i++)
+        {
+            ensure_approximately_equals_range("rows match", rows[i], scalar[i], 0.0001f);
+            ensure_equals("parallel rows match", parallel[i], rows[i]);
+        }
+    }
+}
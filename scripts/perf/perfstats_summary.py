@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""\
+@file   perfstats_summary.py
+@brief  Summarize and compare frame time recordings from PerfStatsRecordToFile
+
+$LicenseInfo:firstyear=2024&license=viewerlgpl$
+Copyright (c) 2024, Linden Research, Inc.
+$/LicenseInfo$
+"""
+
+import csv
+from logsdir import Error, latest_file, logsdir
+import statistics
+import sys
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    index = min(len(values) - 1, max(0, round(pct / 100.0 * (len(values) - 1))))
+    return values[index]
+
+def direction_changes(values):
+    """count reversals in the direction a setting was moved"""
+    changes = 0
+    last_dir = 0
+    for prev, cur in zip(values, values[1:]):
+        if cur == prev:
+            continue
+        cur_dir = 1 if cur > prev else -1
+        if last_dir and cur_dir != last_dir:
+            changes += 1
+        last_dir = cur_dir
+    return changes
+
+def summarize(path, skip=0):
+    frames = []         # frame time in ms for each usable scene row
+    avatar_share = []   # fraction of each frame spent on avatars
+    far_clip = []
+    max_art = []
+    errors = []         # absolute error of the cost model prediction in ms
+    decisions = {}      # predictive tuner decision -> count
+    avatar_time = {}    # frame -> summed avatar time in us
+    scene_rows = []
+    with open(path, newline='') as inf:
+        for row in csv.DictReader(inf):
+            if row['kind'] == 'avatar':
+                frame = int(row['frame_id'])
+                avatar_time[frame] = avatar_time.get(frame, 0.0) + float(row['combined'])
+            elif row['kind'] == 'scene':
+                scene_rows.append(row)
+
+    for row in scene_rows[skip:]:
+        decision = row.get('decision')
+        if decision and decision not in ('none', 'hold', 'untrained'):
+            decisions[decision] = decisions.get(decision, 0) + 1
+        # frames throttled by the FPS limiter or backgrounding say nothing about cost
+        if float(row['sleep']) or float(row['fpslimit']):
+            continue
+        frame_us = float(row['frame'])
+        if frame_us <= 0:
+            continue
+        frames.append(frame_us / 1000.0)
+        avatar_share.append(avatar_time.get(int(row['frame_id']), 0.0) / frame_us)
+        far_clip.append(float(row['far_clip']))
+        max_art.append(float(row['max_art_us']))
+        predicted = float(row.get('predicted_ms') or 0)
+        if predicted:
+            errors.append(abs(predicted - frame_us / 1000.0))
+
+    if not frames:
+        raise Error(f'{path}: no usable frames')
+
+    target_fps = int(scene_rows[-1]['target_fps'] or 0)
+    target_ms = 1000.0 / target_fps if target_fps else 0.0
+    return {
+        'file': str(path),
+        'frames': len(frames),
+        'mean_ms': statistics.fmean(frames),
+        'median_ms': statistics.median(frames),
+        'p95_ms': percentile(frames, 95),
+        'p99_ms': percentile(frames, 99),
+        'fps': 1000.0 / statistics.fmean(frames),
+        'target_fps': target_fps,
+        'over_target': sum(1 for f in frames if target_ms and f > target_ms) / len(frames),
+        'avatar_share': statistics.fmean(avatar_share),
+        'far_clip_min': min(far_clip),
+        'far_clip_max': max(far_clip),
+        'far_clip_reversals': direction_changes(far_clip),
+        'max_art_reversals': direction_changes(max_art),
+        'model_error_ms': statistics.fmean(errors) if errors else 0.0,
+        'tune_changes': sum(decisions.values()),
+        'decisions': decisions,
+    }
+
+FIELDS = [
+    ('frames', '{:d}'),
+    ('fps', '{:.1f}'),
+    ('target_fps', '{:d}'),
+    ('mean_ms', '{:.2f}'),
+    ('median_ms', '{:.2f}'),
+    ('p95_ms', '{:.2f}'),
+    ('p99_ms', '{:.2f}'),
+    ('over_target', '{:.1%}'),
+    ('avatar_share', '{:.1%}'),
+    ('far_clip_min', '{:.0f}'),
+    ('far_clip_max', '{:.0f}'),
+    ('far_clip_reversals', '{:d}'),
+    ('max_art_reversals', '{:d}'),
+    ('model_error_ms', '{:.2f}'),
+    ('tune_changes', '{:d}'),
+    ]
+
+def report(summaries, file=sys.stdout):
+    width = max(len(name) for name, _ in FIELDS)
+    for i, s in enumerate(summaries):
+        print(f'[{i}] {s["file"]}', file=file)
+    print(' ' * width + ''.join(f'{f"[{i}]":>12}' for i in range(len(summaries))), file=file)
+    for name, fmt in FIELDS:
+        print(f'{name:<{width}}' + ''.join(f'{fmt.format(s[name]):>12}' for s in summaries), file=file)
+    for i, s in enumerate(summaries):
+        if s['decisions']:
+            print(f'[{i}] decisions: ' + ', '.join(f'{k}={v}' for k, v in sorted(s['decisions'].items())),
+                  file=file)
+
+def main(*raw_args):
+    from argparse import ArgumentParser
+    parser = ArgumentParser(description="""
+%(prog)s summarizes one or more perfstats.*.csv files written with the
+PerfStatsRecordToFile setting: frame time distribution, the share of each
+frame spent on avatars, how often the autotuner reversed its draw
+distance and avatar render time decisions and, with AutoTunePredictive,
+how well the cost model predicted frame times and which changes it made. Pass several files to compare
+tuning strategies or builds side by side.
+""")
+    parser.add_argument('-s', '--skip', type=int, default=0,
+                        help="""ignore the first SKIP frames of each recording (warm up)""")
+    parser.add_argument('paths', nargs='*',
+                        help="""recordings to summarize (default is most recent)""")
+
+    args = parser.parse_args(raw_args)
+    paths = args.paths or [latest_file(logsdir(), 'perfstats.*.csv')]
+    report([summarize(path, args.skip) for path in paths])
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main(*sys.argv[1:]))
+    except (Error, OSError, KeyError, ValueError) as err:
+        sys.exit(str(err))